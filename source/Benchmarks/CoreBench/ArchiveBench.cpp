@@ -0,0 +1,267 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "ArchiveBench.h"
+#include "T3DZipArchive.h"
+#include "minizip/zip.h"
+#include "minizip/unzip.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t FILE_COUNT = 10000;
+    const uint32_t FILE_SIZE = 4096;
+    const uint32_t LOOKUP_FILE_SIZE = 64;
+    const uint32_t LOOKUP_QUERIES = 1000;
+    const uint32_t LOCATE_QUERIES = 20;
+    const char * const ZIP_NAME = "T3DCoreBench.zip";
+
+    /// 公开 load() 和 unload()，不经过插件和档案管理器
+    class BenchZipArchive : public ZipArchive
+    {
+    public:
+        BenchZipArchive(const String &name)
+            : ZipArchive(name)
+        {
+        }
+
+        using ZipArchive::load;
+        using ZipArchive::unload;
+    };
+
+    String makeName(uint32_t i)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Assets/Meshes/part_%05u.mesh", i);
+        return name;
+    }
+
+    /// 生成测试用的 zip，内容是能压缩一半左右的伪随机数据
+    bool makeZip(const TArray<String> &names, uint32_t fileSize = FILE_SIZE)
+    {
+        zipFile zip = zipOpen64(ZIP_NAME, APPEND_STATUS_CREATE);
+        if (zip == nullptr)
+            return false;
+
+        TArray<uint8_t> data(fileSize);
+        uint32_t seed = 12345;
+        bool ok = true;
+
+        for (size_t i = 0; i < names.size() && ok; ++i)
+        {
+            for (uint32_t k = 0; k < fileSize; ++k)
+            {
+                seed = seed * 1103515245 + 12345;
+                data[k] = (uint8_t)('a' + ((seed >> 16) & 15));
+            }
+
+            ok = (zipOpenNewFileInZip(zip, names[i].c_str(), nullptr,
+                nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED,
+                Z_DEFAULT_COMPRESSION) == ZIP_OK);
+            ok = ok && (zipWriteInFileInZip(zip, &data[0], fileSize)
+                == ZIP_OK);
+            ok = ok && (zipCloseFileInZip(zip) == ZIP_OK);
+        }
+
+        zipClose(zip, nullptr);
+        return ok;
+    }
+
+    /// 不同文件数量的 zip 里 exists() 和 read() 的查找耗时，
+    /// 参照组是原来每次调用 unzLocateFile 线性扫描中央目录
+    void benchLookup(BenchHarness &bench, uint32_t fileCount)
+    {
+        TArray<String> names(fileCount);
+        for (uint32_t i = 0; i < fileCount; ++i)
+        {
+            names[i] = makeName(i);
+        }
+
+        if (!makeZip(names, LOOKUP_FILE_SIZE))
+        {
+            fprintf(stderr, "Create %s failed !\n", ZIP_NAME);
+            return;
+        }
+
+        ArchivePtr archive = new BenchZipArchive(ZIP_NAME);
+        archive->release();
+
+        if (((BenchZipArchive *)(Archive *)archive)->load() != T3D_ERR_OK)
+        {
+            fprintf(stderr, "Load %s failed !\n", ZIP_NAME);
+            remove(ZIP_NAME);
+            return;
+        }
+
+        // 查询的文件均匀分布在整个中央目录里
+        TArray<String> queries(LOOKUP_QUERIES);
+        srand(12345);
+        for (uint32_t i = 0; i < LOOKUP_QUERIES; ++i)
+        {
+            queries[i] = names[rand() % fileCount];
+        }
+
+        char title[128];
+        size_t found = 0;
+
+        snprintf(title, sizeof(title), "ZipArchive.exists/%u entries",
+            fileCount);
+        bench.run(title, 100, LOOKUP_QUERIES, [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += archive->exists(name) ? 1 : 0;
+            }
+        });
+
+        snprintf(title, sizeof(title), "ZipArchive.read/%u entries x %uB",
+            fileCount, LOOKUP_FILE_SIZE);
+        bench.run(title, 10, LOOKUP_QUERIES, [&]()
+        {
+            for (const String &name : queries)
+            {
+                MemoryDataStream stream;
+                archive->read(name, stream);
+                found += stream.size();
+            }
+        });
+
+        ((BenchZipArchive *)(Archive *)archive)->unload();
+
+        unzFile zip = unzOpen64(ZIP_NAME);
+
+        if (zip != nullptr)
+        {
+            snprintf(title, sizeof(title),
+                "ZipArchive.exists/%u entries unzLocateFile baseline",
+                fileCount);
+            bench.run(title, 10, LOCATE_QUERIES, [&]()
+            {
+                for (uint32_t i = 0; i < LOCATE_QUERIES; ++i)
+                {
+                    found += (unzLocateFile(zip, queries[i].c_str(), 1)
+                        == UNZ_OK) ? 1 : 0;
+                }
+            });
+
+            unzClose(zip);
+        }
+
+        doNotOptimize(found);
+
+        remove(ZIP_NAME);
+    }
+}
+
+
+void benchArchive(BenchHarness &bench)
+{
+    // ZipArchive::load() 用引擎的程序路径拼接档案位置，这里只需要一个
+    // 空路径的引擎对象，不初始化，也不销毁（析构要求已经初始化过）
+    if (Engine::getInstancePtr() == nullptr)
+    {
+        new Engine();
+    }
+
+    const uint32_t lookupCounts[] = { 100, 1000, 10000 };
+
+    for (uint32_t count : lookupCounts)
+    {
+        benchLookup(bench, count);
+    }
+
+    TArray<String> names(FILE_COUNT);
+    for (uint32_t i = 0; i < FILE_COUNT; ++i)
+    {
+        names[i] = makeName(i);
+    }
+
+    if (!makeZip(names))
+    {
+        fprintf(stderr, "Create %s failed !\n", ZIP_NAME);
+        return;
+    }
+
+    {
+        ArchivePtr archive = new BenchZipArchive(ZIP_NAME);
+        archive->release();
+
+        if (((BenchZipArchive *)(Archive *)archive)->load() != T3D_ERR_OK)
+        {
+            fprintf(stderr, "Load %s failed !\n", ZIP_NAME);
+            remove(ZIP_NAME);
+            return;
+        }
+
+        // 打乱请求顺序，readMany() 要自己按 zip 里的顺序排
+        TArray<String> queries(names);
+        srand(12345);
+        for (size_t i = queries.size() - 1; i > 0; --i)
+        {
+            std::swap(queries[i], queries[rand() % (i + 1)]);
+        }
+
+        size_t bytes = 0;
+
+        bench.run("ZipArchive.read/10k x 4KB serial", 5, FILE_COUNT, [&]()
+        {
+            for (const String &name : queries)
+            {
+                MemoryDataStream stream;
+                archive->read(name, stream);
+                bytes += stream.size();
+            }
+        });
+
+        const size_t threads[] = { 1, 2, 4, 8, 0 };
+        const char *titles[] =
+        {
+            "ZipArchive.readMany/10k x 4KB 1 thread",
+            "ZipArchive.readMany/10k x 4KB 2 threads",
+            "ZipArchive.readMany/10k x 4KB 4 threads",
+            "ZipArchive.readMany/10k x 4KB 8 threads",
+            "ZipArchive.readMany/10k x 4KB hardware threads",
+        };
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t)
+        {
+            bench.run(titles[t], 5, FILE_COUNT, [&]()
+            {
+                TArray<MemoryDataStream> streams;
+                archive->readMany(queries, streams, threads[t]);
+                bytes += streams.back().size();
+            });
+        }
+
+        bench.note("  %u files, %u hardware threads\n", FILE_COUNT,
+            (uint32_t)TThread::hardware_concurrency());
+
+        doNotOptimize(bytes);
+
+        ((BenchZipArchive *)(Archive *)archive)->unload();
+    }
+
+    remove(ZIP_NAME);
+}
@@ -0,0 +1,131 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "LogBench.h"
+#include <T3DLog.h>
+#include <stdio.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t ITEMS_PER_PRODUCER = 4000;
+
+    /**
+     * @brief 启动一个 Logger，producers 个线程各写 ITEMS_PER_PRODUCER 条日志，
+     *      再关闭 Logger 等异步线程把日志全部写到文件
+     * @param [in] deferred : true 用 traceDeferred()，false 用 trace()
+     * @return 返回被丢弃的日志数量
+     */
+    uint64_t logBurst(uint32_t producers, bool deferred)
+    {
+        Logger *logger = new Logger();
+        logger->setLevel(Logger::E_LEVEL_INFO);
+        logger->startup(2000, "LogBench");
+
+        auto work = [logger, deferred](uint32_t producer)
+        {
+            for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; ++i)
+            {
+                if (deferred)
+                {
+                    logger->traceDeferred(Logger::E_LEVEL_INFO, __FILE__,
+                        __LINE__, "producer [%u] item [%u] value [%f]",
+                        producer, i, (float64_t)i * 0.5);
+                }
+                else
+                {
+                    logger->trace(Logger::E_LEVEL_INFO, __FILE__, __LINE__,
+                        "producer [%u] item [%u] value [%f]",
+                        producer, i, (float64_t)i * 0.5);
+                }
+            }
+        };
+
+        TArray<TThread> workers;
+        workers.reserve(producers - 1);
+
+        for (uint32_t p = 1; p < producers; ++p)
+        {
+            workers.push_back(TThread(work, p));
+        }
+
+        work(0);
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        logger->shutdown();
+
+        uint64_t dropped = logger->getDroppedCount();
+        T3D_SAFE_DELETE(logger);
+        return dropped;
+    }
+}
+
+
+void benchLog(BenchHarness &bench)
+{
+    // Logger 的写回定时器和日志路径都要用到 System，不销毁
+    if (System::getInstancePtr() == nullptr)
+    {
+        new System();
+        System::getInstance().init();
+    }
+
+    const uint32_t producerCounts[] = { 1, 2, 4, 8 };
+    char name[128];
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        bool deferred = (mode == 0);
+
+        for (uint32_t producers : producerCounts)
+        {
+            uint64_t dropped = 0;
+            uint64_t total = 0;
+            int64_t elapsed = 0;
+
+            // 吞吐量按调用次数算，丢弃的日志也算在内，
+            // 另外输出真正写到文件的日志每秒条数
+            snprintf(name, sizeof(name), "Logger.%s/%u producers",
+                deferred ? "traceDeferred" : "trace", producers);
+            bench.run(name, 5, producers * ITEMS_PER_PRODUCER, [&]()
+            {
+                int64_t start = Clock::currentNanoseconds();
+                dropped += logBurst(producers, deferred);
+                elapsed += Clock::currentNanoseconds() - start;
+                total += producers * ITEMS_PER_PRODUCER;
+            });
+
+            float64_t written = (float64_t)(total - dropped);
+            float64_t seconds = (float64_t)elapsed / 1000000000.0;
+
+            bench.note("  %.0f items/s written, %llu of %llu items dropped "
+                "because the queue was full\n",
+                seconds > 0.0 ? written / seconds : 0.0,
+                (unsigned long long)dropped, (unsigned long long)total);
+        }
+    }
+}
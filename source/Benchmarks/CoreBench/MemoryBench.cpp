@@ -0,0 +1,171 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "MemoryBench.h"
+#include <T3DPlatform.h>
+#include <stdio.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t BLOCK_COUNT = 1000;
+    const uint32_t THREAD_BLOCKS = 100;
+    const uint32_t THREAD_ROUNDS = 200;
+
+    /// Object 派生类常见的几种大小
+    const size_t BLOCK_SIZES[] = { 24, 48, 64, 96, 128, 200, 256, 400 };
+    const size_t BLOCK_SIZE_COUNT = sizeof(BLOCK_SIZES) / sizeof(BLOCK_SIZES[0]);
+
+    struct PoolPolicy
+    {
+        static void *allocate(size_t size)
+        {
+            return T3D_POOL_ALLOCATOR.allocate(size);
+        }
+
+        static void deallocate(void *ptr, size_t size)
+        {
+            T3D_POOL_ALLOCATOR.deallocate(ptr, size);
+        }
+    };
+
+    struct SystemPolicy
+    {
+        static void *allocate(size_t size)
+        {
+            return ::operator new(size);
+        }
+
+        static void deallocate(void *ptr, size_t)
+        {
+            ::operator delete(ptr);
+        }
+    };
+
+    /// 分配一批不同大小的内存块，写一下再全部释放
+    template <typename Policy>
+    void allocFreeBatch(void **blocks, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            size_t size = BLOCK_SIZES[i % BLOCK_SIZE_COUNT];
+            blocks[i] = Policy::allocate(size);
+            *(uint32_t *)blocks[i] = i;
+        }
+
+        doNotOptimize(blocks[count - 1]);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            Policy::deallocate(blocks[i], BLOCK_SIZES[i % BLOCK_SIZE_COUNT]);
+        }
+    }
+
+    /// 每个线程各自反复分配释放，当前线程也算一个
+    template <typename Policy>
+    void allocFreeThreads(uint32_t threads)
+    {
+        auto work = []()
+        {
+            void *blocks[THREAD_BLOCKS];
+
+            for (uint32_t r = 0; r < THREAD_ROUNDS; ++r)
+            {
+                allocFreeBatch<Policy>(blocks, THREAD_BLOCKS);
+            }
+        };
+
+        TArray<TThread> workers;
+        workers.reserve(threads - 1);
+
+        for (uint32_t i = 1; i < threads; ++i)
+        {
+            workers.push_back(TThread(work));
+        }
+
+        work();
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    template <typename Policy>
+    void runCases(BenchHarness &bench, const char *policy)
+    {
+        char name[128];
+        void *blocks[BLOCK_COUNT];
+
+        snprintf(name, sizeof(name), "Memory.allocFree/64 %s", policy);
+        bench.run(name, 100, BLOCK_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < BLOCK_COUNT; ++i)
+            {
+                void *ptr = Policy::allocate(64);
+                doNotOptimize(ptr);
+                Policy::deallocate(ptr, 64);
+            }
+        });
+
+        snprintf(name, sizeof(name), "Memory.batch/1000 mixed %s", policy);
+        bench.run(name, 100, BLOCK_COUNT, [&]()
+        {
+            allocFreeBatch<Policy>(blocks, BLOCK_COUNT);
+        });
+
+        const uint32_t threadCounts[] = { 1, 2, 4 };
+
+        for (uint32_t threads : threadCounts)
+        {
+            snprintf(name, sizeof(name), "Memory.threads/%u %s", threads,
+                policy);
+            bench.run(name, 10, threads * THREAD_ROUNDS * THREAD_BLOCKS, [&]()
+            {
+                allocFreeThreads<Policy>(threads);
+            });
+        }
+    }
+}
+
+
+void benchMemory(BenchHarness &bench)
+{
+    runCases<PoolPolicy>(bench, "PoolAllocator");
+    runCases<SystemPolicy>(bench, "system");
+
+    TArray<MemoryPool::Stats> stats;
+    T3D_POOL_ALLOCATOR.getStats(stats);
+
+    size_t chunks = 0;
+    size_t peak = 0;
+
+    for (const auto &s : stats)
+    {
+        chunks += s.chunkCount;
+        peak += s.peakBlocks * s.blockSize;
+    }
+
+    bench.note("  %u pools, %u chunks, peak %u bytes in use\n",
+        (uint32_t)stats.size(), (uint32_t)chunks, (uint32_t)peak);
+}
@@ -0,0 +1,263 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "ResourceBench.h"
+#include <Tiny3D.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t RESOURCE_COUNT = 100000;
+
+    /// 什么都不做的资源，只用来填满缓存
+    class BenchResource : public Resource
+    {
+    public:
+        BenchResource(const String &name)
+            : Resource(name)
+        {
+        }
+
+        virtual Type getType() const override
+        {
+            return E_TYPE_UNKNOWN;
+        }
+
+    protected:
+        virtual TResult load() override
+        {
+            mIsLoaded = true;
+            return T3D_ERR_OK;
+        }
+
+        virtual ResourcePtr clone() const override
+        {
+            return nullptr;
+        }
+    };
+
+    class BenchResourceManager : public ResourceManager
+    {
+    public:
+        BenchResourceManager()
+        {
+        }
+
+        virtual ~BenchResourceManager()
+        {
+            cancelAsyncLoads();
+        }
+
+    protected:
+        virtual ResourcePtr create(const String &name, int32_t argc,
+            va_list args) override
+        {
+            ResourcePtr res = new BenchResource(name);
+            res->release();
+            return res;
+        }
+    };
+
+    /// 参照组：原来的缓存结构，名称到克隆ID再到资源的两层 TMap
+    class LegacyResourceCache
+    {
+    public:
+        void insert(const ResourcePtr &res)
+        {
+            mCache[res->getName()].insert(ResourcesValue(0, res));
+        }
+
+        ResourcePtr getResource(const String &name, ID cloneID = 0) const
+        {
+            ResourcePtr res = nullptr;
+
+            auto i = mCache.find(name);
+
+            if (i != mCache.end())
+            {
+                const Resources &resources = i->second;
+
+                auto itr = resources.find(cloneID);
+
+                if (itr != resources.end())
+                {
+                    res = itr->second;
+                }
+            }
+
+            return res;
+        }
+
+    protected:
+        typedef TMap<ID, ResourcePtr>       Resources;
+        typedef Resources::value_type       ResourcesValue;
+        typedef TMap<String, Resources>     ResourcesMap;
+
+        ResourcesMap    mCache;
+    };
+
+    /// 模拟资源路径，前缀相同，字符串比较要比到后面才能分出大小
+    String makeName(uint32_t i)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "Assets/Textures/Terrain/tile_%06u.dds", i);
+        return name;
+    }
+}
+
+
+void benchResource(BenchHarness &bench)
+{
+    // 资源管理器是事件处理对象，要先有事件管理器
+    EventManager *eventMgr = new EventManager(10);
+
+    {
+        ResourceManagerPtr mgr = new BenchResourceManager();
+        mgr->release();
+
+        LegacyResourceCache legacy;
+
+        TArray<String> names(RESOURCE_COUNT);
+        for (uint32_t i = 0; i < RESOURCE_COUNT; ++i)
+        {
+            names[i] = makeName(i);
+            ResourcePtr res = mgr->load(names[i], 0);
+            legacy.insert(res);
+        }
+
+        // 打乱查找顺序，不让相邻的查找落在相邻的节点和槽上
+        TArray<String> queries(names);
+        srand(12345);
+        for (size_t i = queries.size() - 1; i > 0; --i)
+        {
+            std::swap(queries[i], queries[rand() % (i + 1)]);
+        }
+
+        TArray<uint64_t> hashes(RESOURCE_COUNT);
+        for (uint32_t i = 0; i < RESOURCE_COUNT; ++i)
+        {
+            hashes[i] = StringUtil::hash(queries[i]);
+        }
+
+        // 找不到的名称，只有扩展名不同，在树里会落到各个位置
+        TArray<String> misses(queries);
+        for (String &name : misses)
+        {
+            name.replace(name.length() - 3, 3, "ktx");
+        }
+
+        size_t found = 0;
+
+        bench.run("ResourceCache.getResource/100k TMap baseline", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += (legacy.getResource(name) != nullptr) ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.getResource/100k flat hash", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += (mgr->getResource(name) != nullptr) ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.getResource/100k precomputed hash", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < RESOURCE_COUNT; ++i)
+            {
+                found += (mgr->getResource(hashes[i], queries[i]) != nullptr)
+                    ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.getResource/100k miss TMap baseline", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : misses)
+            {
+                found += (legacy.getResource(name) != nullptr) ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.getResource/100k miss flat hash", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : misses)
+            {
+                found += (mgr->getResource(name) != nullptr) ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.load/100k cached", 10, RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += (mgr->load(name, 0) != nullptr) ? 1 : 0;
+            }
+        });
+
+        // 只比较容器本身，不加锁，不复制智能指针
+        TMap<String, uint32_t> treeMap;
+        TFlatHashMap<String, uint32_t> flatMap;
+        for (uint32_t i = 0; i < RESOURCE_COUNT; ++i)
+        {
+            bool inserted = false;
+            treeMap[names[i]] = i;
+            flatMap.insert(StringUtil::hash(names[i]), names[i], inserted) = i;
+        }
+
+        bench.run("ResourceCache.container/100k TMap", 10, RESOURCE_COUNT,
+            [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += (treeMap.find(name) != treeMap.end()) ? 1 : 0;
+            }
+        });
+
+        bench.run("ResourceCache.container/100k TFlatHashMap", 10,
+            RESOURCE_COUNT, [&]()
+        {
+            for (const String &name : queries)
+            {
+                found += (flatMap.find(StringUtil::hash(name), name) != nullptr)
+                    ? 1 : 0;
+            }
+        });
+
+        bench.note("  %u resources, table capacity %u\n", RESOURCE_COUNT,
+            (uint32_t)flatMap.capacity());
+
+        doNotOptimize(found);
+    }
+
+    delete eventMgr;
+}
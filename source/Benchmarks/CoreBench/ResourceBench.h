@@ -0,0 +1,34 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __RESOURCE_BENCH_H__
+#define __RESOURCE_BENCH_H__
+
+
+#include "BenchHarness.h"
+
+
+/**
+ * @brief 10 万个缓存资源时 ResourceManager::getResource() 的查找耗时，
+ *      以原来按名称索引的两层 TMap 作为参照组
+ */
+void benchResource(BenchHarness &bench);
+
+
+#endif  /*__RESOURCE_BENCH_H__*/
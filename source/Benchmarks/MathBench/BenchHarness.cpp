@@ -0,0 +1,337 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "BenchHarness.h"
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <cmath>
+#include <regex>
+#include <thread>
+
+
+namespace
+{
+    /// 取 --name=value 形式参数的值，名字不匹配时返回 nullptr
+    const char *matchFlag(const char *arg, const char *name)
+    {
+        size_t len = strlen(name);
+
+        if (strncmp(arg, name, len) == 0 && arg[len] == '=')
+            return arg + len + 1;
+
+        return nullptr;
+    }
+
+    /// 已排序数组的百分位数，取最近的排名
+    float64_t percentile(const TArray<float64_t> &sorted,
+        float64_t p)
+    {
+        size_t rank = (size_t)std::ceil(p * sorted.size());
+        rank = std::max<size_t>(rank, 1);
+        return sorted[std::min(rank, sorted.size()) - 1];
+    }
+
+    void writeJsonString(FILE *file, const std::string &str)
+    {
+        fputc('"', file);
+
+        for (size_t i = 0; i < str.size(); ++i)
+        {
+            char c = str[i];
+
+            if (c == '"' || c == '\\')
+                fprintf(file, "\\%c", c);
+            else if ((unsigned char)c < 0x20)
+                fprintf(file, "\\u%04x", c);
+            else
+                fputc(c, file);
+        }
+
+        fputc('"', file);
+    }
+}
+
+
+const uint32_t BenchHarness::DEFAULT_REPETITIONS;
+
+
+BenchHarness::BenchHarness(const char *title)
+    : mTitle(title)
+    , mRepetitions(0)
+    , mJsonStdout(false)
+    , mLastSelected(true)
+{
+}
+
+bool BenchHarness::init(int argc, char *argv[])
+{
+    if (argc > 0)
+        mExecutable = argv[0];
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = nullptr;
+
+        if ((value = matchFlag(arg, "--benchmark_filter")) != nullptr)
+        {
+            mFilter = value;
+        }
+        else if ((value = matchFlag(arg, "--benchmark_repetitions")) != nullptr)
+        {
+            mRepetitions = (uint32_t)atoi(value);
+        }
+        else if ((value = matchFlag(arg, "--benchmark_format")) != nullptr)
+        {
+            if (strcmp(value, "json") == 0)
+                mJsonStdout = true;
+            else if (strcmp(value, "console") == 0)
+                mJsonStdout = false;
+            else
+            {
+                fprintf(stderr, "Unsupported format : %s\n", value);
+                return false;
+            }
+        }
+        else if ((value = matchFlag(arg, "--benchmark_out")) != nullptr)
+        {
+            mOutput = value;
+        }
+        else if ((value = matchFlag(arg, "--benchmark_out_format")) != nullptr)
+        {
+            if (strcmp(value, "json") != 0)
+            {
+                fprintf(stderr, "Unsupported output format : %s\n", value);
+                return false;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown argument : %s\n"
+                "Usage : %s [--benchmark_filter=<regex>] "
+                "[--benchmark_repetitions=<n>] "
+                "[--benchmark_format=<console|json>] "
+                "[--benchmark_out=<file>]\n", arg, argv[0]);
+            return false;
+        }
+    }
+
+    if (!mFilter.empty())
+    {
+        try
+        {
+            std::regex check(mFilter);
+        }
+        catch (const std::regex_error &)
+        {
+            fprintf(stderr, "Invalid filter : %s\n", mFilter.c_str());
+            return false;
+        }
+    }
+
+    note("%s [%s]\n", mTitle.c_str(), getSIMDName());
+    return true;
+}
+
+const char *BenchHarness::getSIMDName()
+{
+#if defined (T3D_SIMD_AVX)
+    return "AVX";
+#elif defined (T3D_SIMD_SSE2)
+    return "SSE2";
+#elif defined (T3D_SIMD_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+bool BenchHarness::isSelected(const char *name) const
+{
+    return mFilter.empty() || std::regex_search(name, std::regex(mFilter));
+}
+
+uint32_t BenchHarness::getRepetitions(uint32_t iterations) const
+{
+    if (mRepetitions > 0)
+        return mRepetitions;
+
+    return std::max<uint32_t>(1, std::min(iterations, DEFAULT_REPETITIONS));
+}
+
+void BenchHarness::note(const char *format, ...)
+{
+    if (!mLastSelected)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(mJsonStdout ? stderr : stdout, format, args);
+    va_end(args);
+}
+
+void BenchHarness::report(const char *name,
+    const TArray<int64_t> &elapsed, uint32_t calls, uint32_t items)
+{
+    Result result;
+    result.name = name;
+    result.itemsPerRepetition = (uint64_t)calls * items;
+
+    for (size_t i = 0; i < elapsed.size(); ++i)
+    {
+        float64_t ns = result.itemsPerRepetition > 0
+            ? (float64_t)elapsed[i] / result.itemsPerRepetition : 0.0;
+        result.nsPerItem.push_back(ns);
+    }
+
+    TArray<float64_t> sorted(result.nsPerItem);
+    std::sort(sorted.begin(), sorted.end());
+
+    float64_t median = percentile(sorted, 0.5);
+    float64_t p99 = percentile(sorted, 0.99);
+    float64_t itemsPerSec = median > 0.0 ? 1000000000.0 / median : 0.0;
+
+    note("%-36s %10.2f ns/item (p99 %10.2f) %14.0f items/s\n", name, median,
+        p99, itemsPerSec);
+
+    mResults.push_back(result);
+}
+
+int BenchHarness::finish()
+{
+    if (mJsonStdout)
+        writeJson(stdout);
+
+    if (!mOutput.empty())
+    {
+        FILE *file = fopen(mOutput.c_str(), "w");
+
+        if (file == nullptr)
+        {
+            fprintf(stderr, "Failed to open %s\n", mOutput.c_str());
+            return 1;
+        }
+
+        writeJson(file);
+        fclose(file);
+    }
+
+    return 0;
+}
+
+void BenchHarness::writeJson(FILE *file) const
+{
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(file, "{\n  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"executable\": ");
+    writeJsonString(file, mExecutable);
+    fprintf(file, ",\n    \"num_cpus\": %u,\n",
+        std::thread::hardware_concurrency());
+    fprintf(file, "    \"mhz_per_cpu\": 0,\n");
+    fprintf(file, "    \"cpu_scaling_enabled\": false,\n");
+    fprintf(file, "    \"simd\": \"%s\",\n", getSIMDName());
+#if defined (NDEBUG)
+    fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(file, "  },\n  \"benchmarks\": [");
+
+    const char *separator = "\n";
+
+    for (size_t i = 0; i < mResults.size(); ++i)
+    {
+        const Result &result = mResults[i];
+        size_t repetitions = result.nsPerItem.size();
+
+        // 每次重复一条记录，时间的单位是处理一个元素的纳秒数
+        for (size_t r = 0; r < repetitions; ++r)
+        {
+            float64_t ns = result.nsPerItem[r];
+            fprintf(file, "%s    {\n      \"name\": ", separator);
+            writeJsonString(file, result.name);
+            fprintf(file, ",\n      \"family_index\": %u,\n"
+                "      \"per_family_instance_index\": 0,\n"
+                "      \"run_name\": ", (uint32_t)i);
+            writeJsonString(file, result.name);
+            fprintf(file, ",\n      \"run_type\": \"iteration\",\n"
+                "      \"repetitions\": %u,\n"
+                "      \"repetition_index\": %u,\n"
+                "      \"threads\": 1,\n"
+                "      \"iterations\": %llu,\n"
+                "      \"real_time\": %.6e,\n"
+                "      \"cpu_time\": %.6e,\n"
+                "      \"time_unit\": \"ns\",\n"
+                "      \"items_per_second\": %.6e\n    }",
+                (uint32_t)repetitions, (uint32_t)r,
+                (unsigned long long)result.itemsPerRepetition, ns, ns,
+                ns > 0.0 ? 1000000000.0 / ns : 0.0);
+            separator = ",\n";
+        }
+
+        // 统计结果，和 google-benchmark 的 _mean、_median、_stddev 一样，
+        // 另外加上 _p99
+        TArray<float64_t> sorted(result.nsPerItem);
+        std::sort(sorted.begin(), sorted.end());
+
+        float64_t mean = 0.0;
+        for (size_t r = 0; r < repetitions; ++r)
+            mean += sorted[r];
+        mean /= repetitions;
+
+        float64_t variance = 0.0;
+        for (size_t r = 0; r < repetitions; ++r)
+            variance += (sorted[r] - mean) * (sorted[r] - mean);
+        float64_t stddev = repetitions > 1
+            ? std::sqrt(variance / (repetitions - 1)) : 0.0;
+
+        const char *names[4] = { "mean", "median", "stddev", "p99" };
+        float64_t values[4] = { mean, percentile(sorted, 0.5), stddev,
+            percentile(sorted, 0.99) };
+
+        for (int32_t k = 0; k < 4; ++k)
+        {
+            fprintf(file, ",\n    {\n      \"name\": ");
+            writeJsonString(file, result.name + "_" + names[k]);
+            fprintf(file, ",\n      \"family_index\": %u,\n"
+                "      \"per_family_instance_index\": 0,\n"
+                "      \"run_name\": ", (uint32_t)i);
+            writeJsonString(file, result.name);
+            fprintf(file, ",\n      \"run_type\": \"aggregate\",\n"
+                "      \"repetitions\": %u,\n"
+                "      \"threads\": 1,\n"
+                "      \"aggregate_name\": \"%s\",\n"
+                "      \"aggregate_unit\": \"time\",\n"
+                "      \"iterations\": %u,\n"
+                "      \"real_time\": %.6e,\n"
+                "      \"cpu_time\": %.6e,\n"
+                "      \"time_unit\": \"ns\"\n    }",
+                (uint32_t)repetitions, names[k], (uint32_t)repetitions,
+                values[k], values[k]);
+        }
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+}
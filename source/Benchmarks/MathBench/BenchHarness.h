@@ -0,0 +1,159 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __BENCH_HARNESS_H__
+#define __BENCH_HARNESS_H__
+
+
+#include <T3DPlatform.h>
+#include <T3DMathLib.h>
+#include <stdio.h>
+#include <string>
+
+
+/**
+ * @brief 防止编译器把没有使用的计算结果优化掉
+ */
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined (_MSC_VER)
+    const volatile char *p = reinterpret_cast<const volatile char *>(&value);
+    (void)*p;
+#else
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#endif
+}
+
+
+/**
+ * @brief 计时工具，多次运行测试函数，输出每次调用的耗时和吞吐量
+ * @remarks 每个测试先预热，再分成若干次重复分别计时，报告中位数和 p99。
+ *      命令行参数和 google-benchmark 的一致，结果可以输出成它的 JSON 格式，
+ *      用 compare.py 之类的工具对比两次运行：
+ *          --benchmark_filter=<正则>       只运行名字匹配的测试
+ *          --benchmark_repetitions=<n>     每个测试重复计时的次数
+ *          --benchmark_format=<console|json>   标准输出的格式
+ *          --benchmark_out=<文件>          另外把 JSON 结果写到文件
+ */
+class BenchHarness
+{
+public:
+    /// 没有指定重复次数时，每个测试最多重复计时的次数
+    static const uint32_t DEFAULT_REPETITIONS = 10;
+
+    /**
+     * @param [in] title : 开始时输出的标题，后面跟着数学库的指令集
+     */
+    BenchHarness(const char *title = "Tiny3D math benchmark");
+
+    /**
+     * @brief 解析命令行参数
+     * @return 参数有错时返回 false
+     */
+    bool init(int argc, char *argv[]);
+
+    /**
+     * @brief 运行一个测试
+     * @param [in] name : 测试名称
+     * @param [in] iterations : 调用 func 的总次数，平均分到每次重复里
+     * @param [in] items : 每次调用处理的元素个数，用来计算吞吐量
+     * @param [in] func : 测试函数
+     * @remarks 没有指定重复次数时，重复次数不超过 iterations，
+     *      总的调用次数和以前一样
+     */
+    template <typename Func>
+    void run(const char *name, uint32_t iterations, uint32_t items, Func func)
+    {
+        mLastSelected = isSelected(name);
+        if (!mLastSelected)
+            return;
+
+        // 先跑一小段预热缓存和 CPU 频率，不计入结果
+        for (uint32_t i = 0; i < iterations / 10 + 1; ++i)
+        {
+            func();
+        }
+
+        uint32_t repetitions = getRepetitions(iterations);
+        uint32_t calls = (iterations + repetitions - 1) / repetitions;
+        TArray<int64_t> elapsed(repetitions);
+
+        for (uint32_t r = 0; r < repetitions; ++r)
+        {
+            int64_t start = Tiny3D::Clock::currentNanoseconds();
+
+            for (uint32_t i = 0; i < calls; ++i)
+            {
+                func();
+            }
+
+            elapsed[r] = Tiny3D::Clock::currentNanoseconds() - start;
+        }
+
+        report(name, elapsed, calls, items);
+    }
+
+    /**
+     * @brief 输出测试的附加信息（误差、个数等）
+     * @remarks JSON 输出到标准输出时写到标准错误，不会破坏 JSON。
+     *      最近一个测试被过滤掉时不输出，它的附加信息没有意义
+     */
+    void note(const char *format, ...);
+
+    /**
+     * @brief 全部测试结束后输出 JSON
+     * @return 程序的返回值
+     */
+    int finish();
+
+    /**
+     * @brief 当前编译的数学库使用的指令集
+     */
+    static const char *getSIMDName();
+
+protected:
+    struct Result
+    {
+        std::string                 name;
+        uint64_t                    itemsPerRepetition;
+        TArray<float64_t>   nsPerItem;  /// 每次重复的结果
+    };
+
+    bool isSelected(const char *name) const;
+
+    uint32_t getRepetitions(uint32_t iterations) const;
+
+    void report(const char *name, const TArray<int64_t> &elapsed,
+        uint32_t calls, uint32_t items);
+
+    void writeJson(FILE *file) const;
+
+    std::string                 mTitle;
+    std::string                 mExecutable;
+    std::string                 mFilter;
+    std::string                 mOutput;
+    uint32_t                    mRepetitions;   /// 0 表示没有指定
+    bool                        mJsonStdout;
+    bool                        mLastSelected;
+    TArray<Result>      mResults;
+};
+
+
+#endif  /*__BENCH_HARNESS_H__*/
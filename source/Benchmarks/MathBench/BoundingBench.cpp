@@ -0,0 +1,142 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "BoundingBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t POINT_COUNT = 1000000;
+
+    typedef TVector3<float32_t> Vector3f;
+    typedef TBoundingBatch<float32_t> BoundingBatch32;
+
+    float32_t randomRange(float32_t lo, float32_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    /// 扁长的点云，绕任意轴旋转过，用来检验 OBB 能不能找回原来的轴
+    void buildPoints(TArray<Vector3f> &points)
+    {
+        Vector3f axis(1.0f, 2.0f, 3.0f);
+        axis.normalize();
+        TMatrix3<float32_t> rot;
+        rot.fromAxisAngle(axis, TRadian<float32_t>(0.7f));
+
+        points.resize(POINT_COUNT);
+
+        for (uint32_t i = 0; i < POINT_COUNT; ++i)
+        {
+            Vector3f p(randomRange(-40.0f, 40.0f), randomRange(-20.0f, 20.0f),
+                randomRange(-5.0f, 5.0f));
+            points[i] = rot * p + Vector3f(100.0f, 200.0f, 300.0f);
+        }
+    }
+
+    /// 检查球是否包含全部的点，返回最远的点超出的距离
+    float32_t sphereExcess(const TSphere<float32_t> &sphere,
+        const TArray<Vector3f> &points)
+    {
+        float32_t excess = 0.0f;
+
+        for (uint32_t i = 0; i < POINT_COUNT; ++i)
+        {
+            float32_t d = (points[i] - sphere.getCenter()).length()
+                - sphere.getRadius();
+            if (d > excess)
+                excess = d;
+        }
+
+        return excess;
+    }
+}
+
+
+void benchBounding(BenchHarness &bench)
+{
+    srand(18);
+
+    TArray<Vector3f> points;
+    buildPoints(points);
+
+    uint32_t threads = std::thread::hardware_concurrency();
+    Vector3f min1, max1, minN, maxN;
+
+    bench.run("Bounding AABB 1M 1 thread", 8, POINT_COUNT, [&]()
+    {
+        BoundingBatch32::computeBounds(&points[0], POINT_COUNT, min1, max1, 1);
+    });
+
+    bench.run("Bounding AABB 1M N threads", 8, POINT_COUNT, [&]()
+    {
+        BoundingBatch32::computeBounds(&points[0], POINT_COUNT, minN, maxN, 0);
+    });
+
+    Vector3f mean1, meanN;
+    TMatrix3<float32_t> cov1, covN;
+
+    bench.run("Bounding covariance 1M 1 thread", 8, POINT_COUNT, [&]()
+    {
+        BoundingBatch32::computeCovariance(&points[0], POINT_COUNT, mean1,
+            cov1, 1);
+    });
+
+    bench.run("Bounding covariance 1M N threads", 8, POINT_COUNT, [&]()
+    {
+        BoundingBatch32::computeCovariance(&points[0], POINT_COUNT, meanN,
+            covN, 0);
+    });
+
+    TObb<float32_t> obb;
+
+    bench.run("Bounding OBB covariance 1M", 8, POINT_COUNT, [&]()
+    {
+        obb.build(&points[0], POINT_COUNT, TObb<float32_t>::E_BUILD_COVARIANCE);
+    });
+
+    TSphere<float32_t> welzl, ritter;
+
+    bench.run("Bounding sphere Welzl 1M", 8, POINT_COUNT, [&]()
+    {
+        welzl.build(&points[0], POINT_COUNT, TSphere<float32_t>::E_BUILD_WELZL);
+    });
+
+    bench.run("Bounding sphere Ritter 1M", 8, POINT_COUNT, [&]()
+    {
+        ritter.build(&points[0], POINT_COUNT,
+            TSphere<float32_t>::E_BUILD_RITTER);
+    });
+
+    bench.note("Bounding %u threads, AABB identical %d, covariance identical %d\n",
+        threads, (min1 == minN && max1 == maxN) ? 1 : 0,
+        (mean1 == meanN && cov1 == covN) ? 1 : 0);
+    bench.note("Bounding OBB extents %f %f %f (expected 40 20 5)\n",
+        obb.getExtent(0), obb.getExtent(1), obb.getExtent(2));
+    bench.note("Bounding sphere radius Welzl %f (excess %g), "
+        "Ritter %f (excess %g)\n", welzl.getRadius(),
+        sphereExcess(welzl, points), ritter.getRadius(),
+        sphereExcess(ritter, points));
+}
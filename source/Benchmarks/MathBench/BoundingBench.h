@@ -0,0 +1,34 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __BOUNDING_BENCH_H__
+#define __BOUNDING_BENCH_H__
+
+
+#include "BenchHarness.h"
+
+
+/**
+ * @brief 100 万个点构造包围体：AABB（单线程和多线程）、协方差 OBB、
+ *      Welzl 最小包围球和 Ritter 近似包围球，以及单线程和多线程结果的对比
+ */
+void benchBounding(BenchHarness &bench);
+
+
+#endif  /*__BOUNDING_BENCH_H__*/
@@ -0,0 +1,239 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "BroadPhaseBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t OBJECT_COUNT = 50000;
+    // 预先算好的帧数，来回播放，物体的运动是连续的
+    const uint32_t FRAME_COUNT = 8;
+    const float32_t WORLD_SIZE = 100.0f;
+    const float32_t MIN_RADIUS = 0.3f;
+    const float32_t MAX_RADIUS = 1.2f;
+    const float32_t MAX_SPEED = 0.5f;
+
+    typedef TAabbTree<float32_t> AabbTree32;
+    typedef TLooseOctree<float32_t> LooseOctree32;
+
+    float32_t randomRange(float32_t lo, float32_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    struct Scene
+    {
+        /// frames[f][i] 是第 f 帧第 i 个物体
+        TArray<TArray<TSphere<float32_t>>>  spheres;
+        TArray<TArray<TAabb<float32_t>>>    boxes;
+        uint32_t                            frame;
+        int32_t                             step;
+
+        /// 下一帧，0 1 ... FRAME_COUNT-1 FRAME_COUNT-2 ... 1 0 1 ...
+        uint32_t advance()
+        {
+            if (frame + step >= FRAME_COUNT)
+                step = -step;
+            frame += step;
+            return frame;
+        }
+    };
+
+    /// 球在世界里匀速运动，碰到边界反弹
+    void buildScene(Scene &scene)
+    {
+        TArray<TVector3<float32_t>> pos(OBJECT_COUNT), vel(OBJECT_COUNT);
+        TArray<float32_t> radius(OBJECT_COUNT);
+        float32_t half = WORLD_SIZE * 0.5f;
+
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            pos[i] = TVector3<float32_t>(randomRange(-half, half),
+                randomRange(-half, half), randomRange(-half, half));
+            vel[i] = TVector3<float32_t>(randomRange(-1.0f, 1.0f),
+                randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f)) * MAX_SPEED;
+            radius[i] = randomRange(MIN_RADIUS, MAX_RADIUS);
+        }
+
+        scene.spheres.resize(FRAME_COUNT);
+        scene.boxes.resize(FRAME_COUNT);
+        scene.frame = 0;
+        scene.step = 1;
+
+        for (uint32_t f = 0; f < FRAME_COUNT; ++f)
+        {
+            scene.spheres[f].resize(OBJECT_COUNT);
+            scene.boxes[f].resize(OBJECT_COUNT);
+
+            for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+            {
+                TVector3<float32_t> r(radius[i], radius[i], radius[i]);
+                scene.spheres[f][i] = TSphere<float32_t>(pos[i], radius[i]);
+                scene.boxes[f][i].setParam(pos[i] - r, pos[i] + r);
+
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    pos[i][k] += vel[i][k];
+                    if (pos[i][k] < -half || pos[i][k] > half)
+                        vel[i][k] = -vel[i][k];
+                }
+            }
+        }
+    }
+
+    /// 用包围盒两两比较得到的物体对个数，作为正确结果
+    size_t bruteForcePairs(const TArray<TAabb<float32_t>> &boxes)
+    {
+        size_t count = 0;
+
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            for (uint32_t j = i + 1; j < OBJECT_COUNT; ++j)
+            {
+                if (TIntrAabbAabb<float32_t>(boxes[i], boxes[j]).test())
+                    ++count;
+            }
+        }
+
+        return count;
+    }
+
+    /// 粗检测得到的物体对交给球和球的细检测，返回真正相交的个数
+    template <typename BroadPhase>
+    size_t narrowPhase(BroadPhase &broadPhase, size_t &pairs)
+    {
+        size_t contacts = 0;
+
+        pairs = broadPhase.computePairs([&](uint32_t a, uint32_t b)
+        {
+            const TSphere<float32_t> *s0
+                = (const TSphere<float32_t> *)broadPhase.getUserData(a);
+            const TSphere<float32_t> *s1
+                = (const TSphere<float32_t> *)broadPhase.getUserData(b);
+
+            if (TIntrSphereSphere<float32_t>(s0, s1).test())
+                ++contacts;
+        });
+
+        return contacts;
+    }
+}
+
+
+void benchBroadPhase(BenchHarness &bench)
+{
+    srand(17);
+
+    Scene scene;
+    buildScene(scene);
+
+    // 用户数据指向物体当前的球，每帧更新时和包围盒一起更新
+    TArray<TSphere<float32_t>> bodies(scene.spheres[0]);
+    AabbTree32 tree(0.1f);
+    TArray<uint32_t> treeProxies(OBJECT_COUNT);
+
+    bench.run("BroadPhase tree insert 50k", 2, OBJECT_COUNT, [&]()
+    {
+        tree.clear();
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            treeProxies[i] = tree.insert(scene.boxes[0][i], &bodies[i]);
+        }
+    });
+
+    TAabb<float32_t> world;
+    float32_t half = WORLD_SIZE * 0.5f;
+    world.setParam(TVector3<float32_t>(-half, -half, -half),
+        TVector3<float32_t>(half, half, half));
+    // 球的半径在 0.3 到 1.2 之间，第 6 层格子的半边长约 0.78，再深没有意义
+    LooseOctree32 octree(world, 6);
+    TArray<uint32_t> octreeProxies(OBJECT_COUNT);
+
+    bench.run("BroadPhase octree insert 50k", 2, OBJECT_COUNT, [&]()
+    {
+        octree.clear();
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            octreeProxies[i] = octree.insert(scene.boxes[0][i], &bodies[i]);
+        }
+    });
+
+    // 两个结构各自按同样的帧序列更新，结束时停在同一帧
+    scene.frame = 0;
+    scene.step = 1;
+    bench.run("BroadPhase tree update 50k", 32, OBJECT_COUNT, [&]()
+    {
+        uint32_t prev = scene.frame;
+        uint32_t f = scene.advance();
+
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            TVector3<float32_t> d = scene.spheres[f][i].getCenter()
+                - scene.spheres[prev][i].getCenter();
+            bodies[i] = scene.spheres[f][i];
+            tree.move(treeProxies[i], scene.boxes[f][i], d);
+        }
+    });
+    uint32_t treeFrame = scene.frame;
+
+    scene.frame = 0;
+    scene.step = 1;
+    bench.run("BroadPhase octree update 50k", 32, OBJECT_COUNT, [&]()
+    {
+        uint32_t f = scene.advance();
+
+        for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            bodies[i] = scene.spheres[f][i];
+            octree.move(octreeProxies[i], scene.boxes[f][i]);
+        }
+    });
+    T3D_ASSERT(scene.frame == treeFrame);
+
+    size_t treePairs = 0, treeContacts = 0;
+    bench.run("BroadPhase tree pairs 50k", 8, OBJECT_COUNT, [&]()
+    {
+        treeContacts = narrowPhase(tree, treePairs);
+    });
+
+    size_t octreePairs = 0, octreeContacts = 0;
+    bench.run("BroadPhase octree pairs 50k", 8, OBJECT_COUNT, [&]()
+    {
+        octreeContacts = narrowPhase(octree, octreePairs);
+    });
+
+    size_t brutePairs = 0;
+    bench.run("BroadPhase brute force pairs 50k", 1, OBJECT_COUNT, [&]()
+    {
+        brutePairs = bruteForcePairs(scene.boxes[treeFrame]);
+    });
+
+    bench.note("BroadPhase %u objects, tree height %d, %u octree nodes\n",
+        OBJECT_COUNT, tree.getHeight(), (uint32_t)octree.getNodeCount());
+    bench.note("BroadPhase pairs tree %u, octree %u, brute force %u, "
+        "contacts %u / %u\n", (uint32_t)treePairs, (uint32_t)octreePairs,
+        (uint32_t)brutePairs, (uint32_t)treeContacts,
+        (uint32_t)octreeContacts);
+}
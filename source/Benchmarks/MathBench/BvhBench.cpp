@@ -0,0 +1,299 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "BvhBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    // 708 x 708 个格子，每格两个三角形，一共 1002528 个三角形
+    const uint32_t GRID_SIZE = 708;
+    const float32_t GRID_SPACING = 1.0f;
+    // 相机射线是 512 x 512 的图像
+    const uint32_t IMAGE_SIZE = 512;
+    const uint32_t RANDOM_RAY_COUNT = 65536;
+    const uint32_t VERIFY_RAY_COUNT = 64;
+
+    typedef TBvh<float32_t> Bvh32;
+
+    float32_t randomRange(float32_t lo, float32_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    float32_t heightAt(uint32_t x, uint32_t z)
+    {
+        return 8.0f * sinf(x * 0.05f) * cosf(z * 0.07f)
+            + 2.0f * sinf(x * 0.31f + z * 0.17f);
+    }
+
+    /// 高度场网格，三角形从上往下看是逆时针，正面朝上
+    void buildMesh(TArray<TTriangle<float32_t>> &triangles)
+    {
+        triangles.resize(GRID_SIZE * GRID_SIZE * 2);
+        size_t n = 0;
+
+        for (uint32_t z = 0; z < GRID_SIZE; ++z)
+        {
+            for (uint32_t x = 0; x < GRID_SIZE; ++x)
+            {
+                TVector3<float32_t> p00(x * GRID_SPACING, heightAt(x, z),
+                    z * GRID_SPACING);
+                TVector3<float32_t> p10((x + 1) * GRID_SPACING,
+                    heightAt(x + 1, z), z * GRID_SPACING);
+                TVector3<float32_t> p01(x * GRID_SPACING, heightAt(x, z + 1),
+                    (z + 1) * GRID_SPACING);
+                TVector3<float32_t> p11((x + 1) * GRID_SPACING,
+                    heightAt(x + 1, z + 1), (z + 1) * GRID_SPACING);
+
+                TVector3<float32_t> t0[3] = { p00, p01, p11 };
+                TVector3<float32_t> t1[3] = { p00, p11, p10 };
+                triangles[n++].setVertices(t0);
+                triangles[n++].setVertices(t1);
+            }
+        }
+    }
+
+    /// 相机在网格上方斜着往下看，相邻像素的射线方向相近
+    void buildCameraRays(TArray<TRay<float32_t>> &rays)
+    {
+        float32_t extent = GRID_SIZE * GRID_SPACING;
+        TVector3<float32_t> eye(extent * 0.5f, 120.0f, -40.0f);
+        TVector3<float32_t> forward(0.0f, -0.6f, 0.8f);
+        TVector3<float32_t> right(1.0f, 0.0f, 0.0f);
+        TVector3<float32_t> up = forward.cross(right);
+
+        rays.resize(IMAGE_SIZE * IMAGE_SIZE);
+
+        // 按 2x4 的小块排列，一个射线包正好是相邻的 8 个像素
+        size_t n = 0;
+        for (uint32_t by = 0; by < IMAGE_SIZE; by += 2)
+        {
+            for (uint32_t bx = 0; bx < IMAGE_SIZE; bx += 4)
+            {
+                for (uint32_t y = by; y < by + 2; ++y)
+                {
+                    for (uint32_t x = bx; x < bx + 4; ++x)
+                    {
+                        float32_t u = (x + 0.5f) / IMAGE_SIZE * 2.0f - 1.0f;
+                        float32_t v = (y + 0.5f) / IMAGE_SIZE * 2.0f - 1.0f;
+                        TVector3<float32_t> dir = forward + right * u + up * v;
+                        dir.normalize();
+                        rays[n++] = TRay<float32_t>(eye, dir * 2000.0f);
+                    }
+                }
+            }
+        }
+    }
+
+    /// 网格上方随机起点、随机朝下的方向，互相之间没有连贯性
+    void buildRandomRays(TArray<TRay<float32_t>> &rays)
+    {
+        float32_t extent = GRID_SIZE * GRID_SPACING;
+        rays.resize(RANDOM_RAY_COUNT);
+
+        for (uint32_t i = 0; i < RANDOM_RAY_COUNT; ++i)
+        {
+            TVector3<float32_t> origin(randomRange(0.0f, extent),
+                randomRange(15.0f, 60.0f), randomRange(0.0f, extent));
+            TVector3<float32_t> dir(randomRange(-1.0f, 1.0f),
+                randomRange(-1.0f, -0.05f), randomRange(-1.0f, 1.0f));
+            dir.normalize();
+            rays[i] = TRay<float32_t>(origin, dir * 1000.0f);
+        }
+    }
+
+    /// 不用加速结构，逐个三角形求最近交点
+    bool bruteForce(const TArray<TTriangle<float32_t>> &triangles,
+        const TRay<float32_t> &ray, float32_t &tHit)
+    {
+        const TVector3<float32_t> &o = ray.getOrigin();
+        const TVector3<float32_t> &d = ray.getDirection();
+        bool found = false;
+        tHit = 1.0f;
+
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            const TTriangle<float32_t> &tri = triangles[i];
+            TVector3<float32_t> e1 = tri[1] - tri[0];
+            TVector3<float32_t> e2 = tri[2] - tri[0];
+            TVector3<float32_t> p = d.cross(e2);
+            float32_t det = e1.dot(p);
+            if (det <= 0.0f)
+                continue;
+
+            TVector3<float32_t> s = o - tri[0];
+            float32_t u = s.dot(p);
+            if (u < 0.0f || u > det)
+                continue;
+
+            TVector3<float32_t> q = s.cross(e1);
+            float32_t v = d.dot(q);
+            if (v < 0.0f || u + v > det)
+                continue;
+
+            float32_t t = e2.dot(q);
+            if (t < 0.0f || t > tHit * det)
+                continue;
+
+            tHit = t / det;
+            found = true;
+        }
+
+        return found;
+    }
+
+    void verify(BenchHarness &bench, const Bvh32 &bvh,
+        const TArray<TTriangle<float32_t>> &triangles,
+        const TArray<TRay<float32_t>> &rays, const char *name)
+    {
+        uint32_t mismatches = 0;
+        TArray<Bvh32::Hit> packetHits(Bvh32::MAX_PACKET_SIZE);
+        bool anyHits[Bvh32::MAX_PACKET_SIZE];
+
+        // 单条射线、射线包、遮挡检测互相对比
+        for (size_t i = 0; i + Bvh32::MAX_PACKET_SIZE <= rays.size();
+            i += Bvh32::MAX_PACKET_SIZE)
+        {
+            bvh.intersect(&rays[i], Bvh32::MAX_PACKET_SIZE, &packetHits[0]);
+            bvh.intersectAny(&rays[i], Bvh32::MAX_PACKET_SIZE, anyHits);
+
+            for (size_t j = 0; j < Bvh32::MAX_PACKET_SIZE; ++j)
+            {
+                Bvh32::Hit hit;
+                bool found = bvh.intersect(rays[i + j], hit);
+                bool packetFound
+                    = (packetHits[j].primitive != Bvh32::INVALID_INDEX);
+
+                if (found != packetFound || found != anyHits[j]
+                    || found != bvh.intersectAny(rays[i + j])
+                    || (found && fabsf(hit.t - packetHits[j].t) > 1e-5f))
+                {
+                    ++mismatches;
+                }
+            }
+        }
+
+        // 少量射线和暴力求交对比
+        uint32_t bruteMismatches = 0;
+        for (uint32_t i = 0; i < VERIFY_RAY_COUNT; ++i)
+        {
+            const TRay<float32_t> &ray = rays[i * (rays.size() / VERIFY_RAY_COUNT)];
+            Bvh32::Hit hit;
+            float32_t t;
+            bool found = bvh.intersect(ray, hit);
+
+            if (found != bruteForce(triangles, ray, t)
+                || (found && fabsf(hit.t - t) > 1e-5f))
+            {
+                ++bruteMismatches;
+            }
+        }
+
+        bench.note("%-32s %u mismatches (packet/any), %u of %u (brute force)\n",
+            name, mismatches, bruteMismatches, VERIFY_RAY_COUNT);
+    }
+
+    void benchRays(BenchHarness &bench, const Bvh32 &bvh,
+        const TArray<TRay<float32_t>> &rays, const char *type)
+    {
+        TArray<Bvh32::Hit> hits(rays.size());
+        TArray<uint8_t> occluded(rays.size());
+        uint32_t count = (uint32_t)rays.size();
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s closest hit", type);
+        bench.run(name, 4, count, [&]()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                bvh.intersect(rays[i], hits[i]);
+            doNotOptimize(hits[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s any hit", type);
+        bench.run(name, 4, count, [&]()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                occluded[i] = bvh.intersectAny(rays[i]);
+            doNotOptimize(occluded[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s packet 4", type);
+        bench.run(name, 4, count, [&]()
+        {
+            for (uint32_t i = 0; i < count; i += 4)
+                bvh.intersect(&rays[i], 4, &hits[i]);
+            doNotOptimize(hits[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s packet 8", type);
+        bench.run(name, 4, count, [&]()
+        {
+            for (uint32_t i = 0; i < count; i += 8)
+                bvh.intersect(&rays[i], 8, &hits[i]);
+            doNotOptimize(hits[0]);
+        });
+    }
+}
+
+
+void benchBvh(BenchHarness &bench)
+{
+    srand(6);
+
+    TArray<TTriangle<float32_t>> triangles;
+    buildMesh(triangles);
+
+    Bvh32 bvh;
+
+    bench.run("Bvh build 1M triangles (1 thread)", 1, 1, [&]()
+    {
+        bvh.build(&triangles[0], triangles.size(), 4, 1);
+    });
+
+    bench.run("Bvh build 1M triangles (all)", 1, 1, [&]()
+    {
+        bvh.build(&triangles[0], triangles.size());
+    });
+
+    bench.note("Bvh %u triangles, %u nodes, %u bytes per node\n",
+        (uint32_t)triangles.size(), (uint32_t)bvh.getNodeCount(),
+        (uint32_t)sizeof(Bvh32::Node));
+
+    TArray<TRay<float32_t>> cameraRays, randomRays;
+    buildCameraRays(cameraRays);
+    buildRandomRays(randomRays);
+
+    verify(bench, bvh, triangles, cameraRays, "Bvh camera rays");
+    verify(bench, bvh, triangles, randomRays, "Bvh random rays");
+
+    benchRays(bench, bvh, cameraRays, "Bvh camera");
+    benchRays(bench, bvh, randomRays, "Bvh random");
+
+    bench.run("Bvh refit 1M triangles", 2, (uint32_t)triangles.size(), [&]()
+    {
+        bvh.refit(&triangles[0]);
+    });
+}
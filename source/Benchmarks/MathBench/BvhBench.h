@@ -0,0 +1,34 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __BVH_BENCH_H__
+#define __BVH_BENCH_H__
+
+
+#include "BenchHarness.h"
+
+
+/**
+ * @brief 百万三角形的高度场网格上 BVH 的构建时间和每秒射线数，
+ *      包括单条射线、射线包、遮挡检测，以及和暴力求交的结果对比
+ */
+void benchBvh(BenchHarness &bench);
+
+
+#endif  /*__BVH_BENCH_H__*/
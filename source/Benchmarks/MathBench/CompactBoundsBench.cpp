@@ -0,0 +1,263 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "CompactBoundsBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t BOX_COUNT = 1000000;
+    const uint32_t QUERY_COUNT = 16;
+    const float32_t WORLD_SIZE = 1000.0f;
+
+    typedef TVector3<float32_t> Vector3f;
+    typedef TAabb<float32_t> Aabb32;
+    typedef TObb<float32_t> Obb32;
+
+    float32_t randomRange(float32_t lo, float32_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    Vector3f randomPoint(float32_t half)
+    {
+        return Vector3f(randomRange(-half, half), randomRange(-half, half),
+            randomRange(-half, half));
+    }
+
+    Aabb32 randomBox(float32_t maxSize)
+    {
+        Vector3f center = randomPoint(WORLD_SIZE * 0.5f);
+        Vector3f extent(randomRange(0.0f, maxSize), randomRange(0.0f, maxSize),
+            randomRange(0.0f, maxSize));
+        Aabb32 box;
+        box.setParam(center - extent, center + extent);
+        return box;
+    }
+
+    /// 参照组：六个 float 的 AABB，不带 TAabb 里的包围球
+    struct PlainAabb
+    {
+        float32_t   minX, minY, minZ;
+        float32_t   maxX, maxY, maxZ;
+    };
+
+    size_t queryPlain(const TArray<PlainAabb> &boxes, const PlainAabb &q,
+        uint32_t *indices)
+    {
+        size_t found = 0;
+
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            const PlainAabb &b = boxes[i];
+            indices[found] = (uint32_t)i;
+            found += ((b.minX <= q.maxX) & (q.minX <= b.maxX)
+                & (b.minY <= q.maxY) & (q.minY <= b.maxY)
+                & (b.minZ <= q.maxZ) & (q.minZ <= b.maxZ)) ? 1 : 0;
+        }
+
+        return found;
+    }
+}
+
+
+void benchCompactBounds(BenchHarness &bench)
+{
+    srand(19);
+
+    TArray<Aabb32> boxes(BOX_COUNT);
+    TArray<PlainAabb> plain(BOX_COUNT);
+
+    for (uint32_t i = 0; i < BOX_COUNT; ++i)
+    {
+        boxes[i] = randomBox(2.0f);
+        plain[i].minX = boxes[i].getMinX();
+        plain[i].minY = boxes[i].getMinY();
+        plain[i].minZ = boxes[i].getMinZ();
+        plain[i].maxX = boxes[i].getMaxX();
+        plain[i].maxY = boxes[i].getMaxY();
+        plain[i].maxZ = boxes[i].getMaxZ();
+    }
+
+    float32_t half = WORLD_SIZE * 0.5f;
+    Aabb32 world;
+    world.setParam(Vector3f(-half, -half, -half), Vector3f(half, half, half));
+
+    TAabbQuantizer<float32_t> quantizer(world);
+    TArray<TQuantizedAabb<float32_t>> quantized(BOX_COUNT);
+
+    bench.run("Compact AABB quantize 1M", 4, BOX_COUNT, [&]()
+    {
+        quantizer.quantize(&boxes[0], &quantized[0], BOX_COUNT);
+    });
+
+    TArray<Aabb32> queries(QUERY_COUNT);
+    TArray<PlainAabb> plainQueries(QUERY_COUNT);
+    TArray<TQuantizedAabb<float32_t>> quantizedQueries(QUERY_COUNT);
+
+    for (uint32_t i = 0; i < QUERY_COUNT; ++i)
+    {
+        queries[i] = randomBox(50.0f);
+        plainQueries[i].minX = queries[i].getMinX();
+        plainQueries[i].minY = queries[i].getMinY();
+        plainQueries[i].minZ = queries[i].getMinZ();
+        plainQueries[i].maxX = queries[i].getMaxX();
+        plainQueries[i].maxY = queries[i].getMaxY();
+        plainQueries[i].maxZ = queries[i].getMaxZ();
+        quantizedQueries[i] = quantizer.quantize(queries[i]);
+    }
+
+    TArray<uint32_t> indices(BOX_COUNT);
+    size_t exactHits = 0, plainHits = 0, quantizedHits = 0;
+
+    // 三组查询的顺序一样，最后一次查询的命中数可以直接比较
+    bench.run("Compact AABB query TAabb 1M", QUERY_COUNT, BOX_COUNT, [&]()
+    {
+        static uint32_t q = 0;
+        const Aabb32 &query = queries[q++ % QUERY_COUNT];
+        exactHits = 0;
+
+        for (uint32_t i = 0; i < BOX_COUNT; ++i)
+        {
+            if (TIntrAabbAabb<float32_t>(boxes[i], query).test())
+                ++exactHits;
+        }
+    });
+
+    bench.run("Compact AABB query float 1M", QUERY_COUNT, BOX_COUNT, [&]()
+    {
+        static uint32_t q = 0;
+        plainHits = queryPlain(plain, plainQueries[q++ % QUERY_COUNT],
+            &indices[0]);
+    });
+
+    bench.run("Compact AABB query 16-bit 1M", QUERY_COUNT, BOX_COUNT, [&]()
+    {
+        static uint32_t q = 0;
+        quantizedHits = TQuantizedAabb<float32_t>::queryOverlaps(
+            &quantized[0], BOX_COUNT, quantizedQueries[q++ % QUERY_COUNT],
+            &indices[0]);
+    });
+
+    bench.note("Compact AABB bytes per box: TAabb %u, float %u, 16-bit %u\n",
+        (uint32_t)sizeof(Aabb32), (uint32_t)sizeof(PlainAabb),
+        (uint32_t)sizeof(TQuantizedAabb<float32_t>));
+    bench.note("Compact AABB hits: TAabb %u, float %u, 16-bit %u (conservative)\n",
+        (uint32_t)exactHits, (uint32_t)plainHits, (uint32_t)quantizedHits);
+
+    // 半精度向量
+    TArray<Vector3f> points(BOX_COUNT), decoded(BOX_COUNT);
+    TArray<HalfVector3> halfPoints(BOX_COUNT);
+
+    for (uint32_t i = 0; i < BOX_COUNT; ++i)
+    {
+        points[i] = randomPoint(100.0f);
+    }
+
+    bench.run("Compact half Vector3 encode 1M", 4, BOX_COUNT, [&]()
+    {
+        HalfVector3::encode(&points[0], &halfPoints[0], BOX_COUNT);
+    });
+
+    bench.run("Compact half Vector3 decode 1M", 4, BOX_COUNT, [&]()
+    {
+        HalfVector3::decode(&halfPoints[0], &decoded[0], BOX_COUNT);
+    });
+
+    float32_t maxError = 0.0f;
+    for (uint32_t i = 0; i < BOX_COUNT; ++i)
+    {
+        float32_t error = (points[i] - decoded[i]).length();
+        if (error > maxError)
+            maxError = error;
+    }
+
+    bench.note("Compact half Vector3 bytes %u (float %u), max error %g in "
+        "[-100, 100]\n", (uint32_t)sizeof(HalfVector3),
+        (uint32_t)sizeof(Vector3f), maxError);
+
+    // 压缩 OBB
+    const uint32_t OBB_COUNT = BOX_COUNT / 4;
+    TArray<Obb32> obbs(OBB_COUNT);
+    TArray<TCompactObb<float32_t>> compact(OBB_COUNT);
+
+    for (uint32_t i = 0; i < OBB_COUNT; ++i)
+    {
+        Vector3f axis = randomPoint(1.0f);
+        axis.normalize();
+        TMatrix3<float32_t> rot;
+        rot.fromAxisAngle(axis, TRadian<float32_t>(randomRange(-3.0f, 3.0f)));
+        obbs[i] = Obb32(randomPoint(WORLD_SIZE * 0.5f), rot.getColumn(0),
+            rot.getColumn(1), rot.getColumn(2), randomRange(0.1f, 4.0f),
+            randomRange(0.1f, 4.0f), randomRange(0.1f, 4.0f));
+    }
+
+    bench.run("Compact OBB encode 250k", 4, OBB_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < OBB_COUNT; ++i)
+        {
+            compact[i].encode(obbs[i]);
+        }
+    });
+
+    TArray<Obb32> decodedObbs(OBB_COUNT);
+
+    bench.run("Compact OBB decode 250k", 4, OBB_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < OBB_COUNT; ++i)
+        {
+            compact[i].decode(decodedObbs[i]);
+        }
+    });
+
+    TSphere<float32_t> sphere(Vector3f::ZERO, WORLD_SIZE * 0.25f);
+    size_t compactHits = 0;
+
+    bench.run("Compact OBB sphere test 250k", 4, OBB_COUNT, [&]()
+    {
+        compactHits = 0;
+
+        for (uint32_t i = 0; i < OBB_COUNT; ++i)
+        {
+            if (compact[i].test(sphere))
+                ++compactHits;
+        }
+    });
+
+    float32_t maxGrowth = 0.0f;
+    for (uint32_t i = 0; i < OBB_COUNT; ++i)
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            float32_t growth = decodedObbs[i].getExtent(k)
+                - obbs[i].getExtent(k);
+            if (growth > maxGrowth)
+                maxGrowth = growth;
+        }
+    }
+
+    bench.note("Compact OBB bytes %u (TObb %u), max extent growth %g, "
+        "sphere hits %u\n", (uint32_t)sizeof(TCompactObb<float32_t>),
+        (uint32_t)sizeof(Obb32), maxGrowth, (uint32_t)compactHits);
+}
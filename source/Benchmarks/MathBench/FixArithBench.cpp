@@ -0,0 +1,199 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "FixArithBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t DATA_COUNT = 1024;
+    const uint32_t MATRIX_COUNT = 256;
+    const uint32_t ITERATIONS = 4000;
+
+    float64_t randomRange(float64_t lo, float64_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    /// 逐项用定点数运算符相乘再相加，每个乘积都单独舍入一次
+    TMatrix4<fix32_t> multiplyByOperators(const TMatrix4<fix32_t> &a,
+        const TMatrix4<fix32_t> &b)
+    {
+        TMatrix4<fix32_t> result(true);
+        const fix32_t *pa = a;
+        const fix32_t *pb = b;
+        fix32_t *pr = result;
+
+        for (int32_t r = 0; r < 4; ++r)
+        {
+            for (int32_t c = 0; c < 4; ++c)
+            {
+                pr[r * 4 + c] = pa[r * 4 + 0] * pb[0 + c]
+                    + pa[r * 4 + 1] * pb[4 + c]
+                    + pa[r * 4 + 2] * pb[8 + c]
+                    + pa[r * 4 + 3] * pb[12 + c];
+            }
+        }
+
+        return result;
+    }
+
+    template <typename F>
+    void benchType(BenchHarness &bench, const char *type)
+    {
+        TArray<F> a(DATA_COUNT), b(DATA_COUNT), results(DATA_COUNT);
+
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            a[i] = F(randomRange(-100.0, 100.0));
+            b[i] = F(randomRange(0.5, 100.0));
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s a * b + c (operators)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            F sum(0);
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                sum = a[i] * b[i] + sum;
+            doNotOptimize(sum);
+        });
+
+        snprintf(name, sizeof(name), "%s mulAdd (wrap)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            F sum(0);
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                sum = TFixOps<FixWrapPolicy>::mulAdd(a[i], b[i], sum);
+            doNotOptimize(sum);
+        });
+
+        snprintf(name, sizeof(name), "%s mulAdd (saturate)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            F sum(0);
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                sum = TFixOps<FixSaturatePolicy>::mulAdd(a[i], b[i], sum);
+            doNotOptimize(sum);
+        });
+
+        snprintf(name, sizeof(name), "%s a / b (operator)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = a[i] / b[0];
+            doNotOptimize(results[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s a / b (TFixDivider)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            TFixDivider<F> divider(b[0]);
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = divider.divide(a[i]);
+            doNotOptimize(results[0]);
+        });
+    }
+}
+
+
+void benchFixArith(BenchHarness &bench)
+{
+    srand(5);
+
+    benchType<fix32_t>(bench, "fix32");
+    benchType<fix64_t>(bench, "fix64");
+
+    TArray<float32_t> a(DATA_COUNT), b(DATA_COUNT), results(DATA_COUNT);
+
+    for (uint32_t i = 0; i < DATA_COUNT; ++i)
+    {
+        a[i] = (float32_t)randomRange(-100.0, 100.0);
+        b[i] = (float32_t)randomRange(0.5, 100.0);
+    }
+
+    bench.run("float32 a * b + c", ITERATIONS, DATA_COUNT, [&]()
+    {
+        float32_t sum = 0.0f;
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            sum = a[i] * b[i] + sum;
+        doNotOptimize(sum);
+    });
+
+    bench.run("float32 a / b", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            results[i] = a[i] / b[0];
+        doNotOptimize(results[0]);
+    });
+
+    // 矩阵乘法：fix32 的 64 位累加版本、逐项用运算符的版本、float32 版本
+    TArray<TMatrix4<fix32_t>> fixMatrices(MATRIX_COUNT);
+    TArray<TMatrix4<fix32_t>> fixResults(MATRIX_COUNT);
+    TArray<TMatrix4<float32_t>> matrices(MATRIX_COUNT);
+    TArray<TMatrix4<float32_t>> floatResults(MATRIX_COUNT);
+
+    for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+    {
+        fix32_t *pf = fixMatrices[i];
+        float32_t *p = matrices[i];
+
+        for (int32_t j = 0; j < 16; ++j)
+        {
+            p[j] = (float32_t)randomRange(-2.0, 2.0);
+            pf[j] = fix32_t(p[j]);
+        }
+    }
+
+    bench.run("fix32 Matrix4 * Matrix4", ITERATIONS, MATRIX_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+        {
+            fixResults[i] = fixMatrices[i]
+                * fixMatrices[(i + 1) & (MATRIX_COUNT - 1)];
+        }
+        doNotOptimize(fixResults[0]);
+    });
+
+    bench.run("fix32 Matrix4 * Matrix4 (operators)", ITERATIONS, MATRIX_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+        {
+            fixResults[i] = multiplyByOperators(fixMatrices[i],
+                fixMatrices[(i + 1) & (MATRIX_COUNT - 1)]);
+        }
+        doNotOptimize(fixResults[0]);
+    });
+
+    bench.run("float32 Matrix4 * Matrix4", ITERATIONS, MATRIX_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+        {
+            floatResults[i] = matrices[i]
+                * matrices[(i + 1) & (MATRIX_COUNT - 1)];
+        }
+        doNotOptimize(floatResults[0]);
+    });
+}
@@ -0,0 +1,33 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __FIX_ARITH_BENCH_H__
+#define __FIX_ARITH_BENCH_H__
+
+
+#include "BenchHarness.h"
+
+
+/**
+ * @brief 定点数乘加、除法、4x4 矩阵乘法的吞吐量，和 float32 版本对比
+ */
+void benchFixArith(BenchHarness &bench);
+
+
+#endif  /*__FIX_ARITH_BENCH_H__*/
@@ -0,0 +1,229 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "FixMathBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t DATA_COUNT = 1024;
+    const uint32_t ITERATIONS = 2000;
+    const uint32_t SAMPLE_COUNT = 200000;
+
+    float64_t randomRange(float64_t lo, float64_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    float64_t toDouble(fix32_t value)
+    {
+        return (float64_t)value.mantissa() / (1 << fix32_t::DECIMAL_BITS);
+    }
+
+    float64_t toDouble(fix64_t value)
+    {
+        return (float64_t)value.mantissa() / (1 << fix64_t::DECIMAL_BITS);
+    }
+
+    /// 老的写法：转成浮点数调用 C 库再转回来
+    template <typename F>
+    F libmRoundTrip(float64_t (*func)(float64_t), F value)
+    {
+        return F(func(toDouble(value)));
+    }
+
+    /// 统计 [lo, hi] 上 TMath<F> 和经过浮点数中转的最大误差
+    template <typename F>
+    void reportError(BenchHarness &bench, const char *name, float64_t lo,
+        float64_t hi, F (*fixFunc)(F), float64_t (*refFunc)(float64_t))
+    {
+        float64_t maxError = 0.0, maxLibmError = 0.0;
+
+        for (uint32_t i = 0; i < SAMPLE_COUNT; ++i)
+        {
+            F x = F(lo + (hi - lo) * i / (SAMPLE_COUNT - 1));
+            float64_t ref = refFunc(toDouble(x));
+            float64_t err = fabs(toDouble(fixFunc(x)) - ref);
+            float64_t libmErr = fabs(toDouble(libmRoundTrip(refFunc, x)) - ref);
+            maxError = err > maxError ? err : maxError;
+            maxLibmError = libmErr > maxLibmError ? libmErr : maxLibmError;
+        }
+
+        bench.note("%-32s max error %.3e (libm round-trip %.3e, 1 ulp %.3e)\n",
+            name, maxError, maxLibmError, toDouble(F(1, 0)));
+    }
+
+    template <typename F>
+    F fixSin(F x) { return TMath<F>::sin(TRadian<F>(x)); }
+    template <typename F>
+    F fixCos(F x) { return TMath<F>::cos(TRadian<F>(x)); }
+    template <typename F>
+    F fixSqrt(F x) { return TMath<F>::sqrt(x); }
+    template <typename F>
+    F fixAsin(F x) { return TMath<F>::asin(x).valueRadians(); }
+    template <typename F>
+    F fixAcos(F x) { return TMath<F>::acos(x).valueRadians(); }
+    template <typename F>
+    F fixAtan(F x) { return TMath<F>::atan(x).valueRadians(); }
+
+    float64_t refSin(float64_t x) { return ::sin(x); }
+    float64_t refCos(float64_t x) { return ::cos(x); }
+    float64_t refSqrt(float64_t x) { return ::sqrt(x); }
+    float64_t refAsin(float64_t x) { return ::asin(x); }
+    float64_t refAcos(float64_t x) { return ::acos(x); }
+    float64_t refAtan(float64_t x) { return ::atan(x); }
+
+    template <typename F>
+    void reportErrors(BenchHarness &bench, const char *type)
+    {
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s sin [-8PI, 8PI]", type);
+        reportError<F>(bench, name, -25.0, 25.0, fixSin<F>, refSin);
+        snprintf(name, sizeof(name), "%s cos [-8PI, 8PI]", type);
+        reportError<F>(bench, name, -25.0, 25.0, fixCos<F>, refCos);
+        snprintf(name, sizeof(name), "%s sqrt [0, 1000]", type);
+        reportError<F>(bench, name, 0.0, 1000.0, fixSqrt<F>, refSqrt);
+        snprintf(name, sizeof(name), "%s asin [-1, 1]", type);
+        reportError<F>(bench, name, -1.0, 1.0, fixAsin<F>, refAsin);
+        snprintf(name, sizeof(name), "%s acos [-1, 1]", type);
+        reportError<F>(bench, name, -1.0, 1.0, fixAcos<F>, refAcos);
+        snprintf(name, sizeof(name), "%s atan [-100, 100]", type);
+        reportError<F>(bench, name, -100.0, 100.0, fixAtan<F>, refAtan);
+
+        float64_t maxError = 0.0;
+        for (uint32_t i = 0; i < SAMPLE_COUNT; ++i)
+        {
+            F y = F(randomRange(-100.0, 100.0));
+            F x = F(randomRange(-100.0, 100.0));
+            float64_t err = fabs(toDouble(TMath<F>::atan2(y, x).valueRadians())
+                - ::atan2(toDouble(y), toDouble(x)));
+            maxError = err > maxError ? err : maxError;
+        }
+        snprintf(name, sizeof(name), "%s atan2", type);
+        bench.note("%-32s max error %.3e\n", name, maxError);
+    }
+
+    template <typename F>
+    void benchType(BenchHarness &bench, const char *type)
+    {
+        TArray<F> angles(DATA_COUNT), values(DATA_COUNT), results(DATA_COUNT);
+
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            angles[i] = F(randomRange(-10.0, 10.0));
+            values[i] = F(randomRange(0.0, 100.0));
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "%s sin", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = TMath<F>::sin(TRadian<F>(angles[i]));
+            doNotOptimize(results[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s sin (libm round-trip)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = libmRoundTrip<F>(refSin, angles[i]);
+            doNotOptimize(results[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s sqrt", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = TMath<F>::sqrt(values[i]);
+            doNotOptimize(results[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s sqrt (libm round-trip)", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+                results[i] = libmRoundTrip<F>(refSqrt, values[i]);
+            doNotOptimize(results[0]);
+        });
+
+        snprintf(name, sizeof(name), "%s atan2", type);
+        bench.run(name, ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results[i] = TMath<F>::atan2(angles[i],
+                    angles[(i + 1) & (DATA_COUNT - 1)]).valueRadians();
+            }
+            doNotOptimize(results[0]);
+        });
+    }
+}
+
+
+void benchFixMath(BenchHarness &bench)
+{
+    srand(3);
+
+    reportErrors<fix32_t>(bench, "fix32");
+    reportErrors<fix64_t>(bench, "fix64");
+
+    benchType<fix32_t>(bench, "fix32");
+    benchType<fix64_t>(bench, "fix64");
+
+    TArray<float32_t> angles(DATA_COUNT), values(DATA_COUNT), results(DATA_COUNT);
+
+    for (uint32_t i = 0; i < DATA_COUNT; ++i)
+    {
+        angles[i] = (float32_t)randomRange(-10.0, 10.0);
+        values[i] = (float32_t)randomRange(0.0, 100.0);
+    }
+
+    bench.run("float32 sin", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            results[i] = TMath<float32_t>::sin(TRadian<float32_t>(angles[i]));
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("float32 sqrt", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            results[i] = TMath<float32_t>::sqrt(values[i]);
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("float32 atan2", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            results[i] = TMath<float32_t>::atan2(angles[i],
+                angles[(i + 1) & (DATA_COUNT - 1)]).valueRadians();
+        }
+        doNotOptimize(results[0]);
+    });
+}
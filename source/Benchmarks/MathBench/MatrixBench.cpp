@@ -0,0 +1,161 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "MatrixBench.h"
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t DATA_COUNT = 256;
+    const uint32_t ITERATIONS = 8000;
+
+    float32_t randomReal()
+    {
+        return (float32_t)rand() / RAND_MAX * 2.0f - 1.0f;
+    }
+
+    TMatrix4<float32_t> randomAffine()
+    {
+        TQuaternion<float32_t> q(randomReal(), randomReal(), randomReal(), randomReal());
+        q.normalize();
+        TMatrix4<float32_t> m;
+        m.makeTransform(
+            TVector3<float32_t>(randomReal(), randomReal(), randomReal()),
+            TVector3<float32_t>(1.0f + randomReal() * 0.5f, 1.0f, 1.0f),
+            q);
+        return m;
+    }
+}
+
+
+void benchMatrix(BenchHarness &bench)
+{
+    srand(1);
+
+    TArray<TMatrix4<float32_t>> affines(DATA_COUNT);
+    TArray<TMatrix4<float32_t>> matrices(DATA_COUNT);
+    TArray<TMatrix4<float32_t>> results(DATA_COUNT);
+    TArray<TVector4<float32_t>> vectors(DATA_COUNT);
+    TArray<TVector4<float32_t>> outVectors(DATA_COUNT);
+    TArray<TVector3<float32_t>> points(DATA_COUNT);
+    TArray<TVector3<float32_t>> outPoints(DATA_COUNT);
+    TArray<TQuaternion<float32_t>> quats(DATA_COUNT);
+
+    for (uint32_t i = 0; i < DATA_COUNT; ++i)
+    {
+        affines[i] = randomAffine();
+        // 加上对角线保证矩阵可逆
+        matrices[i] = affines[i] + TMatrix4<float32_t>(
+            randomReal(), randomReal(), randomReal(), randomReal(),
+            randomReal(), randomReal(), randomReal(), randomReal(),
+            randomReal(), randomReal(), randomReal(), randomReal(),
+            randomReal(), randomReal(), randomReal(), 2.0f);
+        vectors[i] = TVector4<float32_t>(randomReal(), randomReal(), randomReal(), 1.0f);
+        points[i] = TVector3<float32_t>(randomReal(), randomReal(), randomReal());
+        quats[i] = TQuaternion<float32_t>(randomReal(), randomReal(), randomReal(), randomReal());
+        quats[i].normalize();
+    }
+
+    bench.run("Matrix4 * Matrix4", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            results[i] = matrices[i] * matrices[(i + 1) & (DATA_COUNT - 1)];
+        }
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("Matrix4 * Vector4", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            outVectors[i] = matrices[i] * vectors[i];
+        }
+        doNotOptimize(outVectors[0]);
+    });
+
+    bench.run("Matrix4::inverse", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            results[i] = matrices[i].inverse();
+        }
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("Matrix4::inverseAffine", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            results[i] = affines[i].inverseAffine();
+        }
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("Matrix4::concatenateAffine", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            results[i] = affines[i].concatenateAffine(
+                affines[(i + 1) & (DATA_COUNT - 1)]);
+        }
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("Matrix4::transformAffine", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            outPoints[i] = affines[i].transformAffine(points[i]);
+        }
+        doNotOptimize(outPoints[0]);
+    });
+
+    bench.run("Quaternion * Quaternion", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            quats[i] = quats[i] * quats[(i + 1) & (DATA_COUNT - 1)];
+        }
+        doNotOptimize(quats[0]);
+    });
+
+    bench.run("Quaternion * Vector3", ITERATIONS, DATA_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            outPoints[i] = quats[i] * points[i];
+        }
+        doNotOptimize(outPoints[0]);
+    });
+
+    bench.run("Vector4::dot", ITERATIONS, DATA_COUNT, [&]()
+    {
+        float32_t sum = 0.0f;
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)
+        {
+            sum += vectors[i].dot(vectors[(i + 1) & (DATA_COUNT - 1)]);
+        }
+        doNotOptimize(sum);
+    });
+}
@@ -0,0 +1,393 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "RealBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    const uint32_t DATA_COUNT = 256;
+    const uint32_t ITERATIONS = 200;
+    const uint32_t POINT_COUNT = 1024;
+    const uint32_t BUILD_ITERATIONS = 20;
+
+    // 坐标都在 [-8, 8] 以内，fix32 的平方和乘积不会溢出
+    const float32_t WORLD_SIZE = 4.0f;
+
+    float32_t randomRange(float32_t lo, float32_t hi)
+    {
+        return lo + (hi - lo) * rand() / RAND_MAX;
+    }
+
+    template <typename T>
+    TVector3<T> randomVector(float32_t lo, float32_t hi)
+    {
+        return TVector3<T>(T(randomRange(lo, hi)), T(randomRange(lo, hi)),
+            T(randomRange(lo, hi)));
+    }
+
+    template <typename T>
+    TVector3<T> randomDirection()
+    {
+        TVector3<T> v = randomVector<T>(-1.0f, 1.0f);
+        v.normalize();
+        return v;
+    }
+
+    template <typename T>
+    TMatrix3<T> randomRotation()
+    {
+        TMatrix3<T> m;
+        m.fromAxisAngle(randomDirection<T>(),
+            TRadian<T>(T(randomRange(-3.0f, 3.0f))));
+        return m;
+    }
+
+    /// 每种类型一份的测试数据
+    template <typename T>
+    struct TestData
+    {
+        TArray<TVector3<T>>     points;
+        TArray<TRay<T>>         rays;
+        TArray<TPlane<T>>       planes;
+        TArray<TTriangle<T>>    triangles;
+        TArray<TSphere<T>>      spheres;
+        TArray<TAabb<T>>        boxes;
+        TArray<TObb<T>>         obbs;
+        TArray<TMatrix3<T>>     matrices3;
+        TArray<TMatrix4<T>>     matrices4;
+        TArray<TVector4<T>>     vectors4;
+        TArray<TQuaternion<T>>  quats;
+        TFrustum<T>             frustum;
+
+        /// 同类两两检测时和第 i 个配对的下标
+        static uint32_t other(uint32_t i)
+        {
+            return (i * 7 + 3) % DATA_COUNT;
+        }
+
+        void build()
+        {
+            float32_t half = WORLD_SIZE * 0.5f;
+
+            points.resize(POINT_COUNT);
+            for (uint32_t i = 0; i < POINT_COUNT; ++i)
+            {
+                points[i] = randomVector<T>(-half, half);
+            }
+
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                TVector3<T> center = randomVector<T>(-half, half);
+                TVector3<T> extent = randomVector<T>(0.1f, 0.8f);
+                TMatrix3<T> rot = randomRotation<T>();
+
+                rays.push_back(TRay<T>(randomVector<T>(-WORLD_SIZE, WORLD_SIZE),
+                    randomDirection<T>()));
+                planes.push_back(TPlane<T>(randomDirection<T>(),
+                    T(randomRange(-half, half))));
+
+                TVector3<T> vertices[3];
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    vertices[k] = center + randomVector<T>(-1.0f, 1.0f);
+                }
+                triangles.push_back(TTriangle<T>(vertices));
+
+                spheres.push_back(TSphere<T>(center,
+                    T(randomRange(0.1f, 0.8f))));
+
+                TAabb<T> box;
+                box.setParam(center - extent, center + extent);
+                boxes.push_back(box);
+
+                obbs.push_back(TObb<T>(center, rot.getColumn(0),
+                    rot.getColumn(1), rot.getColumn(2), extent.x(),
+                    extent.y(), extent.z()));
+
+                matrices3.push_back(rot * TMatrix3<T>(
+                    T(randomRange(0.5f, 2.0f)), TReal<T>::ZERO, TReal<T>::ZERO,
+                    TReal<T>::ZERO, T(randomRange(0.5f, 2.0f)), TReal<T>::ZERO,
+                    TReal<T>::ZERO, TReal<T>::ZERO, T(randomRange(0.5f, 2.0f))));
+
+                TQuaternion<T> q(rot);
+                TMatrix4<T> m;
+                m.makeTransform(center, randomVector<T>(0.5f, 2.0f), q);
+                matrices4.push_back(m);
+
+                vectors4.push_back(TVector4<T>(center.x(), center.y(),
+                    center.z(), TReal<T>::ONE));
+                quats.push_back(q);
+            }
+
+            // 和 IntersectionApp 一样的视锥，法线朝里
+            T d = T(WORLD_SIZE * 0.5f);
+            frustum.setFace(TFrustum<T>::E_FACE_NEAR,
+                TPlane<T>(TVector3<T>::NEGATIVE_UNIT_Z, TVector3<T>(0, 0, d)));
+            frustum.setFace(TFrustum<T>::E_FACE_FAR,
+                TPlane<T>(TVector3<T>::UNIT_Z, TVector3<T>(0, 0, -d)));
+
+            TMatrix3<T> m0(TVector3<T>::UNIT_X, TRadian<T>(T(0.5236f)));
+            frustum.setFace(TFrustum<T>::E_FACE_TOP,
+                TPlane<T>(m0 * TVector3<T>::NEGATIVE_UNIT_Y,
+                    TVector3<T>(0, d, 0)));
+            TMatrix3<T> m1(TVector3<T>::UNIT_X, TRadian<T>(T(-0.5236f)));
+            frustum.setFace(TFrustum<T>::E_FACE_BOTTOM,
+                TPlane<T>(m1 * TVector3<T>::UNIT_Y, TVector3<T>(0, -d, 0)));
+            TMatrix3<T> m2(TVector3<T>::UNIT_Y, TRadian<T>(T(0.5236f)));
+            frustum.setFace(TFrustum<T>::E_FACE_LEFT,
+                TPlane<T>(m2 * TVector3<T>::UNIT_X, TVector3<T>(-d, 0, 0)));
+            TMatrix3<T> m3(TVector3<T>::UNIT_Y, TRadian<T>(T(-0.5236f)));
+            frustum.setFace(TFrustum<T>::E_FACE_RIGHT,
+                TPlane<T>(m3 * TVector3<T>::NEGATIVE_UNIT_X,
+                    TVector3<T>(d, 0, 0)));
+        }
+    };
+
+    /// test 里的 %s 换成类型名，例如 "Matrix3<%s>::inverse"
+    template <typename Func>
+    void runTest(BenchHarness &bench, const char *type, const char *test,
+        uint32_t iterations, uint32_t items, Func func)
+    {
+        char name[96];
+        snprintf(name, sizeof(name), test, type);
+        bench.run(name, iterations, items, func);
+    }
+
+    /// 第 i 个 A 和第 i 个 B 做检测，统计结果防止被优化掉
+#define BENCH_INTR(INTR, A, B)                                              \
+    runTest(bench, type, #INTR "<%s>", ITERATIONS, DATA_COUNT, [&]()               \
+    {                                                                       \
+        int32_t hits = 0;                                                   \
+        for (uint32_t i = 0; i < DATA_COUNT; ++i)                           \
+        {                                                                   \
+            hits += (int32_t)T##INTR<T>(A, B).test();                       \
+        }                                                                   \
+        doNotOptimize(hits);                                                \
+    })
+
+    template <typename T>
+    void benchIntersections(BenchHarness &bench, const TestData<T> &data,
+        const char *type)
+    {
+        typedef TestData<T> Data;
+
+        // SphereTriangle、SphereAabb、SphereObb、AabbObb、ObbObb 的 test()
+        // 还没实现，只判空就返回 true，测出来的数字没有意义，不跑
+
+        BENCH_INTR(IntrRayTriangle, data.rays[i], data.triangles[i]);
+        BENCH_INTR(IntrRayPlane, data.rays[i], data.planes[i]);
+        BENCH_INTR(IntrRaySphere, data.rays[i], data.spheres[i]);
+        BENCH_INTR(IntrRayAabb, data.rays[i], data.boxes[i]);
+        BENCH_INTR(IntrRayObb, data.rays[i], data.obbs[i]);
+
+        BENCH_INTR(IntrSpherePlane, data.spheres[i], data.planes[i]);
+        BENCH_INTR(IntrSphereSphere, data.spheres[i],
+            data.spheres[Data::other(i)]);
+
+        BENCH_INTR(IntrAabbPlane, data.boxes[i], data.planes[i]);
+        BENCH_INTR(IntrAabbAabb, data.boxes[i], data.boxes[Data::other(i)]);
+
+        BENCH_INTR(IntrObbPlane, data.obbs[i], data.planes[i]);
+
+        BENCH_INTR(IntrFrustumSphere, data.frustum, data.spheres[i]);
+        BENCH_INTR(IntrFrustumAabb, data.frustum, data.boxes[i]);
+        BENCH_INTR(IntrFrustumObb, data.frustum, data.obbs[i]);
+    }
+
+#undef BENCH_INTR
+
+    template <typename T>
+    void benchMatrices(BenchHarness &bench, const TestData<T> &data,
+        const char *type)
+    {
+        typedef TestData<T> Data;
+
+        TArray<TMatrix3<T>> results3(DATA_COUNT);
+        TArray<TMatrix4<T>> results4(DATA_COUNT);
+        TArray<TVector3<T>> results3v(DATA_COUNT);
+        TArray<TVector4<T>> results4v(DATA_COUNT);
+        TArray<TQuaternion<T>> resultsq(DATA_COUNT);
+
+        runTest(bench, type, "Matrix3<%s> * Matrix3", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results3[i] = data.matrices3[i]
+                    * data.matrices3[Data::other(i)];
+            }
+            doNotOptimize(results3[0]);
+        });
+
+        runTest(bench, type, "Matrix3<%s> * Vector3", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results3v[i] = data.matrices3[i] * data.points[i];
+            }
+            doNotOptimize(results3v[0]);
+        });
+
+        runTest(bench, type, "Matrix3<%s>::inverse", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results3[i] = data.matrices3[i].inverse();
+            }
+            doNotOptimize(results3[0]);
+        });
+
+        runTest(bench, type, "Matrix3<%s>::determinant", ITERATIONS, DATA_COUNT,
+            [&]()
+        {
+            T sum = TReal<T>::ZERO;
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                sum += data.matrices3[i].determinant();
+            }
+            doNotOptimize(sum);
+        });
+
+        runTest(bench, type, "Matrix4<%s> * Matrix4", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results4[i] = data.matrices4[i]
+                    * data.matrices4[Data::other(i)];
+            }
+            doNotOptimize(results4[0]);
+        });
+
+        runTest(bench, type, "Matrix4<%s> * Vector4", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results4v[i] = data.matrices4[i] * data.vectors4[i];
+            }
+            doNotOptimize(results4v[0]);
+        });
+
+        runTest(bench, type, "Matrix4<%s>::inverse", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results4[i] = data.matrices4[i].inverse();
+            }
+            doNotOptimize(results4[0]);
+        });
+
+        runTest(bench, type, "Matrix4<%s>::inverseAffine", ITERATIONS, DATA_COUNT,
+            [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                results4[i] = data.matrices4[i].inverseAffine();
+            }
+            doNotOptimize(results4[0]);
+        });
+
+        runTest(bench, type, "Quaternion<%s>::slerp", ITERATIONS, DATA_COUNT, [&]()
+        {
+            for (uint32_t i = 0; i < DATA_COUNT; ++i)
+            {
+                resultsq[i].slerp(data.quats[i], data.quats[Data::other(i)],
+                    TReal<T>::HALF);
+            }
+            doNotOptimize(resultsq[0]);
+        });
+    }
+
+    template <typename T>
+    void benchBuilders(BenchHarness &bench, const TestData<T> &data,
+        const char *type)
+    {
+        const TVector3<T> *points = &data.points[0];
+        TSphere<T> sphere;
+        TAabb<T> box;
+        TObb<T> obb;
+
+        runTest(bench, type, "Sphere<%s> build Welzl", BUILD_ITERATIONS,
+            POINT_COUNT, [&]()
+        {
+            sphere.build(points, POINT_COUNT, TSphere<T>::E_BUILD_WELZL);
+            doNotOptimize(sphere);
+        });
+
+        runTest(bench, type, "Sphere<%s> build Ritter", BUILD_ITERATIONS,
+            POINT_COUNT, [&]()
+        {
+            sphere.build(points, POINT_COUNT, TSphere<T>::E_BUILD_RITTER);
+            doNotOptimize(sphere);
+        });
+
+        runTest(bench, type, "Sphere<%s> build average", BUILD_ITERATIONS,
+            POINT_COUNT, [&]()
+        {
+            sphere.build(points, POINT_COUNT, TSphere<T>::E_BUILD_AVERAGE);
+            doNotOptimize(sphere);
+        });
+
+        runTest(bench, type, "Aabb<%s> build", BUILD_ITERATIONS, POINT_COUNT, [&]()
+        {
+            box.build(points, POINT_COUNT);
+            doNotOptimize(box);
+        });
+
+        runTest(bench, type, "Obb<%s> build AABB", BUILD_ITERATIONS, POINT_COUNT,
+            [&]()
+        {
+            obb.build(points, POINT_COUNT, TObb<T>::E_BUILD_AABB);
+            doNotOptimize(obb);
+        });
+
+        runTest(bench, type, "Obb<%s> build covariance", BUILD_ITERATIONS,
+            POINT_COUNT, [&]()
+        {
+            obb.build(points, POINT_COUNT, TObb<T>::E_BUILD_COVARIANCE);
+            doNotOptimize(obb);
+        });
+    }
+
+    template <typename T>
+    void benchType(BenchHarness &bench, const char *type)
+    {
+        TestData<T> data;
+        data.build();
+
+        benchIntersections(bench, data, type);
+        benchMatrices(bench, data, type);
+        benchBuilders(bench, data, type);
+    }
+}
+
+
+void benchReal(BenchHarness &bench)
+{
+    srand(20);
+
+    benchType<float32_t>(bench, "float32");
+    benchType<float64_t>(bench, "float64");
+    benchType<fix32_t>(bench, "fix32");
+    benchType<fix64_t>(bench, "fix64");
+}
@@ -0,0 +1,35 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __REAL_BENCH_H__
+#define __REAL_BENCH_H__
+
+
+#include "BenchHarness.h"
+
+
+/**
+ * @brief 全部 TIntr* 相交检测、TMatrix3/TMatrix4 运算、TQuaternion::slerp
+ *      和包围体构造，分别用 float32、float64、fix32、fix64 实例化，
+ *      用来比较不同的 Real 类型
+ */
+void benchReal(BenchHarness &bench);
+
+
+#endif  /*__REAL_BENCH_H__*/
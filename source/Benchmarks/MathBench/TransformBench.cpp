@@ -0,0 +1,112 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "TransformBench.h"
+#include <stdlib.h>
+
+
+using namespace Tiny3D;
+
+
+namespace
+{
+    // 4096 个点一共 48KB，三种布局都能放进 L2
+    const uint32_t POINT_COUNT = 4096;
+    const uint32_t MATRIX_COUNT = 256;
+    const uint32_t ITERATIONS = 2000;
+
+    float32_t randomReal()
+    {
+        return (float32_t)rand() / RAND_MAX * 2.0f - 1.0f;
+    }
+}
+
+
+void benchTransform(BenchHarness &bench)
+{
+    srand(2);
+
+    TQuaternion<float32_t> q(randomReal(), randomReal(), randomReal(), randomReal());
+    q.normalize();
+    TMatrix4<float32_t> xform;
+    xform.makeTransform(TVector3<float32_t>(1.0f, 2.0f, 3.0f),
+        TVector3<float32_t>(2.0f, 2.0f, 2.0f), q);
+
+    TArray<TVector3<float32_t>> points(POINT_COUNT);
+    TArray<TVector3<float32_t>> outPoints(POINT_COUNT);
+
+    for (uint32_t i = 0; i < POINT_COUNT; ++i)
+    {
+        points[i] = TVector3<float32_t>(randomReal(), randomReal(), randomReal());
+    }
+
+    TVector3Stream<float32_t> stream(points.data(), POINT_COUNT);
+    TVector3Stream<float32_t> outStream(POINT_COUNT);
+
+    TArray<TMatrix4<float32_t>> lhs(MATRIX_COUNT);
+    TArray<TMatrix4<float32_t>> rhs(MATRIX_COUNT);
+    TArray<TMatrix4<float32_t>> results(MATRIX_COUNT);
+
+    for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+    {
+        float32_t *l = lhs[i];
+        float32_t *r = rhs[i];
+        for (uint32_t j = 0; j < 16; ++j)
+        {
+            l[j] = randomReal();
+            r[j] = randomReal();
+        }
+    }
+
+    bench.run("points: transformAffine loop", ITERATIONS, POINT_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < POINT_COUNT; ++i)
+        {
+            outPoints[i] = xform.transformAffine(points[i]);
+        }
+        doNotOptimize(outPoints[0]);
+    });
+
+    bench.run("points: transformPoints AoS", ITERATIONS, POINT_COUNT, [&]()
+    {
+        transformPoints(xform, points.data(), outPoints.data(), POINT_COUNT);
+        doNotOptimize(outPoints[0]);
+    });
+
+    bench.run("points: transformPoints SoA", ITERATIONS, POINT_COUNT, [&]()
+    {
+        transformPoints(xform, stream, outStream);
+        doNotOptimize(outStream.x()[0]);
+    });
+
+    bench.run("matrices: operator * loop", ITERATIONS, MATRIX_COUNT, [&]()
+    {
+        for (uint32_t i = 0; i < MATRIX_COUNT; ++i)
+        {
+            results[i] = lhs[i] * rhs[i];
+        }
+        doNotOptimize(results[0]);
+    });
+
+    bench.run("matrices: multiplyMatrices", ITERATIONS, MATRIX_COUNT, [&]()
+    {
+        multiplyMatrices(lhs.data(), rhs.data(), results.data(), MATRIX_COUNT);
+        doNotOptimize(results[0]);
+    });
+}
@@ -0,0 +1,50 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "BenchHarness.h"
+#include "BoundingBench.h"
+#include "BroadPhaseBench.h"
+#include "BvhBench.h"
+#include "CompactBoundsBench.h"
+#include "FixArithBench.h"
+#include "FixMathBench.h"
+#include "MatrixBench.h"
+#include "RealBench.h"
+#include "TransformBench.h"
+
+
+int main(int argc, char *argv[])
+{
+    BenchHarness bench;
+
+    if (!bench.init(argc, argv))
+        return 1;
+
+    benchMatrix(bench);
+    benchTransform(bench);
+    benchFixMath(bench);
+    benchFixArith(bench);
+    benchBvh(bench);
+    benchBroadPhase(bench);
+    benchBounding(bench);
+    benchCompactBounds(bench);
+    benchReal(bench);
+
+    return bench.finish();
+}
@@ -0,0 +1,159 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_FLAT_HASH_MAP_H__
+#define __T3D_FLAT_HASH_MAP_H__
+
+
+#include "T3DPrerequisites.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 开放寻址的 hash 表，键的 hash 值由调用者事先算好
+     * @remarks 所有元素放在一块连续的数组里，线性探测，删除时把后面的元素
+     *      往前移，不留墓碑。槽里保存完整的 64 位 hash 值，探测时先比较
+     *      hash 值，相同了才比较键，不同的键 hash 冲突时也能正确区分。
+     *      hash 值为 0 的槽表示空槽，传进来的 0 会被换成 1。
+     *      插入和删除会让之前返回的指针失效。
+     */
+    template <typename K, typename V>
+    class TFlatHashMap
+    {
+    public:
+        /** 最大装载因子，元素个数超过容量的 3/4 时扩容 */
+        static const size_t MAX_LOAD_NUMERATOR = 3;
+        static const size_t MAX_LOAD_DENOMINATOR = 4;
+
+        /** 最小容量 */
+        static const size_t MIN_CAPACITY = 16;
+
+        struct Slot
+        {
+            uint64_t    hash;   /**< 键的 hash 值，0 表示空槽 */
+            K           key;    /**< 键 */
+            V           value;  /**< 值 */
+        };
+
+        TFlatHashMap();
+
+        /** 元素个数 */
+        size_t size() const { return mSize; }
+
+        /** 是否没有元素 */
+        bool empty() const { return mSize == 0; }
+
+        /** 槽的个数，总是 2 的幂或者 0 */
+        size_t capacity() const { return mSlots.size(); }
+
+        /** 删除所有元素，保留容量 */
+        void clear();
+
+        /** 预留能放下 count 个元素的容量 */
+        void reserve(size_t count);
+
+        /**
+         * @brief 查找元素
+         * @param [in] hash : 键的 hash 值
+         * @param [in] key : 键，hash 值相同时用来确认
+         * @return 找到返回值的指针，否则返回 nullptr
+         */
+        V *find(uint64_t hash, const K &key);
+
+        const V *find(uint64_t hash, const K &key) const;
+
+        /**
+         * @brief 查找元素，没有就插入一个默认值
+         * @param [in] hash : 键的 hash 值
+         * @param [in] key : 键
+         * @param [out] inserted : 返回是否新插入
+         * @return 返回值的引用
+         */
+        V &insert(uint64_t hash, const K &key, bool &inserted);
+
+        /**
+         * @brief 删除元素
+         * @return 找到并删除了返回 true
+         */
+        bool erase(uint64_t hash, const K &key);
+
+        /**
+         * @brief 遍历所有元素，func(const K &key, V &value)
+         * @remarks 遍历过程中不能插入和删除
+         */
+        template <typename Func>
+        void forEach(Func func);
+
+        template <typename Func>
+        void forEach(Func func) const;
+
+        /**
+         * @brief 删除所有满足条件的元素，pred(const K &key, V &value)
+         * @return 返回删除的个数
+         */
+        template <typename Pred>
+        size_t eraseIf(Pred pred);
+
+        /**
+         * @brief 按槽下标访问，供需要分多次遍历的调用者使用
+         * @remarks 下标范围是 [0, capacity())，空槽的键和值没有意义
+         */
+        bool isOccupied(size_t index) const { return mSlots[index].hash != 0; }
+
+        const K &keyAt(size_t index) const { return mSlots[index].key; }
+
+        V &valueAt(size_t index) { return mSlots[index].value; }
+
+        const V &valueAt(size_t index) const { return mSlots[index].value; }
+
+        /**
+         * @brief 删除指定下标的元素
+         * @remarks 后面的元素可能移到这个下标，调用者要再检查一次同一个下标
+         */
+        void eraseAt(size_t index) { eraseSlot(index); }
+
+    protected:
+        typedef TArray<Slot>    Slots;
+
+        /** 0 留给空槽 */
+        static uint64_t fixHash(uint64_t hash)
+        {
+            return (hash != 0 ? hash : 1);
+        }
+
+        /** 查找键所在的槽，没有返回 -1 */
+        size_t findSlot(uint64_t hash, const K &key) const;
+
+        /** 重新分配 capacity 个槽并把元素放进去 */
+        void rehash(size_t capacity);
+
+        /** 删除指定的槽，后面同一段探测序列里的元素往前移 */
+        void eraseSlot(size_t index);
+
+        Slots   mSlots;     /**< 槽数组 */
+        size_t  mSize;      /**< 元素个数 */
+    };
+}
+
+
+#include "T3DFlatHashMap.inl"
+
+
+#endif  /*__T3D_FLAT_HASH_MAP_H__*/
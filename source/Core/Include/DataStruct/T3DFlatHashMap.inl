@@ -0,0 +1,280 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline TFlatHashMap<K, V>::TFlatHashMap()
+        : mSize(0)
+    {
+
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline void TFlatHashMap<K, V>::clear()
+    {
+        for (Slot &slot : mSlots)
+        {
+            slot = Slot();
+        }
+
+        mSize = 0;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline void TFlatHashMap<K, V>::reserve(size_t count)
+    {
+        size_t capacity = MIN_CAPACITY;
+
+        while (capacity * MAX_LOAD_NUMERATOR < count * MAX_LOAD_DENOMINATOR)
+        {
+            capacity <<= 1;
+        }
+
+        if (capacity > mSlots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline size_t TFlatHashMap<K, V>::findSlot(uint64_t hash, 
+        const K &key) const
+    {
+        if (mSize == 0)
+            return (size_t)-1;
+
+        hash = fixHash(hash);
+        size_t mask = mSlots.size() - 1;
+        size_t index = (size_t)hash & mask;
+
+        // 装载因子小于 1，一定能碰到空槽
+        while (mSlots[index].hash != 0)
+        {
+            const Slot &slot = mSlots[index];
+
+            if (slot.hash == hash && slot.key == key)
+            {
+                return index;
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        return (size_t)-1;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline V *TFlatHashMap<K, V>::find(uint64_t hash, const K &key)
+    {
+        size_t index = findSlot(hash, key);
+        return (index != (size_t)-1 ? &mSlots[index].value : nullptr);
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline const V *TFlatHashMap<K, V>::find(uint64_t hash, 
+        const K &key) const
+    {
+        size_t index = findSlot(hash, key);
+        return (index != (size_t)-1 ? &mSlots[index].value : nullptr);
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline V &TFlatHashMap<K, V>::insert(uint64_t hash, const K &key,
+        bool &inserted)
+    {
+        if ((mSize + 1) * MAX_LOAD_DENOMINATOR
+            > mSlots.size() * MAX_LOAD_NUMERATOR)
+        {
+            rehash(mSlots.empty() ? MIN_CAPACITY : mSlots.size() * 2);
+        }
+
+        hash = fixHash(hash);
+        size_t mask = mSlots.size() - 1;
+        size_t index = (size_t)hash & mask;
+
+        while (mSlots[index].hash != 0)
+        {
+            Slot &slot = mSlots[index];
+
+            if (slot.hash == hash && slot.key == key)
+            {
+                inserted = false;
+                return slot.value;
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        Slot &slot = mSlots[index];
+        slot.hash = hash;
+        slot.key = key;
+        mSize++;
+
+        inserted = true;
+        return slot.value;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline bool TFlatHashMap<K, V>::erase(uint64_t hash, const K &key)
+    {
+        size_t index = findSlot(hash, key);
+
+        if (index == (size_t)-1)
+            return false;
+
+        eraseSlot(index);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline void TFlatHashMap<K, V>::eraseSlot(size_t index)
+    {
+        size_t mask = mSlots.size() - 1;
+        size_t hole = index;
+        size_t next = (hole + 1) & mask;
+
+        while (mSlots[next].hash != 0)
+        {
+            size_t home = (size_t)mSlots[next].hash & mask;
+
+            // next 的探测起点不在 (hole, next] 区间里，说明它探测时经过了
+            // hole，可以移到 hole，否则留在原地以免它再也找不到
+            bool canMove = (hole <= next) 
+                ? (home <= hole || home > next) 
+                : (home <= hole && home > next);
+
+            if (canMove)
+            {
+                mSlots[hole] = std::move(mSlots[next]);
+                hole = next;
+            }
+
+            next = (next + 1) & mask;
+        }
+
+        mSlots[hole] = Slot();
+        mSize--;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    inline void TFlatHashMap<K, V>::rehash(size_t capacity)
+    {
+        Slots slots(capacity);
+        slots.swap(mSlots);
+
+        size_t mask = capacity - 1;
+
+        for (Slot &slot : slots)
+        {
+            if (slot.hash == 0)
+                continue;
+
+            size_t index = (size_t)slot.hash & mask;
+
+            while (mSlots[index].hash != 0)
+            {
+                index = (index + 1) & mask;
+            }
+
+            mSlots[index] = std::move(slot);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    template <typename Func>
+    inline void TFlatHashMap<K, V>::forEach(Func func)
+    {
+        for (Slot &slot : mSlots)
+        {
+            if (slot.hash != 0)
+            {
+                func(slot.key, slot.value);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    template <typename Func>
+    inline void TFlatHashMap<K, V>::forEach(Func func) const
+    {
+        for (const Slot &slot : mSlots)
+        {
+            if (slot.hash != 0)
+            {
+                func(slot.key, slot.value);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename K, typename V>
+    template <typename Pred>
+    inline size_t TFlatHashMap<K, V>::eraseIf(Pred pred)
+    {
+        size_t count = 0;
+        size_t index = 0;
+
+        while (index < mSlots.size())
+        {
+            Slot &slot = mSlots[index];
+
+            if (slot.hash != 0 && pred(slot.key, slot.value))
+            {
+                // 删除会把后面的元素移到这里，同一个位置要再检查一次。
+                // 从数组末尾绕回来的元素会移到已经检查过的前面，
+                // 它们在末尾时已经检查过了，不会漏掉
+                eraseSlot(index);
+                count++;
+            }
+            else
+            {
+                index++;
+            }
+        }
+
+        return count;
+    }
+}
@@ -96,6 +96,24 @@ namespace Tiny3D
          * @param [in] replaceWithWhat : 替换进去的新字符串
          */
         static void replaceAll(String &str, const String &replaceWhat, const String &replaceWithWhat);
+
+        /**
+         * @brief 计算字符串的 64 位 hash 值
+         * @param [in] str : 字符串
+         * @param [in] len : 字符串长度
+         * @return 每次处理 8 个字节，最后再混合一次，低位也分布均匀，
+         *      可以直接用在按 2 的幂取模的 hash 表里。不是加密 hash，
+         *      结果和字节序有关，不要保存到文件里
+         */
+        static uint64_t hash(const char *str, size_t len);
+
+        /**
+         * @brief 计算字符串的 64 位 hash 值
+         */
+        static uint64_t hash(const String &str)
+        {
+            return hash(str.c_str(), str.length());
+        }
     };
 }
 
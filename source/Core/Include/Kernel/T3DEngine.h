@@ -75,6 +75,11 @@ namespace Tiny3D
          */
         void appWillEnterForeground();
 
+        /**
+         * @brief 系统内存不足时调用本接口告知引擎，卸载所有不使用的资源
+         */
+        void appLowMemory();
+
         /**
          * @brief 安装插件
          * @param [in] plugin : 对应的插件对象
@@ -127,6 +132,11 @@ namespace Tiny3D
          */
         const String &getPluginsPath() const { return mPluginsPath; }
 
+        /**
+         * @brief 获取帧内存分配器，每帧结束时统一回收
+         */
+        FrameArena &getFrameArena() { return *mFrameArena; }
+
     protected:
         /**
          * @brief 初始化应用程序
@@ -191,6 +201,7 @@ namespace Tiny3D
         Logger              *mLogger;           /**< 日志对象 */
         EventManager        *mEventMgr;         /**< 事件管理器对象 */
         ObjectTracer        *mObjTracer;        /**< 对象内存跟踪 */
+        FrameArena          *mFrameArena;       /**< 帧内存分配器 */
 
         Window              *mWindow;           /**< 窗口 */
         bool                mIsRunning;         /**< 引擎是否在运行中 */
@@ -23,6 +23,7 @@
 
 
 #include "T3DPrerequisites.h"
+#include <atomic>
 
 
 namespace Tiny3D
@@ -33,11 +34,28 @@ namespace Tiny3D
     class T3D_ENGINE_API Object
     {
     public:
+        /**
+         * @brief 引用计数策略
+         */
+        enum ReferPolicy
+        {
+            E_REFER_SINGLE_THREAD = 0,  /// 只在一个线程里持有和释放，不用原子操作
+            E_REFER_THREAD_SAFE,        /// 跨线程共享，引用计数使用原子操作
+        };
+
         /**
          * @brief 构造函数
+         * @remarks 默认是单线程策略，编译时定义了 T3D_THREAD_SAFE_REFER
+         *      则所有对象都使用原子引用计数
          */
         Object();
 
+        /**
+         * @brief 构造函数，指定引用计数策略
+         * @param [in] policy : 引用计数策略，子类按需要选择
+         */
+        explicit Object(ReferPolicy policy);
+
         /**
          * @brief 析构函数
          */
@@ -46,23 +64,82 @@ namespace Tiny3D
         /**
          * @brief 持有对象，让对象引用计数加一
          */
-        Object *acquire();
+        Object *acquire()
+        {
+            if (mIsThreadSafe)
+            {
+                mReferCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                // 单线程策略只做普通的读写，不会生成带锁的指令
+                uint32_t count = mReferCount.load(std::memory_order_relaxed);
+                mReferCount.store(count + 1, std::memory_order_relaxed);
+            }
+
+            return this;
+        }
 
         /**
          * @brief 释放对象，让对象引用计数减一
          */
-        void release();
+        void release()
+        {
+            uint32_t count = 0;
+
+            if (mIsThreadSafe)
+            {
+                // acq_rel 保证其他线程对对象的修改在析构前都可见
+                count = mReferCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
+            }
+            else
+            {
+                count = mReferCount.load(std::memory_order_relaxed) - 1;
+                mReferCount.store(count, std::memory_order_relaxed);
+            }
+
+            if (count == 0)
+            {
+                delete this;
+            }
+        }
 
         /**
          * @brief 返回对象当前引用计数
          */
         uint32_t referCount() const
         {
-            return mReferCount;
+            return mReferCount.load(std::memory_order_relaxed);
         }
 
+        /**
+         * @brief 返回是否使用原子引用计数
+         */
+        bool isThreadSafeRefer() const
+        {
+            return mIsThreadSafe;
+        }
+
+        /**
+         * @brief 所有派生类都从 PoolAllocator 按大小分级的内存池分配
+         */
+        static void *operator new(size_t size);
+
+        /**
+         * @brief 带大小的释放，虚析构保证传进来的是实际类型的大小
+         */
+        static void operator delete(void *ptr, size_t size);
+
     private:
-        uint32_t    mReferCount;
+#if defined (T3D_OBJECT_TRACER)
+        /// 把对象加到跟踪器里
+        void trace();
+        /// 把对象从跟踪器里移除
+        void untrace();
+#endif
+
+        std::atomic<uint32_t>   mReferCount;
+        bool                    mIsThreadSafe;
     };
 }
 
@@ -0,0 +1,122 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_FRAME_ARENA_H__
+#define __T3D_FRAME_ARENA_H__
+
+
+#include "T3DPrerequisites.h"
+#include <new>
+
+
+namespace Tiny3D
+{
+    /**
+     * @class FrameArena
+     * @brief 线性分配器，分配只是移动指针，每帧结束时 reset() 一次性回收
+     * @remarks 只给一帧内用完就丢的临时数据用，不会调用析构函数，
+     *      也不能单独释放。不是线程安全的，只能在主线程使用。
+     */
+    class T3D_ENGINE_API FrameArena
+    {
+        T3D_DISABLE_COPY(FrameArena);
+
+    public:
+        /**
+         * @brief 统计信息
+         */
+        struct Stats
+        {
+            size_t      capacity;       /**< 所有大块的总容量 */
+            size_t      usedBytes;      /**< 本帧已经分配的字节数 */
+            size_t      peakBytes;      /**< 单帧分配字节数峰值 */
+            size_t      chunkCount;     /**< 大块数量 */
+            uint64_t    allocCount;     /**< 本帧分配次数 */
+        };
+
+        enum
+        {
+            DEFAULT_CHUNK_SIZE = 64 * 1024,     /**< 默认大块大小 */
+            DEFAULT_ALIGNMENT = 16,             /**< 默认对齐 */
+        };
+
+        /**
+         * @brief 构造函数
+         * @param [in] chunkSize : 每次向系统申请的大块大小
+         */
+        FrameArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+        /**
+         * @brief 析构函数
+         */
+        ~FrameArena();
+
+        /**
+         * @brief 分配内存
+         * @param [in] size : 申请的大小
+         * @param [in] alignment : 对齐，必须是 2 的幂
+         */
+        void *allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+        /**
+         * @brief 在帧内存上构造对象
+         * @remarks 对象不会被析构，只能用于不需要析构的类型
+         */
+        template <typename T, typename... Args>
+        T *create(Args... args)
+        {
+            void *ptr = allocate(sizeof(T), alignof(T));
+            return new (ptr) T(args...);
+        }
+
+        /**
+         * @brief 回收本帧分配的所有内存，O(1)
+         * @remarks 多个大块会合并成一个，下一帧就不需要再申请
+         */
+        void reset();
+
+        /**
+         * @brief 获取统计信息
+         */
+        Stats getStats() const;
+
+    protected:
+        /// 申请新的大块
+        void grow(size_t size);
+
+        struct Chunk
+        {
+            uchar_t     *data;      /**< 大块首地址 */
+            size_t      size;       /**< 大块大小 */
+        };
+
+        typedef TArray<Chunk>       Chunks;
+        typedef Chunks::iterator    ChunksItr;
+
+        Chunks      mChunks;        /**< 所有大块，最后一个是当前在用的 */
+        size_t      mChunkSize;     /**< 默认大块大小 */
+        size_t      mOffset;        /**< 当前大块已经用掉的字节数 */
+        size_t      mUsedBytes;     /**< 本帧已经分配的字节数 */
+        size_t      mPeakBytes;     /**< 单帧分配字节数峰值 */
+        uint64_t    mAllocCount;    /**< 本帧分配次数 */
+    };
+}
+
+
+#endif  /*__T3D_FRAME_ARENA_H__*/
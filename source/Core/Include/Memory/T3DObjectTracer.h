@@ -24,6 +24,7 @@
 
 #include "T3DPrerequisites.h"
 #include "Kernel/T3DObject.h"
+#include <atomic>
 
 
 namespace Tiny3D
@@ -31,8 +32,9 @@ namespace Tiny3D
     /**
      * @class ObjectTracer
      * @brief 一个跟踪内存的类，能够跟踪所有Object其派生类内存泄漏的情况
-     * @remarks 这里的跟踪当对象数量很大的时候会有一定的性能损耗，
-     *      建议这里在定位完内存问题就关闭掉跟踪
+     * @remarks 只有编译时定义了 T3D_OBJECT_TRACER 才会跟踪，否则 Object 的
+     *      构造和析构完全不会访问跟踪器。跟踪的对象按地址分散到多个分片，
+     *      每个分片单独加锁，多线程同时创建对象时也不会都抢同一把锁。
      */
     class ObjectTracer : public Singleton<ObjectTracer>
     {
@@ -77,21 +79,15 @@ namespace Tiny3D
 
         /**
          * @brief 添加一个对象到内存跟踪器里
+         * @param [in] object : 对象
+         * @param [in] size : 对象分配的字节数，不是 new 出来的对象为 0
          */
-        void addObject(Object *object)
-        {
-            if (mIsEnabled)
-                mObjects.insert(object);
-        }
+        void addObject(Object *object, size_t size);
 
         /**
          * @brief 从内存跟踪器里移除一个对象
          */
-        void removeObject(Object *object)
-        {
-            if (mIsEnabled)
-                mObjects.erase(object);
-        }
+        void removeObject(Object *object);
 
         /**
          * @brief 输出信息
@@ -99,13 +95,37 @@ namespace Tiny3D
          */
         void printInfo(const String &str) const;
 
-        typedef TSet<Object*>           Objects;
-        typedef Objects::iterator       ObjectsItr;
-        typedef Objects::const_iterator ObjectsConstItr;
-        typedef Objects::value_type     ObjectsValue;
+        enum
+        {
+            MAX_SHARDS = 16,    /**< 分片数量 */
+        };
+
+        typedef TUnorderedMap<Object*, size_t>  Objects;
+        typedef Objects::iterator               ObjectsItr;
+        typedef Objects::const_iterator         ObjectsConstItr;
+        typedef Objects::value_type             ObjectsValue;
+
+        struct Shard
+        {
+            mutable TMutex  mutex;          /**< 分片的锁 */
+            Objects         objects;        /**< 对象和分配的字节数 */
+            char            padding[64];    /**< 避免相邻分片的锁在同一个缓存行 */
+        };
+
+        /**
+         * @brief 根据对象地址获取所在分片
+         */
+        Shard &getShard(Object *object)
+        {
+            size_t h = (size_t)object >> 4;
+            return mShards[(h ^ (h >> 8)) % MAX_SHARDS];
+        }
 
         bool                    mIsEnabled;     /**< 是否开启了内存跟踪 */
-        Objects                 mObjects;       /**< 对象集合 */
+        Shard                   mShards[MAX_SHARDS];    /**< 对象集合分片 */
+
+        std::atomic<uint64_t>   mTotalObjects;  /**< 累计跟踪过的对象数量 */
+        std::atomic<uint64_t>   mTotalBytes;    /**< 累计跟踪过的对象字节数 */
 
         mutable FileDataStream  *mStream;       /**< 临时输出对象，用于dumpMemoryInfo的时候 */
     };
@@ -49,6 +49,8 @@ namespace Tiny3D
     template <typename T>
     class SmartPtr
     {
+        template <typename T2> friend class SmartPtr;
+
     public:
         static const SmartPtr NULL_PTR;
 
@@ -87,6 +89,23 @@ namespace Tiny3D
             }
         }
 
+        /**
+         * @brief 移动构造函数，直接接管引用，不改变引用计数
+         */
+        SmartPtr(SmartPtr &&rkPointer)
+        {
+            mReferObject = rkPointer.mReferObject;
+            rkPointer.mReferObject = nullptr;
+        }
+
+        template <typename T2>
+        SmartPtr(SmartPtr<T2> &&rkOther,
+            typename std::enable_if<std::is_convertible<T2 *, T *>::value, void>::type ** = 0)
+        {
+            mReferObject = rkOther.mReferObject;
+            rkOther.mReferObject = nullptr;
+        }
+
         template <typename T2>
         SmartPtr(const SmartPtr<T2> &rkOther, const std::_Static_tag &)
         {
@@ -161,6 +180,41 @@ namespace Tiny3D
             return *this;
         }
 
+        /**
+         * @brief 移动赋值，直接接管引用，只释放原来持有的对象
+         */
+        SmartPtr &operator =(SmartPtr &&rkPointer)
+        {
+            if (this != &rkPointer)
+            {
+                Object *obj = mReferObject;
+                mReferObject = rkPointer.mReferObject;
+                rkPointer.mReferObject = nullptr;
+
+                if (obj != nullptr)
+                {
+                    obj->release();
+                }
+            }
+
+            return *this;
+        }
+
+        template <typename T2>
+        SmartPtr &operator =(SmartPtr<T2> &&rkOther)
+        {
+            Object *obj = mReferObject;
+            mReferObject = rkOther.mReferObject;
+            rkOther.mReferObject = nullptr;
+
+            if (obj != nullptr)
+            {
+                obj->release();
+            }
+
+            return *this;
+        }
+
         template <typename T2>
         SmartPtr &operator =(const SmartPtr<T2> &rkOther)
         {
@@ -66,6 +66,30 @@ namespace Tiny3D
          */
         virtual TResult read(const String &name, MemoryDataStream &stream) = 0;
 
+        /**
+         * @brief 一次从档案读取多个文件
+         * @param [in] names : 文件名称列表
+         * @param [out] streams : 返回的数据流，和 names 一一对应
+         * @param [in] threads : 最多使用的线程数，0 表示使用硬件线程数
+         * @return 全部读成功返回T3D_ERR_OK，否则返回第一个失败的错误码，
+         *      失败的文件不影响其他文件读取
+         * @remarks 默认实现在当前线程依次调用 read()，
+         *      派生类可以重写成多个线程并行读取
+         */
+        virtual TResult readMany(const TArray<String> &names, 
+            TArray<MemoryDataStream> &streams, size_t threads = 0);
+
+        /**
+         * @brief 以流的方式打开档案里的指定文件，读取时才按需读入数据
+         * @param [in] name : 文件名称
+         * @param [out] stream : 返回可以定位的只读数据流，用完后调用者负责 delete
+         * @return 打开成功返回T3D_ERR_OK
+         * @remarks 不会把整个文件读进内存，适合音视频、大模型这类大文件。
+         *      返回的数据流不依赖档案对象，可以在别的线程里读，
+         *      但是同一个数据流不能同时在多个线程里读。
+         */
+        virtual TResult open(const String &name, DataStream *&stream) = 0;
+
         /**
          * @brief 写数据流到档案里的指定文件中
          * @param [in] name : 文件名称
@@ -37,6 +37,9 @@ namespace Tiny3D
         , public ResourceManager
     {
     public:
+        /** ResourceManager 也是 EventHandler，这里指明用单例的 getInstance() */
+        using Singleton<ArchiveManager>::getInstance;
+
         /** 创建 ArchiveManager 对象 */
         static ArchiveManagerPtr create();
 
@@ -49,6 +52,15 @@ namespace Tiny3D
         virtual ArchivePtr loadArchive(const String &name, 
             const String &archiveType);
 
+        /**
+         * @brief 在工作线程里异步加载档案系统对象
+         * @remarks 加载成功后在主线程先加到档案列表里，再调用 callback
+         * @see ResourceManager::loadAsync()
+         */
+        virtual ResourceRequestPtr loadArchiveAsync(const String &name,
+            const String &archiveType, int32_t priority,
+            const ResourceRequest::Callback &callback);
+
         /**
          * @brief 卸载档案系统对象
          */
@@ -95,6 +107,7 @@ namespace Tiny3D
         typedef Archives::value_type            ArchivesValue;
 
         Creators    mCreators;
+        TMutex      mCreatorsMutex; /**< mCreators 的互斥量，异步加载时工作线程也会查找 */
         Archives    mArchives;
     };
 
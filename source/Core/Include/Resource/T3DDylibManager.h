@@ -33,6 +33,9 @@ namespace Tiny3D
         , public ResourceManager
     {
     public:
+        /** ResourceManager 也是 EventHandler，这里指明用单例的 getInstance() */
+        using Singleton<DylibManager>::getInstance;
+
         /**
          * @brief 创建动态库管理器对象
          */
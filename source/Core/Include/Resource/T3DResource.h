@@ -24,6 +24,7 @@
 
 #include "Kernel/T3DObject.h"
 #include "T3DTypedef.h"
+#include "DataStruct/T3DString.h"
 
 
 namespace Tiny3D
@@ -77,6 +78,12 @@ namespace Tiny3D
             return mName;
         }
 
+        /** 获取资源名称的 64 位 hash 值，资源管理器用它查找缓存 */
+        uint64_t getNameHash() const
+        {
+            return mNameHash;
+        }
+
         /** 获取资源是否加载 */
         bool isLoaded() const
         {
@@ -109,11 +116,12 @@ namespace Tiny3D
         virtual ResourcePtr clone() const = 0;
 
     protected:
-        ID      mID;        /**< 资源ID */
-        ID      mCloneID;   /**< 如果资源是从其他资源克隆出来的，该ID才有效 */
-        size_t  mSize;      /**< 资源大小 */
-        bool    mIsLoaded;  /**< 资源是否加载标记 */
-        String  mName;      /**< 资源名称 */
+        ID          mID;        /**< 资源ID */
+        ID          mCloneID;   /**< 如果资源是从其他资源克隆出来的，该ID才有效 */
+        size_t      mSize;      /**< 资源大小 */
+        bool        mIsLoaded;  /**< 资源是否加载标记 */
+        String      mName;      /**< 资源名称 */
+        uint64_t    mNameHash;  /**< 资源名称的 hash 值 */
     };
 }
 
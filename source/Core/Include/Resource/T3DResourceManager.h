@@ -22,27 +22,143 @@
 
 
 #include "T3DResource.h"
+#include "Resource/T3DResourceRequest.h"
+#include "DataStruct/T3DFlatHashMap.h"
 
 
 namespace Tiny3D
 {
-    class T3D_ENGINE_API ResourceManager : public Object
+    class T3D_ENGINE_API ResourceManager 
+        : public Object
+        , public EventHandler
     {
+        friend class ResourceRequest;
+        friend class ResourceLoader;
+
+        T3D_DECLARE_EVENT_MAP();
+
     public:
+        /** 异步加载结束的事件ID，只投递给发起请求的资源管理器自己 */
+        static const EventID EV_RESOURCE_LOADED;
+
+        enum
+        {
+            MAX_ASYNC_ARGS = 4,     /**< 异步加载最多能转发给 create() 的参数个数 */
+            EVICTION_TIME_SLICE = 500000,   /**< 每帧淘汰资源的默认时间片，纳秒 */
+        };
+
+        /** 资源缓存的统计数据 */
+        struct Stats
+        {
+            size_t      bytesResident;  /**< 缓存里所有资源的大小之和 */
+            size_t      resources;      /**< 缓存里的资源个数，包括克隆资源 */
+            size_t      budget;         /**< 内存预算，0 表示不限制 */
+            uint64_t    hits;           /**< load() 和 loadAsync() 命中缓存的次数 */
+            uint64_t    misses;         /**< load() 和 loadAsync() 没有命中的次数 */
+            uint64_t    evictions;      /**< 被淘汰和 unloadUnused() 卸载的资源个数 */
+
+            /** 命中率，还没有加载过资源时返回 0 */
+            double hitRatio() const
+            {
+                uint64_t total = hits + misses;
+                return (total > 0 ? (double)hits / (double)total : 0.0);
+            }
+        };
+
         /** 析构函数 */
         virtual ~ResourceManager();
 
         static ID toID(const String &name);
 
-        /** 从文件加载资源到内存 */
+        /** 
+         * @brief 从文件加载资源到内存
+         * @remarks 同名资源正在异步加载时，还在队列里的直接在当前线程加载，
+         *      已经在工作线程加载的等它加载完成
+         */
         virtual ResourcePtr load(const String &name, int32_t argc, ...);
 
+        /**
+         * @brief 在工作线程里异步加载资源
+         * @param [in] name : 资源名称
+         * @param [in] priority : 优先级，值越大越先加载
+         * @param [in] callback : 结束回调，在主线程调用，可以为空
+         * @param [in] argc : 创建参数个数，最多 MAX_ASYNC_ARGS 个
+         * @param [in] ... : 创建参数，都必须是 const char *，会复制一份给工作线程
+         * @return 返回请求句柄。资源已经在缓存里时返回已经完成的句柄，
+         *      回调同样在下一次 dispatchAsyncLoads() 之后调用。
+         * @remarks 同名资源正在加载时不会重复创建，直接返回原来的句柄并追加
+         *      回调，新的优先级更高时提高原来请求的优先级。
+         *      create() 和 Resource::load() 会在工作线程调用，派生类实现时
+         *      不能依赖主线程状态。
+         */
+        virtual ResourceRequestPtr loadAsync(const String &name, 
+            int32_t priority, const ResourceRequest::Callback &callback, 
+            int32_t argc, ...);
+
+        /**
+         * @brief 取消本管理器所有未结束的异步请求，并等待正在加载的请求结束
+         * @remarks 派生类析构时要先调用，避免工作线程还在调用派生类的 create()
+         */
+        void cancelAsyncLoads();
+
+        /**
+         * @brief 派发已经结束的异步请求
+         * @remarks 主线程每帧调用一次，把结束的请求投递到事件队列，
+         *      随后的 EventManager::dispatchEvent() 里调用结束回调
+         */
+        static void dispatchAsyncLoads();
+
         /** 从内存中卸载资源 */
         virtual void unload(ResourcePtr &res);
 
         /** 把当前资源管理器里所有不使用资源从内存中卸载掉 */
         virtual void unloadUnused();
 
+        /**
+         * @brief 设置内存预算
+         * @param [in] budget : 缓存里资源大小之和的上限，单位字节，0 表示不限制
+         * @remarks 超出预算时 evict() 按 CLOCK 算法淘汰没有在外面使用的资源，
+         *      最近被加载或者查询过的资源会多保留一圈。
+         *      资源大小取 Resource::getSize()，加载完以后不应再改变。
+         */
+        void setMemoryBudget(size_t budget);
+
+        /** 获取内存预算，0 表示不限制 */
+        size_t getMemoryBudget() const;
+
+        /**
+         * @brief 淘汰没有使用的资源，直到不超出内存预算
+         * @param [in] timeSlice : 最多花费的时间，纳秒，小于等于 0 表示不限制
+         * @return 返回淘汰掉的资源个数
+         * @remarks 时钟指针的位置会保留下来，一次没有做完的下次接着做
+         */
+        size_t evict(int64_t timeSlice);
+
+        /** 获取统计数据 */
+        Stats getStats() const;
+
+        /** 命中、没命中和淘汰的计数清零 */
+        void resetStats();
+
+        /**
+         * @brief 让所有资源管理器在时间片内淘汰超出预算的资源
+         * @remarks 主线程每帧调用一次，所有资源管理器共用一个时间片，
+         *      时间片小于等于 0 表示不限制
+         */
+        static void evictAll(int64_t timeSlice = EVICTION_TIME_SLICE);
+
+        /**
+         * @brief 所有资源管理器卸载不使用的资源
+         * @remarks 系统内存不足时调用
+         */
+        static void unloadAllUnused();
+
+        /**
+         * @brief 取消所有资源管理器的异步请求，并等待正在加载的请求结束
+         * @remarks 卸载插件之前调用，保证工作线程不会再执行插件里的代码
+         */
+        static void cancelAllAsyncLoads();
+
         /** 
          * @brief 从源资源克隆一份新资源出来
          * @param [in] src : 源资源对象
@@ -60,6 +176,16 @@ namespace Tiny3D
          */
         ResourcePtr getResource(const String &name, ID cloneID = 0) const;
 
+        /** 
+         * @brief 根据事先算好的名称 hash 值获取对应资源对象
+         * @param [in] nameHash : 名称的 hash 值，StringUtil::hash(name)
+         * @param [in] name : 资源名称，hash 冲突时用来确认
+         * @param [in] cloneID : 克隆出来的资源需填写该参数，否则用默认值0
+         * @return 返回查询的资源对象，如果返回NULL_PTR则没有该资源
+         */
+        ResourcePtr getResource(uint64_t nameHash, const String &name, 
+            ID cloneID = 0) const;
+
         /**
          * @brief 根据资源名称获取会所有同名的资源对象，原资源和克隆资源都返回
          * @param [in] name : 资源名称
@@ -83,19 +209,72 @@ namespace Tiny3D
         /** 根据名称计算资源 hash 值，作为其ID */
         static uint32_t hash(const char *str);
 
+        /** 执行已经切换到加载状态的请求，在工作线程或者调用 load() 的线程里 */
+        void runRequest(ResourceRequest *request);
+
+        /** 用复制下来的参数调用 create() */
+        ResourcePtr createWithArgs(const String &name, 
+            const TArray<String> &args);
+
+        /** 把参数转成 va_list 调用 create() */
+        ResourcePtr invokeCreate(const String &name, int32_t argc, ...);
+
+        /** 查找缓存里的原始资源，调用前要锁住 mCacheMutex */
+        ResourcePtr findCached(uint64_t nameHash, const String &name) const;
+
+        /** 
+         * @brief 把加载好的原始资源放进缓存，调用前要锁住 mCacheMutex
+         * @return 缓存里已经有同名原始资源时返回已有的，否则返回 res
+         */
+        ResourcePtr addCached(const ResourcePtr &res);
+
+        /** 在主线程调用请求的结束回调 */
+        T3D_DECLARE_EVENT_HANDLE(onResourceLoaded);
+
     protected:
         typedef TMap<ID, ResourcePtr>       Resources;
         typedef Resources::iterator         ResourcesItr;
         typedef Resources::const_iterator   ResourcesConstItr;
         typedef Resources::value_type       ResourcesValue;
 
-        typedef TMap<String, Resources>         ResourcesMap;
-        typedef ResourcesMap::iterator          ResourcesMapItr;
-        typedef ResourcesMap::const_iterator    ResourcesMapConstItr;
-        typedef ResourcesMap::value_type        ResourcesMapValue;
+        /** 缓存里同一个名称的资源 */
+        struct CacheEntry
+        {
+            ResourcePtr     original;   /**< 原始资源 */
+            Resources       clones;     /**< 克隆资源，按克隆ID索引 */
+            mutable bool    referenced; /**< CLOCK 的访问位，最近用过时为 true */
+
+            CacheEntry() : referenced(true) {}
+        };
+
+        /** 缓存里的资源是否都只被缓存引用，调用前要锁住 mCacheMutex */
+        static bool isUnused(const CacheEntry &entry);
 
-        ResourcesMap    mResourcesCache;    /**< 资源对象池 */
+        /** 
+         * 按名称的 64 位 hash 值索引，每个名称只在表里保存一份，
+         * hash 值相同时再比较名称
+         */
+        typedef TFlatHashMap<String, CacheEntry>            ResourcesCache;
+        typedef TFlatHashMap<String, ResourceRequestPtr>    Requests;
+
+        typedef TList<ResourceManager*>     Managers;
+
+        ResourcesCache  mResourcesCache;    /**< 资源对象池 */
+        Requests        mRequests;          /**< 未结束的异步请求，按名称去重 */
         ID              mCloneID;           /**< 克隆ID */
+
+        size_t          mMemoryBudget;      /**< 内存预算，0 表示不限制 */
+        size_t          mBytesResident;     /**< 缓存里所有资源的大小之和 */
+        size_t          mResidentCount;     /**< 缓存里的资源个数 */
+        size_t          mClockHand;         /**< CLOCK 指针，缓存的槽下标 */
+        uint64_t        mHits;              /**< 命中缓存次数 */
+        uint64_t        mMisses;            /**< 没有命中缓存次数 */
+        uint64_t        mEvictions;         /**< 淘汰的资源个数 */
+
+        mutable TMutex  mCacheMutex;        /**< 资源对象池和异步请求的互斥量 */
+
+        static Managers msManagers;         /**< 所有资源管理器 */
+        static TMutex   msManagersMutex;    /**< msManagers 的互斥量 */
     };
 }
 
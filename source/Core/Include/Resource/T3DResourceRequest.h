@@ -0,0 +1,145 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_RESOURCE_REQUEST_H__
+#define __T3D_RESOURCE_REQUEST_H__
+
+
+#include "Kernel/T3DObject.h"
+#include "T3DTypedef.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 异步加载资源的请求句柄
+     * @remarks 由 ResourceManager::loadAsync() 返回，同名资源加载完成之前的
+     *      所有请求共享同一个句柄。可以在任意线程查询状态、等待或者取消，
+     *      完成回调只会在主线程通过事件系统派发。
+     */
+    class T3D_ENGINE_API ResourceRequest : public Object
+    {
+        friend class ResourceManager;
+        friend class ResourceLoader;
+
+    public:
+        /** 请求状态 */
+        enum State
+        {
+            E_STATE_PENDING = 0,    /**< 在队列里等待工作线程 */
+            E_STATE_LOADING,        /**< 正在创建和加载资源 */
+            E_STATE_LOADED,         /**< 加载成功 */
+            E_STATE_FAILED,         /**< 创建或者加载失败 */
+            E_STATE_CANCELED,       /**< 被取消了 */
+        };
+
+        /** 完成回调，成功、失败和取消都会回调 */
+        typedef std::function<void(ResourceRequest *request)> Callback;
+
+        /** 析构函数 */
+        virtual ~ResourceRequest();
+
+        /** 获取资源名称 */
+        const String &getName() const
+        {
+            return mName;
+        }
+
+        /** 获取请求优先级，值越大越先加载 */
+        int32_t getPriority() const;
+
+        /** 获取请求当前状态 */
+        State getState() const;
+
+        /** 是否已经结束，包括成功、失败和取消 */
+        bool isDone() const;
+
+        /** 获取加载好的资源，没有加载成功返回 nullptr */
+        ResourcePtr getResource() const;
+
+        /**
+         * @brief 取消请求
+         * @return 还没结束的请求返回 true，已经结束的返回 false
+         * @remarks 同名请求共享句柄，取消会影响所有等待这个资源的调用者。
+         *      正在加载的资源会等加载完成后丢弃，不会放进资源缓存。
+         */
+        bool cancel();
+
+        /**
+         * @brief 阻塞等待请求结束
+         * @return 返回结束时的状态
+         * @remarks 只等待加载结束，不等待完成回调
+         */
+        State wait() const;
+
+    protected:
+        /** 构造函数，只能由 ResourceManager 创建 */
+        ResourceRequest(ResourceManager *mgr, const String &name,
+            int32_t priority);
+
+        /** 从等待状态切换到加载状态，已经取消或者已经开始的返回 false */
+        bool start();
+
+        /** 结束请求，状态必须是结束状态之一，调用前要锁住 mMutex */
+        void finish(State state, const ResourcePtr &res);
+
+        typedef TArray<Callback>            Callbacks;
+        typedef TArray<String>              Arguments;
+
+        ResourceManager     *mManager;      /**< 发起请求的资源管理器 */
+        String              mName;          /**< 资源名称 */
+        uint64_t            mNameHash;      /**< 资源名称的 hash 值 */
+        Arguments           mArgs;          /**< 复制下来的创建参数 */
+        Callbacks           mCallbacks;     /**< 所有调用者的完成回调 */
+        ResourcePtr         mResource;      /**< 加载好的资源 */
+        int32_t             mPriority;      /**< 优先级 */
+        State               mState;         /**< 当前状态 */
+        bool                mCanceled;      /**< 加载中被取消，加载完丢弃 */
+
+        mutable TMutex          mMutex;     /**< 状态和资源的互斥量 */
+        mutable TCondVariable   mDoneCond;  /**< 请求结束时唤醒等待的线程 */
+    };
+
+    /**
+     * @brief 异步加载结束事件的参数
+     */
+    class T3D_ENGINE_API ResourceLoadedParam : public EventParam
+    {
+    public:
+        ResourceLoadedParam(ResourceRequest *request)
+            : Request(request)
+        {
+        }
+
+        virtual ~ResourceLoadedParam()
+        {
+        }
+
+        virtual EventParam *clone() override
+        {
+            return new ResourceLoadedParam(Request);
+        }
+
+    public:
+        ResourceRequestPtr  Request;    /**< 结束的请求 */
+    };
+}
+
+
+#endif  /*__T3D_RESOURCE_REQUEST_H__*/
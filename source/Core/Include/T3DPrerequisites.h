@@ -43,6 +43,7 @@ namespace Tiny3D
 {
     class Object;
     class ObjectTracer;
+    class FrameArena;
 
     class Engine;
     class Plugin;
@@ -51,6 +52,7 @@ namespace Tiny3D
 
     class Resource;
     class ResourceManager;
+    class ResourceRequest;
     class Dylib;
     class DylibManager;
     class Archive;
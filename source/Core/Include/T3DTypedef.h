@@ -30,6 +30,7 @@ namespace Tiny3D
 
     T3D_DECLARE_SMART_PTR(Resource);
     T3D_DECLARE_SMART_PTR(ResourceManager);
+    T3D_DECLARE_SMART_PTR(ResourceRequest);
     T3D_DECLARE_SMART_PTR(Dylib);
     T3D_DECLARE_SMART_PTR(DylibManager);
     T3D_DECLARE_SMART_PTR(Archive);
@@ -34,6 +34,7 @@
 
 // Memory
 #include <Memory/T3DSmartPtr.h>
+#include <Memory/T3DFrameArena.h>
 
 // Resource
 #include <Resource/T3DArchive.h>
@@ -43,9 +44,11 @@
 #include <Resource/T3DDylibManager.h>
 #include <Resource/T3DResource.h>
 #include <Resource/T3DResourceManager.h>
+#include <Resource/T3DResourceRequest.h>
 
 // DataStruct
 #include <DataStruct/T3DVariant.h>
 #include <DataStruct/T3DString.h>
+#include <DataStruct/T3DFlatHashMap.h>
 
 #endif  /*__TINY3D_H__*/
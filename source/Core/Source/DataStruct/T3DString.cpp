@@ -18,6 +18,7 @@
  ******************************************************************************/
 
 #include "DataStruct/T3DString.h"
+#include <string.h>
 
 
 namespace Tiny3D
@@ -154,5 +155,42 @@ namespace Tiny3D
             pos++;
         }
     }
+
+    uint64_t StringUtil::hash(const char *str, size_t len)
+    {
+        const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+        const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+        uint64_t value = 0xCBF29CE484222325ULL ^ (len * PRIME1);
+
+        // 资源路径一般都有几十个字符，一次处理 8 个字节
+        while (len >= 8)
+        {
+            uint64_t word;
+            memcpy(&word, str, sizeof(word));
+            word *= PRIME2;
+            word = (word << 31) | (word >> 33);
+            value = (value ^ (word * PRIME1)) * PRIME2;
+            str += 8;
+            len -= 8;
+        }
+
+        // 剩下不到 8 个字节按 FNV-1a 逐个处理
+        while (len > 0)
+        {
+            value ^= (uint8_t)(*str++);
+            value *= 0x100000001B3ULL;
+            len--;
+        }
+
+        // 用 MurmurHash3 的 fmix64 混合，低位也分布均匀
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ULL;
+        value ^= value >> 33;
+
+        return value;
+    }
 }
 
@@ -79,32 +79,58 @@ namespace Tiny3D
                     break;
                 }
 
-                stream.getBuffer((uint8_t *&)content, contentSize);
+                uint8_t *buffer = nullptr;
+                stream.getBuffer(buffer, contentSize);
+                content = (char *)buffer;
             }
             else
             {
                 // 配置文件不在某种档案结构管理里面，就在本地文件系统，直接访问。
-                FileDataStream fs;
-                if (!fs.open(mFilename.c_str(), FileDataStream::E_MODE_READ_ONLY))
+                MappedFile *mapping = nullptr;
+                if (MappedFile::isSupported())
                 {
-                    ret = T3D_ERR_FILE_NOT_EXIST;
-                    T3D_LOG_ERROR("Open config file [%s] failed !",
-                        mFilename.c_str());
-                    break;
+                    mapping = MappedFile::create(mFilename.c_str());
                 }
 
-                contentSize = fs.size();
-                content = new char[contentSize];
-                if (fs.read(content, contentSize) != contentSize)
+                if (mapping != nullptr)
+                {
+                    // 直接借用映射区域，不拷贝文件内容
+                    stream.setMappedFile(mapping);
+                    mapping->release();
+                }
+                else
                 {
+                    FileDataStream fs;
+                    if (!fs.open(mFilename.c_str(), 
+                        FileDataStream::E_MODE_READ_ONLY))
+                    {
+                        ret = T3D_ERR_FILE_NOT_EXIST;
+                        T3D_LOG_ERROR("Open config file [%s] failed !",
+                            mFilename.c_str());
+                        break;
+                    }
+
+                    contentSize = fs.size();
+                    uint8_t *data = new uint8_t[contentSize];
+                    if (fs.read(data, contentSize) != contentSize)
+                    {
+                        T3D_SAFE_DELETE_ARRAY(data);
+                        fs.close();
+                        ret = T3D_ERR_FILE_DATA_MISSING;
+                        T3D_LOG_ERROR("Read config file [%s] data failed !",
+                            mFilename.c_str());
+                        break;
+                    }
+
                     fs.close();
-                    ret = T3D_ERR_FILE_DATA_MISSING;
-                    T3D_LOG_ERROR("Read config file [%s] data failed !",
-                        mFilename.c_str());
-                    break;
+
+                    // 数据交给数据流管理，离开作用域时自动释放
+                    stream.setBuffer(data, contentSize, false);
                 }
 
-                fs.close();
+                uint8_t *buffer = nullptr;
+                stream.getBuffer(buffer, contentSize);
+                content = (char *)buffer;
             }
             
             // 解析 XML 格式
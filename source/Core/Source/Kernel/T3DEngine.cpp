@@ -31,6 +31,7 @@
 #include "DataStruct/T3DString.h"
 
 #include "Memory/T3DObjectTracer.h"
+#include "Memory/T3DFrameArena.h"
 
 
 
@@ -49,14 +50,19 @@ namespace Tiny3D
         : mLogger(nullptr)
         , mEventMgr(nullptr)
         , mObjTracer(nullptr)
+        , mFrameArena(nullptr)
         , mWindow(nullptr)
         , mIsRunning(false)
         , mArchiveMgr(nullptr)
     {
+        mFrameArena = new FrameArena();
     }
 
     Engine::~Engine()
     {
+        // 工作线程可能还在执行插件里的代码，卸载插件前先等异步加载结束
+        ResourceManager::cancelAllAsyncLoads();
+
         unloadPlugins();
 
         mDylibMgr = nullptr;
@@ -68,6 +74,8 @@ namespace Tiny3D
         mObjTracer->dumpMemoryInfo();
         T3D_SAFE_DELETE(mObjTracer);
 
+        T3D_SAFE_DELETE(mFrameArena);
+
         mLogger->shutdown();
         T3D_SAFE_DELETE(mLogger);
     }
@@ -165,11 +173,20 @@ namespace Tiny3D
             if (!mIsRunning)
                 break;
 
+            // 把异步加载结束的资源请求投递到事件队列
+            ResourceManager::dispatchAsyncLoads();
+
             // 事件系统派发事件
             T3D_EVENT_MGR.dispatchEvent();
 
+            // 在时间片内淘汰超出内存预算的资源
+            ResourceManager::evictAll();
+
             // 渲染一帧
             renderOneFrame();
+
+            // 回收本帧的临时内存
+            mFrameArena->reset();
         }
 
         theApp->applicationWillTerminate();
@@ -229,6 +246,12 @@ namespace Tiny3D
         T3D_LOG_ENTER_BACKGROUND();
     }
 
+    void Engine::appLowMemory()
+    {
+        T3D_LOG_WARNING("Low memory, unload all unused resources !");
+        ResourceManager::unloadAllUnused();
+    }
+
     //--------------------------------------------------------------------------
 
     TResult Engine::installPlugin(Plugin *plugin)
@@ -474,7 +497,11 @@ namespace Tiny3D
 
     TResult Engine::initObjectTracer()
     {
+#if defined (T3D_OBJECT_TRACER)
+        mObjTracer = new ObjectTracer(true);
+#else
         mObjTracer = new ObjectTracer();
+#endif
         return T3D_ERR_OK;
     }
 
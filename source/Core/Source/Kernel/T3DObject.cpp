@@ -19,32 +19,83 @@
 
 #include "Kernel/T3DObject.h"
 #include "Memory/T3DObjectTracer.h"
+#include "Memory/T3DMemoryPool.h"
 
 
 namespace Tiny3D
 {
-    Object::Object()
-        : mReferCount(1)
+#if defined (T3D_OBJECT_TRACER)
+    /// 最近一次 Object::operator new 分配的大小，构造函数里取走，栈上的对象为 0
+    static thread_local size_t sAllocatedSize = 0;
+#endif
+
+    void *Object::operator new(size_t size)
     {
-        ObjectTracer::getInstance().addObject(this);
+#if defined (T3D_OBJECT_TRACER)
+        sAllocatedSize = size;
+#endif
+        return T3D_POOL_ALLOCATOR.allocate(size);
     }
 
-    Object::~Object()
+    void Object::operator delete(void *ptr, size_t size)
     {
-        ObjectTracer::getInstance().removeObject(this);
+        T3D_POOL_ALLOCATOR.deallocate(ptr, size);
     }
 
-    Object *Object::acquire()
+#if defined (T3D_OBJECT_TRACER)
+
+    void Object::trace()
     {
-        ++mReferCount;
-        return this;
+        size_t size = sAllocatedSize;
+        sAllocatedSize = 0;
+
+        ObjectTracer *tracer = ObjectTracer::getInstancePtr();
+        if (tracer != nullptr && tracer->isTracingEnabled())
+        {
+            tracer->addObject(this, size);
+        }
     }
 
-    void Object::release()
+    void Object::untrace()
     {
-        if (--mReferCount == 0)
+        ObjectTracer *tracer = ObjectTracer::getInstancePtr();
+        if (tracer != nullptr && tracer->isTracingEnabled())
         {
-            delete this;
+            tracer->removeObject(this);
         }
     }
+#endif
+
+    Object::Object()
+        : mReferCount(1)
+#if defined (T3D_THREAD_SAFE_REFER)
+        , mIsThreadSafe(true)
+#else
+        , mIsThreadSafe(false)
+#endif
+    {
+#if defined (T3D_OBJECT_TRACER)
+        trace();
+#endif
+    }
+
+    Object::Object(ReferPolicy policy)
+        : mReferCount(1)
+#if defined (T3D_THREAD_SAFE_REFER)
+        , mIsThreadSafe(true)
+#else
+        , mIsThreadSafe(policy == E_REFER_THREAD_SAFE)
+#endif
+    {
+#if defined (T3D_OBJECT_TRACER)
+        trace();
+#endif
+    }
+
+    Object::~Object()
+    {
+#if defined (T3D_OBJECT_TRACER)
+        untrace();
+#endif
+    }
 }
@@ -0,0 +1,129 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "Memory/T3DFrameArena.h"
+
+
+namespace Tiny3D
+{
+    FrameArena::FrameArena(size_t chunkSize /* = DEFAULT_CHUNK_SIZE */)
+        : mChunkSize(chunkSize > 0 ? chunkSize : (size_t)DEFAULT_CHUNK_SIZE)
+        , mOffset(0)
+        , mUsedBytes(0)
+        , mPeakBytes(0)
+        , mAllocCount(0)
+    {
+
+    }
+
+    FrameArena::~FrameArena()
+    {
+        for (auto itr = mChunks.begin(); itr != mChunks.end(); ++itr)
+        {
+            ::operator delete(itr->data);
+        }
+
+        mChunks.clear();
+    }
+
+    void FrameArena::grow(size_t size)
+    {
+        Chunk chunk;
+        chunk.size = (size > mChunkSize ? size : mChunkSize);
+        chunk.data = (uchar_t *)::operator new(chunk.size);
+        mChunks.push_back(chunk);
+        mOffset = 0;
+    }
+
+    void *FrameArena::allocate(size_t size, size_t alignment /* = DEFAULT_ALIGNMENT */)
+    {
+        T3D_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        size_t offset = 0;
+
+        if (!mChunks.empty())
+        {
+            const Chunk &chunk = mChunks.back();
+            uintptr_t addr = (uintptr_t)(chunk.data + mOffset);
+            uintptr_t aligned = (addr + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            offset = mOffset + (size_t)(aligned - addr);
+        }
+
+        if (mChunks.empty() || offset + size > mChunks.back().size)
+        {
+            // 当前大块放不下，多申请对齐需要的空间
+            grow(size + alignment);
+
+            uintptr_t addr = (uintptr_t)mChunks.back().data;
+            uintptr_t aligned = (addr + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            offset = (size_t)(aligned - addr);
+        }
+
+        void *ptr = mChunks.back().data + offset;
+        mOffset = offset + size;
+        mUsedBytes += size;
+        mAllocCount++;
+
+        return ptr;
+    }
+
+    void FrameArena::reset()
+    {
+        if (mUsedBytes > mPeakBytes)
+        {
+            mPeakBytes = mUsedBytes;
+        }
+
+        if (mChunks.size() > 1)
+        {
+            // 这一帧用了多个大块，合并成一个够一整帧用的
+            size_t total = 0;
+
+            for (auto itr = mChunks.begin(); itr != mChunks.end(); ++itr)
+            {
+                total += itr->size;
+                ::operator delete(itr->data);
+            }
+
+            mChunks.clear();
+            grow(total);
+        }
+
+        mOffset = 0;
+        mUsedBytes = 0;
+        mAllocCount = 0;
+    }
+
+    FrameArena::Stats FrameArena::getStats() const
+    {
+        Stats stats;
+        stats.capacity = 0;
+
+        for (auto itr = mChunks.begin(); itr != mChunks.end(); ++itr)
+        {
+            stats.capacity += itr->size;
+        }
+
+        stats.usedBytes = mUsedBytes;
+        stats.peakBytes = (mUsedBytes > mPeakBytes ? mUsedBytes : mPeakBytes);
+        stats.chunkCount = mChunks.size();
+        stats.allocCount = mAllocCount;
+        return stats;
+    }
+}
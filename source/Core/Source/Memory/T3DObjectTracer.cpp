@@ -20,6 +20,7 @@
 
 #include "Memory/T3DObjectTracer.h"
 #include <sstream>
+#include <typeinfo>
 
 
 namespace Tiny3D
@@ -28,6 +29,8 @@ namespace Tiny3D
 
     ObjectTracer::ObjectTracer(bool enabled /* = false */)
         : mIsEnabled(enabled)
+        , mTotalObjects(0)
+        , mTotalBytes(0)
         , mStream(nullptr)
     {
 
@@ -38,26 +41,78 @@ namespace Tiny3D
 
     }
 
+    void ObjectTracer::addObject(Object *object, size_t size)
+    {
+        mTotalObjects.fetch_add(1, std::memory_order_relaxed);
+        mTotalBytes.fetch_add(size, std::memory_order_relaxed);
+
+        Shard &shard = getShard(object);
+        TAutoLock<TMutex> lock(shard.mutex);
+        shard.objects.insert(ObjectsValue(object, size));
+    }
+
+    void ObjectTracer::removeObject(Object *object)
+    {
+        // 跟踪器创建之前构造的对象不在集合里，erase 什么都不做
+        Shard &shard = getShard(object);
+        TAutoLock<TMutex> lock(shard.mutex);
+        shard.objects.erase(object);
+    }
+
     void ObjectTracer::dumpMemoryInfo() const
     {
         if (mIsEnabled)
         {
             printInfo("Dump memory leak =================================>\n");
 
+            struct TypeInfo
+            {
+                size_t  count;
+                size_t  bytes;
+            };
+
+            TMap<String, TypeInfo> types;
+            size_t totalLive = 0;
+            size_t totalBytes = 0;
+
             std::stringstream ss;
 
-            for (auto itr = mObjects.begin(); itr != mObjects.end(); ++itr)
+            // 逐个分片合并，每次只锁一个分片
+            for (const Shard &shard : mShards)
             {
-                Object *obj = *itr;
+                TAutoLock<TMutex> lock(shard.mutex);
+
+                for (auto itr = shard.objects.begin(); itr != shard.objects.end(); ++itr)
+                {
+                    Object *obj = itr->first;
+                    String name = typeid(*obj).name();
+
+                    TypeInfo &info = types[name];
+                    info.count++;
+                    info.bytes += itr->second;
+                    totalLive++;
+                    totalBytes += itr->second;
+
+                    ss.str("");
+                    ss << "Leak Object : " << name << " ReferCount : " << obj->referCount() << "\n";
+                    printInfo(ss.str());
+                }
+            }
 
+            // 按类型输出当前存活对象的数量和字节数
+            for (auto itr = types.begin(); itr != types.end(); ++itr)
+            {
                 ss.str("");
-                ss << "Leak Object : " << typeid(*obj).name() << " ReferCount : " << obj->referCount() << "\n";
+                ss << "Live Type : " << itr->first << " Count : " 
+                    << itr->second.count << " Bytes : " << itr->second.bytes << "\n";
                 printInfo(ss.str());
             }
 
             ss.str("");
-
-            ss << "Total leak objects " << mObjects.size();
+            ss << "Total leak objects " << totalLive << " Bytes : " << totalBytes
+                << ", traced objects " << mTotalObjects.load() 
+                << " Bytes : " << mTotalBytes.load() << "\n";
+            printInfo(ss.str());
         }
     }
 
@@ -38,4 +38,25 @@ namespace Tiny3D
     {
         return E_TYPE_ARCHIVE;
     }
+
+    TResult Archive::readMany(const TArray<String> &names, 
+        TArray<MemoryDataStream> &streams, size_t threads /* = 0 */)
+    {
+        TResult ret = T3D_ERR_OK;
+
+        streams.clear();
+        streams.resize(names.size());
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            TResult r = read(names[i], streams[i]);
+
+            if (r != T3D_ERR_OK && ret == T3D_ERR_OK)
+            {
+                ret = r;
+            }
+        }
+
+        return ret;
+    }
 }
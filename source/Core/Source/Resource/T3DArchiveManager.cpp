@@ -45,6 +45,7 @@ namespace Tiny3D
 
     ArchiveManager::~ArchiveManager()
     {
+        cancelAsyncLoads();
 
     }
 
@@ -64,6 +65,31 @@ namespace Tiny3D
         return archive;
     }
 
+    ResourceRequestPtr ArchiveManager::loadArchiveAsync(const String &name,
+        const String &archiveType, int32_t priority,
+        const ResourceRequest::Callback &callback)
+    {
+        // 回调在主线程，这时候再加到档案列表里
+        ResourceRequest::Callback onLoaded = 
+            [this, callback](ResourceRequest *request)
+        {
+            ArchivePtr archive 
+                = smart_pointer_cast<Archive>(request->getResource());
+
+            if (archive != nullptr)
+            {
+                mArchives.insert(ArchivesValue(request->getName(), archive));
+            }
+
+            if (callback)
+            {
+                callback(request);
+            }
+        };
+
+        return loadAsync(name, priority, onLoaded, 1, archiveType.c_str());
+    }
+
     void ArchiveManager::unloadArchive(ArchivePtr archive)
     {
         unload((ResourcePtr &)archive);
@@ -78,6 +104,8 @@ namespace Tiny3D
         {
             String archiveType = va_arg(args, char *);
 
+            // 创建器在插件里，创建完之前不能被移除
+            TAutoLock<TMutex> lock(mCreatorsMutex);
             CreatorsConstItr itr = mCreators.find(archiveType);
 
             if (itr != mCreators.end())
@@ -92,17 +120,23 @@ namespace Tiny3D
 
     void ArchiveManager::addArchiveCreator(ArchiveCreator *creator)
     {
+        TAutoLock<TMutex> lock(mCreatorsMutex);
         mCreators.insert(CreatorsValue(creator->getType(), creator));
     }
 
     void ArchiveManager::removeArchiveCreator(const String &name)
     {
+        TAutoLock<TMutex> lock(mCreatorsMutex);
         auto itr = mCreators.find(name);
-        mCreators.erase(itr);
+        if (itr != mCreators.end())
+        {
+            mCreators.erase(itr);
+        }
     }
 
     void ArchiveManager::removeAllArchiveCreator()
     {
+        TAutoLock<TMutex> lock(mCreatorsMutex);
         mCreators.clear();
     }
 
@@ -40,7 +40,7 @@ namespace Tiny3D
 
     DylibManager::~DylibManager()
     {
-
+        cancelAsyncLoads();
     }
 
     DylibPtr DylibManager::loadDylib(const String &name)
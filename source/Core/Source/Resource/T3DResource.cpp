@@ -24,9 +24,11 @@
 namespace Tiny3D
 {
     Resource::Resource(const String &strName)
-        : mSize(0)
+        : Object(E_REFER_THREAD_SAFE)
+        , mSize(0)
         , mIsLoaded(false)
         , mName(strName)
+        , mNameHash(StringUtil::hash(strName))
     {
 
     }
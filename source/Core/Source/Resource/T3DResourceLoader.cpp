@@ -0,0 +1,201 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "Resource/T3DResourceLoader.h"
+#include "Resource/T3DResourceManager.h"
+#include <functional>
+#include <algorithm>
+
+
+namespace Tiny3D
+{
+    ResourceLoader *ResourceLoader::msInstance = nullptr;
+    uint32_t ResourceLoader::msReferCount = 0;
+    TMutex ResourceLoader::msMutex;
+
+    //--------------------------------------------------------------------------
+
+    void ResourceLoader::acquire()
+    {
+        TAutoLock<TMutex> lock(msMutex);
+
+        if (msReferCount++ == 0)
+        {
+            msInstance = new ResourceLoader();
+        }
+    }
+
+    void ResourceLoader::release()
+    {
+        TAutoLock<TMutex> lock(msMutex);
+
+        T3D_ASSERT(msReferCount > 0);
+
+        if (--msReferCount == 0)
+        {
+            T3D_SAFE_DELETE(msInstance);
+        }
+    }
+
+    ResourceLoader &ResourceLoader::getInstance()
+    {
+        T3D_ASSERT(msInstance != nullptr);
+        return *msInstance;
+    }
+
+    //--------------------------------------------------------------------------
+
+    ResourceLoader::ResourceLoader()
+        : mSequence(0)
+        , mIsRunning(false)
+    {
+
+    }
+
+    ResourceLoader::~ResourceLoader()
+    {
+        // 设置线程退出，唤醒所有线程并等待结束
+        TAutoLock<TMutex> lock(mMutex);
+        mIsRunning = false;
+        lock.unlock();
+        mTaskCond.notify_all();
+
+        for (TThread &worker : mWorkers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void ResourceLoader::push(ResourceRequest *request, int32_t priority)
+    {
+        TAutoLock<TMutex> lock(mMutex);
+
+        if (mWorkers.empty())
+        {
+            // 第一次有请求才启动工作线程，留一个核给主线程
+            size_t count = TThread::hardware_concurrency();
+            count = (count > 1 ? count - 1 : 1);
+
+            mIsRunning = true;
+            mRunning.resize(count, nullptr);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                mWorkers.push_back(
+                    TThread(std::bind(&ResourceLoader::work, this, i)));
+            }
+        }
+
+        Task task = { priority, mSequence++, request };
+        mTasks.push_back(task);
+        std::push_heap(mTasks.begin(), mTasks.end());
+
+        lock.unlock();
+        mTaskCond.notify_one();
+    }
+
+    void ResourceLoader::complete(ResourceRequest *request)
+    {
+        TAutoLock<TMutex> lock(mMutex);
+        mCompleted.push_back(request);
+    }
+
+    void ResourceLoader::takeCompleted(Requests &requests)
+    {
+        TAutoLock<TMutex> lock(mMutex);
+        requests.splice(requests.end(), mCompleted);
+    }
+
+    void ResourceLoader::discard(ResourceManager *mgr)
+    {
+        TAutoLock<TMutex> lock(mMutex);
+
+        // 等这个资源管理器在工作线程上的请求都执行完
+        auto isRunning = [this, mgr]()
+        {
+            for (ResourceRequest *request : mRunning)
+            {
+                if (request != nullptr && request->mManager == mgr)
+                    return true;
+            }
+            return false;
+        };
+
+        while (isRunning())
+        {
+            mIdleCond.wait(lock);
+        }
+
+        // 结束了还没派发的请求不再派发
+        auto itr = mCompleted.begin();
+
+        while (itr != mCompleted.end())
+        {
+            if ((*itr)->mManager == mgr)
+            {
+                itr = mCompleted.erase(itr);
+            }
+            else
+            {
+                ++itr;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void ResourceLoader::work(size_t slot)
+    {
+        TAutoLock<TMutex> lock(mMutex);
+
+        while (mIsRunning)
+        {
+            if (mTasks.empty())
+            {
+                mTaskCond.wait(lock);
+                continue;
+            }
+
+            std::pop_heap(mTasks.begin(), mTasks.end());
+            ResourceRequestPtr request = mTasks.back().request;
+            mTasks.pop_back();
+
+            // 取消了的请求和提高优先级留下的旧任务都在这里跳过，
+            // 切换状态和登记正在执行在同一把锁里，资源管理器析构时能等到
+            if (!request->start())
+            {
+                continue;
+            }
+
+            mRunning[slot] = request;
+            lock.unlock();
+
+            request->mManager->runRequest(request);
+
+            lock.lock();
+            mRunning[slot] = nullptr;
+            mIdleCond.notify_all();
+        }
+    }
+}
@@ -0,0 +1,108 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_RESOURCE_LOADER_H__
+#define __T3D_RESOURCE_LOADER_H__
+
+
+#include "Resource/T3DResourceRequest.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 所有资源管理器共享的异步加载线程池
+     * @remarks 只在引擎内部使用。第一个资源管理器构造时创建，最后一个
+     *      资源管理器析构时销毁，工作线程在第一次有请求时才启动。
+     */
+    class ResourceLoader
+    {
+        T3D_DISABLE_COPY(ResourceLoader);
+
+    public:
+        typedef TList<ResourceRequestPtr>   Requests;
+
+        /** 资源管理器构造时调用，增加引用 */
+        static void acquire();
+
+        /** 资源管理器析构时调用，最后一个引用释放时销毁线程池 */
+        static void release();
+
+        /** 获取线程池，必须在 acquire() 和 release() 之间调用 */
+        static ResourceLoader &getInstance();
+
+        /** 把请求按优先级放进队列，提高优先级时也是再放一次 */
+        void push(ResourceRequest *request, int32_t priority);
+
+        /** 把结束的请求放进结束队列，等主线程派发 */
+        void complete(ResourceRequest *request);
+
+        /** 取出所有结束的请求 */
+        void takeCompleted(Requests &requests);
+
+        /** 
+         * @brief 等待资源管理器所有正在加载的请求结束，并丢弃它的结束请求
+         * @remarks 调用前要先取消资源管理器所有的请求
+         */
+        void discard(ResourceManager *mgr);
+
+    protected:
+        ResourceLoader();
+        ~ResourceLoader();
+
+        /** 工作线程函数 */
+        void work(size_t slot);
+
+        struct Task
+        {
+            int32_t             priority;   /**< 放进队列时的优先级 */
+            uint64_t            sequence;   /**< 放进队列的顺序，同优先级先进先出 */
+            ResourceRequestPtr  request;    /**< 请求 */
+
+            bool operator <(const Task &other) const
+            {
+                if (priority != other.priority)
+                    return priority < other.priority;
+                return sequence > other.sequence;
+            }
+        };
+
+        typedef TArray<Task>                TaskHeap;
+        typedef TArray<TThread>             Workers;
+        typedef TArray<ResourceRequest*>    RunningRequests;
+
+        TaskHeap        mTasks;         /**< 按优先级排序的大顶堆，取消的请求延迟清除 */
+        Requests        mCompleted;     /**< 结束了等主线程派发的请求 */
+        Workers         mWorkers;       /**< 工作线程 */
+        RunningRequests mRunning;       /**< 每个工作线程正在执行的请求 */
+        uint64_t        mSequence;      /**< 下一个任务的顺序号 */
+        bool            mIsRunning;     /**< 工作线程是否在运行 */
+
+        TMutex          mMutex;         /**< 队列和正在执行请求的互斥量 */
+        TCondVariable   mTaskCond;      /**< 有新任务或者退出时唤醒工作线程 */
+        TCondVariable   mIdleCond;      /**< 工作线程执行完一个请求时唤醒等待的线程 */
+
+        static ResourceLoader   *msInstance;    /**< 线程池对象 */
+        static uint32_t         msReferCount;   /**< 资源管理器数量 */
+        static TMutex           msMutex;        /**< 创建和销毁线程池的互斥量 */
+    };
+}
+
+
+#endif  /*__T3D_RESOURCE_LOADER_H__*/
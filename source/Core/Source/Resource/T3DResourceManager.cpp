@@ -19,19 +19,48 @@
 
 
 #include "Resource/T3DResourceManager.h"
+#include "Resource/T3DResourceLoader.h"
 
 
 namespace Tiny3D
 {
+    const EventID ResourceManager::EV_RESOURCE_LOADED = 1;
+
+    ResourceManager::Managers ResourceManager::msManagers;
+    TMutex ResourceManager::msManagersMutex;
+
+    //--------------------------------------------------------------------------
+
+    T3D_BEGIN_EVENT_MAP(ResourceManager, EventHandler)
+        T3D_ON_EVENT(EV_RESOURCE_LOADED, onResourceLoaded)
+    T3D_END_EVENT_MAP()
+
+    //--------------------------------------------------------------------------
+
     ResourceManager::ResourceManager()
         : mCloneID(T3D_INVALID_ID)
+        , mMemoryBudget(0)
+        , mBytesResident(0)
+        , mResidentCount(0)
+        , mClockHand(0)
+        , mHits(0)
+        , mMisses(0)
+        , mEvictions(0)
     {
+        ResourceLoader::acquire();
 
+        TAutoLock<TMutex> lockM(msManagersMutex);
+        msManagers.push_back(this);
     }
 
     ResourceManager::~ResourceManager()
     {
+        TAutoLock<TMutex> lockM(msManagersMutex);
+        msManagers.remove(this);
+        lockM.unlock();
 
+        cancelAsyncLoads();
+        ResourceLoader::release();
     }
 
     ID ResourceManager::toID(const String &name)
@@ -54,49 +83,48 @@ namespace Tiny3D
     ResourcePtr ResourceManager::load(const String &name, int32_t argc, ...)
     {
         ResourcePtr res = nullptr;
+        ResourceRequestPtr request = nullptr;
+        uint64_t nameHash = StringUtil::hash(name);
 
         // First, search cache
-        auto itr = mResourcesCache.find(name);
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        res = findCached(nameHash, name);
 
-        if (itr != mResourcesCache.end())
+        if (res != nullptr)
+        {
+            mHits++;
+        }
+        else
         {
-            // Found it in cache.
-            Resources &resources = itr->second;
+            mMisses++;
+
+            ResourceRequestPtr *pending = mRequests.find(nameHash, name);
 
-            if (resources.size() > 0)
+            if (pending != nullptr)
             {
-                auto i = resources.find(0);
+                request = *pending;
+            }
+        }
 
-                if (i != resources.end())
-                {
-                    // Found in original resource list
-                    res = i->second;
-                }
-                else
-                {
-                    // Found not in original resource list
-                    va_list params;
-                    va_start(params, argc);
-                    res = create(name, argc, params);
-                    va_end(params);
+        lockC.unlock();
 
-                    if (res != nullptr)
-                    {
-                        bool ret = res->load();
-
-                        if (ret)
-                        {
-                            resources.insert(ResourcesValue(0, res));
-                        }
-                        else
-                        {
-                            res = nullptr;
-                        }
-                    }
-                }
+        if (request != nullptr)
+        {
+            // It is loading asynchronously. Load it here if it is still 
+            // queued, otherwise wait for the worker thread.
+            if (request->start())
+            {
+                runRequest(request);
+            }
+            else
+            {
+                request->wait();
             }
+
+            res = request->getResource();
         }
-        else
+
+        if (res == nullptr)
         {
             // Found not, it should create a new instance.
             va_list params;
@@ -110,9 +138,9 @@ namespace Tiny3D
 
                 if (ret == T3D_ERR_OK)
                 {
-                    Resources resources;
-                    resources.insert(ResourcesValue(0, res));
-                    mResourcesCache.insert(ResourcesMapValue(name, resources));
+                    lockC.lock();
+                    res = addCached(res);
+                    lockC.unlock();
                 }
                 else
                 {
@@ -124,6 +152,277 @@ namespace Tiny3D
         return res;
     }
 
+    ResourceRequestPtr ResourceManager::loadAsync(const String &name, 
+        int32_t priority, const ResourceRequest::Callback &callback,
+        int32_t argc, ...)
+    {
+        T3D_ASSERT(argc >= 0 && argc <= MAX_ASYNC_ARGS);
+
+        ResourceRequestPtr request = nullptr;
+        bool queued = false;
+        bool finished = false;
+        uint64_t nameHash = StringUtil::hash(name);
+
+        TAutoLock<TMutex> lockC(mCacheMutex);
+
+        ResourceRequestPtr *pending = mRequests.find(nameHash, name);
+
+        if (pending != nullptr)
+        {
+            // Same resource is loading, share the request.
+            request = *pending;
+            mMisses++;
+
+            TAutoLock<TMutex> lockR(request->mMutex);
+
+            if (callback)
+            {
+                request->mCallbacks.push_back(callback);
+            }
+
+            if (priority > request->mPriority 
+                && ResourceRequest::E_STATE_PENDING == request->mState)
+            {
+                request->mPriority = priority;
+                queued = true;
+            }
+        }
+        else
+        {
+            request = new ResourceRequest(this, name, priority);
+            request->release();
+
+            if (callback)
+            {
+                request->mCallbacks.push_back(callback);
+            }
+
+            ResourcePtr res = findCached(nameHash, name);
+
+            if (res != nullptr)
+            {
+                // Found it in cache.
+                mHits++;
+                TAutoLock<TMutex> lockR(request->mMutex);
+                request->finish(ResourceRequest::E_STATE_LOADED, res);
+                finished = true;
+            }
+            else
+            {
+                // The arguments are copied for the worker thread.
+                mMisses++;
+                va_list params;
+                va_start(params, argc);
+                for (int32_t i = 0; i < argc; ++i)
+                {
+                    const char *arg = va_arg(params, const char *);
+                    request->mArgs.push_back(arg != nullptr ? arg : "");
+                }
+                va_end(params);
+
+                bool inserted = false;
+                mRequests.insert(nameHash, name, inserted) = request;
+                queued = true;
+            }
+        }
+
+        lockC.unlock();
+
+        if (queued)
+        {
+            ResourceLoader::getInstance().push(request, priority);
+        }
+        else if (finished)
+        {
+            ResourceLoader::getInstance().complete(request);
+        }
+
+        return request;
+    }
+
+    void ResourceManager::cancelAsyncLoads()
+    {
+        TList<ResourceRequestPtr> requests;
+
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        mRequests.forEach(
+            [&requests](const String &name, ResourceRequestPtr &request)
+        {
+            requests.push_back(request);
+        });
+        lockC.unlock();
+
+        for (ResourceRequestPtr &request : requests)
+        {
+            request->cancel();
+        }
+
+        ResourceLoader::getInstance().discard(this);
+    }
+
+    void ResourceManager::dispatchAsyncLoads()
+    {
+        ResourceLoader::Requests requests;
+        ResourceLoader::getInstance().takeCompleted(requests);
+
+        for (ResourceRequestPtr &request : requests)
+        {
+            ResourceManager *mgr = request->mManager;
+            ResourceLoadedParam param(request);
+            TResult ret = mgr->postEvent(EV_RESOURCE_LOADED, &param, 
+                mgr->getInstance());
+
+            if (ret != T3D_ERR_OK)
+            {
+                // Could not post it, call back directly.
+                mgr->onResourceLoaded(&param, mgr->getInstance());
+            }
+        }
+    }
+
+    TResult ResourceManager::onResourceLoaded(EventParam *param, 
+        TINSTANCE sender)
+    {
+        ResourceRequest *request = ((ResourceLoadedParam *)param)->Request;
+
+        ResourceRequest::Callbacks callbacks;
+        TAutoLock<TMutex> lockR(request->mMutex);
+        callbacks.swap(request->mCallbacks);
+        lockR.unlock();
+
+        for (const ResourceRequest::Callback &callback : callbacks)
+        {
+            callback(request);
+        }
+
+        return T3D_ERR_OK;
+    }
+
+    void ResourceManager::runRequest(ResourceRequest *request)
+    {
+        ResourcePtr res = createWithArgs(request->mName, request->mArgs);
+
+        if (res != nullptr && res->load() != T3D_ERR_OK)
+        {
+            res = nullptr;
+        }
+
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        TAutoLock<TMutex> lockR(request->mMutex);
+
+        if (request->mCanceled)
+        {
+            // Canceled while loading, drop it.
+            if (res != nullptr)
+            {
+                res->unload();
+            }
+
+            request->finish(ResourceRequest::E_STATE_CANCELED, nullptr);
+        }
+        else
+        {
+            if (res != nullptr)
+            {
+                res = addCached(res);
+                request->finish(ResourceRequest::E_STATE_LOADED, res);
+            }
+            else
+            {
+                request->finish(ResourceRequest::E_STATE_FAILED, nullptr);
+            }
+
+            ResourceRequestPtr *pending 
+                = mRequests.find(request->mNameHash, request->mName);
+            if (pending != nullptr && *pending == request)
+            {
+                mRequests.erase(request->mNameHash, request->mName);
+            }
+        }
+
+        // Unlock the manager first. The thread waiting for this request may
+        // destroy the manager once it wakes up.
+        lockC.unlock();
+        lockR.unlock();
+
+        ResourceLoader::getInstance().complete(request);
+    }
+
+    ResourcePtr ResourceManager::createWithArgs(const String &name, 
+        const TArray<String> &args)
+    {
+        ResourcePtr res = nullptr;
+
+        switch (args.size())
+        {
+        case 0:
+            res = invokeCreate(name, 0);
+            break;
+        case 1:
+            res = invokeCreate(name, 1, args[0].c_str());
+            break;
+        case 2:
+            res = invokeCreate(name, 2, args[0].c_str(), args[1].c_str());
+            break;
+        case 3:
+            res = invokeCreate(name, 3, args[0].c_str(), args[1].c_str(),
+                args[2].c_str());
+            break;
+        case 4:
+            res = invokeCreate(name, 4, args[0].c_str(), args[1].c_str(),
+                args[2].c_str(), args[3].c_str());
+            break;
+        default:
+            T3D_ASSERT(0);
+            break;
+        }
+
+        return res;
+    }
+
+    ResourcePtr ResourceManager::invokeCreate(const String &name, 
+        int32_t argc, ...)
+    {
+        va_list params;
+        va_start(params, argc);
+        ResourcePtr res = create(name, argc, params);
+        va_end(params);
+        return res;
+    }
+
+    ResourcePtr ResourceManager::findCached(uint64_t nameHash, 
+        const String &name) const
+    {
+        const CacheEntry *entry = mResourcesCache.find(nameHash, name);
+
+        if (entry != nullptr && entry->original != nullptr)
+        {
+            entry->referenced = true;
+            return entry->original;
+        }
+
+        return nullptr;
+    }
+
+    ResourcePtr ResourceManager::addCached(const ResourcePtr &res)
+    {
+        bool inserted = false;
+        CacheEntry &entry = mResourcesCache.insert(res->getNameHash(), 
+            res->getName(), inserted);
+
+        if (entry.original == nullptr)
+        {
+            entry.original = res;
+            mBytesResident += res->getSize();
+            mResidentCount++;
+        }
+
+        entry.referenced = true;
+
+        // Use the existing one if another thread has cached it first.
+        return entry.original;
+    }
+
     void ResourceManager::unload(ResourcePtr &res)
     {
         if (res != nullptr && res->referCount() > 1)
@@ -131,25 +430,36 @@ namespace Tiny3D
             Resource *r = res;
             res = nullptr;
 
+            TAutoLock<TMutex> lockC(mCacheMutex);
+
             if (r->referCount() == 1)
             {
                 // Only one instance is used. It should be deleted.
-                auto itr = mResourcesCache.find(r->getName());
+                // Keep the name, r is freed once the cache drops it.
+                uint64_t nameHash = r->getNameHash();
+                String name = r->getName();
+                CacheEntry *entry = mResourcesCache.find(nameHash, name);
 
-                if (itr != mResourcesCache.end())
+                if (entry != nullptr)
                 {
                     // The resource is valid and in the cache.
-                    Resources &resources = itr->second;
+                    mBytesResident -= r->getSize();
+                    mResidentCount--;
 
                     if (r->isCloned())
                     {
                         // erase cloning resource
-                        resources.erase(r->getCloneID());
+                        entry->clones.erase(r->getCloneID());
                     }
                     else
                     {
                         // erase original resource
-                        resources.erase(0);
+                        entry->original = nullptr;
+                    }
+
+                    if (entry->original == nullptr && entry->clones.empty())
+                    {
+                        mResourcesCache.erase(nameHash, name);
                     }
                 }
             }
@@ -162,21 +472,20 @@ namespace Tiny3D
 
     void ResourceManager::unloadUnused()
     {
-        auto itr = mResourcesCache.begin();
+        TAutoLock<TMutex> lockC(mCacheMutex);
 
-        while (itr != mResourcesCache.end())
+        mResourcesCache.eraseIf([this](const String &name, CacheEntry &entry)
         {
-            Resources &resources = itr->second;
+            auto i = entry.clones.begin();
 
-            auto i = resources.begin();
-
-            while (i != resources.end())
+            while (i != entry.clones.end())
             {
-                ResourcePtr &res = i->second;
-
-                if (res->referCount() == 1)
+                if (i->second->referCount() == 1)
                 {
-                    resources.erase(i++);
+                    mBytesResident -= i->second->getSize();
+                    mResidentCount--;
+                    mEvictions++;
+                    entry.clones.erase(i++);
                 }
                 else
                 {
@@ -184,20 +493,206 @@ namespace Tiny3D
                 }
             }
 
-            if (resources.empty())
+            if (entry.original != nullptr 
+                && entry.original->referCount() == 1)
+            {
+                mBytesResident -= entry.original->getSize();
+                mResidentCount--;
+                mEvictions++;
+                entry.original = nullptr;
+            }
+
+            return (entry.original == nullptr && entry.clones.empty());
+        });
+    }
+
+    void ResourceManager::setMemoryBudget(size_t budget)
+    {
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        mMemoryBudget = budget;
+    }
+
+    size_t ResourceManager::getMemoryBudget() const
+    {
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        return mMemoryBudget;
+    }
+
+    bool ResourceManager::isUnused(const CacheEntry &entry)
+    {
+        if (entry.original != nullptr && entry.original->referCount() > 1)
+        {
+            return false;
+        }
+
+        for (const ResourcesValue &value : entry.clones)
+        {
+            if (value.second->referCount() > 1)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t ResourceManager::evict(int64_t timeSlice)
+    {
+        // Check the clock every so many slots, reading it costs more than
+        // looking at a slot.
+        const size_t CHECK_INTERVAL = 32;
+
+        size_t count = 0;
+        int64_t deadline = Clock::currentNanoseconds() + timeSlice;
+
+        // The evicted resources are released after unlocking, destroying 
+        // them may take a while.
+        TList<ResourcePtr> evicted;
+
+        TAutoLock<TMutex> lockC(mCacheMutex);
+
+        // All referenced bits are cleared in the first round, so there is
+        // nothing left to evict after two rounds.
+        size_t steps = 0;
+        size_t maxSteps = mResourcesCache.capacity() * 2;
+
+        while (mMemoryBudget > 0 && mBytesResident > mMemoryBudget 
+            && steps < maxSteps)
+        {
+            if (timeSlice > 0 && steps > 0 && steps % CHECK_INTERVAL == 0
+                && Clock::currentNanoseconds() >= deadline)
+            {
+                break;
+            }
+
+            steps++;
+
+            if (mClockHand >= mResourcesCache.capacity())
+            {
+                mClockHand = 0;
+            }
+
+            if (!mResourcesCache.isOccupied(mClockHand))
             {
-                mResourcesCache.erase(itr++);
+                mClockHand++;
+                continue;
+            }
+
+            CacheEntry &entry = mResourcesCache.valueAt(mClockHand);
+
+            if (!isUnused(entry))
+            {
+                mClockHand++;
+            }
+            else if (entry.referenced)
+            {
+                // Give it a second chance.
+                entry.referenced = false;
+                mClockHand++;
             }
             else
             {
-                ++itr;
+                if (entry.original != nullptr)
+                {
+                    mBytesResident -= entry.original->getSize();
+                    evicted.push_back(entry.original);
+                }
+
+                for (const ResourcesValue &value : entry.clones)
+                {
+                    mBytesResident -= value.second->getSize();
+                    evicted.push_back(value.second);
+                }
+
+                count += (entry.original != nullptr ? 1 : 0) 
+                    + entry.clones.size();
+
+                // The next slot may be moved here, so do not advance.
+                mResourcesCache.eraseAt(mClockHand);
+            }
+        }
+
+        mResidentCount -= count;
+        mEvictions += count;
+
+        lockC.unlock();
+
+        return count;
+    }
+
+    ResourceManager::Stats ResourceManager::getStats() const
+    {
+        Stats stats;
+
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        stats.bytesResident = mBytesResident;
+        stats.resources = mResidentCount;
+        stats.budget = mMemoryBudget;
+        stats.hits = mHits;
+        stats.misses = mMisses;
+        stats.evictions = mEvictions;
+
+        return stats;
+    }
+
+    void ResourceManager::resetStats()
+    {
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        mHits = 0;
+        mMisses = 0;
+        mEvictions = 0;
+    }
+
+    void ResourceManager::evictAll(int64_t timeSlice)
+    {
+        int64_t start = Clock::currentNanoseconds();
+
+        TAutoLock<TMutex> lockM(msManagersMutex);
+
+        for (ResourceManager *mgr : msManagers)
+        {
+            if (timeSlice <= 0)
+            {
+                mgr->evict(0);
+                continue;
+            }
+
+            int64_t remain = timeSlice - (Clock::currentNanoseconds() - start);
+
+            if (remain <= 0)
+            {
+                break;
             }
+
+            mgr->evict(remain);
+        }
+    }
+
+    void ResourceManager::unloadAllUnused()
+    {
+        TAutoLock<TMutex> lockM(msManagersMutex);
+
+        for (ResourceManager *mgr : msManagers)
+        {
+            mgr->unloadUnused();
+        }
+    }
+
+    void ResourceManager::cancelAllAsyncLoads()
+    {
+        TAutoLock<TMutex> lockM(msManagersMutex);
+
+        for (ResourceManager *mgr : msManagers)
+        {
+            mgr->cancelAsyncLoads();
         }
     }
 
     ResourcePtr ResourceManager::clone(const ResourcePtr &src)
     {
+        TAutoLock<TMutex> lockC(mCacheMutex);
         uint32_t unCloneID = (++mCloneID);
+        lockC.unlock();
 
         ResourcePtr res = src->clone();
 
@@ -205,12 +700,16 @@ namespace Tiny3D
         {
             res->mCloneID = unCloneID;
 
-            auto i = mResourcesCache.find(src->getName());
+            lockC.lock();
+            CacheEntry *entry 
+                = mResourcesCache.find(src->getNameHash(), src->getName());
 
-            if (i != mResourcesCache.end())
+            if (entry != nullptr)
             {
-                Resources &resources = i->second;
-                resources.insert(ResourcesValue(unCloneID, res));
+                entry->clones.insert(ResourcesValue(unCloneID, res));
+                entry->referenced = true;
+                mBytesResident += res->getSize();
+                mResidentCount++;
             }
             else
             {
@@ -221,21 +720,36 @@ namespace Tiny3D
         return res;
     }
 
-    ResourcePtr ResourceManager::getResource(const String &name, uint32_t cloneID /* = 0 */) const
+    ResourcePtr ResourceManager::getResource(const String &name, 
+        ID cloneID /* = 0 */) const
+    {
+        return getResource(StringUtil::hash(name), name, cloneID);
+    }
+
+    ResourcePtr ResourceManager::getResource(uint64_t nameHash, 
+        const String &name, ID cloneID /* = 0 */) const
     {
         ResourcePtr res = nullptr;
 
-        auto i = mResourcesCache.find(name);
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        const CacheEntry *entry = mResourcesCache.find(nameHash, name);
 
-        if (i != mResourcesCache.end())
+        if (entry != nullptr)
         {
-            const Resources &resources = i->second;
+            entry->referenced = true;
 
-            auto itr = resources.find(cloneID);
-
-            if (itr != resources.end())
+            if (cloneID == 0)
+            {
+                res = entry->original;
+            }
+            else
             {
-                res = itr->second;
+                auto itr = entry->clones.find(cloneID);
+
+                if (itr != entry->clones.end())
+                {
+                    res = itr->second;
+                }
             }
         }
 
@@ -245,15 +759,20 @@ namespace Tiny3D
     bool ResourceManager::getResources(const String &name, TList<ResourcePtr> &rList) const
     {
         bool bRet = false;
-        auto i = mResourcesCache.find(name);
+        TAutoLock<TMutex> lockC(mCacheMutex);
+        const CacheEntry *entry 
+            = mResourcesCache.find(StringUtil::hash(name), name);
 
-        if (i != mResourcesCache.end())
+        if (entry != nullptr)
         {
-            const Resources &resources = i->second;
+            if (entry->original != nullptr)
+            {
+                rList.push_back(entry->original);
+            }
 
-            auto itr = resources.begin();
+            auto itr = entry->clones.begin();
 
-            while (itr != resources.end())
+            while (itr != entry->clones.end())
             {
                 rList.push_back(itr->second);
                 ++itr;
@@ -265,4 +784,3 @@ namespace Tiny3D
         return bRet;
     }
 }
-
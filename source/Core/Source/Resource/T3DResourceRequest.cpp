@@ -0,0 +1,155 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "Resource/T3DResourceRequest.h"
+#include "Resource/T3DResourceManager.h"
+#include "Resource/T3DResourceLoader.h"
+
+
+namespace Tiny3D
+{
+    ResourceRequest::ResourceRequest(ResourceManager *mgr, const String &name,
+        int32_t priority)
+        : Object(E_REFER_THREAD_SAFE)
+        , mManager(mgr)
+        , mName(name)
+        , mNameHash(StringUtil::hash(name))
+        , mResource(nullptr)
+        , mPriority(priority)
+        , mState(E_STATE_PENDING)
+        , mCanceled(false)
+    {
+
+    }
+
+    ResourceRequest::~ResourceRequest()
+    {
+
+    }
+
+    int32_t ResourceRequest::getPriority() const
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+        return mPriority;
+    }
+
+    ResourceRequest::State ResourceRequest::getState() const
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+        return mState;
+    }
+
+    bool ResourceRequest::isDone() const
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+        return (mState >= E_STATE_LOADED);
+    }
+
+    ResourcePtr ResourceRequest::getResource() const
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+        return mResource;
+    }
+
+    bool ResourceRequest::cancel()
+    {
+        // 先检查是否已经结束，结束了的请求它的管理器可能已经析构了
+        TAutoLock<TMutex> lockR(mMutex);
+        if (mState >= E_STATE_LOADED || mCanceled)
+        {
+            return false;
+        }
+        lockR.unlock();
+
+        // 锁的顺序是先资源管理器再请求，和加载线程一致
+        ResourceManager *mgr = mManager;
+        TAutoLock<TMutex> lockC(mgr->mCacheMutex);
+        lockR.lock();
+
+        bool ret = false;
+        bool finished = false;
+
+        if (E_STATE_PENDING == mState)
+        {
+            // 还在队列里，直接结束，队列里的任务取出来时会跳过
+            finish(E_STATE_CANCELED, nullptr);
+            finished = true;
+            ret = true;
+        }
+        else if (E_STATE_LOADING == mState && !mCanceled)
+        {
+            // 正在加载，加载线程结束时丢弃结果
+            mCanceled = true;
+            ret = true;
+        }
+
+        if (ret)
+        {
+            // 从去重表里拿掉，后面同名的请求重新加载
+            ResourceRequestPtr *pending = mgr->mRequests.find(mNameHash, mName);
+            if (pending != nullptr && *pending == this)
+            {
+                mgr->mRequests.erase(mNameHash, mName);
+            }
+        }
+
+        lockR.unlock();
+        lockC.unlock();
+
+        if (finished)
+        {
+            ResourceLoader::getInstance().complete(this);
+        }
+
+        return ret;
+    }
+
+    ResourceRequest::State ResourceRequest::wait() const
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+
+        while (mState < E_STATE_LOADED)
+        {
+            mDoneCond.wait(lockR);
+        }
+
+        return mState;
+    }
+
+    bool ResourceRequest::start()
+    {
+        TAutoLock<TMutex> lockR(mMutex);
+
+        if (E_STATE_PENDING != mState)
+        {
+            return false;
+        }
+
+        mState = E_STATE_LOADING;
+        return true;
+    }
+
+    void ResourceRequest::finish(State state, const ResourcePtr &res)
+    {
+        T3D_ASSERT(state >= E_STATE_LOADED);
+        mState = state;
+        mResource = res;
+        mDoneCond.notify_all();
+    }
+}
@@ -22,6 +22,7 @@
 
 
 #include "T3DEventPrerequisites.h"
+#include "T3DEventQueue.h"
 
 
 namespace Tiny3D
@@ -36,6 +37,13 @@ namespace Tiny3D
         /** 事件项 */
         struct EventItem
         {
+            EventItem()
+                : mEventID(0)
+                , mEventParam(nullptr)
+                , mReceiver(nullptr)
+                , mSender(nullptr)
+            {}
+
             EventItem(EventID evid, EventParam *param,
                 TINSTANCE receiver, TINSTANCE sender)
                 : mEventID(evid)
@@ -300,9 +308,7 @@ namespace Tiny3D
         typedef HandlerList::iterator       HandlerListItr;
         typedef HandlerList::const_iterator HandlerListConstItr;
 
-        typedef TList<EventItem>            EventList;
-        typedef EventList::iterator         EventListItr;
-        typedef EventList::const_iterator   EventListConstItr;
+        typedef TEventQueue<EventItem>      EventList;
 
         typedef TSet<TINSTANCE>             EventInstSet;
         typedef EventInstSet::iterator      EventInstSetItr;
@@ -318,7 +324,7 @@ namespace Tiny3D
 
         int32_t         mCurrentQueue;              /// 当前待处理事件队列
         uint32_t        mMaxHandlingDuration;       /// 处理事件持续最大时间
-        int64_t         mStartHandleTime;           /// 开始处理事件时间
+        int64_t         mStartHandleTime;           /// 开始处理事件时间，单调时钟纳秒数
         uint32_t        mMaxCallStackLevel;         /// 处理事件嵌套调用栈层级
         int32_t         mCurrentCallStack;          /// 当前栈深度
 
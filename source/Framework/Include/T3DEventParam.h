@@ -37,6 +37,18 @@ namespace Tiny3D
          *      事件派发时候能保存一个深拷贝的副本
          */
         virtual EventParam *clone() = 0;
+
+        /**
+         * @brief 事件参数都从 PoolAllocator 按大小分级的内存池分配
+         * @remarks 异步事件每次都要 clone() 一份参数，派发完马上释放，
+         *      内存块会被反复使用，稳定后不再向系统申请内存
+         */
+        static void *operator new(size_t size);
+
+        /**
+         * @brief 带大小的释放，虚析构保证传进来的是实际类型的大小
+         */
+        static void operator delete(void *ptr, size_t size);
     };
 }
 
@@ -0,0 +1,130 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_EVENT_QUEUE_H__
+#define __T3D_EVENT_QUEUE_H__
+
+
+#include "T3DEventPrerequisites.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 连续内存的环形队列，用来存放待派发的事件
+     * @remarks 容量是 2 的幂，放满了才翻倍扩容，稳定后入队出队都不会分配内存。
+     *      元素类型需要能默认构造和拷贝。
+     */
+    template <typename T>
+    class TEventQueue
+    {
+    public:
+        TEventQueue(size_t capacity = 64)
+            : mHead(0)
+            , mSize(0)
+        {
+            size_t cap = 1;
+            while (cap < capacity)
+            {
+                cap <<= 1;
+            }
+
+            mItems.resize(cap);
+        }
+
+        bool empty() const      { return mSize == 0; }
+
+        size_t size() const     { return mSize; }
+
+        /**
+         * @brief 获取从队头开始的第 i 个元素
+         */
+        T &operator [](size_t i)
+        {
+            return mItems[(mHead + i) & (mItems.size() - 1)];
+        }
+
+        const T &operator [](size_t i) const
+        {
+            return mItems[(mHead + i) & (mItems.size() - 1)];
+        }
+
+        T &front()              { return mItems[mHead]; }
+
+        void push_back(const T &item)
+        {
+            if (mSize == mItems.size())
+            {
+                grow();
+            }
+
+            mItems[(mHead + mSize) & (mItems.size() - 1)] = item;
+            ++mSize;
+        }
+
+        void push_front(const T &item)
+        {
+            if (mSize == mItems.size())
+            {
+                grow();
+            }
+
+            mHead = (mHead + mItems.size() - 1) & (mItems.size() - 1);
+            mItems[mHead] = item;
+            ++mSize;
+        }
+
+        void pop_front()
+        {
+            mHead = (mHead + 1) & (mItems.size() - 1);
+            --mSize;
+        }
+
+        /**
+         * @brief 清空队列，保留已经分配的内存
+         */
+        void clear()
+        {
+            mHead = 0;
+            mSize = 0;
+        }
+
+    protected:
+        /// 容量翻倍，把元素按顺序挪到新数组的开头
+        void grow()
+        {
+            TArray<T> items(mItems.size() * 2);
+
+            for (size_t i = 0; i < mSize; ++i)
+            {
+                items[i] = (*this)[i];
+            }
+
+            mItems.swap(items);
+            mHead = 0;
+        }
+
+        TArray<T>   mItems;     /// 元素数组
+        size_t      mHead;      /// 队头下标
+        size_t      mSize;      /// 元素数量
+    };
+}
+
+
+#endif  /*__T3D_EVENT_QUEUE_H__*/
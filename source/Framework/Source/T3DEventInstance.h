@@ -37,6 +37,17 @@ namespace Tiny3D
             , slot(i)
         {}
 
+        /// 和 Object 一样从 PoolAllocator 分配
+        static void *operator new(size_t size)
+        {
+            return T3D_POOL_ALLOCATOR.allocate(size);
+        }
+
+        static void operator delete(void *ptr, size_t size)
+        {
+            T3D_POOL_ALLOCATOR.deallocate(ptr, size);
+        }
+
         void    *obj;
         int32_t slot;
     };
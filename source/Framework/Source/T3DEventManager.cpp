@@ -121,10 +121,15 @@ namespace Tiny3D
 
             while (itr != mEventHandlers.end())
             {
-                TINSTANCE receiver = (*itr)->getInstance();
-                EventItem item(evid, param->clone(), receiver, sender);
-                mEventCache.push_back(item);
-                ret = T3D_ERR_FWK_SUSPENDED;
+                // 句柄表里有未使用的空槽，跳过
+                if (*itr != nullptr)
+                {
+                    TINSTANCE receiver = (*itr)->getInstance();
+                    EventItem item(evid, param->clone(), receiver, sender);
+                    mEventCache.push_back(item);
+                    ret = T3D_ERR_FWK_SUSPENDED;
+                }
+
                 ++itr;
             }
         }
@@ -147,9 +152,14 @@ namespace Tiny3D
                 while (itr != mEventHandlers.end())
                 {
                     EventHandler *handler = *itr;
-                    // 没有暂停，那全部给派发吧
-                    handler->processEvent(evid, param, sender);
-                    ret = T3D_ERR_OK;
+
+                    if (handler != nullptr)
+                    {
+                        // 没有暂停，那全部给派发吧
+                        handler->processEvent(evid, param, sender);
+                        ret = T3D_ERR_OK;
+                    }
+
                     ++itr;
                 }
             } while (0);
@@ -324,10 +334,15 @@ namespace Tiny3D
             while (itr != mEventHandlers.end())
             {
                 EventHandler *handler = *itr;
-                EventParam *para = param->clone();
-                EventItem item(evid, para, handler->getInstance(), sender);
-                mEventCache.push_back(item);
-                ret = T3D_ERR_FWK_SUSPENDED;
+
+                if (handler != nullptr)
+                {
+                    EventParam *para = param->clone();
+                    EventItem item(evid, para, handler->getInstance(), sender);
+                    mEventCache.push_back(item);
+                    ret = T3D_ERR_FWK_SUSPENDED;
+                }
+
                 ++itr;
             }
         }
@@ -338,10 +353,15 @@ namespace Tiny3D
             while (itr != mEventHandlers.end())
             {
                 EventHandler *handler = *itr;
-                EventParam *para = param->clone();
-                EventItem item(evid, para, handler->getInstance(), sender);
-                mEventQueue[mCurrentQueue].push_back(item);
-                ret = T3D_ERR_OK;
+
+                if (handler != nullptr)
+                {
+                    EventParam *para = param->clone();
+                    EventItem item(evid, para, handler->getInstance(), sender);
+                    mEventQueue[mCurrentQueue].push_back(item);
+                    ret = T3D_ERR_OK;
+                }
+
                 ++itr;
             }
         }
@@ -476,6 +496,8 @@ namespace Tiny3D
             if (mEventQueue[index].empty())
                 break;
 
+            mStartHandleTime = Clock::currentNanoseconds();
+
             while (!mEventQueue[index].empty())
             {
                 const EventItem &item = mEventQueue[index].front();
@@ -521,10 +543,11 @@ namespace Tiny3D
         if (dispatchImmdiately)
         {
             // 马上派发缓存中的所有事件
-            auto itr = mEventCache.begin();
-
-            while (itr != mEventCache.end())
+            while (!mEventCache.empty())
             {
+                EventItem item = mEventCache.front();
+                mEventCache.pop_front();
+
                 mCurrentCallStack++;
 
                 if (mCurrentCallStack > mMaxCallStackLevel)
@@ -537,31 +560,24 @@ namespace Tiny3D
                 {
                     EventHandler *handler = nullptr;
 
-                    if (getEventHandler(itr->mReceiver, handler))
+                    if (getEventHandler(item.mReceiver, handler))
                     {
-                        handler->processEvent(itr->mEventID, itr->mEventParam,
-                            itr->mSender);
+                        handler->processEvent(item.mEventID, item.mEventParam,
+                            item.mSender);
                     }
 
                     mCurrentCallStack--;
                 }
 
-                delete itr->mEventParam;
-                ++itr;
+                delete item.mEventParam;
             }
-
-            mEventCache.clear();
         }
         else
         {
             // 不马上派发，重新放回事件队列里
-            auto itr = mEventCache.begin();
-
-            while (itr != mEventCache.end())
+            for (size_t i = 0; i < mEventCache.size(); ++i)
             {
-                const EventItem &item = *itr;
-                mEventQueue[mCurrentQueue].push_back(item);
-                ++itr;
+                mEventQueue[mCurrentQueue].push_back(mEventCache[i]);
             }
 
             mEventCache.clear();
@@ -691,15 +707,14 @@ namespace Tiny3D
 
         for (i = 0; i < MAX_EVENT_QUEUE; ++i)
         {
-            EventListItr itr = mEventQueue[i].begin();
-            while (itr != mEventQueue[i].end())
+            EventList &queue = mEventQueue[i];
+
+            for (size_t j = 0; j < queue.size(); ++j)
             {
-                EventItem &item = *itr;
-                delete item.mEventParam;
-                ++itr;
+                delete queue[j].mEventParam;
             }
 
-            mEventQueue[i].clear();
+            queue.clear();
         }
     }
 }
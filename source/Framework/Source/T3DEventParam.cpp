@@ -18,3 +18,17 @@
  ******************************************************************************/
 
 #include "T3DEventParam.h"
+
+
+namespace Tiny3D
+{
+    void *EventParam::operator new(size_t size)
+    {
+        return T3D_POOL_ALLOCATOR.allocate(size);
+    }
+
+    void EventParam::operator delete(void *ptr, size_t size)
+    {
+        T3D_POOL_ALLOCATOR.deallocate(ptr, size);
+    }
+}
@@ -26,6 +26,9 @@
 
 #define __T3D_OPEN_LOG__
 
+/// 打开后日志只在调用线程打包参数，格式化放到日志异步线程
+#define __T3D_LOG_DEFERRED_FORMAT__
+
 
 #if defined (__T3D_OPEN_LOG__)
 
@@ -85,11 +88,19 @@
              T3D_LOGGER.enterForeground();   \
          }
 
+#if defined (__T3D_LOG_DEFERRED_FORMAT__)
+    #define T3D_LOG_TRACE(level, fmt, ...)  \
+         if (Tiny3D::Logger::getInstancePtr() != nullptr)    \
+         {   \
+             T3D_LOGGER.traceDeferred(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);    \
+         }
+#else
     #define T3D_LOG_TRACE(level, fmt, ...)  \
          if (Tiny3D::Logger::getInstancePtr() != nullptr)    \
          {   \
              T3D_LOGGER.trace(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__);    \
          }
+#endif
 
     #define T3D_LOG_FATAL(fmt, ...)         \
         T3D_LOG_TRACE(Tiny3D::Logger::E_LEVEL_FATAL, fmt, ##__VA_ARGS__)
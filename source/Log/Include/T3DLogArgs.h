@@ -0,0 +1,206 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_LOG_ARGS_H__
+#define __T3D_LOG_ARGS_H__
+
+
+#include "T3DLogPrerequisites.h"
+#include <type_traits>
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 延迟格式化日志的参数包
+     * @remarks 写日志时只把参数按原始二进制连同类型标记打包到栈上的缓冲区里，
+     *      由日志异步线程调用 format() 再按格式串还原成文本。
+     *      字符串参数会被拷贝，其他指针只记录地址。
+     */
+    class T3D_LOG_API LogArgs
+    {
+    public:
+        enum Type
+        {
+            E_TYPE_NONE = 0,
+            E_TYPE_INT32,       /// 32 位及以下的有符号整数
+            E_TYPE_UINT32,      /// 32 位无符号整数
+            E_TYPE_INT64,       /// 64 位有符号整数
+            E_TYPE_UINT64,      /// 64 位无符号整数
+            E_TYPE_DOUBLE,      /// 浮点数
+            E_TYPE_POINTER,     /// 指针
+            E_TYPE_STRING,      /// 字符串，内容跟在后面，以 0 结尾
+        };
+
+        enum
+        {
+            MAX_SIZE = 1024,    /// 参数包最大字节数，超出的参数会被截断
+        };
+
+        LogArgs()
+            : mSize(0)
+            , mIsFull(false)
+        {
+
+        }
+
+        /**
+         * @brief 打包所有参数
+         */
+        template <typename... Args>
+        void pack(Args... args)
+        {
+            packArgs(args...);
+        }
+
+        const uint8_t *data() const { return mData; }
+
+        size_t size() const         { return mSize; }
+
+        /**
+         * @brief 根据格式串和参数包还原出文本
+         * @param [in] buffer : 输出文本缓冲区
+         * @param [in] bufSize : 输出文本缓冲区大小
+         * @param [in] fmt : printf 风格的格式串
+         * @param [in] data : 参数包数据
+         * @param [in] dataSize : 参数包大小
+         * @return 返回输出文本长度，不包括结尾的 0
+         */
+        static size_t format(char *buffer, size_t bufSize, const char *fmt,
+            const uint8_t *data, size_t dataSize);
+
+    protected:
+        void packArgs()
+        {
+
+        }
+
+        template <typename T, typename... Rest>
+        void packArgs(T value, Rest... rest)
+        {
+            put(value);
+            packArgs(rest...);
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value 
+            || std::is_enum<T>::value>::type put(T value)
+        {
+            // 按可变参数的默认提升规则记录类型，还原时跟原来的调用一致
+            if (sizeof(T) <= sizeof(int32_t))
+            {
+                if (sizeof(T) < sizeof(int32_t) || std::is_signed<T>::value
+                    || std::is_enum<T>::value)
+                {
+                    int32_t v = (int32_t)value;
+                    putValue(E_TYPE_INT32, &v, sizeof(v));
+                }
+                else
+                {
+                    uint32_t v = (uint32_t)value;
+                    putValue(E_TYPE_UINT32, &v, sizeof(v));
+                }
+            }
+            else if (std::is_signed<T>::value)
+            {
+                int64_t v = (int64_t)value;
+                putValue(E_TYPE_INT64, &v, sizeof(v));
+            }
+            else
+            {
+                uint64_t v = (uint64_t)value;
+                putValue(E_TYPE_UINT64, &v, sizeof(v));
+            }
+        }
+
+        void put(double value)
+        {
+            putValue(E_TYPE_DOUBLE, &value, sizeof(value));
+        }
+
+        void put(const char *value)
+        {
+            putString(value);
+        }
+
+        void put(char *value)
+        {
+            putString(value);
+        }
+
+        void put(const String &value)
+        {
+            putString(value.c_str());
+        }
+
+        template <typename T>
+        void put(T *value)
+        {
+            const void *v = value;
+            putValue(E_TYPE_POINTER, &v, sizeof(v));
+        }
+
+        void putValue(uint8_t type, const void *value, size_t size)
+        {
+            if (!mIsFull && mSize + 1 + size <= MAX_SIZE)
+            {
+                mData[mSize] = type;
+                memcpy(mData + mSize + 1, value, size);
+                mSize += 1 + size;
+            }
+            else
+            {
+                // 放不下了，后面的参数都丢弃，还原时输出 (?)
+                mIsFull = true;
+            }
+        }
+
+        void putString(const char *value)
+        {
+            if (value == nullptr)
+            {
+                value = "(null)";
+            }
+
+            if (!mIsFull && mSize + 2 <= MAX_SIZE)
+            {
+                // 字符串放不下时截断
+                size_t len = strlen(value);
+                size_t space = MAX_SIZE - mSize - 2;
+                len = (len > space ? space : len);
+                mData[mSize] = E_TYPE_STRING;
+                memcpy(mData + mSize + 1, value, len);
+                mData[mSize + 1 + len] = 0;
+                mSize += len + 2;
+            }
+            else
+            {
+                mIsFull = true;
+            }
+        }
+
+    protected:
+        size_t      mSize;              /// 已经打包的字节数
+        bool        mIsFull;            /// 缓冲区是否已经满了
+        uint8_t     mData[MAX_SIZE];    /// 参数包数据
+    };
+}
+
+
+#endif  /*__T3D_LOG_ARGS_H__*/
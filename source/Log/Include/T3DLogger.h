@@ -22,12 +22,15 @@
 
 
 #include "T3DLogPrerequisites.h"
+#include "T3DLogArgs.h"
+#include <atomic>
 
 
 namespace Tiny3D
 {
     class LogItem;
     class LogTask;
+    class LogQueue;
 
     class T3D_LOG_API Logger 
         : public Singleton<Logger>
@@ -87,6 +90,7 @@ namespace Tiny3D
 
         /**
          * @brief 设置最大缓存大小，大于该大小的缓存日志会马上提交异步线程写回文件
+         * @note 日志队列容量根据该值计算，只有异步线程启动前设置才会重建队列
          */
         void setMaxCacheSize(uint32_t unMaxCacheSize);
 
@@ -124,6 +128,26 @@ namespace Tiny3D
          */
         void trace(Level level, const char *filename, int32_t line, const char *fmt, ...);
 
+        /**
+         * @brief 输出日志，只打包参数，格式化延迟到异步线程
+         * @param [in] level : 输出日志相应级别
+         * @param [in] filename : 输出日志的源码文件
+         * @param [in] line : 输出日志对应源码文件的行数
+         * @param [in] fmt : 格式化字符串，必须是字符串常量
+         * @param [in] args : 参数列表
+         * @return void
+         */
+        template <typename... Args>
+        void traceDeferred(Level level, const char *filename, int32_t line, const char *fmt, Args... args)
+        {
+            if (!mIsForced && level > mStrategy.eLevel)
+                return;
+
+            LogArgs logArgs;
+            logArgs.pack(args...);
+            commitDeferred(level, filename, line, fmt, logArgs);
+        }
+
         /**
          * @brief 关闭日志模块
          */
@@ -139,6 +163,16 @@ namespace Tiny3D
          */
         void enterForeground();
 
+        /**
+         * @brief 获取 Logger 创建以来因为队列满被丢弃的日志总数
+         * @note 写文件时才累计，shutdown() 之后是准确值。
+         *      ERROR 及以上级别的日志不会被丢弃
+         */
+        uint64_t getDroppedCount() const
+        {
+            return mDroppedCount.load(std::memory_order_relaxed);
+        }
+
         /**
          * @brief 根据日志文本获取日志级别枚举值
          */
@@ -158,8 +192,8 @@ namespace Tiny3D
 
         /// 打开日志文件
         bool openLogFile();
-        /// 根据缓存缓冲区索引写文件
-        void writeLogFile(std::vector<LogItem*> &cache);
+        /// 把日志队列中的日志批量写文件
+        void writeLogFile();
         /// 关闭日志文件
         void closeLogFile();
 
@@ -174,7 +208,20 @@ namespace Tiny3D
         /// 定时器回调，继承自RunLoopObserver
         virtual void onTimer(ID timerID, int32_t dt) override;
 
-        String getFileName(const String &path) const;
+        const char *getFileName(const char *path) const;
+
+        /// 把打包好参数的日志放入日志队列
+        void commitDeferred(Level level, const char *filename, int32_t line, const char *fmt, const LogArgs &args);
+
+        /// 日志队列满时调用，ERROR 及以上级别的日志同步写回腾出空间后返回 true 重试，其他级别丢弃并返回 false
+        bool makeRoom(Level level);
+        /// 日志发布后检查缓存数量，到达上限时唤醒异步线程写回
+        void notifyPending(size_t pending);
+
+        /// 根据缓存策略计算日志队列容量
+        size_t getQueueCapacity() const;
+        /// 异步线程没有启动时按照缓存策略重建日志队列
+        void resizeQueue();
 
         /// 异步线程调用的工作过程
         //static int32_t asyncWorkingProcedure(Logger *pThis);
@@ -191,18 +238,16 @@ namespace Tiny3D
 
         /// 提交检查过期日志异步任务
         void commitCheckExpiredTask();
-        /// 提交把缓存写回文件异步任务
-        void commitFlushCacheTask();
 
         /// 处理检查过期日志异步任务
         TResult processCheckExpiredTask(LogTask *task);
-        /// 处理把缓存写回文件异步任务
-        TResult processFlushCacheTask(LogTask *task);
 
     private:
-        typedef TList<LogItem*>             ItemCache;
-        typedef ItemCache::iterator         ItemCacheItr;
-        typedef ItemCache::const_iterator   ItemCacheConstItr;
+        enum
+        {
+            MIN_QUEUE_SIZE = 256,       /// 日志队列最小容量
+            QUEUE_CACHE_FACTOR = 16,    /// 日志队列容量至少是最大缓存数量的倍数，给异步线程留出写回的时间
+        };
 
         typedef TList<LogTask*>             TaskQueue;
         typedef TaskQueue::iterator         TaskQueueItr;
@@ -217,7 +262,7 @@ namespace Tiny3D
 
         DateTime            mCurLogFileTime;    /// 当前日志文件的时间，用于跨小时切换日志文件
 
-        ItemCache           mItemCache;         /// 缓存日志记录，到达一定数量或者时间时提交异步写回处理
+        LogQueue            *mItemQueue;        /// 缓存日志记录，到达一定数量或者时间时唤醒异步线程写回
         TaskQueue           mTaskQueue;         /// 异步任务队列
 
         FileDataStream      mFileStream;        /// 文件输出对象
@@ -226,11 +271,16 @@ namespace Tiny3D
 
         TMutex              mWaitMutex;     /// 用于挂起线程互斥量
         TCondVariable       mWaitCond;      /// 异步线程条件变量
+        std::atomic<bool>   mWakeRequested; /// 是否已经有线程请求唤醒异步线程，避免每条日志都去唤醒
+
+        TMutex              mWriteMutex;        /// 写文件互斥量，队列满时写日志的线程也会同步写回
 
         TMutex              mTaskMutex;         /// 异步任务互斥量
 
         int32_t             mTaskType;          /// 当前处理任务
 
+        std::atomic<uint64_t>   mDroppedCount;  /// 因为队列满被丢弃的日志总数
+
         bool                mIsForced;          /// 是否强制输出
         bool                mIsOutputConsole;   /// 是否同步输出到控制台
         bool                mIsRunning;         /// 日志系统是否运行中
@@ -0,0 +1,363 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "T3DLogArgs.h"
+#include <stdio.h>
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 参数包读取游标
+     */
+    struct LogArgsReader
+    {
+        const uint8_t   *data;
+        size_t          size;
+        size_t          pos;
+
+        bool next(uint8_t &type, const uint8_t *&value)
+        {
+            if (pos >= size)
+            {
+                return false;
+            }
+
+            type = data[pos];
+            value = data + pos + 1;
+
+            switch (type)
+            {
+            case LogArgs::E_TYPE_INT32:
+            case LogArgs::E_TYPE_UINT32:
+                pos += 1 + sizeof(int32_t);
+                break;
+            case LogArgs::E_TYPE_INT64:
+            case LogArgs::E_TYPE_UINT64:
+                pos += 1 + sizeof(int64_t);
+                break;
+            case LogArgs::E_TYPE_DOUBLE:
+                pos += 1 + sizeof(double);
+                break;
+            case LogArgs::E_TYPE_POINTER:
+                pos += 1 + sizeof(void *);
+                break;
+            case LogArgs::E_TYPE_STRING:
+                pos += 2 + strlen((const char *)value);
+                break;
+            default:
+                pos = size;
+                return false;
+            }
+
+            return (pos <= size);
+        }
+
+        bool nextInt(int32_t &value)
+        {
+            uint8_t type;
+            const uint8_t *v = nullptr;
+
+            if (!next(type, v))
+            {
+                return false;
+            }
+
+            if (type == LogArgs::E_TYPE_INT32 || type == LogArgs::E_TYPE_UINT32)
+            {
+                memcpy(&value, v, sizeof(value));
+            }
+            else if (type == LogArgs::E_TYPE_INT64 || type == LogArgs::E_TYPE_UINT64)
+            {
+                int64_t val;
+                memcpy(&val, v, sizeof(val));
+                value = (int32_t)val;
+            }
+            else
+            {
+                value = 0;
+            }
+
+            return true;
+        }
+    };
+
+    /**
+     * @brief 按参数的原始类型调用 snprintf，星号宽度和精度放在前面
+     */
+    template <typename T>
+    static int formatValue(char *buffer, size_t bufSize, const char *spec,
+        int32_t stars, const int32_t *star, T value)
+    {
+        int ret = 0;
+
+        switch (stars)
+        {
+        case 0:
+            ret = snprintf(buffer, bufSize, spec, value);
+            break;
+        case 1:
+            ret = snprintf(buffer, bufSize, spec, star[0], value);
+            break;
+        default:
+            ret = snprintf(buffer, bufSize, spec, star[0], star[1], value);
+            break;
+        }
+
+        return ret;
+    }
+
+    size_t LogArgs::format(char *buffer, size_t bufSize, const char *fmt,
+        const uint8_t *data, size_t dataSize)
+    {
+        if (buffer == nullptr || bufSize == 0)
+        {
+            return 0;
+        }
+
+        LogArgsReader reader = { data, dataSize, 0 };
+
+        size_t len = 0;
+        const size_t maxLen = bufSize - 1;
+        const char *p = fmt;
+
+        while (*p != 0 && len < maxLen)
+        {
+            if (*p != '%')
+            {
+                buffer[len++] = *p++;
+                continue;
+            }
+
+            if (*(p + 1) == '%')
+            {
+                buffer[len++] = '%';
+                p += 2;
+                continue;
+            }
+
+            // 截取一个完整的格式说明符，例如 %-08.3lf
+            char spec[32];
+            size_t specLen = 0;
+            int32_t stars = 0;
+            int32_t star[2] = { 0, 0 };
+            const char *s = p;
+
+            spec[specLen++] = *s++;
+
+            while (*s != 0 && strchr("diouxXeEfFgGaAcspn", *s) == nullptr)
+            {
+                if (*s == '*')
+                {
+                    // 最多支持宽度和精度两个星号
+                    if (stars < 2)
+                    {
+                        reader.nextInt(star[stars++]);
+                        spec[specLen++] = *s;
+                    }
+
+                    ++s;
+                    continue;
+                }
+
+                // 长度修饰符统一去掉，下面按记录的真实类型重新补上
+                if (strchr("hlLjztq", *s) == nullptr
+                    && specLen < sizeof(spec) - 6)
+                {
+                    spec[specLen++] = *s;
+                }
+
+                ++s;
+            }
+
+            if (*s == 0)
+            {
+                // 不完整的格式串，丢弃剩下的内容
+                break;
+            }
+
+            char conversion = *s;
+            p = s + 1;
+
+            if (conversion == 'n')
+            {
+                continue;
+            }
+
+            bool isInteger = (strchr("diouxXc", conversion) != nullptr);
+            bool isFloat = (strchr("eEfFgGaA", conversion) != nullptr);
+
+            if (isInteger && conversion != 'c')
+            {
+                spec[specLen++] = 'l';
+                spec[specLen++] = 'l';
+            }
+
+            spec[specLen++] = conversion;
+            spec[specLen] = 0;
+
+            uint8_t type = E_TYPE_NONE;
+            const uint8_t *value = nullptr;
+            if (!reader.next(type, value))
+            {
+                type = E_TYPE_NONE;
+            }
+
+            char *out = buffer + len;
+            size_t space = bufSize - len;
+            int ret = 0;
+
+            if (type == E_TYPE_NONE)
+            {
+                // 参数缺失或者被截断了
+                ret = snprintf(out, space, "(?)");
+            }
+            else if (isInteger)
+            {
+                long long v = 0;
+
+                switch (type)
+                {
+                case E_TYPE_INT32:
+                    {
+                        int32_t val;
+                        memcpy(&val, value, sizeof(val));
+                        // 32 位负数按无符号输出时不能带上高 32 位
+                        v = (strchr("ouxX", conversion) != nullptr
+                            ? (long long)(uint32_t)val : val);
+                    }
+                    break;
+                case E_TYPE_UINT32:
+                    {
+                        uint32_t val;
+                        memcpy(&val, value, sizeof(val));
+                        v = val;
+                    }
+                    break;
+                case E_TYPE_DOUBLE:
+                    {
+                        double val;
+                        memcpy(&val, value, sizeof(val));
+                        v = (long long)val;
+                    }
+                    break;
+                case E_TYPE_POINTER:
+                    {
+                        const void *val;
+                        memcpy(&val, value, sizeof(val));
+                        v = (long long)(uintptr_t)val;
+                    }
+                    break;
+                case E_TYPE_INT64:
+                case E_TYPE_UINT64:
+                    memcpy(&v, value, sizeof(v));
+                    break;
+                default:
+                    break;
+                }
+
+                if (conversion == 'c')
+                {
+                    ret = formatValue(out, space, spec, stars, star, (int)v);
+                }
+                else
+                {
+                    ret = formatValue(out, space, spec, stars, star, v);
+                }
+            }
+            else if (isFloat)
+            {
+                double v = 0.0;
+
+                switch (type)
+                {
+                case E_TYPE_DOUBLE:
+                    memcpy(&v, value, sizeof(v));
+                    break;
+                case E_TYPE_INT32:
+                    {
+                        int32_t val;
+                        memcpy(&val, value, sizeof(val));
+                        v = val;
+                    }
+                    break;
+                case E_TYPE_UINT32:
+                    {
+                        uint32_t val;
+                        memcpy(&val, value, sizeof(val));
+                        v = val;
+                    }
+                    break;
+                case E_TYPE_INT64:
+                    {
+                        int64_t val;
+                        memcpy(&val, value, sizeof(val));
+                        v = (double)val;
+                    }
+                    break;
+                case E_TYPE_UINT64:
+                    {
+                        uint64_t val;
+                        memcpy(&val, value, sizeof(val));
+                        v = (double)val;
+                    }
+                    break;
+                default:
+                    break;
+                }
+
+                ret = formatValue(out, space, spec, stars, star, v);
+            }
+            else if (type == E_TYPE_STRING)
+            {
+                if (conversion == 's')
+                {
+                    const char *v = (const char *)value;
+                    ret = formatValue(out, space, spec, stars, star, v);
+                }
+                else
+                {
+                    const void *v = value;
+                    ret = snprintf(out, space, "%p", v);
+                }
+            }
+            else if (type == E_TYPE_POINTER)
+            {
+                // 只记录了地址，%s 也不能解引用，统一按地址输出
+                const void *v;
+                memcpy(&v, value, sizeof(v));
+                ret = snprintf(out, space, "%p", v);
+            }
+            else
+            {
+                // 类型和格式对不上
+                ret = snprintf(out, space, "(?)");
+            }
+
+            if (ret > 0)
+            {
+                len += (size_t)ret;
+            }
+        }
+
+        len = (len > maxLen ? maxLen : len);
+        buffer[len] = 0;
+        return len;
+    }
+}
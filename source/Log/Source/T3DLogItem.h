@@ -23,7 +23,9 @@
 
 #include "T3DLogPrerequisites.h"
 #include "T3DLogger.h"
-#include <sstream>
+#include "T3DLogArgs.h"
+#include <stdarg.h>
+#include <functional>
 
 
 namespace Tiny3D
@@ -33,13 +35,87 @@ namespace Tiny3D
         friend class Logger;
 
     public:
-        LogItem(Logger::Level level, const char *filename, int32_t line, const char *content)
+        LogItem()
+            : mContentSize(0)
+            , mHour(0)
+            , mIsDeferred(false)
+            , mLevel(Logger::E_LEVEL_OFF)
+            , mLine(0)
+            , mFilenameOffset(0)
+            , mFormatOffset(0)
+            , mTimestamp(0)
+            , mThreadID(0)
+        {
+            mContent[0] = 0;
+        }
+
+        /**
+         * @brief 直接在日志项上格式化，不需要任何临时对象
+         */
+        void vformat(Logger::Level level, const char *filename, int32_t line, const char *fmt, va_list args)
         {
             DateTime dt = DateTime::currentDateTime();
             mHour = dt.Hour();
-            formatContent(dt, filename, line, level, content);
+            mIsDeferred = false;
+
+            uint32_t size = formatHeader(dt, currentThreadID(), filename, line, level);
+            int32_t ret = vsnprintf(mContent + size, sizeof(mContent) - size, fmt, args);
+            size = clampSize(size, ret);
+            mContentSize = appendNewLine(size);
+        }
+
+        void format(Logger::Level level, const char *filename, int32_t line, const char *fmt, ...)
+        {
+            va_list args;
+            va_start(args, fmt);
+            vformat(level, filename, line, fmt, args);
+            va_end(args);
+        }
+
+        /**
+         * @brief 只记录时间、线程、格式串和二进制参数包，不做任何格式化
+         * @remarks 格式串和文件名跟在参数包后面拷贝一份，写文件前插件被卸载了
+         *      也不会访问到已经卸载的字符串常量
+         */
+        void defer(Logger::Level level, const char *filename, int32_t line, const char *fmt, const LogArgs &args)
+        {
+            mIsDeferred = true;
+            mLevel = level;
+            mLine = line;
+            mTimestamp = Clock::currentNanoseconds();
+            mThreadID = currentThreadID();
+            mContentSize = (uint32_t)args.size();
+            memcpy(mContent, args.data(), mContentSize);
+            mFilenameOffset = mContentSize;
+            mFormatOffset = copyString(mFilenameOffset, filename, MAX_FILENAME);
+            copyString(mFormatOffset, fmt, sizeof(mContent));
+        }
+
+        /**
+         * @brief 在异步线程把延迟格式化的日志项还原成文本日志项
+         * @param [in] item : 输出的文本日志项
+         * @param [in] wallMSecs : 换算基准点的墙上时间，毫秒
+         * @param [in] monoNSecs : 换算基准点的单调时钟时间，纳秒
+         */
+        void resolve(LogItem &item, int64_t wallMSecs, int64_t monoNSecs) const
+        {
+            // 写日志时只取单调时钟，这里按基准点换算回墙上时间
+            int64_t msecs = wallMSecs + (mTimestamp - monoNSecs) / 1000000LL;
+            DateTime dt = DateTime::fromMSecsSinceEpoch(msecs);
+            item.mHour = dt.Hour();
+            item.mIsDeferred = false;
+
+            uint32_t size = item.formatHeader(dt, mThreadID,
+                mContent + mFilenameOffset, mLine, mLevel);
+            size_t ret = LogArgs::format(item.mContent + size,
+                sizeof(item.mContent) - size, mContent + mFormatOffset,
+                (const uint8_t *)mContent, mContentSize);
+            size = item.clampSize(size, (int32_t)ret);
+            item.mContentSize = item.appendNewLine(size);
         }
 
+        bool isDeferred() const    { return mIsDeferred; }
+
         void outputFile(FileDataStream &fs) const
         {
             // 日志格式
@@ -57,22 +133,67 @@ namespace Tiny3D
         int32_t getHour() const    { return mHour; }
 
     protected:
-        uint32_t formatContent(const DateTime &dt, const char *filename, int32_t line, Logger::Level level, const char *content)
+        static ulong_t currentThreadID()
         {
-            std::thread::id threadID = std::this_thread::get_id();
-            String strDateTime = dt.toString();
-            std::stringstream ss;
-            ss<<strDateTime<<"|"<<level<<"|"<<threadID<<"|"<<filename<<"|"<<line<<"|"<<content<<"\n";
-            mContentSize = ss.str().length();
-            mContentSize = (mContentSize > sizeof(mContent) - 1 ? sizeof(mContent) - 1 : ss.str().length());
-            memcpy(mContent, ss.str().c_str(), mContentSize);
-            mContent[mContentSize] = 0;
-            return mContentSize;
+            std::hash<std::thread::id> hasher;
+            return (ulong_t)hasher(std::this_thread::get_id());
+        }
+
+        uint32_t formatHeader(const DateTime &dt, ulong_t threadID, const char *filename, int32_t line, Logger::Level level)
+        {
+            int32_t ret = snprintf(mContent, sizeof(mContent),
+                "%d-%02d-%02d %02d:%02d:%02d.%03d|%d|%lu|%s|%d|",
+                dt.Year(), dt.Month(), dt.Day(), dt.Hour(), dt.Minute(),
+                dt.Second(), dt.Millisecond(), level, threadID, filename, line);
+            return clampSize(0, ret);
+        }
+
+        uint32_t clampSize(uint32_t offset, int32_t written) const
+        {
+            // 预留一个字节给换行符
+            const uint32_t maxSize = sizeof(mContent) - 2;
+            uint32_t size = offset + (written > 0 ? written : 0);
+            return (size > maxSize ? maxSize : size);
+        }
+
+        /// 把字符串拷贝到 mContent 的 offset 处，超长截断，返回下一个位置
+        uint32_t copyString(uint32_t offset, const char *str, size_t maxLen)
+        {
+            size_t space = sizeof(mContent) - offset - 1;
+            size_t len = strlen(str);
+            len = (len > maxLen ? maxLen : len);
+            len = (len > space ? space : len);
+            memcpy(mContent + offset, str, len);
+            mContent[offset + len] = 0;
+            return offset + (uint32_t)len + 1;
+        }
+
+        uint32_t appendNewLine(uint32_t size)
+        {
+            mContent[size++] = '\n';
+            mContent[size] = 0;
+            return size;
         }
 
     private:
+        enum
+        {
+            MAX_FILENAME = 255,     /// 延迟格式化时文件名最多拷贝的长度
+        };
+
         uint32_t        mContentSize;
         int32_t         mHour;
+
+        /// 以下是延迟格式化的日志项才用到的字段，参数包、文件名和格式串
+        /// 依次放在 mContent 里
+        bool            mIsDeferred;
+        Logger::Level   mLevel;
+        int32_t         mLine;
+        uint32_t        mFilenameOffset;    /// 文件名在 mContent 里的位置
+        uint32_t        mFormatOffset;      /// 格式串在 mContent 里的位置
+        int64_t         mTimestamp;     /// 单调时钟纳秒数
+        ulong_t         mThreadID;
+
         char            mContent[2048];
     };
 }
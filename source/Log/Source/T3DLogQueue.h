@@ -0,0 +1,202 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_LOG_QUEUE_H__
+#define __T3D_LOG_QUEUE_H__
+
+
+#include "T3DLogPrerequisites.h"
+#include "T3DLogItem.h"
+#include <atomic>
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 多生产者单消费者的无锁环形日志队列
+     * @remarks 所有日志项在构造时一次性分配好，写日志的线程只需要抢占一个槽位、
+     *      在槽位上直接格式化并发布，不分配内存也不加锁。只能有一个线程消费。
+     *      队列满时抢占失败，由调用者决定丢弃还是等待消费者腾出空间。
+     */
+    class LogQueue
+    {
+        T3D_DISABLE_COPY(LogQueue);
+
+    public:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;   /// 槽位序号，用于区分空闲、写入中和可读
+            size_t              position;   /// 抢占到的写入位置
+            LogItem             item;       /// 日志项
+        };
+
+        /**
+         * @brief 构造函数
+         * @param [in] capacity : 队列容量，必须是 2 的幂
+         */
+        LogQueue(size_t capacity)
+            : mSlots(nullptr)
+            , mMask(capacity - 1)
+            , mEnqueuePos(0)
+            , mDequeuePos(0)
+            , mDroppedCount(0)
+        {
+            T3D_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+            mSlots = new Slot[capacity];
+
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~LogQueue()
+        {
+            T3D_SAFE_DELETE_ARRAY(mSlots);
+        }
+
+        /**
+         * @brief 生产者抢占一个空闲槽位，队列满时返回 nullptr
+         */
+        Slot *acquire()
+        {
+            size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+            Slot *slot = nullptr;
+
+            while (1)
+            {
+                slot = &mSlots[pos & mMask];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+                if (diff == 0)
+                {
+                    if (mEnqueuePos.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // 队列满了
+                    return nullptr;
+                }
+                else
+                {
+                    pos = mEnqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->position = pos;
+            return slot;
+        }
+
+        /**
+         * @brief 生产者写完槽位后发布，消费者才能看到
+         * @return 返回发布后队列中待消费的日志数量
+         */
+        size_t publish(Slot *slot)
+        {
+            size_t pos = slot->position;
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return pos + 1 - mDequeuePos.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 消费者获取队首可读的槽位，队列空时返回 nullptr
+         */
+        Slot *front()
+        {
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            Slot *slot = &mSlots[pos & mMask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+            {
+                return nullptr;
+            }
+
+            return slot;
+        }
+
+        /**
+         * @brief 消费者处理完队首槽位后归还给生产者
+         */
+        void pop(Slot *slot)
+        {
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            slot->sequence.store(pos + mMask + 1, std::memory_order_release);
+            mDequeuePos.store(pos + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 队列是否为空
+         */
+        bool empty() const
+        {
+            return mEnqueuePos.load(std::memory_order_relaxed)
+                == mDequeuePos.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 获取队列容量
+         */
+        size_t capacity() const
+        {
+            return mMask + 1;
+        }
+
+        /**
+         * @brief 记录一条因为队列满被丢弃的日志
+         */
+        void markDropped()
+        {
+            mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief 获取并清零因为队列满被丢弃的日志数量
+         */
+        size_t takeDroppedCount()
+        {
+            return mDroppedCount.exchange(0, std::memory_order_relaxed);
+        }
+
+    protected:
+        enum
+        {
+            CACHE_LINE_SIZE = 64,   /// 生产者和消费者位置分开放，避免伪共享
+        };
+
+        Slot                *mSlots;        /// 预分配的槽位
+        size_t              mMask;          /// 容量掩码
+
+        char                mPad0[CACHE_LINE_SIZE];
+        std::atomic<size_t> mEnqueuePos;    /// 生产者写入位置
+        char                mPad1[CACHE_LINE_SIZE];
+        std::atomic<size_t> mDequeuePos;    /// 消费者读取位置
+        char                mPad2[CACHE_LINE_SIZE];
+        std::atomic<size_t> mDroppedCount;  /// 队列满被丢弃的日志数量
+    };
+}
+
+
+#endif  /*__T3D_LOG_QUEUE_H__*/
@@ -34,11 +34,4 @@ namespace Tiny3D
     {
         return E_TYPE_CHECK_EXPIRED;
     }
-
-    ////////////////////////////////////////////////////////////////////////////
-    // LogTaskFlushCache
-    LogTask::Type LogTaskFlushCache::getType() const
-    {
-        return E_TYPE_FLUSH_CACHE;
-    }
 }
@@ -35,7 +35,7 @@ namespace Tiny3D
         {
             E_TYPE_NONE = 0,        /// 没有类型
             E_TYPE_CHECK_EXPIRED,   /// 检查过期日志文件
-            E_TYPE_FLUSH_CACHE,     /// 把缓存日志写回文件
+            E_TYPE_FLUSH_CACHE,     /// 把日志队列写回文件
             E_TYPE_MAX
         };
 
@@ -59,24 +59,6 @@ namespace Tiny3D
     protected:
         uint32_t mExpired;
     };
-
-    class LogTaskFlushCache : public LogTask
-    {
-    public:
-        LogTaskFlushCache(size_t nCacheSize)
-            : mItemCache(nCacheSize)
-        {
-
-        }
-
-        virtual Type getType() const override;
-
-        typedef std::vector<LogItem *>      ItemCache;
-        typedef ItemCache::iterator         ItemCacheItr;
-        typedef ItemCache::const_iterator   ItemCacheConstItr;
-
-        ItemCache   mItemCache;
-    };
 }
 
 
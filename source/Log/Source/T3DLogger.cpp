@@ -20,6 +20,7 @@
 #include "T3DLogger.h"
 #include "T3DLogItem.h"
 #include "T3DLogTask.h"
+#include "T3DLogQueue.h"
 #include <sstream>
 #include <stdarg.h>
 #include <functional>
@@ -42,7 +43,10 @@ namespace Tiny3D
         : mFlushCacheTimerID(T3D_INVALID_TIMER_ID)
         , mAppID(0)
         , mTag("tag")
+        , mItemQueue(nullptr)
+        , mWakeRequested(false)
         , mTaskType(LogTask::E_TYPE_NONE)
+        , mDroppedCount(0)
         , mIsForced(false)
         , mIsRunning(false)
         , mIsTerminated(false)
@@ -52,11 +56,13 @@ namespace Tiny3D
         mStrategy.unExpired = 7;
         mStrategy.unMaxCacheSize = 50;
         mStrategy.unMaxCacheTime = 1000 * 5;
+
+        mItemQueue = new LogQueue(getQueueCapacity());
     }
 
     Logger::~Logger()
     {
-
+        T3D_SAFE_DELETE(mItemQueue);
     }
 
     void Logger::setLevel(Level eLevel)
@@ -84,6 +90,7 @@ namespace Tiny3D
     void Logger::setMaxCacheSize(uint32_t unMaxCacheSize)
     {
         mStrategy.unMaxCacheSize = unMaxCacheSize;
+        resizeQueue();
     }
 
     void Logger::setExpired(uint32_t unExpired)
@@ -113,6 +120,9 @@ namespace Tiny3D
     TResult Logger::startup(ID appID, const String &tag,
         bool force /* = false */, bool outputConsole /* = false */)
     {
+        /// 队列容量跟随缓存策略
+        resizeQueue();
+
         mAppID = appID;
         mTag = tag;
         mIsForced = force;
@@ -141,33 +151,110 @@ namespace Tiny3D
         if (!mIsForced && level > mStrategy.eLevel)
             return;
 
-        va_list args;
-        char content[2048] = {0};
+        /// 从日志队列抢占一个预分配的日志项
+        LogQueue::Slot *slot = nullptr;
+        while ((slot = mItemQueue->acquire()) == nullptr)
+        {
+            if (!makeRoom(level))
+                return;
+        }
 
+        /// 截取路径，直接获取源码文件名，并在日志项上直接格式化
+        va_list args;
         va_start(args, fmt);
-        vsnprintf(content, sizeof(content)-1, fmt, args);
+        slot->item.vformat(level, getFileName(filename), line, fmt, args);
         va_end(args);
 
-        /// 截取路径，直接获取源码文件名
-        String name = getFileName(filename);
+        /// 输出到控制台
+        if (mIsOutputConsole)
+        {
+            slot->item.outputConsole();
+        }
 
-        /// 生成一条日志项
-        LogItem *item = new LogItem(level, name.c_str(), line, content);
+        notifyPending(mItemQueue->publish(slot));
+    }
 
-        /// 输出到控制台
+    void Logger::commitDeferred(Level level, const char *filename,
+        int32_t line, const char *fmt, const LogArgs &args)
+    {
+        LogQueue::Slot *slot = nullptr;
+        while ((slot = mItemQueue->acquire()) == nullptr)
+        {
+            if (!makeRoom(level))
+                return;
+        }
+
+        /// 只拷贝参数包，写文件前的格式化放到异步线程
+        slot->item.defer(level, getFileName(filename), line, fmt, args);
+
+        /// 控制台输出要及时，并且和立即格式化的日志保持先后顺序，
+        /// 所以在调用线程格式化一份输出
         if (mIsOutputConsole)
         {
-            item->outputConsole();
+            LogItem text;
+            slot->item.resolve(text, DateTime::currentMSecsSinceEpoch(),
+                Clock::currentNanoseconds());
+            text.outputConsole();
         }
 
-        mItemCache.push_back(item);
+        notifyPending(mItemQueue->publish(slot));
+    }
 
-        if (mItemCache.size() >= mStrategy.unMaxCacheSize)
+    bool Logger::makeRoom(Level level)
+    {
+        if (level > E_LEVEL_ERROR)
+        {
+            /// 普通日志直接丢弃，只记录数量
+            mItemQueue->markDropped();
+            return false;
+        }
+
+        /// 错误日志不能丢，在调用线程同步写回腾出空间，
+        /// 异步线程正在写的话会等它写完
+        writeLogFile();
+        std::this_thread::yield();
+        return true;
+    }
+
+    void Logger::notifyPending(size_t pending)
+    {
+        /// 缓存数量到达上限，唤醒异步线程写回。多个线程同时发布时可能都越过上限，
+        /// 用标记保证只唤醒一次，异步线程开始写回时清除标记
+        if (pending >= mStrategy.unMaxCacheSize
+            && !mWakeRequested.exchange(true, std::memory_order_acq_rel))
         {
-            commitFlushCacheTask();
+            wakeAsyncTask();
         }
     }
 
+    size_t Logger::getQueueCapacity() const
+    {
+        size_t minCapacity = (size_t)mStrategy.unMaxCacheSize * QUEUE_CACHE_FACTOR;
+        size_t capacity = MIN_QUEUE_SIZE;
+
+        while (capacity < minCapacity)
+        {
+            capacity <<= 1;
+        }
+
+        return capacity;
+    }
+
+    void Logger::resizeQueue()
+    {
+        size_t capacity = getQueueCapacity();
+
+        /// 异步线程启动后其他线程随时可能写日志，不能重建队列
+        if (mWorkingThread.joinable() || mItemQueue == nullptr
+            || mItemQueue->capacity() == capacity || !mItemQueue->empty())
+        {
+            return;
+        }
+
+        T3D_SAFE_DELETE(mItemQueue);
+        mItemQueue = new LogQueue(capacity);
+    }
+
     void Logger::shutdown()
     {
         /// 停止缓存写回文件间隔定时器
@@ -287,27 +374,54 @@ namespace Tiny3D
         return ret;
     }
 
-    void Logger::writeLogFile(TArray<LogItem*> &cache)
+    void Logger::writeLogFile()
     {
-        TArray<LogItem*>::iterator itr = cache.begin();
+        /// 异步线程和队列满时写日志的线程都会写回，同一时间只能有一个消费者
+        TAutoLock<TMutex> lock(mWriteMutex);
+
+        size_t dropped = mItemQueue->takeDroppedCount();
+        if (dropped > 0)
+        {
+            // 记录因为队列满而丢弃的日志数量
+            mDroppedCount.fetch_add(dropped, std::memory_order_relaxed);
+
+            LogItem item;
+            item.format(E_LEVEL_WARNING, "T3DLogger.cpp", __LINE__,
+                "%lu log items were dropped because the queue was full !",
+                (ulong_t)dropped);
+            item.outputFile(mFileStream);
+        }
+
+        LogQueue::Slot *slot = nullptr;
+        LogItem text;
 
-        while (itr != cache.end() && !mIsTerminated)
+        // 每批日志重新取一次基准点，系统时间被调整后也能跟上
+        int64_t wallMSecs = DateTime::currentMSecsSinceEpoch();
+        int64_t monoNSecs = Clock::currentNanoseconds();
+
+        while (!mIsTerminated && (slot = mItemQueue->front()) != nullptr)
         {
-            LogItem *item = *itr;
+            const LogItem *pItem = &slot->item;
+
+            if (pItem->isDeferred())
+            {
+                // 延迟格式化的日志在这里才还原成文本
+                pItem->resolve(text, wallMSecs, monoNSecs);
+                pItem = &text;
+            }
+
+            const LogItem &item = *pItem;
 
-            if (item->getHour() != mCurLogFileTime.Hour())
+            if (item.getHour() != mCurLogFileTime.Hour())
             {
                 // 跨越到下一个小时，重新写一个新文件
                 closeLogFile();
                 openLogFile();
             }
 
-            item->outputFile(mFileStream);
-            delete item;
-            ++itr;
+            item.outputFile(mFileStream);
+            mItemQueue->pop(slot);
         }
-
-        cache.clear();
     }
 
     void Logger::closeLogFile()
@@ -328,16 +442,7 @@ namespace Tiny3D
         Level eLevel = mStrategy.eLevel;
         mStrategy.eLevel = E_LEVEL_OFF;
 
-        TArray<LogItem *> cache(mItemCache.size());
-        TArray<LogItem *>::iterator itr = cache.begin();
-        while (itr != cache.end())
-        {
-            *itr = mItemCache.front();
-            mItemCache.pop_front();
-            ++itr;
-        }
-
-        writeLogFile(cache);
+        writeLogFile();
 
         /// 恢复当前日志级别
         mStrategy.eLevel = eLevel;
@@ -362,24 +467,19 @@ namespace Tiny3D
     {
         if (timerID == mFlushCacheTimerID)
         {
-            commitFlushCacheTask();
+            startAsyncTask();
         }
     }
 
-    String Logger::getFileName(const String &path) const
+    const char *Logger::getFileName(const char *path) const
     {
-        String name;
-        int32_t pos = path.rfind("\\");
-        if (pos == String::npos)
+        const char *name = strrchr(path, '\\');
+        if (name == nullptr)
         {
-            pos = path.rfind("/");
-        }
-        if (pos != String::npos)
-        {
-            name = path.substr(pos+1);
+            name = strrchr(path, '/');
         }
 
-        return name;
+        return (name != nullptr ? name + 1 : path);
     }
 
 //     int32_t Logger::asyncWorkingProcedure(Logger *pThis)
@@ -413,33 +513,26 @@ namespace Tiny3D
                 case LogTask::E_TYPE_CHECK_EXPIRED:
                     processCheckExpiredTask(task);
                     break;
-                case LogTask::E_TYPE_FLUSH_CACHE:
-                    processFlushCacheTask(task);
-                    break;
                 default:
+                    delete task;
                     break;
                 }
             }
 
+            // 批量把日志队列中的日志写回文件，之后到达缓存上限的日志可以再次唤醒
+            mWakeRequested.store(false, std::memory_order_release);
+            mTaskType = LogTask::E_TYPE_FLUSH_CACHE;
+            writeLogFile();
+            mTaskType = LogTask::E_TYPE_NONE;
+
             if (mIsTerminated)
             {
 //                 ret = -1;
                 break;
             }
 
-            mTaskMutex.lock();
-            bool isTaskEmpty = mTaskQueue.empty();
-            mTaskMutex.unlock();
-
-            if (isTaskEmpty)
-            {
-                suspendAsyncTask();
-            }
-            else
-            {
-                // 挂起10ms
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+            // 没有任务也没有日志时挂起，直到被唤醒或者缓存时间间隔到达
+            suspendAsyncTask();
         }
 
 //         return ret;
@@ -450,19 +543,15 @@ namespace Tiny3D
         if (!mWorkingThread.joinable())
         {
             /// 启动异步线程
-            mWorkingThread = std::thread(std::bind(&Logger::workingProcedure, this));
             mIsRunning = true;
             mIsTerminated = false;
             mTaskType = LogTask::E_TYPE_NONE;
+            mWorkingThread = std::thread(std::bind(&Logger::workingProcedure, this));
         }
         else
         {
-            // 异步线程已经启动了
-            if (mIsSuspended)
-            {
-                // 异步线程被挂起，则唤醒
-                wakeAsyncTask();
-            }
+            // 异步线程已经启动了，如果被挂起，则唤醒
+            wakeAsyncTask();
         }
     }
 
@@ -472,13 +561,9 @@ namespace Tiny3D
         {
             mIsTerminated = true;
 
-            if (mIsSuspended)
-            {
-                // 异步任务线程挂起中，直接唤醒
-                wakeAsyncTask();
-            }
+            // 异步任务线程可能正要挂起，直接唤醒
+            wakeAsyncTask();
 
-            // 没挂起，直接停掉
             mWorkingThread.join();
             mIsRunning = false;
             mIsTerminated = false;
@@ -488,11 +573,21 @@ namespace Tiny3D
     void Logger::suspendAsyncTask()
     {
         TAutoLock<TMutex> lock(mWaitMutex);
-        mIsSuspended = true;
-        while (mIsSuspended)
+
+        mTaskMutex.lock();
+        bool isTaskEmpty = mTaskQueue.empty();
+        mTaskMutex.unlock();
+
+        if (mIsTerminated || !isTaskEmpty || !mItemQueue->empty())
         {
-            mWaitCond.wait(lock);
+            // 还有工作要做，不挂起
+            return;
         }
+
+        mIsSuspended = true;
+        mWaitCond.wait_for(lock, 
+            std::chrono::milliseconds(mStrategy.unMaxCacheTime));
+        mIsSuspended = false;
     }
 
     void Logger::wakeAsyncTask()
@@ -513,25 +608,6 @@ namespace Tiny3D
         startAsyncTask();
     }
 
-    void Logger::commitFlushCacheTask()
-    {
-        LogTaskFlushCache *task = new LogTaskFlushCache(mItemCache.size());
-        LogTaskFlushCache::ItemCacheItr itr = task->mItemCache.begin();
-
-        while (!mItemCache.empty())
-        {
-            *itr = mItemCache.front();
-            ++itr;
-            mItemCache.pop_front();
-        }
-
-        mTaskMutex.lock();
-        mTaskQueue.push_back(task);
-        mTaskMutex.unlock();
-
-        startAsyncTask();
-    }
-
     TResult Logger::processCheckExpiredTask(LogTask *task)
     {
         mTaskType = LogTask::E_TYPE_CHECK_EXPIRED;
@@ -569,16 +645,4 @@ namespace Tiny3D
 
         return T3D_ERR_OK;
     }
-
-    TResult Logger::processFlushCacheTask(LogTask *task)
-    {
-        mTaskType = LogTask::E_TYPE_FLUSH_CACHE;
-
-        writeLogFile(((LogTaskFlushCache *)task)->mItemCache);
-
-        delete task;
-        mTaskType = LogTask::E_TYPE_NONE;
-
-        return T3D_ERR_OK;
-    }
 }
@@ -23,6 +23,7 @@
 
 #include "T3DMathPrerequisites.h"
 #include "T3DSphere.h"
+#include "T3DBoundingBatch.h"
 
 
 namespace Tiny3D
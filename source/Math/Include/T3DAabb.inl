@@ -47,29 +47,15 @@ namespace Tiny3D
     template <typename T>
     void TAabb<T>::build(const TVector3<T> points[], size_t count)
     {
-        mMaxX = TReal<T>::MINUS_INF;
-        mMaxY = TReal<T>::MINUS_INF;
-        mMaxZ = TReal<T>::MINUS_INF;
-        mMinX = TReal<T>::INF;
-        mMinY = TReal<T>::INF;
-        mMinZ = TReal<T>::INF;
-
-        size_t i = 0;
-        for (i = 0; i < count; ++i)
-        {
-            if (points[i].x() > mMaxX)
-                mMaxX = points[i].x();
-            if (points[i].x() < mMinX)
-                mMinX = points[i].x();
-            if (points[i].y() > mMaxY)
-                mMaxY = points[i].y();
-            if (points[i].y() < mMinY)
-                mMinY = points[i].y();
-            if (points[i].z() > mMaxZ)
-                mMaxZ = points[i].z();
-            if (points[i].z() < mMinZ)
-                mMinZ = points[i].z();
-        }
+        TVector3<T> vMin, vMax;
+        TBoundingBatch<T>::computeBounds(points, count, vMin, vMax);
+
+        mMinX = vMin.x();
+        mMinY = vMin.y();
+        mMinZ = vMin.z();
+        mMaxX = vMax.x();
+        mMaxY = vMax.y();
+        mMaxZ = vMax.z();
 
         TVector3<T> center(
             (mMinX + mMaxX) * TReal<T>::HALF,
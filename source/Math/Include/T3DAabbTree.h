@@ -0,0 +1,196 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_AABB_TREE_H__
+#define __T3D_AABB_TREE_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DMath.h"
+#include "T3DAabb.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 动态 AABB 树，用于碰撞检测的粗检测阶段（broad-phase）
+     * @remarks 每个物体对应一个叶子，叶子保存物体的“胖”包围盒，即实际
+     *      包围盒向外扩大 margin，再沿预计的位移方向拉长。物体移动时只要还在
+     *      胖包围盒里面就不用改动树，移出去了才删掉叶子重新插入。
+     *
+     *      插入时从根往下按表面积代价选兄弟节点，插入和删除以后沿路径往上
+     *      做 AVL 式的旋转，保持树的高度平衡。
+     *
+     *      查询和配对只报告实际包围盒相交的物体，结果可以直接交给
+     *      TIntrAabbAabb、TIntrSphereSphere 等细检测类。getAabb 返回的包围盒
+     *      就是插入或移动时传进来的实际包围盒，userData 用来找回物体本身。
+     *
+     *      代理（proxy）编号就是叶子节点的下标，删除以后会被重复使用。
+     */
+    template <typename T>
+    class TAabbTree
+    {
+    public:
+        /// 无效的代理编号
+        static const uint32_t INVALID_PROXY = 0xFFFFFFFF;
+
+        /**
+         * @brief 构造函数
+         * @param [in] margin : 胖包围盒每个方向扩大的距离
+         */
+        TAabbTree(T margin = T(0.1f));
+
+        /**
+         * @brief 插入一个物体
+         * @param [in] box : 物体的包围盒
+         * @param [in] userData : 用户数据，配对时用来找回物体
+         * @return 代理编号
+         */
+        uint32_t insert(const TAabb<T> &box, void *userData = nullptr);
+
+        /// 删除一个物体
+        void remove(uint32_t proxy);
+
+        /**
+         * @brief 更新物体的包围盒
+         * @param [in] proxy : 代理编号
+         * @param [in] box : 新的包围盒
+         * @param [in] displacement : 物体预计的位移，胖包围盒沿这个方向
+         *      额外拉长，下一次移动更可能还在胖包围盒里
+         * @return 叶子被重新插入时返回 true，只更新了实际包围盒返回 false
+         */
+        bool move(uint32_t proxy, const TAabb<T> &box,
+            const TVector3<T> &displacement = TVector3<T>::ZERO);
+
+        /// 清空
+        void clear();
+
+        /// 代理的实际包围盒
+        const TAabb<T> &getAabb(uint32_t proxy) const;
+
+        /// 代理的用户数据
+        void *getUserData(uint32_t proxy) const;
+
+        /// 物体个数
+        size_t getProxyCount() const;
+
+        /// 树的高度，只有一个叶子时为 0，空树为 -1
+        int32_t getHeight() const;
+
+        /**
+         * @brief 找出和 box 相交的所有物体
+         * @param [in] box : 查询的包围盒
+         * @param [in] callback : 每个相交的物体调用一次 callback(uint32_t proxy)
+         */
+        template <typename Callback>
+        void queryOverlaps(const TAabb<T> &box, Callback callback) const;
+
+        /**
+         * @brief 找出所有包围盒相交的物体对
+         * @remarks 树自身做一次遍历，每一对只报告一次，
+         *      调用 callback(uint32_t proxyA, uint32_t proxyB)，proxyA < proxyB
+         * @return 物体对的个数
+         */
+        template <typename Callback>
+        size_t computePairs(Callback callback);
+
+    protected:
+        /// 查询用的栈深度，平衡树的高度远小于这个值
+        static const uint32_t STACK_SIZE = 256;
+
+        /// 胖包围盒沿位移方向拉长的倍数
+        static const int32_t DISPLACEMENT_MULTIPLIER = 2;
+
+        struct Node
+        {
+            /// 胖包围盒，内部节点是两个孩子的并集
+            T           mins[3];
+            T           maxs[3];
+            /// 父节点，节点空闲时是空闲链表的下一个节点
+            uint32_t    parent;
+            /// 叶子的两个孩子都是 INVALID_PROXY
+            uint32_t    child1;
+            uint32_t    child2;
+            /// 叶子为 0，空闲节点为 -1
+            int32_t     height;
+        };
+
+        /// 叶子的物体数据，和节点数组一一对应
+        struct Leaf
+        {
+            TAabb<T>    box;
+            void        *userData;
+        };
+
+        /// computePairs 遍历时的节点对，a == b 表示节点自身内部配对
+        struct NodePair
+        {
+            uint32_t    a;
+            uint32_t    b;
+        };
+
+        uint32_t allocateNode();
+
+        void freeNode(uint32_t index);
+
+        void insertLeaf(uint32_t leaf);
+
+        void removeLeaf(uint32_t leaf);
+
+        /// 以 index 为根做一次旋转，返回旋转以后这个位置上的节点
+        uint32_t balance(uint32_t index);
+
+        /// 从 index 往上重新计算高度和包围盒，顺便做旋转
+        void fixUpwards(uint32_t index);
+
+        /// 用两个孩子更新节点的包围盒和高度
+        void updateNode(uint32_t index);
+
+        bool isLeaf(const Node &node) const
+        {
+            return (node.child1 == INVALID_PROXY);
+        }
+
+        /// 包围盒一半的表面积，插入时的代价
+        static float32_t halfArea(const T mins[3], const T maxs[3]);
+
+        /// 两个包围盒并集一半的表面积
+        static float32_t unionArea(const Node &a, const Node &b);
+
+        static bool overlaps(const Node &a, const Node &b);
+
+        static bool overlaps(const Node &node, const TAabb<T> &box);
+
+        static bool overlaps(const TAabb<T> &a, const TAabb<T> &b);
+
+        TArray<Node>        mNodes;
+        TArray<Leaf>        mLeaves;
+        TArray<NodePair>    mPairStack;
+        uint32_t            mRoot;
+        uint32_t            mFreeList;
+        size_t              mProxyCount;
+        T                   mMargin;
+    };
+}
+
+
+#include "T3DAabbTree.inl"
+
+
+#endif  /*__T3D_AABB_TREE_H__*/
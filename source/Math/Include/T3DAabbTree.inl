@@ -0,0 +1,572 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const uint32_t TAabbTree<T>::INVALID_PROXY;
+
+    template <typename T>
+    const uint32_t TAabbTree<T>::STACK_SIZE;
+
+    template <typename T>
+    const int32_t TAabbTree<T>::DISPLACEMENT_MULTIPLIER;
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline TAabbTree<T>::TAabbTree(T margin)
+        : mRoot(INVALID_PROXY)
+        , mFreeList(INVALID_PROXY)
+        , mProxyCount(0)
+        , mMargin(margin)
+    {
+
+    }
+
+    template <typename T>
+    inline void TAabbTree<T>::clear()
+    {
+        mNodes.clear();
+        mLeaves.clear();
+        mRoot = INVALID_PROXY;
+        mFreeList = INVALID_PROXY;
+        mProxyCount = 0;
+    }
+
+    template <typename T>
+    inline const TAabb<T> &TAabbTree<T>::getAabb(uint32_t proxy) const
+    {
+        T3D_ASSERT(proxy < mNodes.size() && isLeaf(mNodes[proxy]));
+        return mLeaves[proxy].box;
+    }
+
+    template <typename T>
+    inline void *TAabbTree<T>::getUserData(uint32_t proxy) const
+    {
+        T3D_ASSERT(proxy < mNodes.size() && isLeaf(mNodes[proxy]));
+        return mLeaves[proxy].userData;
+    }
+
+    template <typename T>
+    inline size_t TAabbTree<T>::getProxyCount() const
+    {
+        return mProxyCount;
+    }
+
+    template <typename T>
+    inline int32_t TAabbTree<T>::getHeight() const
+    {
+        return (mRoot == INVALID_PROXY) ? -1 : mNodes[mRoot].height;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    uint32_t TAabbTree<T>::insert(const TAabb<T> &box, void *userData)
+    {
+        uint32_t proxy = allocateNode();
+        Node &node = mNodes[proxy];
+
+        node.mins[0] = box.getMinX() - mMargin;
+        node.mins[1] = box.getMinY() - mMargin;
+        node.mins[2] = box.getMinZ() - mMargin;
+        node.maxs[0] = box.getMaxX() + mMargin;
+        node.maxs[1] = box.getMaxY() + mMargin;
+        node.maxs[2] = box.getMaxZ() + mMargin;
+        node.height = 0;
+
+        mLeaves[proxy].box = box;
+        mLeaves[proxy].userData = userData;
+
+        insertLeaf(proxy);
+        ++mProxyCount;
+
+        return proxy;
+    }
+
+    template <typename T>
+    void TAabbTree<T>::remove(uint32_t proxy)
+    {
+        T3D_ASSERT(proxy < mNodes.size() && isLeaf(mNodes[proxy]));
+
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --mProxyCount;
+    }
+
+    template <typename T>
+    bool TAabbTree<T>::move(uint32_t proxy, const TAabb<T> &box,
+        const TVector3<T> &displacement)
+    {
+        T3D_ASSERT(proxy < mNodes.size() && isLeaf(mNodes[proxy]));
+
+        mLeaves[proxy].box = box;
+
+        Node &node = mNodes[proxy];
+        T mins[3] = { box.getMinX(), box.getMinY(), box.getMinZ() };
+        T maxs[3] = { box.getMaxX(), box.getMaxY(), box.getMaxZ() };
+
+        if (node.mins[0] <= mins[0] && node.mins[1] <= mins[1]
+            && node.mins[2] <= mins[2] && maxs[0] <= node.maxs[0]
+            && maxs[1] <= node.maxs[1] && maxs[2] <= node.maxs[2])
+        {
+            // 还在胖包围盒里面，树不用动
+            return false;
+        }
+
+        removeLeaf(proxy);
+
+        T multiplier((int32_t)DISPLACEMENT_MULTIPLIER);
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            T d = displacement[k] * multiplier;
+            node.mins[k] = mins[k] - mMargin;
+            node.maxs[k] = maxs[k] + mMargin;
+
+            if (d < TReal<T>::ZERO)
+                node.mins[k] += d;
+            else
+                node.maxs[k] += d;
+        }
+
+        insertLeaf(proxy);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    uint32_t TAabbTree<T>::allocateNode()
+    {
+        uint32_t index;
+
+        if (mFreeList == INVALID_PROXY)
+        {
+            index = (uint32_t)mNodes.size();
+            mNodes.resize(index + 1);
+            mLeaves.resize(index + 1);
+        }
+        else
+        {
+            index = mFreeList;
+            mFreeList = mNodes[index].parent;
+        }
+
+        Node &node = mNodes[index];
+        node.parent = INVALID_PROXY;
+        node.child1 = INVALID_PROXY;
+        node.child2 = INVALID_PROXY;
+        node.height = 0;
+        mLeaves[index].userData = nullptr;
+
+        return index;
+    }
+
+    template <typename T>
+    inline void TAabbTree<T>::freeNode(uint32_t index)
+    {
+        mNodes[index].parent = mFreeList;
+        mNodes[index].height = -1;
+        mFreeList = index;
+    }
+
+    template <typename T>
+    void TAabbTree<T>::insertLeaf(uint32_t leaf)
+    {
+        if (mRoot == INVALID_PROXY)
+        {
+            mRoot = leaf;
+            mNodes[leaf].parent = INVALID_PROXY;
+            return;
+        }
+
+        // 从根往下找代价最小的兄弟节点：在 index 处和它组成新的父节点的代价
+        // 是并集的面积，往下走的话 index 的面积会增加，这部分是继承代价
+        const Node &leafNode = mNodes[leaf];
+        uint32_t index = mRoot;
+
+        while (!isLeaf(mNodes[index]))
+        {
+            const Node &node = mNodes[index];
+            const Node &child1 = mNodes[node.child1];
+            const Node &child2 = mNodes[node.child2];
+
+            float32_t area = halfArea(node.mins, node.maxs);
+            float32_t combined = unionArea(node, leafNode);
+            float32_t cost = 2.0f * combined;
+            float32_t inheritance = 2.0f * (combined - area);
+
+            float32_t cost1 = unionArea(child1, leafNode) + inheritance;
+            if (!isLeaf(child1))
+                cost1 -= halfArea(child1.mins, child1.maxs);
+
+            float32_t cost2 = unionArea(child2, leafNode) + inheritance;
+            if (!isLeaf(child2))
+                cost2 -= halfArea(child2.mins, child2.maxs);
+
+            if (cost < cost1 && cost < cost2)
+                break;
+
+            index = (cost1 < cost2) ? node.child1 : node.child2;
+        }
+
+        uint32_t sibling = index;
+
+        // 新的父节点，分配时节点数组可能扩容，之前的引用都不能再用
+        uint32_t parent = allocateNode();
+        uint32_t oldParent = mNodes[sibling].parent;
+
+        Node &newParent = mNodes[parent];
+        newParent.parent = oldParent;
+        newParent.child1 = sibling;
+        newParent.child2 = leaf;
+        mNodes[sibling].parent = parent;
+        mNodes[leaf].parent = parent;
+        updateNode(parent);
+
+        if (oldParent == INVALID_PROXY)
+        {
+            mRoot = parent;
+        }
+        else if (mNodes[oldParent].child1 == sibling)
+        {
+            mNodes[oldParent].child1 = parent;
+        }
+        else
+        {
+            mNodes[oldParent].child2 = parent;
+        }
+
+        fixUpwards(oldParent);
+    }
+
+    template <typename T>
+    void TAabbTree<T>::removeLeaf(uint32_t leaf)
+    {
+        if (leaf == mRoot)
+        {
+            mRoot = INVALID_PROXY;
+            return;
+        }
+
+        // 父节点被兄弟节点取代
+        uint32_t parent = mNodes[leaf].parent;
+        uint32_t grandParent = mNodes[parent].parent;
+        uint32_t sibling = (mNodes[parent].child1 == leaf)
+            ? mNodes[parent].child2 : mNodes[parent].child1;
+
+        mNodes[sibling].parent = grandParent;
+
+        if (grandParent == INVALID_PROXY)
+        {
+            mRoot = sibling;
+        }
+        else
+        {
+            if (mNodes[grandParent].child1 == parent)
+                mNodes[grandParent].child1 = sibling;
+            else
+                mNodes[grandParent].child2 = sibling;
+        }
+
+        freeNode(parent);
+        fixUpwards(grandParent);
+    }
+
+    template <typename T>
+    void TAabbTree<T>::fixUpwards(uint32_t index)
+    {
+        while (index != INVALID_PROXY)
+        {
+            index = balance(index);
+            updateNode(index);
+            index = mNodes[index].parent;
+        }
+    }
+
+    template <typename T>
+    inline void TAabbTree<T>::updateNode(uint32_t index)
+    {
+        Node &node = mNodes[index];
+        const Node &child1 = mNodes[node.child1];
+        const Node &child2 = mNodes[node.child2];
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            node.mins[k] = TMath<T>::min(child1.mins[k], child2.mins[k]);
+            node.maxs[k] = TMath<T>::max(child1.maxs[k], child2.maxs[k]);
+        }
+
+        node.height = 1 + std::max(child1.height, child2.height);
+    }
+
+    template <typename T>
+    uint32_t TAabbTree<T>::balance(uint32_t iA)
+    {
+        Node &A = mNodes[iA];
+
+        if (isLeaf(A) || A.height < 2)
+            return iA;
+
+        uint32_t iB = A.child1;
+        uint32_t iC = A.child2;
+        Node &B = mNodes[iB];
+        Node &C = mNodes[iC];
+
+        int32_t diff = C.height - B.height;
+
+        if (diff > 1)
+        {
+            // C 太高，把 C 转上来，A 成为 C 的孩子，C 较高的孩子留在 C 下面
+            uint32_t iF = C.child1;
+            uint32_t iG = C.child2;
+            Node &F = mNodes[iF];
+            Node &G = mNodes[iG];
+
+            C.child1 = iA;
+            C.parent = A.parent;
+            A.parent = iC;
+
+            if (C.parent == INVALID_PROXY)
+                mRoot = iC;
+            else if (mNodes[C.parent].child1 == iA)
+                mNodes[C.parent].child1 = iC;
+            else
+                mNodes[C.parent].child2 = iC;
+
+            if (F.height > G.height)
+            {
+                C.child2 = iF;
+                A.child2 = iG;
+                G.parent = iA;
+            }
+            else
+            {
+                C.child2 = iG;
+                A.child2 = iF;
+                F.parent = iA;
+            }
+
+            updateNode(iA);
+            updateNode(iC);
+            return iC;
+        }
+
+        if (diff < -1)
+        {
+            // B 太高，对称地把 B 转上来
+            uint32_t iD = B.child1;
+            uint32_t iE = B.child2;
+            Node &D = mNodes[iD];
+            Node &E = mNodes[iE];
+
+            B.child1 = iA;
+            B.parent = A.parent;
+            A.parent = iB;
+
+            if (B.parent == INVALID_PROXY)
+                mRoot = iB;
+            else if (mNodes[B.parent].child1 == iA)
+                mNodes[B.parent].child1 = iB;
+            else
+                mNodes[B.parent].child2 = iB;
+
+            if (D.height > E.height)
+            {
+                B.child2 = iD;
+                A.child1 = iE;
+                E.parent = iA;
+            }
+            else
+            {
+                B.child2 = iE;
+                A.child1 = iD;
+                D.parent = iA;
+            }
+
+            updateNode(iA);
+            updateNode(iB);
+            return iB;
+        }
+
+        return iA;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline float32_t TAabbTree<T>::halfArea(const T mins[3], const T maxs[3])
+    {
+        float32_t dx = (float32_t)(maxs[0] - mins[0]);
+        float32_t dy = (float32_t)(maxs[1] - mins[1]);
+        float32_t dz = (float32_t)(maxs[2] - mins[2]);
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    template <typename T>
+    inline float32_t TAabbTree<T>::unionArea(const Node &a, const Node &b)
+    {
+        T mins[3], maxs[3];
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            mins[k] = TMath<T>::min(a.mins[k], b.mins[k]);
+            maxs[k] = TMath<T>::max(a.maxs[k], b.maxs[k]);
+        }
+
+        return halfArea(mins, maxs);
+    }
+
+    template <typename T>
+    inline bool TAabbTree<T>::overlaps(const Node &a, const Node &b)
+    {
+        return a.mins[0] <= b.maxs[0] && b.mins[0] <= a.maxs[0]
+            && a.mins[1] <= b.maxs[1] && b.mins[1] <= a.maxs[1]
+            && a.mins[2] <= b.maxs[2] && b.mins[2] <= a.maxs[2];
+    }
+
+    template <typename T>
+    inline bool TAabbTree<T>::overlaps(const Node &node, const TAabb<T> &box)
+    {
+        return node.mins[0] <= box.getMaxX() && box.getMinX() <= node.maxs[0]
+            && node.mins[1] <= box.getMaxY() && box.getMinY() <= node.maxs[1]
+            && node.mins[2] <= box.getMaxZ() && box.getMinZ() <= node.maxs[2];
+    }
+
+    template <typename T>
+    inline bool TAabbTree<T>::overlaps(const TAabb<T> &a, const TAabb<T> &b)
+    {
+        return a.getMinX() <= b.getMaxX() && b.getMinX() <= a.getMaxX()
+            && a.getMinY() <= b.getMaxY() && b.getMinY() <= a.getMaxY()
+            && a.getMinZ() <= b.getMaxZ() && b.getMinZ() <= a.getMaxZ();
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    template <typename Callback>
+    void TAabbTree<T>::queryOverlaps(const TAabb<T> &box,
+        Callback callback) const
+    {
+        if (mRoot == INVALID_PROXY)
+            return;
+
+        uint32_t stack[STACK_SIZE];
+        uint32_t top = 0;
+        stack[top++] = mRoot;
+
+        while (top > 0)
+        {
+            uint32_t index = stack[--top];
+            const Node &node = mNodes[index];
+
+            if (!overlaps(node, box))
+                continue;
+
+            if (isLeaf(node))
+            {
+                if (overlaps(mLeaves[index].box, box))
+                    callback(index);
+            }
+            else
+            {
+                T3D_ASSERT(top + 2 <= STACK_SIZE);
+                stack[top++] = node.child1;
+                stack[top++] = node.child2;
+            }
+        }
+    }
+
+    template <typename T>
+    template <typename Callback>
+    size_t TAabbTree<T>::computePairs(Callback callback)
+    {
+        if (mRoot == INVALID_PROXY)
+            return 0;
+
+        // 任意两个叶子只有一个最近公共祖先，在那里作为两棵子树之间的节点对
+        // 被展开一次，所以每一对只报告一次
+        size_t count = 0;
+        NodePair root = { mRoot, mRoot };
+        mPairStack.clear();
+        mPairStack.push_back(root);
+
+        while (!mPairStack.empty())
+        {
+            NodePair pair = mPairStack.back();
+            mPairStack.pop_back();
+
+            const Node &a = mNodes[pair.a];
+
+            if (pair.a == pair.b)
+            {
+                if (!isLeaf(a))
+                {
+                    NodePair p0 = { a.child1, a.child1 };
+                    NodePair p1 = { a.child2, a.child2 };
+                    NodePair p2 = { a.child1, a.child2 };
+                    mPairStack.push_back(p0);
+                    mPairStack.push_back(p1);
+                    mPairStack.push_back(p2);
+                }
+                continue;
+            }
+
+            const Node &b = mNodes[pair.b];
+
+            if (!overlaps(a, b))
+                continue;
+
+            bool leafA = isLeaf(a);
+            bool leafB = isLeaf(b);
+
+            if (leafA && leafB)
+            {
+                if (overlaps(mLeaves[pair.a].box, mLeaves[pair.b].box))
+                {
+                    if (pair.a < pair.b)
+                        callback(pair.a, pair.b);
+                    else
+                        callback(pair.b, pair.a);
+                    ++count;
+                }
+            }
+            else if (leafB || (!leafA && a.height >= b.height))
+            {
+                // 展开较高的一边
+                NodePair p0 = { a.child1, pair.b };
+                NodePair p1 = { a.child2, pair.b };
+                mPairStack.push_back(p0);
+                mPairStack.push_back(p1);
+            }
+            else
+            {
+                NodePair p0 = { pair.a, b.child1 };
+                NodePair p1 = { pair.a, b.child2 };
+                mPairStack.push_back(p0);
+                mPairStack.push_back(p1);
+            }
+        }
+
+        return count;
+    }
+}
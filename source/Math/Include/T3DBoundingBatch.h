@@ -0,0 +1,112 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_BOUNDING_BATCH_H__
+#define __T3D_BOUNDING_BATCH_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DMath.h"
+#include "T3DVector3.h"
+#include "T3DMatrix3.h"
+#include "T3DMathSIMD.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 构建包围体用到的点集规约：包围盒、协方差、投影范围、最远点
+     * @remarks 点集按 CHUNK_SIZE 个一块，每块单独规约后按块的顺序合并，
+     *      所以结果只和点集有关，和线程数无关。点数超过 PARALLEL_SIZE 时
+     *      各块分给多个线程。float32_t 在开启 SIMD 时每次处理 4 个点。
+     *
+     *      threads 为 0 表示使用所有硬件线程。
+     */
+    template <typename T>
+    class TBoundingBatch
+    {
+    public:
+        /// 每块的点数
+        static const size_t CHUNK_SIZE = 16384;
+
+        /// 点数不少于这个值时才使用多线程
+        static const size_t PARALLEL_SIZE = 65536;
+
+        /// count 个点分成多少块
+        static size_t getChunkCount(size_t count);
+
+        /// 各分量的最小值和最大值，count 为 0 时 vMin 为 INF，vMax 为 MINUS_INF
+        static void computeBounds(const TVector3<T> *points, size_t count,
+            TVector3<T> &vMin, TVector3<T> &vMax, size_t threads = 0);
+
+        /**
+         * @brief 均值和协方差矩阵
+         * @remarks 每块先求块内均值再累加离差乘积，块之间按样本数加权合并，
+         *      点离原点很远时也不会因为相减抵消而丢失精度
+         */
+        static void computeCovariance(const TVector3<T> *points, size_t count,
+            TVector3<T> &mean, TMatrix3<T> &covariance, size_t threads = 0);
+
+        /// 点在三个轴上投影的最小值和最大值，vMin[i] 对应 axis[i]
+        static void computeProjectedBounds(const TVector3<T> *points,
+            size_t count, const TVector3<T> axis[3], TVector3<T> &vMin,
+            TVector3<T> &vMax, size_t threads = 0);
+
+        /**
+         * @brief 每块里离 center 最远的点
+         * @param [out] indices : 每块最远点的下标，至少 getChunkCount(count) 个
+         * @param [out] distances2 : 对应的距离平方
+         */
+        static void computeFarthestPoints(const TVector3<T> *points,
+            size_t count, const TVector3<T> &center, size_t *indices,
+            T *distances2, size_t threads = 0);
+
+    protected:
+        /// 把 count 个点分块交给 func(chunk, begin, end)
+        template <typename Func>
+        static void runChunks(size_t count, size_t threads, const Func &func);
+
+        static void boundsKernel(const TVector3<T> *points, size_t count,
+            T mins[3], T maxs[3]);
+
+        static void sumKernel(const TVector3<T> *points, size_t count,
+            T sum[3]);
+
+        /// 离差乘积的和，依次是 xx, xy, xz, yy, yz, zz
+        static void momentKernel(const TVector3<T> *points, size_t count,
+            const T mean[3], T moments[6]);
+
+        static void projectKernel(const TVector3<T> *points, size_t count,
+            const TVector3<T> axis[3], T mins[3], T maxs[3]);
+
+        /// 返回块内最远点的下标
+        static size_t farthestKernel(const TVector3<T> *points, size_t count,
+            const T center[3], T &distance2);
+
+        /// farthestKernel 的逐点版本，距离相同时取下标小的
+        static size_t farthestScalar(const TVector3<T> *points, size_t count,
+            const T center[3], T &distance2);
+    };
+}
+
+
+#include "T3DBoundingBatch.inl"
+
+
+#endif  /*__T3D_BOUNDING_BATCH_H__*/
@@ -0,0 +1,590 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const size_t TBoundingBatch<T>::CHUNK_SIZE;
+
+    template <typename T>
+    const size_t TBoundingBatch<T>::PARALLEL_SIZE;
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline size_t TBoundingBatch<T>::getChunkCount(size_t count)
+    {
+        return (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    }
+
+    template <typename T>
+    template <typename Func>
+    void TBoundingBatch<T>::runChunks(size_t count, size_t threads,
+        const Func &func)
+    {
+        size_t chunks = getChunkCount(count);
+
+        if (threads == 0)
+        {
+            threads = TThread::hardware_concurrency();
+        }
+
+        if (threads == 0 || count < PARALLEL_SIZE)
+        {
+            threads = 1;
+        }
+
+        threads = std::min(threads, chunks);
+
+        auto work = [&](size_t t)
+        {
+            for (size_t c = t; c < chunks; c += threads)
+            {
+                size_t begin = c * CHUNK_SIZE;
+                func(c, begin, std::min(count, begin + CHUNK_SIZE));
+            }
+        };
+
+        TArray<TThread> workers;
+
+        for (size_t t = 1; t < threads; ++t)
+        {
+            workers.push_back(TThread(work, t));
+        }
+
+        work(0);
+
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i].join();
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    void TBoundingBatch<T>::computeBounds(const TVector3<T> *points,
+        size_t count, TVector3<T> &vMin, TVector3<T> &vMax, size_t threads)
+    {
+        size_t chunks = getChunkCount(count);
+        TArray<T> mins(chunks * 3), maxs(chunks * 3);
+
+        runChunks(count, threads, [&](size_t c, size_t begin, size_t end)
+        {
+            boundsKernel(points + begin, end - begin, &mins[c * 3],
+                &maxs[c * 3]);
+        });
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            vMin[k] = TReal<T>::INF;
+            vMax[k] = TReal<T>::MINUS_INF;
+        }
+
+        for (size_t c = 0; c < chunks; ++c)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                vMin[k] = TMath<T>::min(vMin[k], mins[c * 3 + k]);
+                vMax[k] = TMath<T>::max(vMax[k], maxs[c * 3 + k]);
+            }
+        }
+    }
+
+    template <typename T>
+    void TBoundingBatch<T>::computeCovariance(const TVector3<T> *points,
+        size_t count, TVector3<T> &mean, TMatrix3<T> &covariance,
+        size_t threads)
+    {
+        mean = TVector3<T>::ZERO;
+        covariance.makeZero();
+
+        if (count == 0)
+            return;
+
+        // 每块保存和、块内均值和关于块内均值的离差乘积
+        size_t chunks = getChunkCount(count);
+        TArray<T> sums(chunks * 3), means(chunks * 3), moments(chunks * 6);
+
+        runChunks(count, threads, [&](size_t c, size_t begin, size_t end)
+        {
+            const TVector3<T> *p = points + begin;
+            size_t n = end - begin;
+            T *sum = &sums[c * 3];
+            T *m = &means[c * 3];
+            sumKernel(p, n, sum);
+
+            T inv = TReal<T>::ONE / T((int32_t)n);
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                m[k] = sum[k] * inv;
+            }
+
+            momentKernel(p, n, m, &moments[c * 6]);
+        });
+
+        T total[3] = { TReal<T>::ZERO, TReal<T>::ZERO, TReal<T>::ZERO };
+
+        for (size_t c = 0; c < chunks; ++c)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                total[k] += sums[c * 3 + k];
+            }
+        }
+
+        T inv = TReal<T>::ONE / T((int32_t)count);
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            mean[k] = total[k] * inv;
+        }
+
+        // 总的离差乘积 = 各块的离差乘积 + 块内点数 * 块均值相对总均值的偏移乘积
+        T m[6] = { TReal<T>::ZERO, TReal<T>::ZERO, TReal<T>::ZERO,
+            TReal<T>::ZERO, TReal<T>::ZERO, TReal<T>::ZERO };
+
+        for (size_t c = 0; c < chunks; ++c)
+        {
+            size_t begin = c * CHUNK_SIZE;
+            T n((int32_t)(std::min(count, begin + CHUNK_SIZE) - begin));
+            T dx = means[c * 3 + 0] - mean[0];
+            T dy = means[c * 3 + 1] - mean[1];
+            T dz = means[c * 3 + 2] - mean[2];
+            const T *mc = &moments[c * 6];
+
+            m[0] += mc[0] + n * dx * dx;
+            m[1] += mc[1] + n * dx * dy;
+            m[2] += mc[2] + n * dx * dz;
+            m[3] += mc[3] + n * dy * dy;
+            m[4] += mc[4] + n * dy * dz;
+            m[5] += mc[5] + n * dz * dz;
+        }
+
+        covariance[0][0] = m[0] * inv;
+        covariance[0][1] = covariance[1][0] = m[1] * inv;
+        covariance[0][2] = covariance[2][0] = m[2] * inv;
+        covariance[1][1] = m[3] * inv;
+        covariance[1][2] = covariance[2][1] = m[4] * inv;
+        covariance[2][2] = m[5] * inv;
+    }
+
+    template <typename T>
+    void TBoundingBatch<T>::computeProjectedBounds(const TVector3<T> *points,
+        size_t count, const TVector3<T> axis[3], TVector3<T> &vMin,
+        TVector3<T> &vMax, size_t threads)
+    {
+        size_t chunks = getChunkCount(count);
+        TArray<T> mins(chunks * 3), maxs(chunks * 3);
+
+        runChunks(count, threads, [&](size_t c, size_t begin, size_t end)
+        {
+            projectKernel(points + begin, end - begin, axis, &mins[c * 3],
+                &maxs[c * 3]);
+        });
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            vMin[k] = TReal<T>::INF;
+            vMax[k] = TReal<T>::MINUS_INF;
+        }
+
+        for (size_t c = 0; c < chunks; ++c)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                vMin[k] = TMath<T>::min(vMin[k], mins[c * 3 + k]);
+                vMax[k] = TMath<T>::max(vMax[k], maxs[c * 3 + k]);
+            }
+        }
+    }
+
+    template <typename T>
+    void TBoundingBatch<T>::computeFarthestPoints(const TVector3<T> *points,
+        size_t count, const TVector3<T> &center, size_t *indices,
+        T *distances2, size_t threads)
+    {
+        T c[3] = { center[0], center[1], center[2] };
+
+        runChunks(count, threads, [&](size_t chunk, size_t begin, size_t end)
+        {
+            indices[chunk] = begin + farthestKernel(points + begin,
+                end - begin, c, distances2[chunk]);
+        });
+    }
+
+    //--------------------------------------------------------------------------
+    // 通用的逐点计算
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline void TBoundingBatch<T>::boundsKernel(const TVector3<T> *points,
+        size_t count, T mins[3], T maxs[3])
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            mins[k] = TReal<T>::INF;
+            maxs[k] = TReal<T>::MINUS_INF;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                mins[k] = TMath<T>::min(mins[k], points[i][k]);
+                maxs[k] = TMath<T>::max(maxs[k], points[i][k]);
+            }
+        }
+    }
+
+    template <typename T>
+    inline void TBoundingBatch<T>::sumKernel(const TVector3<T> *points,
+        size_t count, T sum[3])
+    {
+        sum[0] = sum[1] = sum[2] = TReal<T>::ZERO;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            sum[0] += points[i][0];
+            sum[1] += points[i][1];
+            sum[2] += points[i][2];
+        }
+    }
+
+    template <typename T>
+    inline void TBoundingBatch<T>::momentKernel(const TVector3<T> *points,
+        size_t count, const T mean[3], T moments[6])
+    {
+        for (int32_t k = 0; k < 6; ++k)
+        {
+            moments[k] = TReal<T>::ZERO;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            T dx = points[i][0] - mean[0];
+            T dy = points[i][1] - mean[1];
+            T dz = points[i][2] - mean[2];
+
+            moments[0] += dx * dx;
+            moments[1] += dx * dy;
+            moments[2] += dx * dz;
+            moments[3] += dy * dy;
+            moments[4] += dy * dz;
+            moments[5] += dz * dz;
+        }
+    }
+
+    template <typename T>
+    inline void TBoundingBatch<T>::projectKernel(const TVector3<T> *points,
+        size_t count, const TVector3<T> axis[3], T mins[3], T maxs[3])
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            mins[k] = TReal<T>::INF;
+            maxs[k] = TReal<T>::MINUS_INF;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                T d = points[i].dot(axis[k]);
+                mins[k] = TMath<T>::min(mins[k], d);
+                maxs[k] = TMath<T>::max(maxs[k], d);
+            }
+        }
+    }
+
+    template <typename T>
+    inline size_t TBoundingBatch<T>::farthestKernel(const TVector3<T> *points,
+        size_t count, const T center[3], T &distance2)
+    {
+        return farthestScalar(points, count, center, distance2);
+    }
+
+    template <typename T>
+    inline size_t TBoundingBatch<T>::farthestScalar(const TVector3<T> *points,
+        size_t count, const T center[3], T &distance2)
+    {
+        size_t index = 0;
+        distance2 = TReal<T>::MINUS_ONE;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            T dx = points[i][0] - center[0];
+            T dy = points[i][1] - center[1];
+            T dz = points[i][2] - center[2];
+            T d2 = dx * dx + dy * dy + dz * dz;
+
+            if (d2 > distance2)
+            {
+                distance2 = d2;
+                index = i;
+            }
+        }
+
+        return index;
+    }
+
+#if defined (T3D_SIMD)
+    //--------------------------------------------------------------------------
+    // float32_t 每次处理 4 个点，TVector3<float32_t> 是 3 个连续的 float，
+    // 4 个点正好 12 个 float，用 simdLoadXYZ4 转成按分量存放
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline void TBoundingBatch<float32_t>::boundsKernel(
+        const TVector3<float32_t> *points, size_t count, float32_t mins[3],
+        float32_t maxs[3])
+    {
+        SIMDFloat4 minX = simdSplat(TReal<float32_t>::INF);
+        SIMDFloat4 minY = minX, minZ = minX;
+        SIMDFloat4 maxX = simdSplat(TReal<float32_t>::MINUS_INF);
+        SIMDFloat4 maxY = maxX, maxZ = maxX;
+
+        const float32_t *src = (const float32_t *)points;
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 12)
+        {
+            SIMDFloat4 x, y, z;
+            simdLoadXYZ4(src, x, y, z);
+            minX = simdMin(minX, x);
+            minY = simdMin(minY, y);
+            minZ = simdMin(minZ, z);
+            maxX = simdMax(maxX, x);
+            maxY = simdMax(maxY, y);
+            maxZ = simdMax(maxZ, z);
+        }
+
+        mins[0] = simdHorizontalMin(minX);
+        mins[1] = simdHorizontalMin(minY);
+        mins[2] = simdHorizontalMin(minZ);
+        maxs[0] = simdHorizontalMax(maxX);
+        maxs[1] = simdHorizontalMax(maxY);
+        maxs[2] = simdHorizontalMax(maxZ);
+
+        for (; i < count; ++i)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                mins[k] = std::min(mins[k], points[i][k]);
+                maxs[k] = std::max(maxs[k], points[i][k]);
+            }
+        }
+    }
+
+    template <>
+    inline void TBoundingBatch<float32_t>::sumKernel(
+        const TVector3<float32_t> *points, size_t count, float32_t sum[3])
+    {
+        SIMDFloat4 sx = simdSplat(0.0f), sy = sx, sz = sx;
+        const float32_t *src = (const float32_t *)points;
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 12)
+        {
+            SIMDFloat4 x, y, z;
+            simdLoadXYZ4(src, x, y, z);
+            sx = simdAdd(sx, x);
+            sy = simdAdd(sy, y);
+            sz = simdAdd(sz, z);
+        }
+
+        sum[0] = simdHorizontalSum(sx);
+        sum[1] = simdHorizontalSum(sy);
+        sum[2] = simdHorizontalSum(sz);
+
+        for (; i < count; ++i)
+        {
+            sum[0] += points[i][0];
+            sum[1] += points[i][1];
+            sum[2] += points[i][2];
+        }
+    }
+
+    template <>
+    inline void TBoundingBatch<float32_t>::momentKernel(
+        const TVector3<float32_t> *points, size_t count,
+        const float32_t mean[3], float32_t moments[6])
+    {
+        const SIMDFloat4 mx = simdSplat(mean[0]);
+        const SIMDFloat4 my = simdSplat(mean[1]);
+        const SIMDFloat4 mz = simdSplat(mean[2]);
+        SIMDFloat4 xx = simdSplat(0.0f), xy = xx, xz = xx;
+        SIMDFloat4 yy = xx, yz = xx, zz = xx;
+
+        const float32_t *src = (const float32_t *)points;
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 12)
+        {
+            SIMDFloat4 x, y, z;
+            simdLoadXYZ4(src, x, y, z);
+            x = simdSub(x, mx);
+            y = simdSub(y, my);
+            z = simdSub(z, mz);
+            xx = simdMulAdd(x, x, xx);
+            xy = simdMulAdd(x, y, xy);
+            xz = simdMulAdd(x, z, xz);
+            yy = simdMulAdd(y, y, yy);
+            yz = simdMulAdd(y, z, yz);
+            zz = simdMulAdd(z, z, zz);
+        }
+
+        moments[0] = simdHorizontalSum(xx);
+        moments[1] = simdHorizontalSum(xy);
+        moments[2] = simdHorizontalSum(xz);
+        moments[3] = simdHorizontalSum(yy);
+        moments[4] = simdHorizontalSum(yz);
+        moments[5] = simdHorizontalSum(zz);
+
+        for (; i < count; ++i)
+        {
+            float32_t dx = points[i][0] - mean[0];
+            float32_t dy = points[i][1] - mean[1];
+            float32_t dz = points[i][2] - mean[2];
+
+            moments[0] += dx * dx;
+            moments[1] += dx * dy;
+            moments[2] += dx * dz;
+            moments[3] += dy * dy;
+            moments[4] += dy * dz;
+            moments[5] += dz * dz;
+        }
+    }
+
+    template <>
+    inline void TBoundingBatch<float32_t>::projectKernel(
+        const TVector3<float32_t> *points, size_t count,
+        const TVector3<float32_t> axis[3], float32_t mins[3],
+        float32_t maxs[3])
+    {
+        SIMDFloat4 ax[3], ay[3], az[3], lo[3], hi[3];
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            ax[k] = simdSplat(axis[k][0]);
+            ay[k] = simdSplat(axis[k][1]);
+            az[k] = simdSplat(axis[k][2]);
+            lo[k] = simdSplat(TReal<float32_t>::INF);
+            hi[k] = simdSplat(TReal<float32_t>::MINUS_INF);
+        }
+
+        const float32_t *src = (const float32_t *)points;
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 12)
+        {
+            SIMDFloat4 x, y, z;
+            simdLoadXYZ4(src, x, y, z);
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                SIMDFloat4 d = simdMulAdd(z, az[k],
+                    simdMulAdd(y, ay[k], simdMul(x, ax[k])));
+                lo[k] = simdMin(lo[k], d);
+                hi[k] = simdMax(hi[k], d);
+            }
+        }
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            mins[k] = simdHorizontalMin(lo[k]);
+            maxs[k] = simdHorizontalMax(hi[k]);
+        }
+
+        for (; i < count; ++i)
+        {
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                float32_t d = points[i].dot(axis[k]);
+                mins[k] = std::min(mins[k], d);
+                maxs[k] = std::max(maxs[k], d);
+            }
+        }
+    }
+
+    template <>
+    inline size_t TBoundingBatch<float32_t>::farthestKernel(
+        const TVector3<float32_t> *points, size_t count,
+        const float32_t center[3], float32_t &distance2)
+    {
+        // 先按 64 个点一段求出最大距离所在的段，再在那一段里逐点找下标。
+        // 逐点计算的运算顺序和 SIMD 一样，结果完全相同
+        const size_t BLOCK_SIZE = 64;
+        const SIMDFloat4 cx = simdSplat(center[0]);
+        const SIMDFloat4 cy = simdSplat(center[1]);
+        const SIMDFloat4 cz = simdSplat(center[2]);
+
+        float32_t best = -1.0f;
+        size_t bestBlock = 0;
+        size_t blocks = count / BLOCK_SIZE;
+        const float32_t *src = (const float32_t *)points;
+
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            SIMDFloat4 blockMax = simdSplat(-1.0f);
+
+            for (size_t i = 0; i < BLOCK_SIZE; i += 4, src += 12)
+            {
+                SIMDFloat4 x, y, z;
+                simdLoadXYZ4(src, x, y, z);
+                x = simdSub(x, cx);
+                y = simdSub(y, cy);
+                z = simdSub(z, cz);
+                SIMDFloat4 d2 = simdAdd(simdAdd(simdMul(x, x), simdMul(y, y)),
+                    simdMul(z, z));
+                blockMax = simdMax(blockMax, d2);
+            }
+
+            float32_t m = simdHorizontalMax(blockMax);
+            if (m > best)
+            {
+                best = m;
+                bestBlock = b;
+            }
+        }
+
+        size_t index = 0;
+        distance2 = -1.0f;
+
+        if (blocks > 0)
+        {
+            index = bestBlock * BLOCK_SIZE + farthestScalar(
+                points + bestBlock * BLOCK_SIZE, BLOCK_SIZE, center, distance2);
+        }
+
+        // 剩下不满一段的点
+        size_t tail = blocks * BLOCK_SIZE;
+        float32_t d2;
+        size_t i = tail + farthestScalar(points + tail, count - tail,
+            center, d2);
+
+        if (d2 > distance2)
+        {
+            distance2 = d2;
+            index = i;
+        }
+
+        return index;
+    }
+#endif  /*T3D_SIMD*/
+}
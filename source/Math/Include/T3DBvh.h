@@ -0,0 +1,323 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_BVH_H__
+#define __T3D_BVH_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DMath.h"
+#include "T3DMathSIMD.h"
+#include "T3DRay.h"
+#include "T3DAabb.h"
+#include "T3DTriangle.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 层次包围盒（Bounding Volume Hierarchy），用于射线拾取加速
+     * @remarks 图元可以是 TAabb（场景物体）或者 TTriangle（网格）。
+     *
+     *      构建使用分桶的 SAH（Surface Area Heuristic），每个节点沿中心点分布
+     *      最长的轴分 BIN_COUNT 个桶选代价最小的划分，孩子的包围盒由桶合并
+     *      得到，不用再扫一遍图元。图元很多时顶层几层的分桶分给多个线程做，
+     *      下面的子树作为独立任务并行构建，最后拼接到同一个节点数组里。
+     *
+     *      节点按数组平铺存放，两个孩子总是相邻，float32_t 时每个节点 32 字节，
+     *      两个孩子正好占一条 64 字节的缓存行。孩子的下标总比父节点大，refit
+     *      只要倒序扫一遍节点数组。
+     *
+     *      射线语义和 TRay 一致，交点为 P + t * D，0 <= t <= 1。三角形和
+     *      TIntrRayTriangle 一样只跟正面（逆时针）相交。
+     *
+     *      射线包一次最多 MAX_PACKET_SIZE 条射线共用一次遍历，适合相机发出的
+     *      方向相近的射线，float32_t 开启 SIMD 时包围盒和三角形检测每次处理
+     *      4 条射线。
+     */
+    template <typename T>
+    class TBvh
+    {
+    public:
+        /// 没有相交时 Hit::primitive 的值
+        static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+        /// 射线包最多的射线条数
+        static const size_t MAX_PACKET_SIZE = 8;
+
+        /// SAH 每个轴上的桶数
+        static const uint32_t BIN_COUNT = 16;
+
+        /// 平铺的节点
+        struct Node
+        {
+            T           mins[3];
+            /// 内部节点是左孩子的下标，右孩子紧跟在后面；叶子是第一个图元的位置
+            uint32_t    offset;
+            T           maxs[3];
+            /// 叶子里的图元个数，内部节点为 0
+            uint32_t    count;
+        };
+
+        /// 射线的最近交点
+        struct Hit
+        {
+            T           t;          /// 交点参数，交点 = 原点 + t * 方向
+            T           u;          /// 三角形重心坐标，图元是 AABB 时为 0
+            T           v;
+            uint32_t    primitive;  /// 图元在构建时数组里的下标
+        };
+
+        TBvh();
+
+        /**
+         * @brief 以 AABB 为图元构建
+         * @param [in] boxes : 图元包围盒数组
+         * @param [in] count : 图元个数
+         * @param [in] maxLeafSize : 叶子最多的图元个数
+         * @param [in] threads : 构建线程数，0 表示使用所有硬件线程
+         */
+        void build(const TAabb<T> *boxes, size_t count,
+            size_t maxLeafSize = 4, size_t threads = 0);
+
+        /// 以三角形为图元构建，参数同上
+        void build(const TTriangle<T> *triangles, size_t count,
+            size_t maxLeafSize = 4, size_t threads = 0);
+
+        /**
+         * @brief 图元移动以后重新计算节点包围盒，树的结构不变
+         * @remarks 数组的顺序和个数必须和构建时一样。物体移动幅度很大时树的
+         *      质量会下降，这时应该重新构建。
+         */
+        void refit(const TAabb<T> *boxes);
+
+        /// 三角形版本的 refit
+        void refit(const TTriangle<T> *triangles);
+
+        /// 清空
+        void clear();
+
+        /// 求射线的最近交点
+        bool intersect(const TRay<T> &ray, Hit &hit) const;
+
+        /// 只判断射线是否和任意图元相交，找到一个就返回，用于遮挡检测
+        bool intersectAny(const TRay<T> &ray) const;
+
+        /**
+         * @brief 射线包求最近交点
+         * @param [in] rays : 射线数组，超过 MAX_PACKET_SIZE 条时分成多个包
+         * @param [in] count : 射线条数
+         * @param [out] hits : 每条射线的交点，没有相交时 primitive 为 INVALID_INDEX
+         * @return 有交点的射线条数
+         */
+        size_t intersect(const TRay<T> *rays, size_t count, Hit *hits) const;
+
+        /// 射线包的遮挡检测，hits[i] 返回第 i 条射线是否相交，返回相交的条数
+        size_t intersectAny(const TRay<T> *rays, size_t count,
+            bool *hits) const;
+
+        /// 节点数组，第 0 个是根节点
+        const Node *getNodes() const
+        {
+            return mNodes.empty() ? nullptr : &mNodes[0];
+        }
+
+        size_t getNodeCount() const
+        {
+            return mNodes.size();
+        }
+
+        size_t getPrimitiveCount() const
+        {
+            return mIndices.size();
+        }
+
+        /**
+         * @brief 叶子里图元的原始下标
+         * @remarks 叶子节点的图元是 getPrimitiveIndices()[offset] 到
+         *      getPrimitiveIndices()[offset + count - 1]
+         */
+        const uint32_t *getPrimitiveIndices() const
+        {
+            return mIndices.empty() ? nullptr : &mIndices[0];
+        }
+
+    protected:
+        enum PrimitiveType
+        {
+            E_PRIMITIVE_NONE = 0,
+            E_PRIMITIVE_AABB,
+            E_PRIMITIVE_TRIANGLE,
+        };
+
+        /// 按叶子顺序存放的 AABB 图元
+        struct BoxData
+        {
+            T   mins[3];
+            T   maxs[3];
+        };
+
+        /// 按叶子顺序存放的三角形图元，预先算好两条边
+        struct TriangleData
+        {
+            T   v0[3];
+            T   e1[3];
+            T   e2[3];
+        };
+
+        /// 构建时每个图元的包围盒和中心
+        struct BuildItem
+        {
+            T   mins[3];
+            T   maxs[3];
+            T   center[3];
+        };
+
+        /// 一组图元的包围盒、中心点的包围盒和个数，也用作 SAH 的桶
+        struct RangeBounds
+        {
+            T           mins[3];
+            T           maxs[3];
+            T           centerMins[3];
+            T           centerMaxs[3];
+            uint32_t    count;
+        };
+
+        /// 留到最后并行构建的子树
+        struct BuildTask
+        {
+            uint32_t    node;
+            uint32_t    begin;
+            uint32_t    end;
+            uint32_t    depth;
+            RangeBounds bounds;
+        };
+
+        struct BuildContext
+        {
+            const BuildItem *items;
+            uint32_t        *indices;
+            size_t          maxLeafSize;
+            size_t          threads;
+            /// 图元数不超过这个值的子树作为并行任务
+            uint32_t        taskSize;
+            TArray<BuildTask> *tasks;
+        };
+
+        /// 射线和射线包遍历时用的数据
+        struct RayData
+        {
+            T   origin[3];
+            T   dir[3];
+            T   invDir[3];
+        };
+
+        struct Packet
+        {
+            T   ox[MAX_PACKET_SIZE], oy[MAX_PACKET_SIZE], oz[MAX_PACKET_SIZE];
+            T   dx[MAX_PACKET_SIZE], dy[MAX_PACKET_SIZE], dz[MAX_PACKET_SIZE];
+            T   ix[MAX_PACKET_SIZE], iy[MAX_PACKET_SIZE], iz[MAX_PACKET_SIZE];
+            T   tMax[MAX_PACKET_SIZE];
+            uint32_t primitive[MAX_PACKET_SIZE];
+            T   u[MAX_PACKET_SIZE], v[MAX_PACKET_SIZE];
+        };
+
+        /// 超过 SAH_DEPTH_LIMIT 层以后改成按中位数划分，保证深度不超过遍历栈
+        static const uint32_t SAH_DEPTH_LIMIT = 32;
+        static const uint32_t STACK_SIZE = 64;
+
+        /// 图元数超过这个值的节点，包围盒统计和分桶分给多个线程做
+        static const uint32_t PARALLEL_SIZE = 65536;
+
+        /// 在 threads 个线程上运行 func(i)，i 是线程序号，第 0 个在当前线程运行
+        template <typename Func>
+        static void parallelRun(size_t threads, const Func &func);
+
+        void buildItems(const TArray<BuildItem> &items, size_t maxLeafSize,
+            size_t threads);
+
+        void buildNode(BuildContext &ctx, TArray<Node> &nodes, uint32_t index,
+            uint32_t begin, uint32_t end, uint32_t depth,
+            const RangeBounds &bounds) const;
+
+        void computeBounds(const BuildContext &ctx, uint32_t begin,
+            uint32_t end, RangeBounds &bounds) const;
+
+        /// 按中心点在 axis 轴上的位置分桶，同时统计每个桶的包围盒
+        void computeBins(const BuildContext &ctx, uint32_t begin, uint32_t end,
+            int32_t axis, T centerMin, T scale,
+            RangeBounds bins[BIN_COUNT]) const;
+
+        static void resetBounds(RangeBounds &bounds);
+
+        static void growBounds(RangeBounds &bounds, const BuildItem &item);
+
+        static void mergeBounds(RangeBounds &bounds, const RangeBounds &other);
+
+        void makeLeaf(Node &node, uint32_t begin, uint32_t end) const;
+
+        void refitNodes();
+
+        static void setupRay(const TRay<T> &ray, RayData &data);
+
+        static T safeInverse(T d);
+
+        static float32_t halfArea(const T mins[3], const T maxs[3]);
+
+        /// 射线和节点包围盒检测，tNear 返回进入包围盒的 t
+        static bool intersectNode(const Node &node, const RayData &ray, T tMax,
+            T &tNear);
+
+        static bool intersectBox(const BoxData &box, const RayData &ray,
+            T tMax, T &t);
+
+        static bool intersectTriangle(const TriangleData &tri,
+            const T origin[3], const T dir[3], T tMax, T &t, T &u, T &v);
+
+        static uint32_t binIndex(T center, T centerMin, T scale);
+
+        static void getLane(const Packet &packet, size_t lane, RayData &ray);
+
+        bool intersectLeaf(const Node &node, const RayData &ray, Hit &hit,
+            bool any) const;
+
+        size_t intersectPacket(const TRay<T> *rays, size_t count, Hit *hits,
+            bool any) const;
+
+        /// 射线包和节点包围盒检测，返回 mask 里相交的射线
+        uint32_t intersectNodePacket(const Node &node, const Packet &packet,
+            uint32_t mask) const;
+
+        /// 射线包和一个三角形检测，更新交点，返回 mask 里相交的射线
+        uint32_t intersectTrianglePacket(const TriangleData &tri,
+            uint32_t primitive, Packet &packet, uint32_t mask) const;
+
+        TArray<Node>            mNodes;
+        TArray<uint32_t>        mIndices;
+        TArray<BoxData>         mBoxes;
+        TArray<TriangleData>    mTriangles;
+        PrimitiveType           mType;
+    };
+}
+
+
+#include "T3DBvh.inl"
+
+
+#endif  /*__T3D_BVH_H__*/
@@ -0,0 +1,1358 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const uint32_t TBvh<T>::INVALID_INDEX;
+
+    template <typename T>
+    const size_t TBvh<T>::MAX_PACKET_SIZE;
+
+    template <typename T>
+    const uint32_t TBvh<T>::BIN_COUNT;
+
+    template <typename T>
+    const uint32_t TBvh<T>::SAH_DEPTH_LIMIT;
+
+    template <typename T>
+    const uint32_t TBvh<T>::STACK_SIZE;
+
+    template <typename T>
+    const uint32_t TBvh<T>::PARALLEL_SIZE;
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline TBvh<T>::TBvh()
+        : mType(E_PRIMITIVE_NONE)
+    {
+
+    }
+
+    template <typename T>
+    inline void TBvh<T>::clear()
+    {
+        mNodes.clear();
+        mIndices.clear();
+        mBoxes.clear();
+        mTriangles.clear();
+        mType = E_PRIMITIVE_NONE;
+    }
+
+    //--------------------------------------------------------------------------
+    // 构建
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    void TBvh<T>::build(const TAabb<T> *boxes, size_t count,
+        size_t maxLeafSize /* = 4 */, size_t threads /* = 0 */)
+    {
+        clear();
+        mType = E_PRIMITIVE_AABB;
+
+        TArray<BuildItem> items(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            BuildItem &item = items[i];
+            item.mins[0] = boxes[i].getMinX();
+            item.mins[1] = boxes[i].getMinY();
+            item.mins[2] = boxes[i].getMinZ();
+            item.maxs[0] = boxes[i].getMaxX();
+            item.maxs[1] = boxes[i].getMaxY();
+            item.maxs[2] = boxes[i].getMaxZ();
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                item.center[k] = (item.mins[k] + item.maxs[k]) * TReal<T>::HALF;
+            }
+        }
+
+        buildItems(items, maxLeafSize, threads);
+
+        mBoxes.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const BuildItem &item = items[mIndices[i]];
+            BoxData &box = mBoxes[i];
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                box.mins[k] = item.mins[k];
+                box.maxs[k] = item.maxs[k];
+            }
+        }
+    }
+
+    template <typename T>
+    void TBvh<T>::build(const TTriangle<T> *triangles, size_t count,
+        size_t maxLeafSize /* = 4 */, size_t threads /* = 0 */)
+    {
+        clear();
+        mType = E_PRIMITIVE_TRIANGLE;
+
+        TArray<BuildItem> items(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const TTriangle<T> &tri = triangles[i];
+            BuildItem &item = items[i];
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                item.mins[k] = TMath<T>::min(tri[0][k],
+                    TMath<T>::min(tri[1][k], tri[2][k]));
+                item.maxs[k] = TMath<T>::max(tri[0][k],
+                    TMath<T>::max(tri[1][k], tri[2][k]));
+                item.center[k] = (item.mins[k] + item.maxs[k]) * TReal<T>::HALF;
+            }
+        }
+
+        buildItems(items, maxLeafSize, threads);
+
+        // 图元按叶子的顺序重新存放，遍历叶子时是连续访问
+        mBoxes.resize(count);
+        mTriangles.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t index = mIndices[i];
+            const TTriangle<T> &tri = triangles[index];
+            const BuildItem &item = items[index];
+            BoxData &box = mBoxes[i];
+            TriangleData &data = mTriangles[i];
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                box.mins[k] = item.mins[k];
+                box.maxs[k] = item.maxs[k];
+                data.v0[k] = tri[0][k];
+                data.e1[k] = tri[1][k] - tri[0][k];
+                data.e2[k] = tri[2][k] - tri[0][k];
+            }
+        }
+    }
+
+    template <typename T>
+    template <typename Func>
+    inline void TBvh<T>::parallelRun(size_t threads, const Func &func)
+    {
+        TArray<TThread> workers;
+
+        for (size_t i = 1; i < threads; ++i)
+        {
+            workers.push_back(TThread(func, i));
+        }
+
+        func(0);
+
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i].join();
+        }
+    }
+
+    template <typename T>
+    void TBvh<T>::buildItems(const TArray<BuildItem> &items,
+        size_t maxLeafSize, size_t threads)
+    {
+        size_t count = items.size();
+        mIndices.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            mIndices[i] = (uint32_t)i;
+        }
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (threads == 0)
+        {
+            threads = TThread::hardware_concurrency();
+        }
+
+        if (threads == 0 || count < PARALLEL_SIZE)
+        {
+            threads = 1;
+        }
+
+        TArray<BuildTask> tasks;
+
+        BuildContext ctx;
+        ctx.items = &items[0];
+        ctx.indices = &mIndices[0];
+        ctx.maxLeafSize = maxLeafSize > 0 ? maxLeafSize : 1;
+        ctx.threads = threads;
+        // 每个线程大约分到 4 个子树，负载不均时有余地
+        ctx.taskSize = (uint32_t)(count / (threads * 4));
+        ctx.tasks = (threads > 1 ? &tasks : nullptr);
+
+        RangeBounds bounds;
+        computeBounds(ctx, 0, (uint32_t)count, bounds);
+
+        mNodes.reserve(count * 2 / ctx.maxLeafSize + 1);
+        mNodes.resize(1);
+        buildNode(ctx, mNodes, 0, 0, (uint32_t)count, 0, bounds);
+
+        if (tasks.empty())
+        {
+            return;
+        }
+
+        // 大的子树先分，每次分给当前负载最小的线程
+        std::sort(tasks.begin(), tasks.end(),
+            [](const BuildTask &a, const BuildTask &b)
+        {
+            return (a.end - a.begin) > (b.end - b.begin);
+        });
+
+        TArray<TArray<size_t>> assignments(threads);
+        TArray<size_t> loads(threads, 0);
+
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            size_t t = std::min_element(loads.begin(), loads.end())
+                - loads.begin();
+            assignments[t].push_back(i);
+            loads[t] += tasks[i].end - tasks[i].begin;
+        }
+
+        // 每个子树构建到自己的节点数组里，下标 0 是子树的根
+        TArray<TArray<Node>> subtrees(tasks.size());
+
+        parallelRun(threads, [&](size_t t)
+        {
+            BuildContext local = ctx;
+            local.threads = 1;
+            local.tasks = nullptr;
+
+            for (size_t i = 0; i < assignments[t].size(); ++i)
+            {
+                const BuildTask &task = tasks[assignments[t][i]];
+                TArray<Node> &nodes = subtrees[assignments[t][i]];
+                nodes.reserve((task.end - task.begin) * 2 / local.maxLeafSize + 1);
+                nodes.resize(1);
+                buildNode(local, nodes, 0, task.begin, task.end, task.depth,
+                    task.bounds);
+            }
+        });
+
+        // 拼接：子树的根放到占位节点上，其余节点追加到数组末尾，
+        // 子树里第 i 个节点的新下标是 base + i - 1
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            TArray<Node> &nodes = subtrees[i];
+            uint32_t base = (uint32_t)mNodes.size();
+
+            for (size_t j = 0; j < nodes.size(); ++j)
+            {
+                if (nodes[j].count == 0)
+                {
+                    nodes[j].offset = base + nodes[j].offset - 1;
+                }
+            }
+
+            mNodes[tasks[i].node] = nodes[0];
+            mNodes.insert(mNodes.end(), nodes.begin() + 1, nodes.end());
+        }
+    }
+
+    template <typename T>
+    void TBvh<T>::buildNode(BuildContext &ctx, TArray<Node> &nodes,
+        uint32_t index, uint32_t begin, uint32_t end, uint32_t depth,
+        const RangeBounds &bounds) const
+    {
+        uint32_t count = end - begin;
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            nodes[index].mins[k] = bounds.mins[k];
+            nodes[index].maxs[k] = bounds.maxs[k];
+        }
+
+        if (count <= 1)
+        {
+            makeLeaf(nodes[index], begin, end);
+            return;
+        }
+
+        if (ctx.tasks != nullptr && count <= ctx.taskSize
+            && count > ctx.maxLeafSize)
+        {
+            // 子树留给后面并行构建，这里先占位
+            BuildTask task = { index, begin, end, depth, bounds };
+            ctx.tasks->push_back(task);
+            return;
+        }
+
+        int32_t axis = 0;
+        T extent = bounds.centerMaxs[0] - bounds.centerMins[0];
+
+        for (int32_t k = 1; k < 3; ++k)
+        {
+            T e = bounds.centerMaxs[k] - bounds.centerMins[k];
+            if (e > extent)
+            {
+                extent = e;
+                axis = k;
+            }
+        }
+
+        const BuildItem *items = ctx.items;
+        uint32_t *indices = ctx.indices;
+        uint32_t mid = begin + count / 2;
+        RangeBounds left, right;
+        bool hasBounds = false;
+
+        if (extent <= TReal<T>::ZERO)
+        {
+            // 所有中心点重合，没法按位置划分，图元不多就直接做叶子
+            if (count <= ctx.maxLeafSize)
+            {
+                makeLeaf(nodes[index], begin, end);
+                return;
+            }
+        }
+        else if (depth >= SAH_DEPTH_LIMIT)
+        {
+            // 太深了，按中位数对半分，保证剩下的深度是对数级的
+            std::nth_element(indices + begin, indices + mid, indices + end,
+                [items, axis](uint32_t a, uint32_t b)
+            {
+                return items[a].center[axis] < items[b].center[axis];
+            });
+        }
+        else
+        {
+            // 乘一个略小于 1 的系数，中心点在最大值上的图元也落在最后一个桶里
+            T centerMin = bounds.centerMins[axis];
+            T scale = T((int32_t)BIN_COUNT) * T(0.9999f) / extent;
+            RangeBounds bins[BIN_COUNT];
+            computeBins(ctx, begin, end, axis, centerMin, scale, bins);
+
+            // 从右往左累计，rightCost[i] 是第 i 个桶及其右边的代价
+            float32_t rightCost[BIN_COUNT];
+            RangeBounds accum;
+            resetBounds(accum);
+
+            for (uint32_t i = BIN_COUNT - 1; i > 0; --i)
+            {
+                mergeBounds(accum, bins[i]);
+                rightCost[i] = (accum.count > 0)
+                    ? halfArea(accum.mins, accum.maxs) * accum.count : 0.0f;
+            }
+
+            float32_t bestCost = std::numeric_limits<float32_t>::max();
+            uint32_t bestSplit = 0;
+            resetBounds(accum);
+
+            for (uint32_t i = 1; i < BIN_COUNT; ++i)
+            {
+                mergeBounds(accum, bins[i - 1]);
+
+                if (accum.count == 0 || accum.count == count)
+                    continue;
+
+                float32_t cost = halfArea(accum.mins, accum.maxs) * accum.count
+                    + rightCost[i];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = i;
+                }
+            }
+
+            // 遍历一个节点的代价按求交一个图元的一半估计
+            float32_t area = halfArea(bounds.mins, bounds.maxs);
+            float32_t splitCost = (area > 0.0f)
+                ? 0.5f + bestCost / area : (float32_t)count;
+
+            if (bestSplit == 0 || (splitCost >= (float32_t)count
+                && count <= ctx.maxLeafSize))
+            {
+                if (count <= ctx.maxLeafSize)
+                {
+                    makeLeaf(nodes[index], begin, end);
+                    return;
+                }
+            }
+            else
+            {
+                uint32_t *p = std::partition(indices + begin, indices + end,
+                    [=](uint32_t i)
+                {
+                    return binIndex(items[i].center[axis], centerMin, scale)
+                        < bestSplit;
+                });
+
+                mid = (uint32_t)(p - indices);
+
+                resetBounds(left);
+                resetBounds(right);
+
+                for (uint32_t i = 0; i < BIN_COUNT; ++i)
+                {
+                    mergeBounds(i < bestSplit ? left : right, bins[i]);
+                }
+
+                hasBounds = true;
+            }
+        }
+
+        if (!hasBounds)
+        {
+            computeBounds(ctx, begin, mid, left);
+            computeBounds(ctx, mid, end, right);
+        }
+
+        uint32_t child = (uint32_t)nodes.size();
+        nodes.resize(child + 2);
+        nodes[index].offset = child;
+        nodes[index].count = 0;
+
+        buildNode(ctx, nodes, child, begin, mid, depth + 1, left);
+        buildNode(ctx, nodes, child + 1, mid, end, depth + 1, right);
+    }
+
+    template <typename T>
+    inline void TBvh<T>::resetBounds(RangeBounds &bounds)
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            bounds.mins[k] = bounds.centerMins[k] = TReal<T>::INF;
+            bounds.maxs[k] = bounds.centerMaxs[k] = TReal<T>::MINUS_INF;
+        }
+
+        bounds.count = 0;
+    }
+
+    template <typename T>
+    inline void TBvh<T>::growBounds(RangeBounds &bounds, const BuildItem &item)
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            bounds.mins[k] = TMath<T>::min(bounds.mins[k], item.mins[k]);
+            bounds.maxs[k] = TMath<T>::max(bounds.maxs[k], item.maxs[k]);
+            bounds.centerMins[k] = TMath<T>::min(bounds.centerMins[k],
+                item.center[k]);
+            bounds.centerMaxs[k] = TMath<T>::max(bounds.centerMaxs[k],
+                item.center[k]);
+        }
+
+        bounds.count++;
+    }
+
+    template <typename T>
+    inline void TBvh<T>::mergeBounds(RangeBounds &bounds,
+        const RangeBounds &other)
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            bounds.mins[k] = TMath<T>::min(bounds.mins[k], other.mins[k]);
+            bounds.maxs[k] = TMath<T>::max(bounds.maxs[k], other.maxs[k]);
+            bounds.centerMins[k] = TMath<T>::min(bounds.centerMins[k],
+                other.centerMins[k]);
+            bounds.centerMaxs[k] = TMath<T>::max(bounds.centerMaxs[k],
+                other.centerMaxs[k]);
+        }
+
+        bounds.count += other.count;
+    }
+
+    template <typename T>
+    void TBvh<T>::computeBounds(const BuildContext &ctx, uint32_t begin,
+        uint32_t end, RangeBounds &bounds) const
+    {
+        uint32_t count = end - begin;
+        size_t threads = (count < PARALLEL_SIZE ? 1 : ctx.threads);
+        TArray<RangeBounds> partial(threads);
+
+        parallelRun(threads, [&](size_t t)
+        {
+            RangeBounds &b = partial[t];
+            resetBounds(b);
+
+            uint32_t to = begin + (uint32_t)(count * (t + 1) / threads);
+            for (uint32_t i = begin + (uint32_t)(count * t / threads); i < to; ++i)
+            {
+                growBounds(b, ctx.items[ctx.indices[i]]);
+            }
+        });
+
+        bounds = partial[0];
+
+        for (size_t t = 1; t < threads; ++t)
+        {
+            mergeBounds(bounds, partial[t]);
+        }
+    }
+
+    template <typename T>
+    void TBvh<T>::computeBins(const BuildContext &ctx, uint32_t begin,
+        uint32_t end, int32_t axis, T centerMin, T scale,
+        RangeBounds bins[BIN_COUNT]) const
+    {
+        uint32_t count = end - begin;
+        size_t threads = (count < PARALLEL_SIZE ? 1 : ctx.threads);
+        TArray<RangeBounds> partial(threads * BIN_COUNT);
+
+        parallelRun(threads, [&](size_t t)
+        {
+            RangeBounds *b = &partial[t * BIN_COUNT];
+
+            for (uint32_t i = 0; i < BIN_COUNT; ++i)
+            {
+                resetBounds(b[i]);
+            }
+
+            uint32_t to = begin + (uint32_t)(count * (t + 1) / threads);
+            for (uint32_t i = begin + (uint32_t)(count * t / threads); i < to; ++i)
+            {
+                const BuildItem &item = ctx.items[ctx.indices[i]];
+                growBounds(b[binIndex(item.center[axis], centerMin, scale)],
+                    item);
+            }
+        });
+
+        for (uint32_t i = 0; i < BIN_COUNT; ++i)
+        {
+            bins[i] = partial[i];
+
+            for (size_t t = 1; t < threads; ++t)
+            {
+                mergeBounds(bins[i], partial[t * BIN_COUNT + i]);
+            }
+        }
+    }
+
+    template <typename T>
+    inline void TBvh<T>::makeLeaf(Node &node, uint32_t begin,
+        uint32_t end) const
+    {
+        node.offset = begin;
+        node.count = end - begin;
+    }
+
+    template <typename T>
+    inline uint32_t TBvh<T>::binIndex(T center, T centerMin, T scale)
+    {
+        int32_t i = (int32_t)((center - centerMin) * scale);
+        i = (i < 0 ? 0 : i);
+        return (uint32_t)(i < (int32_t)BIN_COUNT ? i : BIN_COUNT - 1);
+    }
+
+    template <typename T>
+    inline float32_t TBvh<T>::halfArea(const T mins[3], const T maxs[3])
+    {
+        float32_t dx = (float32_t)(maxs[0] - mins[0]);
+        float32_t dy = (float32_t)(maxs[1] - mins[1]);
+        float32_t dz = (float32_t)(maxs[2] - mins[2]);
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    //--------------------------------------------------------------------------
+    // refit
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    void TBvh<T>::refit(const TAabb<T> *boxes)
+    {
+        T3D_ASSERT(mType == E_PRIMITIVE_AABB);
+
+        for (size_t i = 0; i < mBoxes.size(); ++i)
+        {
+            const TAabb<T> &aabb = boxes[mIndices[i]];
+            BoxData &box = mBoxes[i];
+            box.mins[0] = aabb.getMinX();
+            box.mins[1] = aabb.getMinY();
+            box.mins[2] = aabb.getMinZ();
+            box.maxs[0] = aabb.getMaxX();
+            box.maxs[1] = aabb.getMaxY();
+            box.maxs[2] = aabb.getMaxZ();
+        }
+
+        refitNodes();
+    }
+
+    template <typename T>
+    void TBvh<T>::refit(const TTriangle<T> *triangles)
+    {
+        T3D_ASSERT(mType == E_PRIMITIVE_TRIANGLE);
+
+        for (size_t i = 0; i < mTriangles.size(); ++i)
+        {
+            const TTriangle<T> &tri = triangles[mIndices[i]];
+            BoxData &box = mBoxes[i];
+            TriangleData &data = mTriangles[i];
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                box.mins[k] = TMath<T>::min(tri[0][k],
+                    TMath<T>::min(tri[1][k], tri[2][k]));
+                box.maxs[k] = TMath<T>::max(tri[0][k],
+                    TMath<T>::max(tri[1][k], tri[2][k]));
+                data.v0[k] = tri[0][k];
+                data.e1[k] = tri[1][k] - tri[0][k];
+                data.e2[k] = tri[2][k] - tri[0][k];
+            }
+        }
+
+        refitNodes();
+    }
+
+    template <typename T>
+    void TBvh<T>::refitNodes()
+    {
+        // 孩子的下标总比父节点大，倒序处理时孩子已经更新过了
+        for (size_t i = mNodes.size(); i > 0; --i)
+        {
+            Node &node = mNodes[i - 1];
+
+            if (node.count > 0)
+            {
+                const BoxData &first = mBoxes[node.offset];
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    node.mins[k] = first.mins[k];
+                    node.maxs[k] = first.maxs[k];
+                }
+
+                for (uint32_t j = 1; j < node.count; ++j)
+                {
+                    const BoxData &box = mBoxes[node.offset + j];
+                    for (int32_t k = 0; k < 3; ++k)
+                    {
+                        node.mins[k] = TMath<T>::min(node.mins[k], box.mins[k]);
+                        node.maxs[k] = TMath<T>::max(node.maxs[k], box.maxs[k]);
+                    }
+                }
+            }
+            else
+            {
+                const Node &left = mNodes[node.offset];
+                const Node &right = mNodes[node.offset + 1];
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    node.mins[k] = TMath<T>::min(left.mins[k], right.mins[k]);
+                    node.maxs[k] = TMath<T>::max(left.maxs[k], right.maxs[k]);
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // 单条射线
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline T TBvh<T>::safeInverse(T d)
+    {
+        // 方向分量很小时按 EPSILON 计算，避免定点数溢出
+        if (TMath<T>::abs(d) < TReal<T>::EPSILON)
+        {
+            return (d < TReal<T>::ZERO ? -TReal<T>::ONE : TReal<T>::ONE)
+                / TReal<T>::EPSILON;
+        }
+
+        return TReal<T>::ONE / d;
+    }
+
+    template <>
+    inline float32_t TBvh<float32_t>::safeInverse(float32_t d)
+    {
+        // 分量为 0 时用一个很大的数代替无穷大，避免 0 * INF 得到 NaN
+        return (d == 0.0f ? 1e30f : 1.0f / d);
+    }
+
+    template <>
+    inline float64_t TBvh<float64_t>::safeInverse(float64_t d)
+    {
+        return (d == 0.0 ? 1e300 : 1.0 / d);
+    }
+
+    template <typename T>
+    inline void TBvh<T>::setupRay(const TRay<T> &ray, RayData &data)
+    {
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            data.origin[k] = ray.getOrigin()[k];
+            data.dir[k] = ray.getDirection()[k];
+            data.invDir[k] = safeInverse(data.dir[k]);
+        }
+    }
+
+    template <typename T>
+    inline bool TBvh<T>::intersectNode(const Node &node, const RayData &ray,
+        T tMax, T &tNear)
+    {
+        T t0 = (node.mins[0] - ray.origin[0]) * ray.invDir[0];
+        T t1 = (node.maxs[0] - ray.origin[0]) * ray.invDir[0];
+        T tmin = TMath<T>::min(t0, t1);
+        T tmax = TMath<T>::max(t0, t1);
+
+        t0 = (node.mins[1] - ray.origin[1]) * ray.invDir[1];
+        t1 = (node.maxs[1] - ray.origin[1]) * ray.invDir[1];
+        tmin = TMath<T>::max(tmin, TMath<T>::min(t0, t1));
+        tmax = TMath<T>::min(tmax, TMath<T>::max(t0, t1));
+
+        t0 = (node.mins[2] - ray.origin[2]) * ray.invDir[2];
+        t1 = (node.maxs[2] - ray.origin[2]) * ray.invDir[2];
+        tmin = TMath<T>::max(tmin, TMath<T>::min(t0, t1));
+        tmax = TMath<T>::min(tmax, TMath<T>::max(t0, t1));
+
+        tNear = tmin;
+        return (tmin <= tmax && tmax >= TReal<T>::ZERO && tmin <= tMax);
+    }
+
+    template <typename T>
+    inline bool TBvh<T>::intersectBox(const BoxData &box, const RayData &ray,
+        T tMax, T &t)
+    {
+        // BoxData 和 Node 的前面部分布局不同，这里单独展开
+        T t0 = (box.mins[0] - ray.origin[0]) * ray.invDir[0];
+        T t1 = (box.maxs[0] - ray.origin[0]) * ray.invDir[0];
+        T tmin = TMath<T>::min(t0, t1);
+        T tmax = TMath<T>::max(t0, t1);
+
+        for (int32_t k = 1; k < 3; ++k)
+        {
+            t0 = (box.mins[k] - ray.origin[k]) * ray.invDir[k];
+            t1 = (box.maxs[k] - ray.origin[k]) * ray.invDir[k];
+            tmin = TMath<T>::max(tmin, TMath<T>::min(t0, t1));
+            tmax = TMath<T>::min(tmax, TMath<T>::max(t0, t1));
+        }
+
+        // 起点在盒子里面时交点就是起点
+        t = TMath<T>::max(tmin, TReal<T>::ZERO);
+        return (tmin <= tmax && tmax >= TReal<T>::ZERO && t <= tMax);
+    }
+
+    template <typename T>
+    inline bool TBvh<T>::intersectTriangle(const TriangleData &tri,
+        const T origin[3], const T dir[3], T tMax, T &t, T &u, T &v)
+    {
+        // Moller-Trumbore，det > 0 时射线从正面射入，
+        // 为了不做除法，比较都乘上 det 以后进行
+        T px = dir[1] * tri.e2[2] - dir[2] * tri.e2[1];
+        T py = dir[2] * tri.e2[0] - dir[0] * tri.e2[2];
+        T pz = dir[0] * tri.e2[1] - dir[1] * tri.e2[0];
+
+        T det = tri.e1[0] * px + tri.e1[1] * py + tri.e1[2] * pz;
+        if (det <= TReal<T>::ZERO)
+            return false;
+
+        T sx = origin[0] - tri.v0[0];
+        T sy = origin[1] - tri.v0[1];
+        T sz = origin[2] - tri.v0[2];
+
+        T uu = sx * px + sy * py + sz * pz;
+        if (uu < TReal<T>::ZERO || uu > det)
+            return false;
+
+        T qx = sy * tri.e1[2] - sz * tri.e1[1];
+        T qy = sz * tri.e1[0] - sx * tri.e1[2];
+        T qz = sx * tri.e1[1] - sy * tri.e1[0];
+
+        T vv = dir[0] * qx + dir[1] * qy + dir[2] * qz;
+        if (vv < TReal<T>::ZERO || uu + vv > det)
+            return false;
+
+        T tt = tri.e2[0] * qx + tri.e2[1] * qy + tri.e2[2] * qz;
+        if (tt < TReal<T>::ZERO || tt > tMax * det)
+            return false;
+
+        T invDet = TReal<T>::ONE / det;
+        t = tt * invDet;
+        u = uu * invDet;
+        v = vv * invDet;
+        return true;
+    }
+
+    template <typename T>
+    inline bool TBvh<T>::intersectLeaf(const Node &node, const RayData &ray,
+        Hit &hit, bool any) const
+    {
+        bool found = false;
+        T t, u, v;
+
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+        {
+            bool result = (mType == E_PRIMITIVE_TRIANGLE)
+                ? intersectTriangle(mTriangles[i], ray.origin, ray.dir, hit.t,
+                    t, u, v)
+                : intersectBox(mBoxes[i], ray, hit.t, t);
+
+            if (result)
+            {
+                hit.t = t;
+                hit.u = (mType == E_PRIMITIVE_TRIANGLE ? u : TReal<T>::ZERO);
+                hit.v = (mType == E_PRIMITIVE_TRIANGLE ? v : TReal<T>::ZERO);
+                hit.primitive = mIndices[i];
+                found = true;
+
+                if (any)
+                    break;
+            }
+        }
+
+        return found;
+    }
+
+    template <typename T>
+    bool TBvh<T>::intersect(const TRay<T> &ray, Hit &hit) const
+    {
+        hit.t = TReal<T>::ONE;
+        hit.u = hit.v = TReal<T>::ZERO;
+        hit.primitive = INVALID_INDEX;
+
+        RayData data;
+        setupRay(ray, data);
+
+        T tNear;
+        if (mNodes.empty() || !intersectNode(mNodes[0], data, hit.t, tNear))
+        {
+            return false;
+        }
+
+        struct Entry
+        {
+            uint32_t    node;
+            T           tNear;
+        };
+
+        Entry stack[STACK_SIZE];
+        uint32_t top = 0;
+        uint32_t index = 0;
+
+        for (;;)
+        {
+            const Node &node = mNodes[index];
+
+            if (node.count == 0)
+            {
+                // 两个孩子都相交时先走近的，远的压栈
+                T tLeft, tRight;
+                bool hitLeft = intersectNode(mNodes[node.offset], data, hit.t,
+                    tLeft);
+                bool hitRight = intersectNode(mNodes[node.offset + 1], data,
+                    hit.t, tRight);
+
+                if (hitLeft && hitRight)
+                {
+                    T3D_ASSERT(top < STACK_SIZE);
+                    if (tRight < tLeft)
+                    {
+                        stack[top].node = node.offset;
+                        stack[top].tNear = tLeft;
+                        index = node.offset + 1;
+                    }
+                    else
+                    {
+                        stack[top].node = node.offset + 1;
+                        stack[top].tNear = tRight;
+                        index = node.offset;
+                    }
+                    ++top;
+                    continue;
+                }
+                else if (hitLeft || hitRight)
+                {
+                    index = node.offset + (hitLeft ? 0 : 1);
+                    continue;
+                }
+            }
+            else
+            {
+                intersectLeaf(node, data, hit, false);
+            }
+
+            // 出栈时跳过比当前最近交点还远的节点
+            while (top > 0 && stack[top - 1].tNear > hit.t)
+            {
+                --top;
+            }
+
+            if (top == 0)
+                break;
+
+            index = stack[--top].node;
+        }
+
+        return (hit.primitive != INVALID_INDEX);
+    }
+
+    template <typename T>
+    bool TBvh<T>::intersectAny(const TRay<T> &ray) const
+    {
+        Hit hit;
+        hit.t = TReal<T>::ONE;
+        hit.primitive = INVALID_INDEX;
+
+        RayData data;
+        setupRay(ray, data);
+
+        T tNear;
+        if (mNodes.empty() || !intersectNode(mNodes[0], data, hit.t, tNear))
+        {
+            return false;
+        }
+
+        uint32_t stack[STACK_SIZE];
+        uint32_t top = 0;
+        uint32_t index = 0;
+
+        for (;;)
+        {
+            const Node &node = mNodes[index];
+
+            if (node.count == 0)
+            {
+                T tLeft, tRight;
+                bool hitLeft = intersectNode(mNodes[node.offset], data, hit.t,
+                    tLeft);
+                bool hitRight = intersectNode(mNodes[node.offset + 1], data,
+                    hit.t, tRight);
+
+                if (hitLeft && hitRight)
+                {
+                    // 近的先走，遮挡物通常离起点更近，能更早结束
+                    T3D_ASSERT(top < STACK_SIZE);
+                    bool rightFirst = (tRight < tLeft);
+                    stack[top++] = node.offset + (rightFirst ? 0 : 1);
+                    index = node.offset + (rightFirst ? 1 : 0);
+                    continue;
+                }
+                else if (hitLeft || hitRight)
+                {
+                    index = node.offset + (hitLeft ? 0 : 1);
+                    continue;
+                }
+            }
+            else if (intersectLeaf(node, data, hit, true))
+            {
+                return true;
+            }
+
+            if (top == 0)
+                break;
+
+            index = stack[--top];
+        }
+
+        return false;
+    }
+
+    //--------------------------------------------------------------------------
+    // 射线包
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    size_t TBvh<T>::intersect(const TRay<T> *rays, size_t count,
+        Hit *hits) const
+    {
+        return intersectPacket(rays, count, hits, false);
+    }
+
+    template <typename T>
+    size_t TBvh<T>::intersectAny(const TRay<T> *rays, size_t count,
+        bool *hits) const
+    {
+        Hit results[MAX_PACKET_SIZE];
+        size_t found = 0;
+
+        for (size_t start = 0; start < count; start += MAX_PACKET_SIZE)
+        {
+            size_t n = std::min(MAX_PACKET_SIZE, count - start);
+            found += intersectPacket(rays + start, n, results, true);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                hits[start + i] = (results[i].primitive != INVALID_INDEX);
+            }
+        }
+
+        return found;
+    }
+
+    template <typename T>
+    inline void TBvh<T>::getLane(const Packet &packet, size_t lane,
+        RayData &ray)
+    {
+        ray.origin[0] = packet.ox[lane];
+        ray.origin[1] = packet.oy[lane];
+        ray.origin[2] = packet.oz[lane];
+        ray.dir[0] = packet.dx[lane];
+        ray.dir[1] = packet.dy[lane];
+        ray.dir[2] = packet.dz[lane];
+        ray.invDir[0] = packet.ix[lane];
+        ray.invDir[1] = packet.iy[lane];
+        ray.invDir[2] = packet.iz[lane];
+    }
+
+    template <typename T>
+    size_t TBvh<T>::intersectPacket(const TRay<T> *rays, size_t count,
+        Hit *hits, bool any) const
+    {
+        size_t found = 0;
+
+        for (size_t start = 0; start < count; start += MAX_PACKET_SIZE)
+        {
+            size_t n = std::min(MAX_PACKET_SIZE, count - start);
+            Packet packet;
+
+            // 不足一包时用第一条射线补齐，补上的射线不参与检测
+            for (size_t i = 0; i < MAX_PACKET_SIZE; ++i)
+            {
+                RayData ray;
+                setupRay(rays[start + (i < n ? i : 0)], ray);
+                packet.ox[i] = ray.origin[0];
+                packet.oy[i] = ray.origin[1];
+                packet.oz[i] = ray.origin[2];
+                packet.dx[i] = ray.dir[0];
+                packet.dy[i] = ray.dir[1];
+                packet.dz[i] = ray.dir[2];
+                packet.ix[i] = ray.invDir[0];
+                packet.iy[i] = ray.invDir[1];
+                packet.iz[i] = ray.invDir[2];
+                packet.tMax[i] = TReal<T>::ONE;
+                packet.u[i] = packet.v[i] = TReal<T>::ZERO;
+                packet.primitive[i] = INVALID_INDEX;
+            }
+
+            // active 是还需要继续找交点的射线，any 模式下找到一个就去掉
+            uint32_t active = (1u << n) - 1;
+
+            struct Entry
+            {
+                uint32_t    node;
+                uint32_t    mask;
+            };
+
+            Entry stack[STACK_SIZE];
+            uint32_t top = 0;
+            uint32_t index = 0;
+            uint32_t mask = mNodes.empty()
+                ? 0 : intersectNodePacket(mNodes[0], packet, active);
+
+            while (mask != 0)
+            {
+                const Node &node = mNodes[index];
+
+                if (node.count == 0)
+                {
+                    const Node &left = mNodes[node.offset];
+                    const Node &right = mNodes[node.offset + 1];
+                    uint32_t maskLeft = intersectNodePacket(left, packet, mask);
+                    uint32_t maskRight = intersectNodePacket(right, packet, mask);
+
+                    // 按第一条有效射线的方向决定先走哪个孩子
+                    size_t lane = 0;
+                    while (!(mask & (1u << lane)))
+                        ++lane;
+
+                    T order = packet.dx[lane]
+                        * (right.mins[0] + right.maxs[0] - left.mins[0] - left.maxs[0])
+                        + packet.dy[lane]
+                        * (right.mins[1] + right.maxs[1] - left.mins[1] - left.maxs[1])
+                        + packet.dz[lane]
+                        * (right.mins[2] + right.maxs[2] - left.mins[2] - left.maxs[2]);
+
+                    uint32_t first = node.offset, second = node.offset + 1;
+                    if (order < TReal<T>::ZERO)
+                    {
+                        std::swap(first, second);
+                        std::swap(maskLeft, maskRight);
+                    }
+
+                    if (maskLeft != 0 && maskRight != 0)
+                    {
+                        T3D_ASSERT(top < STACK_SIZE);
+                        stack[top].node = second;
+                        stack[top].mask = maskRight;
+                        ++top;
+                    }
+
+                    if (maskLeft != 0 || maskRight != 0)
+                    {
+                        index = (maskLeft != 0 ? first : second);
+                        mask = (maskLeft != 0 ? maskLeft : maskRight);
+                        continue;
+                    }
+                }
+                else
+                {
+                    for (uint32_t i = node.offset;
+                        i < node.offset + node.count && mask != 0; ++i)
+                    {
+                        uint32_t hitMask = 0;
+
+                        if (mType == E_PRIMITIVE_TRIANGLE)
+                        {
+                            hitMask = intersectTrianglePacket(mTriangles[i],
+                                mIndices[i], packet, mask);
+                        }
+                        else
+                        {
+                            for (size_t j = 0; j < MAX_PACKET_SIZE; ++j)
+                            {
+                                RayData ray;
+                                T t;
+
+                                if (!(mask & (1u << j)))
+                                    continue;
+
+                                getLane(packet, j, ray);
+                                if (intersectBox(mBoxes[i], ray, packet.tMax[j], t))
+                                {
+                                    packet.tMax[j] = t;
+                                    packet.u[j] = packet.v[j] = TReal<T>::ZERO;
+                                    packet.primitive[j] = mIndices[i];
+                                    hitMask |= (1u << j);
+                                }
+                            }
+                        }
+
+                        if (any)
+                        {
+                            active &= ~hitMask;
+                            mask &= ~hitMask;
+                        }
+                    }
+                }
+
+                // 出栈时用当前的最近交点重新检测一次，跳过已经没有意义的节点
+                mask = 0;
+                while (top > 0 && mask == 0)
+                {
+                    --top;
+                    index = stack[top].node;
+                    mask = intersectNodePacket(mNodes[index], packet,
+                        stack[top].mask & active);
+                }
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                Hit &hit = hits[start + i];
+                hit.t = packet.tMax[i];
+                hit.u = packet.u[i];
+                hit.v = packet.v[i];
+                hit.primitive = packet.primitive[i];
+
+                if (hit.primitive != INVALID_INDEX)
+                {
+                    ++found;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    template <typename T>
+    inline uint32_t TBvh<T>::intersectNodePacket(const Node &node,
+        const Packet &packet, uint32_t mask) const
+    {
+        uint32_t result = 0;
+
+        for (size_t i = 0; i < MAX_PACKET_SIZE; ++i)
+        {
+            if (mask & (1u << i))
+            {
+                RayData ray;
+                T tNear;
+                getLane(packet, i, ray);
+                if (intersectNode(node, ray, packet.tMax[i], tNear))
+                    result |= (1u << i);
+            }
+        }
+
+        return result;
+    }
+
+    template <typename T>
+    inline uint32_t TBvh<T>::intersectTrianglePacket(const TriangleData &tri,
+        uint32_t primitive, Packet &packet, uint32_t mask) const
+    {
+        uint32_t result = 0;
+
+        for (size_t i = 0; i < MAX_PACKET_SIZE; ++i)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+
+            T origin[3] = { packet.ox[i], packet.oy[i], packet.oz[i] };
+            T dir[3] = { packet.dx[i], packet.dy[i], packet.dz[i] };
+            T t, u, v;
+
+            if (intersectTriangle(tri, origin, dir, packet.tMax[i], t, u, v))
+            {
+                packet.tMax[i] = t;
+                packet.u[i] = u;
+                packet.v[i] = v;
+                packet.primitive[i] = primitive;
+                result |= (1u << i);
+            }
+        }
+
+        return result;
+    }
+
+#if defined (T3D_SIMD)
+    //--------------------------------------------------------------------------
+    // float32_t 的射线包一次处理 4 条射线
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline uint32_t TBvh<float32_t>::intersectNodePacket(const Node &node,
+        const Packet &packet, uint32_t mask) const
+    {
+        const SIMDFloat4 zero = simdSplat(0.0f);
+        SIMDFloat4 minX = simdSplat(node.mins[0]);
+        SIMDFloat4 minY = simdSplat(node.mins[1]);
+        SIMDFloat4 minZ = simdSplat(node.mins[2]);
+        SIMDFloat4 maxX = simdSplat(node.maxs[0]);
+        SIMDFloat4 maxY = simdSplat(node.maxs[1]);
+        SIMDFloat4 maxZ = simdSplat(node.maxs[2]);
+        uint32_t result = 0;
+
+        for (size_t g = 0; g < MAX_PACKET_SIZE; g += 4)
+        {
+            uint32_t groupMask = (mask >> g) & 0xF;
+            if (groupMask == 0)
+                continue;
+
+            SIMDFloat4 ox = simdLoad(packet.ox + g);
+            SIMDFloat4 ix = simdLoad(packet.ix + g);
+            SIMDFloat4 t0 = simdMul(simdSub(minX, ox), ix);
+            SIMDFloat4 t1 = simdMul(simdSub(maxX, ox), ix);
+            SIMDFloat4 tmin = simdMin(t0, t1);
+            SIMDFloat4 tmax = simdMax(t0, t1);
+
+            SIMDFloat4 oy = simdLoad(packet.oy + g);
+            SIMDFloat4 iy = simdLoad(packet.iy + g);
+            t0 = simdMul(simdSub(minY, oy), iy);
+            t1 = simdMul(simdSub(maxY, oy), iy);
+            tmin = simdMax(tmin, simdMin(t0, t1));
+            tmax = simdMin(tmax, simdMax(t0, t1));
+
+            SIMDFloat4 oz = simdLoad(packet.oz + g);
+            SIMDFloat4 iz = simdLoad(packet.iz + g);
+            t0 = simdMul(simdSub(minZ, oz), iz);
+            t1 = simdMul(simdSub(maxZ, oz), iz);
+            tmin = simdMax(tmin, simdMin(t0, t1));
+            tmax = simdMin(tmax, simdMax(t0, t1));
+
+            uint32_t miss = simdMoveMask(simdCmpGt(tmin, tmax))
+                | simdMoveMask(simdCmpGt(zero, tmax))
+                | simdMoveMask(simdCmpGt(tmin, simdLoad(packet.tMax + g)));
+
+            result |= (groupMask & ~miss) << g;
+        }
+
+        return result;
+    }
+
+    template <>
+    inline uint32_t TBvh<float32_t>::intersectTrianglePacket(
+        const TriangleData &tri, uint32_t primitive, Packet &packet,
+        uint32_t mask) const
+    {
+        const SIMDFloat4 zero = simdSplat(0.0f);
+        SIMDFloat4 e1x = simdSplat(tri.e1[0]);
+        SIMDFloat4 e1y = simdSplat(tri.e1[1]);
+        SIMDFloat4 e1z = simdSplat(tri.e1[2]);
+        SIMDFloat4 e2x = simdSplat(tri.e2[0]);
+        SIMDFloat4 e2y = simdSplat(tri.e2[1]);
+        SIMDFloat4 e2z = simdSplat(tri.e2[2]);
+        uint32_t result = 0;
+
+        for (size_t g = 0; g < MAX_PACKET_SIZE; g += 4)
+        {
+            uint32_t groupMask = (mask >> g) & 0xF;
+            if (groupMask == 0)
+                continue;
+
+            SIMDFloat4 dx = simdLoad(packet.dx + g);
+            SIMDFloat4 dy = simdLoad(packet.dy + g);
+            SIMDFloat4 dz = simdLoad(packet.dz + g);
+
+            SIMDFloat4 px = simdSub(simdMul(dy, e2z), simdMul(dz, e2y));
+            SIMDFloat4 py = simdSub(simdMul(dz, e2x), simdMul(dx, e2z));
+            SIMDFloat4 pz = simdSub(simdMul(dx, e2y), simdMul(dy, e2x));
+            SIMDFloat4 det = simdAdd(simdAdd(simdMul(e1x, px), simdMul(e1y, py)),
+                simdMul(e1z, pz));
+
+            SIMDFloat4 sx = simdSub(simdLoad(packet.ox + g), simdSplat(tri.v0[0]));
+            SIMDFloat4 sy = simdSub(simdLoad(packet.oy + g), simdSplat(tri.v0[1]));
+            SIMDFloat4 sz = simdSub(simdLoad(packet.oz + g), simdSplat(tri.v0[2]));
+            SIMDFloat4 u = simdAdd(simdAdd(simdMul(sx, px), simdMul(sy, py)),
+                simdMul(sz, pz));
+
+            SIMDFloat4 qx = simdSub(simdMul(sy, e1z), simdMul(sz, e1y));
+            SIMDFloat4 qy = simdSub(simdMul(sz, e1x), simdMul(sx, e1z));
+            SIMDFloat4 qz = simdSub(simdMul(sx, e1y), simdMul(sy, e1x));
+            SIMDFloat4 v = simdAdd(simdAdd(simdMul(dx, qx), simdMul(dy, qy)),
+                simdMul(dz, qz));
+            SIMDFloat4 t = simdAdd(simdAdd(simdMul(e2x, qx), simdMul(e2y, qy)),
+                simdMul(e2z, qz));
+
+            uint32_t ok = simdMoveMask(simdCmpGt(det, zero));
+            uint32_t miss = simdMoveMask(simdCmpGt(zero, u))
+                | simdMoveMask(simdCmpGt(u, det))
+                | simdMoveMask(simdCmpGt(zero, v))
+                | simdMoveMask(simdCmpGt(simdAdd(u, v), det))
+                | simdMoveMask(simdCmpGt(zero, t))
+                | simdMoveMask(simdCmpGt(t, simdMul(simdLoad(packet.tMax + g), det)));
+
+            uint32_t hit = groupMask & ok & ~miss;
+            if (hit == 0)
+                continue;
+
+            float32_t dets[4], us[4], vs[4], ts[4];
+            simdStore(dets, det);
+            simdStore(us, u);
+            simdStore(vs, v);
+            simdStore(ts, t);
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                if (hit & (1u << i))
+                {
+                    float32_t invDet = 1.0f / dets[i];
+                    packet.tMax[g + i] = ts[i] * invDet;
+                    packet.u[g + i] = us[i] * invDet;
+                    packet.v[g + i] = vs[i] * invDet;
+                    packet.primitive[g + i] = primitive;
+                }
+            }
+
+            result |= hit << g;
+        }
+
+        return result;
+    }
+#endif  /*T3D_SIMD*/
+}
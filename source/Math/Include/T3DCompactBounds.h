@@ -0,0 +1,164 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_COMPACT_BOUNDS_H__
+#define __T3D_COMPACT_BOUNDS_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DHalfFloat.h"
+#include "T3DQuaternion.h"
+#include "T3DSphere.h"
+#include "T3DAabb.h"
+#include "T3DObb.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 相对父包围盒量化成 16 位整数的 AABB，12 个字节
+     * @remarks 量化和还原由 TAabbQuantizer 完成，同一个量化器量化出来的
+     *      AABB 之间可以直接用整数做相交检测。量化是保守的：最小值向下取整，
+     *      最大值向上取整，所以原来相交的两个盒子量化后一定相交，
+     *      检测结果只可能多报，不会漏报。
+     */
+    template <typename T>
+    class TQuantizedAabb
+    {
+    public:
+        TQuantizedAabb();
+
+        uint16_t getMin(int32_t axis) const;
+        uint16_t getMax(int32_t axis) const;
+
+        void setMin(int32_t axis, uint16_t value);
+        void setMax(int32_t axis, uint16_t value);
+
+        /// 两个盒子是否相交，边界接触也算相交
+        bool overlaps(const TQuantizedAabb &other) const;
+
+        /// other 是否完全在盒子里
+        bool contains(const TQuantizedAabb &other) const;
+
+        /**
+         * @brief 在 count 个盒子里找和 query 相交的
+         * @param [out] indices : 相交的盒子的下标，至少 count 个元素
+         * @return 相交的盒子个数
+         */
+        static size_t queryOverlaps(const TQuantizedAabb *boxes, size_t count,
+            const TQuantizedAabb &query, uint32_t *indices);
+
+    private:
+        uint16_t    mMin[3];
+        uint16_t    mMax[3];
+    };
+
+    /**
+     * @brief 在父包围盒里把 AABB 量化成 TQuantizedAabb，或者还原回来
+     * @remarks 每个轴把父包围盒等分成 65535 份。超出父包围盒的部分会被截断，
+     *      截断以后相交检测仍然是保守的，但还原出来的盒子不再包含原来的盒子。
+     *      只适用于浮点数类型。
+     */
+    template <typename T>
+    class TAabbQuantizer
+    {
+    public:
+        static const uint32_t QUANTIZED_MAX = 65535;
+
+        TAabbQuantizer();
+        TAabbQuantizer(const TAabb<T> &parent);
+
+        void setParent(const TAabb<T> &parent);
+
+        /// 量化一个盒子，还原后的盒子包含原来的盒子
+        TQuantizedAabb<T> quantize(const TAabb<T> &box) const;
+
+        void quantize(const TAabb<T> *boxes, TQuantizedAabb<T> *quantized,
+            size_t count) const;
+
+        /// 还原成 AABB
+        TAabb<T> dequantize(const TQuantizedAabb<T> &quantized) const;
+
+        /// 用量化后的形式检测 box 和 quantized 是否相交，结果是保守的
+        bool overlaps(const TQuantizedAabb<T> &quantized,
+            const TAabb<T> &box) const;
+
+    protected:
+        uint16_t quantizeMin(T value, int32_t axis) const;
+        uint16_t quantizeMax(T value, int32_t axis) const;
+        T dequantize(uint32_t value, int32_t axis) const;
+
+    private:
+        T   mOrigin[3];     /// 父包围盒的最小点
+        T   mStep[3];       /// 每一份的长度
+        T   mScale[3];      /// 1 / mStep
+    };
+
+    /**
+     * @brief 压缩的 OBB，float32_t 时 24 个字节（TObb 是 60 个字节）
+     * @remarks 中心保持原来的精度；三个轴压缩成单位四元数，
+     *      只存绝对值较小的三个分量，每个 15 位，最大分量的下标存在
+     *      前两个分量的最高位；半长用向上舍入的半精度数保存。
+     *      压缩时按还原后的轴重新计算半长，保证还原出来的 OBB 包含原来的
+     *      OBB，轴不是正交的也一样。左手系的轴会把第三个轴反向。
+     */
+    template <typename T>
+    class TCompactObb
+    {
+    public:
+        TCompactObb();
+        TCompactObb(const TObb<T> &obb);
+
+        void encode(const TObb<T> &obb);
+        void decode(TObb<T> &obb) const;
+
+        const TVector3<T> &getCenter() const;
+
+        /// 还原出来的三个轴
+        void getAxis(TVector3<T> *axis) const;
+
+        /// 还原出来的半长
+        T getExtent(int32_t idx) const;
+
+        TQuaternion<T> getOrientation() const;
+
+        /// 点是否在盒子里，直接在压缩形式上计算
+        bool contains(const TVector3<T> &point) const;
+
+        /// 和球是否相交，直接在压缩形式上计算，结果是保守的
+        bool test(const TSphere<T> &sphere) const;
+
+    protected:
+        static const int32_t ROTATION_BITS = 15;
+        static const uint32_t ROTATION_MAX = (1u << ROTATION_BITS) - 1;
+
+        void encodeOrientation(const TQuaternion<T> &orientation);
+
+    private:
+        TVector3<T> mCenter;
+        uint16_t    mRotation[3];
+        uint16_t    mExtent[3];
+    };
+}
+
+
+#include "T3DCompactBounds.inl"
+
+
+#endif  /*__T3D_COMPACT_BOUNDS_H__*/
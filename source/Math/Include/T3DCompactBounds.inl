@@ -0,0 +1,432 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    inline TQuantizedAabb<T>::TQuantizedAabb()
+    {
+        mMin[0] = mMin[1] = mMin[2] = 0;
+        mMax[0] = mMax[1] = mMax[2] = 0;
+    }
+
+    template <typename T>
+    inline uint16_t TQuantizedAabb<T>::getMin(int32_t axis) const
+    {
+        T3D_ASSERT(axis >= 0 && axis < 3);
+        return mMin[axis];
+    }
+
+    template <typename T>
+    inline uint16_t TQuantizedAabb<T>::getMax(int32_t axis) const
+    {
+        T3D_ASSERT(axis >= 0 && axis < 3);
+        return mMax[axis];
+    }
+
+    template <typename T>
+    inline void TQuantizedAabb<T>::setMin(int32_t axis, uint16_t value)
+    {
+        T3D_ASSERT(axis >= 0 && axis < 3);
+        mMin[axis] = value;
+    }
+
+    template <typename T>
+    inline void TQuantizedAabb<T>::setMax(int32_t axis, uint16_t value)
+    {
+        T3D_ASSERT(axis >= 0 && axis < 3);
+        mMax[axis] = value;
+    }
+
+    template <typename T>
+    inline bool TQuantizedAabb<T>::overlaps(const TQuantizedAabb &other) const
+    {
+        // 用 & 而不是 &&，没有分支
+        return ((mMin[0] <= other.mMax[0]) & (other.mMin[0] <= mMax[0])
+            & (mMin[1] <= other.mMax[1]) & (other.mMin[1] <= mMax[1])
+            & (mMin[2] <= other.mMax[2]) & (other.mMin[2] <= mMax[2]));
+    }
+
+    template <typename T>
+    inline bool TQuantizedAabb<T>::contains(const TQuantizedAabb &other) const
+    {
+        return ((mMin[0] <= other.mMin[0]) & (other.mMax[0] <= mMax[0])
+            & (mMin[1] <= other.mMin[1]) & (other.mMax[1] <= mMax[1])
+            & (mMin[2] <= other.mMin[2]) & (other.mMax[2] <= mMax[2]));
+    }
+
+    template <typename T>
+    size_t TQuantizedAabb<T>::queryOverlaps(const TQuantizedAabb *boxes,
+        size_t count, const TQuantizedAabb &query, uint32_t *indices)
+    {
+        size_t found = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            // 总是写入，命中时才移动写入位置
+            indices[found] = (uint32_t)i;
+            found += boxes[i].overlaps(query) ? 1 : 0;
+        }
+
+        return found;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    const uint32_t TAabbQuantizer<T>::QUANTIZED_MAX;
+
+    template <typename T>
+    inline TAabbQuantizer<T>::TAabbQuantizer()
+    {
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            mOrigin[i] = TReal<T>::ZERO;
+            mStep[i] = mScale[i] = TReal<T>::ONE;
+        }
+    }
+
+    template <typename T>
+    inline TAabbQuantizer<T>::TAabbQuantizer(const TAabb<T> &parent)
+    {
+        setParent(parent);
+    }
+
+    template <typename T>
+    void TAabbQuantizer<T>::setParent(const TAabb<T> &parent)
+    {
+        T vMin[3] = { parent.getMinX(), parent.getMinY(), parent.getMinZ() };
+        T vMax[3] = { parent.getMaxX(), parent.getMaxY(), parent.getMaxZ() };
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            T size = vMax[i] - vMin[i];
+            mOrigin[i] = vMin[i];
+
+            if (size > TReal<T>::ZERO)
+            {
+                mStep[i] = size / (T)QUANTIZED_MAX;
+
+                // 保证最大的量化值还原后不小于父包围盒的最大值
+                while (dequantize(QUANTIZED_MAX, i) < vMax[i])
+                    mStep[i] += mStep[i] * TReal<T>::EPSILON;
+            }
+            else
+            {
+                mStep[i] = TReal<T>::ONE;
+            }
+
+            mScale[i] = TReal<T>::ONE / mStep[i];
+        }
+    }
+
+    template <typename T>
+    inline T TAabbQuantizer<T>::dequantize(uint32_t value, int32_t axis) const
+    {
+        return mOrigin[axis] + (T)value * mStep[axis];
+    }
+
+    template <typename T>
+    inline uint16_t TAabbQuantizer<T>::quantizeMin(T value, int32_t axis) const
+    {
+        T t = (value - mOrigin[axis]) * mScale[axis];
+
+        if (!(t > TReal<T>::ZERO))
+            return 0;
+
+        uint32_t q = (t >= (T)QUANTIZED_MAX) ? QUANTIZED_MAX : (uint32_t)t;
+
+        // 乘以倒数有舍入误差，按还原后的值修正，最多差一格
+        while (q > 0 && dequantize(q, axis) > value)
+            --q;
+
+        return (uint16_t)q;
+    }
+
+    template <typename T>
+    inline uint16_t TAabbQuantizer<T>::quantizeMax(T value, int32_t axis) const
+    {
+        T t = (value - mOrigin[axis]) * mScale[axis];
+
+        if (!(t > TReal<T>::ZERO))
+            return 0;
+
+        if (t >= (T)QUANTIZED_MAX)
+            return (uint16_t)QUANTIZED_MAX;
+
+        uint32_t q = (uint32_t)t;
+
+        while (q < QUANTIZED_MAX && dequantize(q, axis) < value)
+            ++q;
+
+        return (uint16_t)q;
+    }
+
+    template <typename T>
+    inline TQuantizedAabb<T> TAabbQuantizer<T>::quantize(
+        const TAabb<T> &box) const
+    {
+        TQuantizedAabb<T> result;
+        result.setMin(0, quantizeMin(box.getMinX(), 0));
+        result.setMin(1, quantizeMin(box.getMinY(), 1));
+        result.setMin(2, quantizeMin(box.getMinZ(), 2));
+        result.setMax(0, quantizeMax(box.getMaxX(), 0));
+        result.setMax(1, quantizeMax(box.getMaxY(), 1));
+        result.setMax(2, quantizeMax(box.getMaxZ(), 2));
+        return result;
+    }
+
+    template <typename T>
+    void TAabbQuantizer<T>::quantize(const TAabb<T> *boxes,
+        TQuantizedAabb<T> *quantized, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            quantized[i] = quantize(boxes[i]);
+        }
+    }
+
+    template <typename T>
+    inline TAabb<T> TAabbQuantizer<T>::dequantize(
+        const TQuantizedAabb<T> &quantized) const
+    {
+        TAabb<T> box;
+        box.setParam(
+            TVector3<T>(dequantize(quantized.getMin(0), 0),
+                dequantize(quantized.getMin(1), 1),
+                dequantize(quantized.getMin(2), 2)),
+            TVector3<T>(dequantize(quantized.getMax(0), 0),
+                dequantize(quantized.getMax(1), 1),
+                dequantize(quantized.getMax(2), 2)));
+        return box;
+    }
+
+    template <typename T>
+    inline bool TAabbQuantizer<T>::overlaps(const TQuantizedAabb<T> &quantized,
+        const TAabb<T> &box) const
+    {
+        return quantized.overlaps(quantize(box));
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    const int32_t TCompactObb<T>::ROTATION_BITS;
+
+    template <typename T>
+    const uint32_t TCompactObb<T>::ROTATION_MAX;
+
+    template <typename T>
+    inline TCompactObb<T>::TCompactObb()
+        : mCenter(TVector3<T>::ZERO)
+    {
+        // 单位四元数：w 最大，x、y、z 都是 0
+        mRotation[0] = mRotation[1] = mRotation[2]
+            = (uint16_t)((ROTATION_MAX + 1) / 2);
+        mExtent[0] = mExtent[1] = mExtent[2] = 0;
+    }
+
+    template <typename T>
+    inline TCompactObb<T>::TCompactObb(const TObb<T> &obb)
+    {
+        encode(obb);
+    }
+
+    template <typename T>
+    void TCompactObb<T>::encodeOrientation(const TQuaternion<T> &orientation)
+    {
+        T c[4] = { orientation.w(), orientation.x(), orientation.y(),
+            orientation.z() };
+
+        int32_t largest = 0;
+        for (int32_t i = 1; i < 4; ++i)
+        {
+            if (TMath<T>::abs(c[i]) > TMath<T>::abs(c[largest]))
+                largest = i;
+        }
+
+        // q 和 -q 是同一个旋转，让最大分量为正，还原时就不用存符号
+        T sign = (c[largest] < TReal<T>::ZERO)
+            ? TReal<T>::MINUS_ONE : TReal<T>::ONE;
+
+        // 其余三个分量的绝对值不超过 1/sqrt(2)，映射到 [0, ROTATION_MAX]
+        const T scale = T(0.70710678118654752440) * (T)ROTATION_MAX;
+        const T bias = (T)ROTATION_MAX * TReal<T>::HALF;
+
+        for (int32_t i = 0, n = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            T v = sign * c[i] * scale + bias + TReal<T>::HALF;
+            v = TMath<T>::max(TReal<T>::ZERO,
+                TMath<T>::min(v, (T)ROTATION_MAX));
+            mRotation[n++] = (uint16_t)(uint32_t)v;
+        }
+
+        mRotation[0] |= (uint16_t)((largest & 1) << ROTATION_BITS);
+        mRotation[1] |= (uint16_t)((largest >> 1) << ROTATION_BITS);
+    }
+
+    template <typename T>
+    TQuaternion<T> TCompactObb<T>::getOrientation() const
+    {
+        int32_t largest = (mRotation[0] >> ROTATION_BITS)
+            | ((mRotation[1] >> ROTATION_BITS) << 1);
+
+        const T scale = T(1.41421356237309504880) / (T)ROTATION_MAX;
+        const T bias = T(0.70710678118654752440);
+
+        T c[4];
+        T sum = TReal<T>::ZERO;
+
+        for (int32_t i = 0, n = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            c[i] = (T)(mRotation[n++] & ROTATION_MAX) * scale - bias;
+            sum += c[i] * c[i];
+        }
+
+        c[largest] = TMath<T>::sqrt(
+            TMath<T>::max(TReal<T>::ZERO, TReal<T>::ONE - sum));
+
+        TQuaternion<T> orientation(c[0], c[1], c[2], c[3]);
+        orientation.normalize();
+        return orientation;
+    }
+
+    template <typename T>
+    void TCompactObb<T>::encode(const TObb<T> &obb)
+    {
+        mCenter = obb.getCenter();
+
+        TVector3<T> axis[3] = { obb.getAxis(0), obb.getAxis(1),
+            obb.getAxis(2) };
+
+        // 四元数只能表示旋转，左手系时把第三个轴反向，盒子本身不变
+        if (axis[0].cross(axis[1]).dot(axis[2]) < TReal<T>::ZERO)
+            axis[2] = -axis[2];
+
+        TQuaternion<T> orientation(axis);
+        orientation.normalize();
+        encodeOrientation(orientation);
+
+        // 原来的盒子在还原出来的轴上的投影半长：sum(e_j * |a_j . b_i|)
+        TVector3<T> decoded[3];
+        getAxis(decoded);
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            T extent = TReal<T>::ZERO;
+
+            for (int32_t j = 0; j < 3; ++j)
+            {
+                extent += TMath<T>::abs(obb.getExtent(j))
+                    * TMath<T>::abs(axis[j].dot(decoded[i]));
+            }
+
+            uint16_t half = HalfFloat::fromFloat((float32_t)extent,
+                HalfFloat::E_ROUND_UP);
+
+            // T 比 float32_t 精度高时，转成 float32_t 可能已经变小了
+            while ((T)HalfFloat::toFloat(half) < extent)
+                half = HalfFloat::nextUp(half);
+
+            mExtent[i] = half;
+        }
+    }
+
+    template <typename T>
+    void TCompactObb<T>::decode(TObb<T> &obb) const
+    {
+        TVector3<T> axis[3];
+        getAxis(axis);
+
+        obb.setCenter(mCenter);
+        obb.setAxis(axis[0], axis[1], axis[2]);
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            obb.setExtent(i, getExtent(i));
+        }
+    }
+
+    template <typename T>
+    inline const TVector3<T> &TCompactObb<T>::getCenter() const
+    {
+        return mCenter;
+    }
+
+    template <typename T>
+    inline void TCompactObb<T>::getAxis(TVector3<T> *axis) const
+    {
+        TQuaternion<T> orientation = getOrientation();
+        axis[0] = orientation.xAxis();
+        axis[1] = orientation.yAxis();
+        axis[2] = orientation.zAxis();
+    }
+
+    template <typename T>
+    inline T TCompactObb<T>::getExtent(int32_t idx) const
+    {
+        T3D_ASSERT(idx >= 0 && idx < 3);
+        return (T)HalfFloat::toFloat(mExtent[idx]);
+    }
+
+    template <typename T>
+    bool TCompactObb<T>::contains(const TVector3<T> &point) const
+    {
+        TVector3<T> axis[3];
+        getAxis(axis);
+
+        TVector3<T> d = point - mCenter;
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            if (TMath<T>::abs(d.dot(axis[i])) > getExtent(i))
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    bool TCompactObb<T>::test(const TSphere<T> &sphere) const
+    {
+        TVector3<T> axis[3];
+        getAxis(axis);
+
+        // 球心到盒子的最近距离
+        TVector3<T> d = sphere.getCenter() - mCenter;
+        T distance2 = TReal<T>::ZERO;
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            T excess = TMath<T>::abs(d.dot(axis[i])) - getExtent(i);
+
+            if (excess > TReal<T>::ZERO)
+                distance2 += excess * excess;
+        }
+
+        return distance2 <= sphere.getRadius() * sphere.getRadius();
+    }
+}
@@ -156,36 +156,15 @@ namespace Tiny3D
 
     inline fix32 operator *(const fix32 &fx, const fix32 &gx)
     {
-        if (fx.eq_0() || gx.eq_0())
-            return fix32::ZERO;
-        if (fx.eq_1())
-            return gx;
-        if (gx.eq_1())
-            return fx;
-
-        int64_t value = fx.m;
-        value *= gx.m;
-
-        T3D_ASSERT(value <= 8796093022207LL && value >= -8796093022208LL);
-        return fix32(value);
+        // 不再特判 0 和 1，加宽相乘四舍五入的结果本来就一样，省掉分支
+        return fix32(FixCheckedPolicy::mul<int32_t, fix32::DECIMAL_BITS>(
+            fx.m, gx.m), 0);
     }
 
     inline fix32 operator /(const fix32 &fx, const fix32 &gx)
     {
-        if (fx.eq_0())
-            return fix32::ZERO;
-        if (gx.eq_1())
-            return fx;
-        if (gx.eq_0())
-            return fix32::INF;
-
-        int64_t value = fx.m;
-        value <<= fix32::DECIMAL_BITS;
-        value /= gx.m;
-
-        T3D_ASSERT(value <= fix32::MAX_INT_VALUE 
-            && value >= fix32::MIN_INT_VALUE);
-        return fix32((int32_t)value, 0);
+        return fix32(FixCheckedPolicy::div<int32_t, fix32::DECIMAL_BITS>(
+            fx.m, gx.m), 0);
     }
 
     //--------------------------------------------------------------------------
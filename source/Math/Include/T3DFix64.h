@@ -21,6 +21,7 @@
 #define __T3D_FIX64_H__
 
 #include "T3DMathPrerequisites.h"
+#include "T3DFixPolicy.h"
 #include "T3DFix32.h"
 
 namespace Tiny3D
@@ -32,8 +33,8 @@ namespace Tiny3D
     class T3D_MATH_API fix64
     {
     public:
-        static const int32_t INTEGER_BITS;      // 整数位数
-        static const int32_t DECIMAL_BITS;      // 小数位数
+        static const int32_t INTEGER_BITS = 40; // 整数位数
+        static const int32_t DECIMAL_BITS = 24; // 小数位数
 
         static const int64_t MAX_INT_VALUE;     // 最大的整型数
         static const int64_t MIN_INT_VALUE;     // 最小的整型数
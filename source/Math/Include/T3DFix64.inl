@@ -163,37 +163,15 @@ namespace Tiny3D
 
     inline fix64 operator *(const fix64 &fx, const fix64 &gx)
     {
-        if (fx.eq_0() || gx.eq_0())
-            return fix64::ZERO;
-        if (fx.eq_1())
-            return gx;
-        if (gx.eq_1())
-            return fx;
-
-        int64_t value = fx.m;
-        value *= gx.m;
-
-        T3D_ASSERT(value <= fix64::MAX_INT_VALUE
-            && value >= fix64::MIN_INT_VALUE);
-        return fix64(value, 0);
+        // 乘积要加宽到 128 位再移回小数位数，否则稍大一点的数就会溢出
+        return fix64(FixCheckedPolicy::mul<int64_t, fix64::DECIMAL_BITS>(
+            fx.m, gx.m), 0);
     }
 
     inline fix64 operator /(const fix64 &fx, const fix64 &gx)
     {
-        if (fx.eq_0())
-            return fix64::ZERO;
-        if (gx.eq_1())
-            return fx;
-        if (gx.eq_0())
-            return fix64::INF;
-
-        int64_t value = fx.m;
-        value <<= fix64::DECIMAL_BITS;
-        value /= gx.m;
-
-        T3D_ASSERT(value <= fix64::MAX_INT_VALUE
-            && value >= fix64::MIN_INT_VALUE);
-        return fix64(value, 0);
+        return fix64(FixCheckedPolicy::div<int64_t, fix64::DECIMAL_BITS>(
+            fx.m, gx.m), 0);
     }
 
     //--------------------------------------------------------------------------
@@ -0,0 +1,153 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_FIX_MATH_H__
+#define __T3D_FIX_MATH_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DFix32.h"
+#include "T3DFix64.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 只用整数运算实现的平方根、三角函数和反三角函数
+     * @remarks 给 TMath<fix32_t> 和 TMath<fix64_t> 用，不经过浮点数，在没有
+     *      FPU 的平台上也快，而且不同平台上的结果逐位一致。
+     *      内部统一用 Q30 定点数（低 30 位是小数）表示角度和三角函数值，
+     *      接口上的 fracBits 是调用者定点数格式的小数位数。
+     *
+     *      正弦余弦用 1/4 周期 256 项的正弦表，表项之间用
+     *      sin(a + d) = sin(a)cos(d) + cos(a)sin(d) 加 d 的泰勒展开插值，
+     *      误差在 1e-8 以内。反正切用 30 次迭代的 CORDIC，平方根逐位求出。
+     */
+    class T3D_MATH_API FixMath
+    {
+    public:
+        /// 内部定点数的小数位数
+        static const int32_t Q_BITS = 30;
+        /// Q30 的 1
+        static const int64_t Q_ONE = 1LL << 30;
+        /// Q30 的 PI
+        static const int64_t Q_PI = 3373259426LL;
+        /// Q30 的 PI / 2
+        static const int64_t Q_HALF_PI = 1686629713LL;
+        /// Q30 的 2 * PI
+        static const int64_t Q_TWO_PI = 6746518852LL;
+
+        /**
+         * @brief 根据相位求正弦和余弦
+         * @param [in] phase : 相位，一整圈是 2^32
+         * @param [out] s : 正弦值，Q30
+         * @param [out] c : 余弦值，Q30
+         */
+        static void sinCosPhase(uint32_t phase, int64_t &s, int64_t &c);
+
+        /**
+         * @brief 根据弧度求正弦和余弦
+         * @param [in] radians : 弧度，带 fracBits 位小数的定点数
+         * @param [in] fracBits : radians 的小数位数，不超过 30
+         * @param [out] s : 正弦值，Q30
+         * @param [out] c : 余弦值，Q30
+         */
+        static void sinCosRadians(int64_t radians, int32_t fracBits,
+            int64_t &s, int64_t &c);
+
+        /**
+         * @brief 根据角度求正弦和余弦
+         * @param [in] degrees : 角度，带 fracBits 位小数的定点数
+         * @param [in] fracBits : degrees 的小数位数，不超过 30
+         * @param [out] s : 正弦值，Q30
+         * @param [out] c : 余弦值，Q30
+         */
+        static void sinCosDegrees(int64_t degrees, int32_t fracBits,
+            int64_t &s, int64_t &c);
+
+        /**
+         * @brief 求 y/x 的反正切
+         * @param [in] y, x : 只要是同一种格式就行，跟小数位数无关
+         * @param [in] fracBits : 结果需要的精度，用来决定 CORDIC 迭代次数
+         * @return 返回 [-PI, PI] 的弧度，Q30
+         */
+        static int64_t atan2(int64_t y, int64_t x, int32_t fracBits = Q_BITS);
+
+        /// 求反正弦，value 是 Q30，返回 [-PI/2, PI/2] 的弧度，Q30
+        static int64_t asin(int64_t value, int32_t fracBits = Q_BITS);
+
+        /// 求反余弦，value 是 Q30，返回 [0, PI] 的弧度，Q30
+        static int64_t acos(int64_t value, int32_t fracBits = Q_BITS);
+
+        /**
+         * @brief 求平方根，结果四舍五入
+         * @param [in] value : 带 fracBits 位小数的定点数
+         * @param [in] fracBits : 小数位数，必须是偶数
+         * @return 返回同样带 fracBits 位小数的平方根
+         */
+        static uint64_t sqrt(uint64_t value, int32_t fracBits);
+
+        /// Q30 转成带 fracBits 位小数的定点数，四舍五入
+        static int64_t fromQ30(int64_t value, int32_t fracBits)
+        {
+            int32_t shift = Q_BITS - fracBits;
+            return (value + (1LL << (shift - 1))) >> shift;
+        }
+    };
+
+    /**
+     * @brief 用 FixMath 实现的定点数数学函数，F 是定点数类型，M 是它的尾数类型
+     * @remarks TMath<fix32_t> 和 TMath<fix64_t> 的特化都转到这里
+     */
+    template <typename F, typename M>
+    class TFixMath
+    {
+    public:
+        static F sqrt(F value);
+        static F invSqrt(F value);
+        static F abs(F value);
+
+        static F sin(F radians);
+        static F cos(F radians);
+        static F tan(F radians);
+
+        static F sinDegrees(F degrees);
+        static F cosDegrees(F degrees);
+        static F tanDegrees(F degrees);
+
+        static F asin(F value);
+        static F acos(F value);
+        static F atan(F value);
+        static F atan2(F y, F x);
+
+    protected:
+        /// 尾数转成 Q30，超出 [-1, 1] 的先截断
+        static int64_t toClampedQ30(F value);
+        /// Q30 转成定点数
+        static F fromQ30(int64_t value);
+        /// 用 Q30 的正弦余弦求正切，超出范围时返回无穷大
+        static F tanFromSinCos(int64_t s, int64_t c);
+    };
+}
+
+
+#include "T3DFixMath.inl"
+
+
+#endif  /*__T3D_FIX_MATH_H__*/
@@ -0,0 +1,168 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::sqrt(F value)
+    {
+        T3D_ASSERT(value.ge_0());
+
+        if (value.le_0())
+            return F::ZERO;
+
+        return F((M)FixMath::sqrt((uint64_t)value.mantissa(),
+            F::DECIMAL_BITS), 0);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::invSqrt(F value)
+    {
+        T3D_ASSERT(value.gt_0());
+
+        int64_t s = (int64_t)sqrt(value).mantissa();
+        if (s == 0)
+            return F::INF;
+
+        // 1 / s，分子是两倍小数位数的 1
+        int64_t one = 1LL << (2 * F::DECIMAL_BITS);
+        return F((M)((one + (s >> 1)) / s), 0);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::abs(F value)
+    {
+        return value.lt_0() ? -value : value;
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::sin(F radians)
+    {
+        int64_t s, c;
+        FixMath::sinCosRadians(radians.mantissa(), F::DECIMAL_BITS, s, c);
+        return fromQ30(s);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::cos(F radians)
+    {
+        int64_t s, c;
+        FixMath::sinCosRadians(radians.mantissa(), F::DECIMAL_BITS, s, c);
+        return fromQ30(c);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::tan(F radians)
+    {
+        int64_t s, c;
+        FixMath::sinCosRadians(radians.mantissa(), F::DECIMAL_BITS, s, c);
+        return tanFromSinCos(s, c);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::sinDegrees(F degrees)
+    {
+        int64_t s, c;
+        FixMath::sinCosDegrees(degrees.mantissa(), F::DECIMAL_BITS, s, c);
+        return fromQ30(s);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::cosDegrees(F degrees)
+    {
+        int64_t s, c;
+        FixMath::sinCosDegrees(degrees.mantissa(), F::DECIMAL_BITS, s, c);
+        return fromQ30(c);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::tanDegrees(F degrees)
+    {
+        int64_t s, c;
+        FixMath::sinCosDegrees(degrees.mantissa(), F::DECIMAL_BITS, s, c);
+        return tanFromSinCos(s, c);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::asin(F value)
+    {
+        return fromQ30(FixMath::asin(toClampedQ30(value),
+            F::DECIMAL_BITS));
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::acos(F value)
+    {
+        return fromQ30(FixMath::acos(toClampedQ30(value),
+            F::DECIMAL_BITS));
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::atan(F value)
+    {
+        return fromQ30(FixMath::atan2(value.mantissa(),
+            1LL << F::DECIMAL_BITS, F::DECIMAL_BITS));
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::atan2(F y, F x)
+    {
+        return fromQ30(FixMath::atan2(y.mantissa(), x.mantissa(),
+            F::DECIMAL_BITS));
+    }
+
+    template <typename F, typename M>
+    inline int64_t TFixMath<F, M>::toClampedQ30(F value)
+    {
+        int64_t m = value.mantissa();
+        int64_t one = 1LL << F::DECIMAL_BITS;
+
+        if (m > one)
+            m = one;
+        else if (m < -one)
+            m = -one;
+
+        return m * (1LL << (FixMath::Q_BITS - F::DECIMAL_BITS));
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::fromQ30(int64_t value)
+    {
+        return F((M)FixMath::fromQ30(value, F::DECIMAL_BITS), 0);
+    }
+
+    template <typename F, typename M>
+    inline F TFixMath<F, M>::tanFromSinCos(int64_t s, int64_t c)
+    {
+        if (c == 0)
+            return (s < 0) ? F::MINUSINF : F::INF;
+
+        // |s| <= 2^30，左移小数位数以后最多 54 位，不会溢出
+        int64_t t = (s * (1LL << F::DECIMAL_BITS)) / c;
+        int64_t inf = F::INF.mantissa();
+
+        if (t > inf)
+            return F::INF;
+        if (t < -inf)
+            return F::MINUSINF;
+
+        return F((M)t, 0);
+    }
+}
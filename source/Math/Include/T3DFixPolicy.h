@@ -0,0 +1,328 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_FIX_POLICY_H__
+#define __T3D_FIX_POLICY_H__
+
+
+#include "T3DMathPrerequisites.h"
+
+#if defined (_MSC_VER) && defined (_M_X64)
+    #include <intrin.h>
+#endif
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 定点数乘除用到的加宽运算
+     * @remarks 乘法先加宽到两倍位数再移位，结果四舍五入。
+     *      64 位的乘除有 128 位整数时直接用，没有时拆开计算。
+     */
+    class FixWide
+    {
+    public:
+        /// (a * b) >> shift，四舍五入，overflow 返回结果是否超出 int32_t
+        static int32_t mulShift(int32_t a, int32_t b, int32_t shift,
+            bool &overflow)
+        {
+            int64_t p = ((int64_t)a * b + (1LL << (shift - 1))) >> shift;
+            overflow = (p != (int32_t)p);
+            return (int32_t)p;
+        }
+
+        /// (a * b) >> shift，四舍五入，overflow 返回结果是否超出 int64_t
+        static int64_t mulShift(int64_t a, int64_t b, int32_t shift,
+            bool &overflow)
+        {
+#if defined (__SIZEOF_INT128__)
+            __int128 p = ((__int128)a * b + ((__int128)1 << (shift - 1))) >> shift;
+            overflow = (p != (int64_t)p);
+            return (int64_t)p;
+#else
+            int64_t hi;
+            uint64_t lo;
+    #if defined (_MSC_VER) && defined (_M_X64)
+            lo = (uint64_t)_mul128(a, b, &hi);
+    #else
+            mul128(a, b, hi, lo);
+    #endif
+            // 加上舍入用的一半，低位进位到高位
+            uint64_t half = 1ULL << (shift - 1);
+            uint64_t sum = lo + half;
+            hi += (sum < lo) ? 1 : 0;
+            lo = sum;
+
+            // 移位以后能放进 int64_t 的条件是高位从第 shift - 1 位往上都是符号位
+            int64_t top = hi >> (shift - 1);
+            overflow = (top != 0 && top != -1);
+            return (int64_t)((lo >> shift) | ((uint64_t)hi << (64 - shift)));
+#endif
+        }
+
+        /// (a << shift) / b，向 0 取整，b 不能为 0
+        static int32_t divShift(int32_t a, int32_t b, int32_t shift,
+            bool &overflow)
+        {
+            int64_t q = ((int64_t)a * (1LL << shift)) / b;
+            overflow = (q != (int32_t)q);
+            return (int32_t)q;
+        }
+
+        /// (a << shift) / b，向 0 取整，b 不能为 0
+        static int64_t divShift(int64_t a, int64_t b, int32_t shift,
+            bool &overflow)
+        {
+#if defined (__SIZEOF_INT128__)
+            __int128 q = ((__int128)a * ((__int128)1 << shift)) / b;
+            overflow = (q != (int64_t)q);
+            return (int64_t)q;
+#else
+            // 先求整数部分的商和余数，再逐位求出 shift 位小数
+            bool negative = ((a < 0) != (b < 0));
+            uint64_t ua = (a < 0) ? (uint64_t)0 - (uint64_t)a : (uint64_t)a;
+            uint64_t ub = (b < 0) ? (uint64_t)0 - (uint64_t)b : (uint64_t)b;
+            uint64_t q = ua / ub;
+            uint64_t r = ua % ub;
+
+            overflow = (q >> (63 - shift)) != 0;
+
+            for (int32_t i = 0; i < shift; ++i)
+            {
+                r <<= 1;
+                q <<= 1;
+                if (r >= ub)
+                {
+                    r -= ub;
+                    q |= 1;
+                }
+            }
+
+            return negative ? (int64_t)((uint64_t)0 - q) : (int64_t)q;
+#endif
+        }
+
+    protected:
+        /// 有符号 64 位乘法的 128 位结果
+        static void mul128(int64_t a, int64_t b, int64_t &hi, uint64_t &lo)
+        {
+            uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+            uint64_t a0 = ua & 0xFFFFFFFF, a1 = ua >> 32;
+            uint64_t b0 = ub & 0xFFFFFFFF, b1 = ub >> 32;
+
+            uint64_t p00 = a0 * b0;
+            uint64_t p01 = a0 * b1;
+            uint64_t p10 = a1 * b0;
+            uint64_t p11 = a1 * b1;
+
+            uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+            lo = (p00 & 0xFFFFFFFF) | (mid << 32);
+            uint64_t uhi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+
+            // 无符号结果修正成有符号结果
+            if (a < 0)
+                uhi -= ub;
+            if (b < 0)
+                uhi -= ua;
+
+            hi = (int64_t)uhi;
+        }
+    };
+
+    /**
+     * @brief 不做任何检查的定点数乘除，溢出时按补码回绕
+     * @remarks 乘法就是加宽、相乘、四舍五入移位，没有分支。除数不能为 0。
+     */
+    struct FixWrapPolicy
+    {
+        template <typename M, int32_t FRAC>
+        static M mul(M a, M b)
+        {
+            bool overflow;
+            return FixWide::mulShift(a, b, FRAC, overflow);
+        }
+
+        template <typename M, int32_t FRAC>
+        static M div(M a, M b)
+        {
+            bool overflow;
+            return FixWide::divShift(a, b, FRAC, overflow);
+        }
+    };
+
+    /**
+     * @brief 溢出时截断到最大值或最小值（即定点数的 INF 和 MINUSINF）
+     * @remarks 除数为 0 时按被除数的符号返回 INF 或 MINUSINF
+     */
+    struct FixSaturatePolicy
+    {
+        template <typename M, int32_t FRAC>
+        static M mul(M a, M b)
+        {
+            bool overflow;
+            M r = FixWide::mulShift(a, b, FRAC, overflow);
+            return overflow ? saturate<M>((a < 0) != (b < 0)) : r;
+        }
+
+        template <typename M, int32_t FRAC>
+        static M div(M a, M b)
+        {
+            if (b == 0)
+                return saturate<M>(a < 0);
+
+            bool overflow;
+            M r = FixWide::divShift(a, b, FRAC, overflow);
+            return overflow ? saturate<M>((a < 0) != (b < 0)) : r;
+        }
+
+        template <typename M>
+        static M saturate(bool negative)
+        {
+            return negative ? std::numeric_limits<M>::min()
+                : std::numeric_limits<M>::max();
+        }
+    };
+
+    /**
+     * @brief 定点数运算符默认使用的策略
+     * @remarks 调试版断言不溢出，发布版和 FixWrapPolicy 完全一样；
+     *      除数为 0 时返回 INF，和以前的行为一致
+     */
+    struct FixCheckedPolicy
+    {
+        template <typename M, int32_t FRAC>
+        static M mul(M a, M b)
+        {
+            bool overflow;
+            M r = FixWide::mulShift(a, b, FRAC, overflow);
+            T3D_ASSERT(!overflow);
+            return r;
+        }
+
+        template <typename M, int32_t FRAC>
+        static M div(M a, M b)
+        {
+            if (b == 0)
+                return std::numeric_limits<M>::max();
+
+            bool overflow;
+            M r = FixWide::divShift(a, b, FRAC, overflow);
+            T3D_ASSERT(!overflow);
+            return r;
+        }
+    };
+
+    /**
+     * @brief 按指定策略做定点数运算
+     * @remarks 例如 TFixOps<FixWrapPolicy>::mul(a, b)，
+     *      F 是 fix32 或 fix64，Policy 是上面的策略之一
+     */
+    template <typename Policy>
+    class TFixOps
+    {
+    public:
+        template <typename F>
+        static F mul(const F &a, const F &b)
+        {
+            return F(Policy::template mul<decltype(a.mantissa()),
+                F::DECIMAL_BITS>(a.mantissa(), b.mantissa()), 0);
+        }
+
+        template <typename F>
+        static F div(const F &a, const F &b)
+        {
+            return F(Policy::template div<decltype(a.mantissa()),
+                F::DECIMAL_BITS>(a.mantissa(), b.mantissa()), 0);
+        }
+
+        /// a * b + c，加法按补码回绕
+        template <typename F>
+        static F mulAdd(const F &a, const F &b, const F &c)
+        {
+            return F(Policy::template mul<decltype(a.mantissa()),
+                F::DECIMAL_BITS>(a.mantissa(), b.mantissa()) + c.mantissa(), 0);
+        }
+    };
+
+    /**
+     * @brief 用倒数乘法代替除法
+     * @remarks 构造时求一次除数的倒数，之后每次除法只要一次加宽乘法和移位，
+     *      适合同一个数除很多次的情况，比如向量归一化、矩阵除以行列式。
+     *      倒数保留 62 位有效位，乘积在 128 位里算，结果和直接相除
+     *      最多差 1 个最低位。
+     */
+    template <typename F>
+    class TFixDivider
+    {
+    public:
+        TFixDivider(const F &divisor)
+        {
+            int64_t d = divisor.mantissa();
+            T3D_ASSERT(d != 0);
+
+            uint64_t ud = (d < 0) ? (uint64_t)0 - (uint64_t)d : (uint64_t)d;
+            int32_t bits = 0;
+            while ((ud >> bits) > 1)
+                ++bits;
+
+            // 长除法求 2^(62 + bits) / |d|，结果落在 (2^61, 2^62] 之间
+            uint64_t r = 1ULL << bits;
+            uint64_t q = (r >= ud) ? 1 : 0;
+            r -= q * ud;
+
+            for (int32_t i = 0; i < 62; ++i)
+            {
+                r <<= 1;
+                q <<= 1;
+                if (r >= ud)
+                {
+                    r -= ud;
+                    q |= 1;
+                }
+            }
+
+            mReciprocal = (d < 0) ? -(int64_t)q : (int64_t)q;
+
+            // value / d = value * 2^FRAC / d = (value * mReciprocal) >> (62 + bits - FRAC)
+            mShift = 62 + bits - F::DECIMAL_BITS;
+
+            // 移位不超过 62 位，除数的绝对值大于 1 时丢掉倒数的低位，
+            // 这时商本身也变小了，需要的有效位数同样变少
+            if (mShift > 62)
+            {
+                mReciprocal >>= (mShift - 62);
+                mShift = 62;
+            }
+        }
+
+        F divide(const F &value) const
+        {
+            bool overflow;
+            return F((decltype(value.mantissa()))FixWide::mulShift(
+                (int64_t)value.mantissa(), mReciprocal, mShift, overflow), 0);
+        }
+
+    protected:
+        int64_t mReciprocal;
+        int32_t mShift;
+    };
+}
+
+
+#endif  /*__T3D_FIX_POLICY_H__*/
@@ -0,0 +1,141 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_FRUSTUM_CULLER_H__
+#define __T3D_FRUSTUM_CULLER_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DFrustum.h"
+#include "T3DVector3Stream.h"
+#include "T3DMathSIMD.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 批量视锥裁剪
+     * @remarks 输入是按分量分开存放的包围球或 AABB 数组，输出可见性位掩码，
+     *      第 i 个物体可见时 mask[i / 32] 的第 i % 32 位为 1。
+     *      物体按 GROUP_SIZE 个一组，每组同时和一个平面做检测，整组都被剔除
+     *      就不再测剩下的平面。float32_t 在开启 SIMD 时一组只要一条（AVX）
+     *      或两条（SSE2/NEON）向量指令序列。
+     *
+     *      可选的平面缓存每组一个字节，记录上次把整组剔除掉的平面，下次先测
+     *      这个平面（平面连贯性）。缓存由调用者持有，第一次使用前清零即可。
+     *
+     *      AABB 对每个平面只测离平面最远的正顶点（p-vertex），正顶点按平面
+     *      法线所在的卦限在 setFrustum 时预先选好，检测时不需要逐个比较。
+     *      判定规则和 TIntrFrustumSphere、TIntrFrustumAabb 一致。
+     */
+    template <typename T>
+    class TFrustumCuller
+    {
+    public:
+        /// 每组物体个数，位掩码的一个字节对应一组
+        static const size_t GROUP_SIZE = 8;
+
+        TFrustumCuller();
+        TFrustumCuller(const TFrustum<T> &frustum);
+
+        /// 设置视锥，同时预先计算每个平面的正顶点卦限
+        void setFrustum(const TFrustum<T> &frustum);
+
+        /// 保存 count 个物体的可见性需要多少个 uint32_t
+        static size_t getMaskSize(size_t count);
+
+        /// 保存 count 个物体的平面缓存需要多少个字节
+        static size_t getCacheSize(size_t count);
+
+        /// 从位掩码里取第 i 个物体是否可见
+        static bool isVisible(const uint32_t *mask, size_t i);
+
+        /**
+         * @brief 批量裁剪包围球
+         * @param [in] x, y, z : 球心各分量数组
+         * @param [in] radius : 半径数组
+         * @param [in] count : 球的个数
+         * @param [out] mask : 可见性位掩码，至少 getMaskSize(count) 个元素
+         * @param [in,out] planeCache : 平面缓存，至少 getCacheSize(count)
+         *      个字节，可以为空
+         * @return 可见物体的个数
+         */
+        size_t cullSpheres(const T *x, const T *y, const T *z,
+            const T *radius, size_t count, uint32_t *mask,
+            uint8_t *planeCache = nullptr) const;
+
+        /// 球心用 TVector3Stream 存放的版本
+        size_t cullSpheres(const TVector3Stream<T> &centers, const T *radius,
+            uint32_t *mask, uint8_t *planeCache = nullptr) const;
+
+        /**
+         * @brief 批量裁剪 AABB
+         * @param [in] minX, minY, minZ : 最小点各分量数组
+         * @param [in] maxX, maxY, maxZ : 最大点各分量数组
+         * @param [in] count : AABB 的个数
+         * @param [out] mask : 可见性位掩码，至少 getMaskSize(count) 个元素
+         * @param [in,out] planeCache : 平面缓存，至少 getCacheSize(count)
+         *      个字节，可以为空
+         * @return 可见物体的个数
+         */
+        size_t cullAabbs(const T *minX, const T *minY, const T *minZ,
+            const T *maxX, const T *maxY, const T *maxZ, size_t count,
+            uint32_t *mask, uint8_t *planeCache = nullptr) const;
+
+        /// 最小点和最大点用 TVector3Stream 存放的版本
+        size_t cullAabbs(const TVector3Stream<T> &mins,
+            const TVector3Stream<T> &maxs, uint32_t *mask,
+            uint8_t *planeCache = nullptr) const;
+
+    protected:
+        /// 一组球和一个平面检测，返回在平面正面或相交的位
+        uint32_t testSpheres(size_t plane, const T *x, const T *y,
+            const T *z, const T *radius, size_t n) const;
+
+        /// 一组 AABB 的正顶点和一个平面检测，返回在平面正面或相交的位
+        uint32_t testAabbs(size_t plane, const T *px, const T *py,
+            const T *pz, size_t n) const;
+
+        uint32_t testSpheresGeneric(size_t plane, const T *x, const T *y,
+            const T *z, const T *radius, size_t n) const;
+
+        uint32_t testAabbsGeneric(size_t plane, const T *px, const T *py,
+            const T *pz, size_t n) const;
+
+        /// 写入一组的可见性并返回可见个数
+        static size_t storeGroup(uint32_t *mask, size_t group,
+            uint32_t visible);
+
+        enum Octant
+        {
+            E_OCTANT_X = 0x01,  /// 法线 x 分量为正，正顶点取最大点的 x
+            E_OCTANT_Y = 0x02,  /// 法线 y 分量为正
+            E_OCTANT_Z = 0x04,  /// 法线 z 分量为正
+        };
+
+        T       mPlanes[TFrustum<T>::E_MAX_FACE][4];    /// 平面方程系数
+        uint8_t mOctants[TFrustum<T>::E_MAX_FACE];      /// 正顶点卦限
+    };
+}
+
+
+#include "T3DFrustumCuller.inl"
+
+
+#endif  /*__T3D_FRUSTUM_CULLER_H__*/
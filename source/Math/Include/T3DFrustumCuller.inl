@@ -0,0 +1,336 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const size_t TFrustumCuller<T>::GROUP_SIZE;
+
+    template <typename T>
+    inline TFrustumCuller<T>::TFrustumCuller()
+    {
+        for (size_t i = 0; i < TFrustum<T>::E_MAX_FACE; ++i)
+        {
+            mPlanes[i][0] = mPlanes[i][1] = TReal<T>::ZERO;
+            mPlanes[i][2] = mPlanes[i][3] = TReal<T>::ZERO;
+            mOctants[i] = 0;
+        }
+    }
+
+    template <typename T>
+    inline TFrustumCuller<T>::TFrustumCuller(const TFrustum<T> &frustum)
+    {
+        setFrustum(frustum);
+    }
+
+    template <typename T>
+    inline void TFrustumCuller<T>::setFrustum(const TFrustum<T> &frustum)
+    {
+        for (size_t i = 0; i < TFrustum<T>::E_MAX_FACE; ++i)
+        {
+            const TPlane<T> &plane
+                = frustum.getFace((typename TFrustum<T>::Face)i);
+
+            mPlanes[i][0] = plane[0];
+            mPlanes[i][1] = plane[1];
+            mPlanes[i][2] = plane[2];
+            mPlanes[i][3] = plane[3];
+
+            mOctants[i] = 0;
+            if (plane[0] > TReal<T>::ZERO)
+                mOctants[i] |= E_OCTANT_X;
+            if (plane[1] > TReal<T>::ZERO)
+                mOctants[i] |= E_OCTANT_Y;
+            if (plane[2] > TReal<T>::ZERO)
+                mOctants[i] |= E_OCTANT_Z;
+        }
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::getMaskSize(size_t count)
+    {
+        return (count + 31) / 32;
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::getCacheSize(size_t count)
+    {
+        return (count + GROUP_SIZE - 1) / GROUP_SIZE;
+    }
+
+    template <typename T>
+    inline bool TFrustumCuller<T>::isVisible(const uint32_t *mask, size_t i)
+    {
+        return ((mask[i >> 5] >> (i & 31)) & 1) != 0;
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::storeGroup(uint32_t *mask, size_t group,
+        uint32_t visible)
+    {
+        // 一个 uint32_t 放 4 组，每组 8 位
+        size_t shift = (group & 3) * GROUP_SIZE;
+
+        if (shift == 0)
+            mask[group >> 2] = 0;
+
+        mask[group >> 2] |= visible << shift;
+
+        size_t n = 0;
+        while (visible != 0)
+        {
+            visible &= visible - 1;
+            ++n;
+        }
+
+        return n;
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::cullSpheres(const T *x, const T *y,
+        const T *z, const T *radius, size_t count, uint32_t *mask,
+        uint8_t *planeCache /* = nullptr */) const
+    {
+        const size_t planeCount = TFrustum<T>::E_MAX_FACE;
+        size_t visibleCount = 0;
+
+        for (size_t group = 0, base = 0; base < count;
+            ++group, base += GROUP_SIZE)
+        {
+            size_t n = count - base < GROUP_SIZE ? count - base : GROUP_SIZE;
+            uint32_t visible = (1u << n) - 1;
+
+            // 从上次剔除整组的平面开始测
+            size_t plane = (planeCache != nullptr) ? planeCache[group] : 0;
+            if (plane >= planeCount)
+                plane = 0;
+
+            for (size_t i = 0; i < planeCount; ++i)
+            {
+                visible &= testSpheres(plane, x + base, y + base, z + base,
+                    radius + base, n);
+
+                if (visible == 0)
+                {
+                    if (planeCache != nullptr)
+                        planeCache[group] = (uint8_t)plane;
+                    break;
+                }
+
+                if (++plane == planeCount)
+                    plane = 0;
+            }
+
+            visibleCount += storeGroup(mask, group, visible);
+        }
+
+        return visibleCount;
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::cullSpheres(
+        const TVector3Stream<T> &centers, const T *radius, uint32_t *mask,
+        uint8_t *planeCache /* = nullptr */) const
+    {
+        return cullSpheres(centers.x(), centers.y(), centers.z(), radius,
+            centers.size(), mask, planeCache);
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::cullAabbs(const T *minX, const T *minY,
+        const T *minZ, const T *maxX, const T *maxY, const T *maxZ,
+        size_t count, uint32_t *mask, uint8_t *planeCache /* = nullptr */) const
+    {
+        const size_t planeCount = TFrustum<T>::E_MAX_FACE;
+        size_t visibleCount = 0;
+
+        for (size_t group = 0, base = 0; base < count;
+            ++group, base += GROUP_SIZE)
+        {
+            size_t n = count - base < GROUP_SIZE ? count - base : GROUP_SIZE;
+            uint32_t visible = (1u << n) - 1;
+
+            size_t plane = (planeCache != nullptr) ? planeCache[group] : 0;
+            if (plane >= planeCount)
+                plane = 0;
+
+            for (size_t i = 0; i < planeCount; ++i)
+            {
+                uint8_t octant = mOctants[plane];
+                const T *px = (octant & E_OCTANT_X) ? maxX : minX;
+                const T *py = (octant & E_OCTANT_Y) ? maxY : minY;
+                const T *pz = (octant & E_OCTANT_Z) ? maxZ : minZ;
+
+                visible &= testAabbs(plane, px + base, py + base, pz + base,
+                    n);
+
+                if (visible == 0)
+                {
+                    if (planeCache != nullptr)
+                        planeCache[group] = (uint8_t)plane;
+                    break;
+                }
+
+                if (++plane == planeCount)
+                    plane = 0;
+            }
+
+            visibleCount += storeGroup(mask, group, visible);
+        }
+
+        return visibleCount;
+    }
+
+    template <typename T>
+    inline size_t TFrustumCuller<T>::cullAabbs(const TVector3Stream<T> &mins,
+        const TVector3Stream<T> &maxs, uint32_t *mask,
+        uint8_t *planeCache /* = nullptr */) const
+    {
+        T3D_ASSERT(mins.size() == maxs.size());
+        return cullAabbs(mins.x(), mins.y(), mins.z(), maxs.x(), maxs.y(),
+            maxs.z(), mins.size(), mask, planeCache);
+    }
+
+    template <typename T>
+    inline uint32_t TFrustumCuller<T>::testSpheres(size_t plane, const T *x,
+        const T *y, const T *z, const T *radius, size_t n) const
+    {
+        return testSpheresGeneric(plane, x, y, z, radius, n);
+    }
+
+    template <typename T>
+    inline uint32_t TFrustumCuller<T>::testAabbs(size_t plane, const T *px,
+        const T *py, const T *pz, size_t n) const
+    {
+        return testAabbsGeneric(plane, px, py, pz, n);
+    }
+
+    template <typename T>
+    inline uint32_t TFrustumCuller<T>::testSpheresGeneric(size_t plane,
+        const T *x, const T *y, const T *z, const T *radius, size_t n) const
+    {
+        const T *p = mPlanes[plane];
+        uint32_t bits = 0;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            T d = p[0] * x[i] + p[1] * y[i] + p[2] * z[i] + p[3];
+            if (d + radius[i] > TReal<T>::ZERO)
+                bits |= (1u << i);
+        }
+
+        return bits;
+    }
+
+    template <typename T>
+    inline uint32_t TFrustumCuller<T>::testAabbsGeneric(size_t plane,
+        const T *px, const T *py, const T *pz, size_t n) const
+    {
+        const T *p = mPlanes[plane];
+        uint32_t bits = 0;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            T d = p[0] * px[i] + p[1] * py[i] + p[2] * pz[i] + p[3];
+            if (d > TReal<T>::ZERO)
+                bits |= (1u << i);
+        }
+
+        return bits;
+    }
+
+#if defined (T3D_SIMD)
+    template <>
+    inline uint32_t TFrustumCuller<float32_t>::testSpheres(size_t plane,
+        const float32_t *x, const float32_t *y, const float32_t *z,
+        const float32_t *radius, size_t n) const
+    {
+        if (n != GROUP_SIZE)
+            return testSpheresGeneric(plane, x, y, z, radius, n);
+
+        const float32_t *p = mPlanes[plane];
+
+#if defined (T3D_SIMD_AVX)
+        __m256 d = _mm256_add_ps(_mm256_set1_ps(p[3]), _mm256_loadu_ps(radius));
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[0]), _mm256_loadu_ps(x)));
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[1]), _mm256_loadu_ps(y)));
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[2]), _mm256_loadu_ps(z)));
+        return (uint32_t)_mm256_movemask_ps(
+            _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ));
+#else
+        const SIMDFloat4 nx = simdSplat(p[0]);
+        const SIMDFloat4 ny = simdSplat(p[1]);
+        const SIMDFloat4 nz = simdSplat(p[2]);
+        const SIMDFloat4 nd = simdSplat(p[3]);
+        const SIMDFloat4 zero = simdSplat(0.0f);
+
+        SIMDFloat4 d0 = simdAdd(nd, simdLoad(radius));
+        d0 = simdMulAdd(nx, simdLoad(x), d0);
+        d0 = simdMulAdd(ny, simdLoad(y), d0);
+        d0 = simdMulAdd(nz, simdLoad(z), d0);
+
+        SIMDFloat4 d1 = simdAdd(nd, simdLoad(radius + 4));
+        d1 = simdMulAdd(nx, simdLoad(x + 4), d1);
+        d1 = simdMulAdd(ny, simdLoad(y + 4), d1);
+        d1 = simdMulAdd(nz, simdLoad(z + 4), d1);
+
+        return simdMoveMask(simdCmpGt(d0, zero))
+            | (simdMoveMask(simdCmpGt(d1, zero)) << 4);
+#endif
+    }
+
+    template <>
+    inline uint32_t TFrustumCuller<float32_t>::testAabbs(size_t plane,
+        const float32_t *px, const float32_t *py, const float32_t *pz,
+        size_t n) const
+    {
+        if (n != GROUP_SIZE)
+            return testAabbsGeneric(plane, px, py, pz, n);
+
+        const float32_t *p = mPlanes[plane];
+
+#if defined (T3D_SIMD_AVX)
+        __m256 d = _mm256_set1_ps(p[3]);
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[0]), _mm256_loadu_ps(px)));
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[1]), _mm256_loadu_ps(py)));
+        d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(p[2]), _mm256_loadu_ps(pz)));
+        return (uint32_t)_mm256_movemask_ps(
+            _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ));
+#else
+        const SIMDFloat4 nx = simdSplat(p[0]);
+        const SIMDFloat4 ny = simdSplat(p[1]);
+        const SIMDFloat4 nz = simdSplat(p[2]);
+        const SIMDFloat4 nd = simdSplat(p[3]);
+        const SIMDFloat4 zero = simdSplat(0.0f);
+
+        SIMDFloat4 d0 = simdMulAdd(nx, simdLoad(px), nd);
+        d0 = simdMulAdd(ny, simdLoad(py), d0);
+        d0 = simdMulAdd(nz, simdLoad(pz), d0);
+
+        SIMDFloat4 d1 = simdMulAdd(nx, simdLoad(px + 4), nd);
+        d1 = simdMulAdd(ny, simdLoad(py + 4), d1);
+        d1 = simdMulAdd(nz, simdLoad(pz + 4), d1);
+
+        return simdMoveMask(simdCmpGt(d0, zero))
+            | (simdMoveMask(simdCmpGt(d1, zero)) << 4);
+#endif
+    }
+#endif  /*T3D_SIMD*/
+}
@@ -0,0 +1,105 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_HALF_FLOAT_H__
+#define __T3D_HALF_FLOAT_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DVector3.h"
+#include <string.h>
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief IEEE 754 半精度浮点数（binary16）和 float32_t 之间的转换
+     * @remarks 半精度数用 uint16_t 保存：1 位符号、5 位指数、10 位尾数，
+     *      能表示的最大值是 65504，相对精度约 1/2048。
+     *      转换支持向最近偶数舍入和向正负无穷舍入，后两种用来做保守的
+     *      包围体压缩（最小值向下舍入，最大值向上舍入）。
+     */
+    class HalfFloat
+    {
+    public:
+        enum RoundMode
+        {
+            E_ROUND_NEAREST = 0,    /// 向最近的偶数舍入
+            E_ROUND_UP,             /// 向正无穷舍入，结果不小于原值
+            E_ROUND_DOWN,           /// 向负无穷舍入，结果不大于原值
+        };
+
+        static const uint16_t POSITIVE_INF = 0x7C00;
+        static const uint16_t NEGATIVE_INF = 0xFC00;
+
+        /// float32_t 转成半精度数
+        static uint16_t fromFloat(float32_t value,
+            RoundMode mode = E_ROUND_NEAREST);
+
+        /// 半精度数转成 float32_t，结果是精确的
+        static float32_t toFloat(uint16_t value);
+
+        /// 比 value 大的下一个半精度数，正无穷和 NaN 不变
+        static uint16_t nextUp(uint16_t value);
+
+        /// 比 value 小的下一个半精度数，负无穷和 NaN 不变
+        static uint16_t nextDown(uint16_t value);
+
+    protected:
+        static uint16_t roundNearest(float32_t value);
+    };
+
+    /**
+     * @brief 分量用半精度数保存的三维向量，6 个字节
+     */
+    class HalfVector3
+    {
+    public:
+        HalfVector3();
+        HalfVector3(const TVector3<float32_t> &v,
+            HalfFloat::RoundMode mode = HalfFloat::E_ROUND_NEAREST);
+
+        void set(const TVector3<float32_t> &v,
+            HalfFloat::RoundMode mode = HalfFloat::E_ROUND_NEAREST);
+
+        TVector3<float32_t> toVector3() const;
+
+        uint16_t operator [](int32_t i) const;
+        uint16_t &operator [](int32_t i);
+
+        bool operator ==(const HalfVector3 &other) const;
+        bool operator !=(const HalfVector3 &other) const;
+
+        /// 批量转换 count 个向量
+        static void encode(const TVector3<float32_t> *src, HalfVector3 *dst,
+            size_t count, HalfFloat::RoundMode mode = HalfFloat::E_ROUND_NEAREST);
+
+        static void decode(const HalfVector3 *src, TVector3<float32_t> *dst,
+            size_t count);
+
+    private:
+        uint16_t    mTuples[3];
+    };
+}
+
+
+#include "T3DHalfFloat.inl"
+
+
+#endif  /*__T3D_HALF_FLOAT_H__*/
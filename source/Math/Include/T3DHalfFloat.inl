@@ -0,0 +1,207 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    inline uint16_t HalfFloat::roundNearest(float32_t value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+        bits &= 0x7FFFFFFF;
+
+        if (bits >= 0x7F800000)
+        {
+            // 无穷大和 NaN，NaN 保留为静默 NaN
+            return sign | ((bits > 0x7F800000) ? 0x7E00 : POSITIVE_INF);
+        }
+
+        if (bits >= 0x477FF000)
+        {
+            // 不小于 65520 的数舍入到无穷大
+            return sign | POSITIVE_INF;
+        }
+
+        if (bits < 0x38800000)
+        {
+            // 小于 2^-14，结果是非规格化数或者 0
+            if (bits <= 0x33000000)
+                return sign;
+
+            uint32_t mantissa = (bits & 0x007FFFFF) | 0x00800000;
+            uint32_t shift = 126 - (bits >> 23);
+            uint32_t result = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1);
+            uint32_t half = 1u << (shift - 1);
+
+            if (rest > half || (rest == half && (result & 1)))
+                ++result;
+
+            return sign | (uint16_t)result;
+        }
+
+        // 指数偏移从 127 换成 15，尾数截掉 13 位，进位会自然进到指数
+        uint32_t result = (bits - 0x38000000) >> 13;
+        uint32_t rest = bits & 0x1FFF;
+
+        // 舍入方向接近随机，不用分支
+        result += (uint32_t)(rest > 0x1000)
+            | ((uint32_t)(rest == 0x1000) & result);
+
+        return sign | (uint16_t)result;
+    }
+
+    inline uint16_t HalfFloat::fromFloat(float32_t value, RoundMode mode)
+    {
+        uint16_t result = roundNearest(value);
+
+        if (mode == E_ROUND_UP)
+        {
+            if (toFloat(result) < value)
+                result = nextUp(result);
+        }
+        else if (mode == E_ROUND_DOWN)
+        {
+            if (toFloat(result) > value)
+                result = nextDown(result);
+        }
+
+        return result;
+    }
+
+    inline float32_t HalfFloat::toFloat(uint16_t value)
+    {
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x03FF;
+        uint32_t bits;
+
+        if (exponent == 0)
+        {
+            // 非规格化数是 mantissa * 2^-24，乘法是精确的
+            float32_t result = (float32_t)mantissa * 5.9604644775390625e-8f;
+            return sign ? -result : result;
+        }
+        else if (exponent == 31)
+        {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float32_t result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    inline uint16_t HalfFloat::nextUp(uint16_t value)
+    {
+        if ((value & 0x7FFF) > POSITIVE_INF || value == POSITIVE_INF)
+            return value;
+
+        if (value == 0x8000)
+            return 0x0001;
+
+        return (value & 0x8000) ? value - 1 : value + 1;
+    }
+
+    inline uint16_t HalfFloat::nextDown(uint16_t value)
+    {
+        if ((value & 0x7FFF) > POSITIVE_INF || value == NEGATIVE_INF)
+            return value;
+
+        if (value == 0x0000)
+            return 0x8001;
+
+        return (value & 0x8000) ? value + 1 : value - 1;
+    }
+
+    //--------------------------------------------------------------------------
+
+    inline HalfVector3::HalfVector3()
+    {
+        mTuples[0] = mTuples[1] = mTuples[2] = 0;
+    }
+
+    inline HalfVector3::HalfVector3(const TVector3<float32_t> &v,
+        HalfFloat::RoundMode mode)
+    {
+        set(v, mode);
+    }
+
+    inline void HalfVector3::set(const TVector3<float32_t> &v,
+        HalfFloat::RoundMode mode)
+    {
+        mTuples[0] = HalfFloat::fromFloat(v.x(), mode);
+        mTuples[1] = HalfFloat::fromFloat(v.y(), mode);
+        mTuples[2] = HalfFloat::fromFloat(v.z(), mode);
+    }
+
+    inline TVector3<float32_t> HalfVector3::toVector3() const
+    {
+        return TVector3<float32_t>(HalfFloat::toFloat(mTuples[0]),
+            HalfFloat::toFloat(mTuples[1]), HalfFloat::toFloat(mTuples[2]));
+    }
+
+    inline uint16_t HalfVector3::operator [](int32_t i) const
+    {
+        T3D_ASSERT(i >= 0 && i < 3);
+        return mTuples[i];
+    }
+
+    inline uint16_t &HalfVector3::operator [](int32_t i)
+    {
+        T3D_ASSERT(i >= 0 && i < 3);
+        return mTuples[i];
+    }
+
+    inline bool HalfVector3::operator ==(const HalfVector3 &other) const
+    {
+        return (mTuples[0] == other.mTuples[0]
+            && mTuples[1] == other.mTuples[1]
+            && mTuples[2] == other.mTuples[2]);
+    }
+
+    inline bool HalfVector3::operator !=(const HalfVector3 &other) const
+    {
+        return !operator ==(other);
+    }
+
+    inline void HalfVector3::encode(const TVector3<float32_t> *src,
+        HalfVector3 *dst, size_t count, HalfFloat::RoundMode mode)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i].set(src[i], mode);
+        }
+    }
+
+    inline void HalfVector3::decode(const HalfVector3 *src,
+        TVector3<float32_t> *dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[i] = src[i].toVector3();
+        }
+    }
+}
@@ -54,8 +54,13 @@ namespace Tiny3D
         if (mBox0 == nullptr || mBox1 == nullptr)
             return false;
 
-
-        return true;
+        // 三个轴上的投影都重叠才相交，边界接触也算相交
+        return mBox0->getMinX() <= mBox1->getMaxX()
+            && mBox1->getMinX() <= mBox0->getMaxX()
+            && mBox0->getMinY() <= mBox1->getMaxY()
+            && mBox1->getMinY() <= mBox0->getMaxY()
+            && mBox0->getMinZ() <= mBox1->getMaxZ()
+            && mBox1->getMinZ() <= mBox0->getMaxZ();
     }
 }
 
@@ -0,0 +1,174 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_LOOSE_OCTREE_H__
+#define __T3D_LOOSE_OCTREE_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DMath.h"
+#include "T3DAabb.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 松散八叉树，和 TAabbTree 接口相同的另一种粗检测结构
+     * @remarks 每个格子的松散包围盒是格子本身放大 looseness 倍，物体按中心
+     *      点所在的格子和自身大小放到能完全装下它的最深一层，移动时只在跨格子
+     *      或者大小变化时才换节点，不需要旋转和重建，更新比 TAabbTree 便宜，
+     *      但物体大小相差悬殊时查询要测的物体更多。
+     *
+     *      八叉树覆盖的是包含 world 的立方体，节点按需创建，子树里没有物体
+     *      以后回收。远离世界范围、装不进任何孩子的物体放在根节点，根节点
+     *      总是被遍历，所以结果仍然正确，只是变慢。
+     *
+     *      查询和配对的结果和 TAabbTree 一样是实际包围盒相交的物体。
+     */
+    template <typename T>
+    class TLooseOctree
+    {
+    public:
+        /// 无效的代理编号
+        static const uint32_t INVALID_PROXY = 0xFFFFFFFF;
+
+        /// 最大深度
+        static const uint32_t MAX_DEPTH = 16;
+
+        /**
+         * @brief 构造函数
+         * @param [in] world : 世界范围
+         * @param [in] maxDepth : 最大深度，根节点深度为 0，不超过 MAX_DEPTH
+         * @param [in] looseness : 松散包围盒相对格子的倍数，要大于 1
+         */
+        TLooseOctree(const TAabb<T> &world, uint32_t maxDepth = 8,
+            T looseness = TReal<T>::ONE + TReal<T>::ONE);
+
+        /**
+         * @brief 插入一个物体
+         * @param [in] box : 物体的包围盒
+         * @param [in] userData : 用户数据，配对时用来找回物体
+         * @return 代理编号
+         */
+        uint32_t insert(const TAabb<T> &box, void *userData = nullptr);
+
+        /// 删除一个物体
+        void remove(uint32_t proxy);
+
+        /**
+         * @brief 更新物体的包围盒
+         * @return 物体换了节点时返回 true
+         */
+        bool move(uint32_t proxy, const TAabb<T> &box);
+
+        /// 删除所有物体和节点，世界范围不变
+        void clear();
+
+        /// 代理的实际包围盒
+        const TAabb<T> &getAabb(uint32_t proxy) const;
+
+        /// 代理的用户数据
+        void *getUserData(uint32_t proxy) const;
+
+        /// 物体个数
+        size_t getProxyCount() const;
+
+        /// 正在使用的节点个数
+        size_t getNodeCount() const;
+
+        /**
+         * @brief 找出和 box 相交的所有物体
+         * @param [in] box : 查询的包围盒
+         * @param [in] callback : 每个相交的物体调用一次 callback(uint32_t proxy)
+         */
+        template <typename Callback>
+        void queryOverlaps(const TAabb<T> &box, Callback callback) const;
+
+        /**
+         * @brief 找出所有包围盒相交的物体对
+         * @remarks 每个物体用自己的包围盒查询一次，只报告编号比自己大的物体，
+         *      调用 callback(uint32_t proxyA, uint32_t proxyB)，proxyA < proxyB
+         * @return 物体对的个数
+         */
+        template <typename Callback>
+        size_t computePairs(Callback callback) const;
+
+    protected:
+        /// 遍历用的栈深度，每层最多压入 8 个孩子
+        static const uint32_t STACK_SIZE = 8 * MAX_DEPTH + 8;
+
+        /// 松散包围盒由格子算出来，不单独保存，float32_t 时每个节点 64 字节
+        struct Node
+        {
+            /// 格子的中心和半边长
+            T           center[3];
+            T           halfSize;
+            uint32_t    children[8];
+            uint32_t    depth;
+            /// 节点里第一个物体，节点空闲时是空闲链表的下一个节点
+            uint32_t    first;
+            /// 整棵子树里的物体个数，为 0 的子树不用遍历
+            uint32_t    count;
+            uint32_t    parent;
+        };
+
+        struct Proxy
+        {
+            TAabb<T>    box;
+            void        *userData;
+            /// 所在的节点，空闲的代理为 INVALID_PROXY
+            uint32_t    node;
+            /// 同一个节点里物体的双向链表，空闲时 next 是空闲链表
+            uint32_t    prev;
+            uint32_t    next;
+        };
+
+        /// 找到能装下 box 的最深的节点，路径上缺的节点会被创建
+        uint32_t findNode(const TAabb<T> &box);
+
+        uint32_t createChild(uint32_t parent, uint32_t octant);
+
+        void link(uint32_t proxy, uint32_t node);
+
+        void unlink(uint32_t proxy);
+
+        /// 从 node 往上回收没有物体的节点
+        void prune(uint32_t node);
+
+        void setupRoot();
+
+        static bool overlaps(const TAabb<T> &a, const TAabb<T> &b);
+
+        TArray<Node>    mNodes;
+        TArray<Proxy>   mProxies;
+        TAabb<T>        mWorld;
+        uint32_t        mMaxDepth;
+        T               mLooseness;
+        uint32_t        mFreeList;
+        uint32_t        mFreeNodes;
+        size_t          mNodeCount;
+        size_t          mProxyCount;
+    };
+}
+
+
+#include "T3DLooseOctree.inl"
+
+
+#endif  /*__T3D_LOOSE_OCTREE_H__*/
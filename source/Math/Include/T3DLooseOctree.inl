@@ -0,0 +1,439 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const uint32_t TLooseOctree<T>::INVALID_PROXY;
+
+    template <typename T>
+    const uint32_t TLooseOctree<T>::MAX_DEPTH;
+
+    template <typename T>
+    const uint32_t TLooseOctree<T>::STACK_SIZE;
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    TLooseOctree<T>::TLooseOctree(const TAabb<T> &world, uint32_t maxDepth,
+        T looseness)
+        : mWorld(world)
+        , mMaxDepth(std::min(maxDepth, MAX_DEPTH))
+        , mLooseness(looseness)
+        , mFreeList(INVALID_PROXY)
+        , mFreeNodes(INVALID_PROXY)
+        , mNodeCount(0)
+        , mProxyCount(0)
+    {
+        T3D_ASSERT(looseness > TReal<T>::ONE);
+        setupRoot();
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::clear()
+    {
+        mNodes.clear();
+        mProxies.clear();
+        mFreeList = INVALID_PROXY;
+        mFreeNodes = INVALID_PROXY;
+        mNodeCount = 0;
+        mProxyCount = 0;
+        setupRoot();
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::setupRoot()
+    {
+        T size = TMath<T>::max(mWorld.getWidth(),
+            TMath<T>::max(mWorld.getHeight(), mWorld.getDepth()));
+
+        Node root;
+        root.center[0] = (mWorld.getMinX() + mWorld.getMaxX()) * TReal<T>::HALF;
+        root.center[1] = (mWorld.getMinY() + mWorld.getMaxY()) * TReal<T>::HALF;
+        root.center[2] = (mWorld.getMinZ() + mWorld.getMaxZ()) * TReal<T>::HALF;
+        root.halfSize = size * TReal<T>::HALF;
+
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            root.children[i] = INVALID_PROXY;
+        }
+
+        root.depth = 0;
+        root.first = INVALID_PROXY;
+        root.count = 0;
+        root.parent = INVALID_PROXY;
+
+        mNodes.push_back(root);
+        mNodeCount = 1;
+    }
+
+    template <typename T>
+    inline const TAabb<T> &TLooseOctree<T>::getAabb(uint32_t proxy) const
+    {
+        T3D_ASSERT(proxy < mProxies.size()
+            && mProxies[proxy].node != INVALID_PROXY);
+        return mProxies[proxy].box;
+    }
+
+    template <typename T>
+    inline void *TLooseOctree<T>::getUserData(uint32_t proxy) const
+    {
+        T3D_ASSERT(proxy < mProxies.size()
+            && mProxies[proxy].node != INVALID_PROXY);
+        return mProxies[proxy].userData;
+    }
+
+    template <typename T>
+    inline size_t TLooseOctree<T>::getProxyCount() const
+    {
+        return mProxyCount;
+    }
+
+    template <typename T>
+    inline size_t TLooseOctree<T>::getNodeCount() const
+    {
+        return mNodeCount;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    uint32_t TLooseOctree<T>::insert(const TAabb<T> &box, void *userData)
+    {
+        uint32_t proxy;
+
+        if (mFreeList == INVALID_PROXY)
+        {
+            proxy = (uint32_t)mProxies.size();
+            mProxies.resize(proxy + 1);
+        }
+        else
+        {
+            proxy = mFreeList;
+            mFreeList = mProxies[proxy].next;
+        }
+
+        mProxies[proxy].box = box;
+        mProxies[proxy].userData = userData;
+        link(proxy, findNode(box));
+        ++mProxyCount;
+
+        return proxy;
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::remove(uint32_t proxy)
+    {
+        T3D_ASSERT(proxy < mProxies.size()
+            && mProxies[proxy].node != INVALID_PROXY);
+
+        uint32_t node = mProxies[proxy].node;
+        unlink(proxy);
+        prune(node);
+
+        Proxy &p = mProxies[proxy];
+        p.node = INVALID_PROXY;
+        p.userData = nullptr;
+        p.next = mFreeList;
+        mFreeList = proxy;
+        --mProxyCount;
+    }
+
+    template <typename T>
+    bool TLooseOctree<T>::move(uint32_t proxy, const TAabb<T> &box)
+    {
+        T3D_ASSERT(proxy < mProxies.size()
+            && mProxies[proxy].node != INVALID_PROXY);
+
+        mProxies[proxy].box = box;
+
+        uint32_t oldNode = mProxies[proxy].node;
+        uint32_t node = findNode(box);
+        if (node == oldNode)
+            return false;
+
+        // 先挂到新节点再回收旧节点，新节点可能是旧节点的祖先
+        unlink(proxy);
+        link(proxy, node);
+        prune(oldNode);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    uint32_t TLooseOctree<T>::findNode(const TAabb<T> &box)
+    {
+        T mins[3] = { box.getMinX(), box.getMinY(), box.getMinZ() };
+        T maxs[3] = { box.getMaxX(), box.getMaxY(), box.getMaxZ() };
+        T center[3];
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            center[k] = (mins[k] + maxs[k]) * TReal<T>::HALF;
+        }
+
+        // 按中心点选孩子，包围盒完全在孩子的松散包围盒里才往下走。
+        // 中心点稍微超出世界范围的物体也能放进边上的格子
+        uint32_t index = 0;
+
+        while (mNodes[index].depth < mMaxDepth)
+        {
+            const Node &node = mNodes[index];
+            T half = node.halfSize * TReal<T>::HALF;
+            T loose = half * mLooseness;
+            uint32_t octant = 0;
+            bool fits = true;
+
+            for (int32_t k = 0; k < 3 && fits; ++k)
+            {
+                T c;
+
+                if (center[k] >= node.center[k])
+                {
+                    octant |= (1 << k);
+                    c = node.center[k] + half;
+                }
+                else
+                {
+                    c = node.center[k] - half;
+                }
+
+                fits = (c - loose <= mins[k] && maxs[k] <= c + loose);
+            }
+
+            if (!fits)
+                break;
+
+            uint32_t child = node.children[octant];
+
+            if (child == INVALID_PROXY)
+            {
+                child = createChild(index, octant);
+            }
+
+            index = child;
+        }
+
+        return index;
+    }
+
+    template <typename T>
+    uint32_t TLooseOctree<T>::createChild(uint32_t parent, uint32_t octant)
+    {
+        Node child;
+        const Node &node = mNodes[parent];
+
+        child.halfSize = node.halfSize * TReal<T>::HALF;
+
+        for (int32_t k = 0; k < 3; ++k)
+        {
+            child.center[k] = (octant & (1 << k))
+                ? node.center[k] + child.halfSize
+                : node.center[k] - child.halfSize;
+        }
+
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            child.children[i] = INVALID_PROXY;
+        }
+
+        child.depth = node.depth + 1;
+        child.first = INVALID_PROXY;
+        child.count = 0;
+        child.parent = parent;
+
+        // push_back 以后 node 不能再用
+        uint32_t index;
+
+        if (mFreeNodes == INVALID_PROXY)
+        {
+            index = (uint32_t)mNodes.size();
+            mNodes.push_back(child);
+        }
+        else
+        {
+            index = mFreeNodes;
+            mFreeNodes = mNodes[index].first;
+            mNodes[index] = child;
+        }
+
+        mNodes[parent].children[octant] = index;
+        ++mNodeCount;
+
+        return index;
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::link(uint32_t proxy, uint32_t node)
+    {
+        Proxy &p = mProxies[proxy];
+        p.node = node;
+        p.prev = INVALID_PROXY;
+        p.next = mNodes[node].first;
+
+        if (p.next != INVALID_PROXY)
+            mProxies[p.next].prev = proxy;
+
+        mNodes[node].first = proxy;
+
+        for (uint32_t i = node; i != INVALID_PROXY; i = mNodes[i].parent)
+        {
+            mNodes[i].count++;
+        }
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::unlink(uint32_t proxy)
+    {
+        Proxy &p = mProxies[proxy];
+
+        if (p.prev != INVALID_PROXY)
+            mProxies[p.prev].next = p.next;
+        else
+            mNodes[p.node].first = p.next;
+
+        if (p.next != INVALID_PROXY)
+            mProxies[p.next].prev = p.prev;
+
+        for (uint32_t i = p.node; i != INVALID_PROXY; i = mNodes[i].parent)
+        {
+            mNodes[i].count--;
+        }
+    }
+
+    template <typename T>
+    void TLooseOctree<T>::prune(uint32_t node)
+    {
+        // count 是整棵子树的物体个数，为 0 时孩子也已经在之前被回收了
+        while (node != 0 && mNodes[node].count == 0)
+        {
+            uint32_t parent = mNodes[node].parent;
+            Node &p = mNodes[parent];
+
+            for (int32_t i = 0; i < 8; ++i)
+            {
+                if (p.children[i] == node)
+                {
+                    p.children[i] = INVALID_PROXY;
+                    break;
+                }
+            }
+
+            mNodes[node].first = mFreeNodes;
+            mFreeNodes = node;
+            --mNodeCount;
+            node = parent;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    template <typename T>
+    inline bool TLooseOctree<T>::overlaps(const TAabb<T> &a, const TAabb<T> &b)
+    {
+        return a.getMinX() <= b.getMaxX() && b.getMinX() <= a.getMaxX()
+            && a.getMinY() <= b.getMaxY() && b.getMinY() <= a.getMaxY()
+            && a.getMinZ() <= b.getMaxZ() && b.getMinZ() <= a.getMaxZ();
+    }
+
+    template <typename T>
+    template <typename Callback>
+    void TLooseOctree<T>::queryOverlaps(const TAabb<T> &box,
+        Callback callback) const
+    {
+        if (mNodes[0].count == 0)
+            return;
+
+        T mins[3] = { box.getMinX(), box.getMinY(), box.getMinZ() };
+        T maxs[3] = { box.getMaxX(), box.getMaxY(), box.getMaxZ() };
+
+        // 根节点不测包围盒，世界范围之外的物体都在根节点里。
+        // 空的子树都已经被回收，存在的孩子里一定有物体
+        uint32_t stack[STACK_SIZE];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const Node &node = mNodes[stack[--top]];
+
+            for (uint32_t i = node.first; i != INVALID_PROXY;
+                i = mProxies[i].next)
+            {
+                if (overlaps(mProxies[i].box, box))
+                    callback(i);
+            }
+
+            // 孩子的松散包围盒直接从格子算出来，算法和 createChild 一样，
+            // 不用读孩子节点。axes[k] 第 0 位是低半边的孩子和 box 重叠，
+            // 第 1 位是高半边的孩子
+            T half = node.halfSize * TReal<T>::HALF;
+            T loose = half * mLooseness;
+            uint32_t axes[3];
+
+            for (int32_t k = 0; k < 3; ++k)
+            {
+                T lo = node.center[k] - half;
+                T hi = node.center[k] + half;
+                bool low = (lo - loose <= maxs[k] && mins[k] <= lo + loose);
+                bool high = (hi - loose <= maxs[k] && mins[k] <= hi + loose);
+                axes[k] = (low ? 1 : 0) | (high ? 2 : 0);
+            }
+
+            for (uint32_t c = 0; c < 8; ++c)
+            {
+                uint32_t child = node.children[c];
+
+                if (child != INVALID_PROXY && ((axes[0] >> (c & 1))
+                    & (axes[1] >> ((c >> 1) & 1))
+                    & (axes[2] >> (c >> 2)) & 1))
+                {
+                    T3D_ASSERT(top < STACK_SIZE);
+                    stack[top++] = child;
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    template <typename Callback>
+    size_t TLooseOctree<T>::computePairs(Callback callback) const
+    {
+        size_t count = 0;
+
+        for (uint32_t i = 0; i < (uint32_t)mProxies.size(); ++i)
+        {
+            if (mProxies[i].node == INVALID_PROXY)
+                continue;
+
+            queryOverlaps(mProxies[i].box, [&](uint32_t j)
+            {
+                if (j > i)
+                {
+                    callback(i, j);
+                    ++count;
+                }
+            });
+        }
+
+        return count;
+    }
+}
@@ -25,6 +25,7 @@
 #include <math.h>
 #include "T3DFix32.h"
 #include "T3DFix64.h"
+#include "T3DFixMath.h"
 #include "T3DRadian.h"
 #include "T3DDegree.h"
 
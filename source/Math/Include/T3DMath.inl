@@ -252,5 +252,200 @@ namespace Tiny3D
     template <typename T>
     const T TMath<T>::RADIANS_TO_DEGREES = T(180.0f) / PI;
 
+    ////////////////////////////////////////////////////////////////////////////
+    // 定点数只用整数运算，不转成浮点数调用 C 库，各平台结果逐位一致
+
+    template <>
+    inline fix32_t TMath<fix32_t>::sqrt(fix32_t value)
+    {
+        return TFixMath<fix32_t, int32_t>::sqrt(value);
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::invSqrt(fix32_t value)
+    {
+        return TFixMath<fix32_t, int32_t>::invSqrt(value);
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::abs(fix32_t value)
+    {
+        return TFixMath<fix32_t, int32_t>::abs(value);
+    }
+
+    template <>
+    inline TDegree<fix32_t> TMath<fix32_t>::abs(const TDegree<fix32_t> &value)
+    {
+        return TDegree<fix32_t>(TFixMath<fix32_t, int32_t>::abs(value.valueDegrees()));
+    }
+
+    template <>
+    inline TRadian<fix32_t> TMath<fix32_t>::abs(const TRadian<fix32_t> &value)
+    {
+        return TRadian<fix32_t>(TFixMath<fix32_t, int32_t>::abs(value.valueRadians()));
+    }
+
+    template <>
+    inline bool TMath<fix32_t>::realEqual(fix32_t a, fix32_t b, fix32_t tolerance)
+    {
+        return TFixMath<fix32_t, int32_t>::abs(b - a) <= tolerance;
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::sin(const TDegree<fix32_t> &degrees)
+    {
+        return TFixMath<fix32_t, int32_t>::sinDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::sin(const TRadian<fix32_t> &radians)
+    {
+        return TFixMath<fix32_t, int32_t>::sin(radians.valueRadians());
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::cos(const TDegree<fix32_t> &degrees)
+    {
+        return TFixMath<fix32_t, int32_t>::cosDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::cos(const TRadian<fix32_t> &radians)
+    {
+        return TFixMath<fix32_t, int32_t>::cos(radians.valueRadians());
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::tan(const TDegree<fix32_t> &degrees)
+    {
+        return TFixMath<fix32_t, int32_t>::tanDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix32_t TMath<fix32_t>::tan(const TRadian<fix32_t> &radians)
+    {
+        return TFixMath<fix32_t, int32_t>::tan(radians.valueRadians());
+    }
+
+    template <>
+    inline TRadian<fix32_t> TMath<fix32_t>::asin(fix32_t value)
+    {
+        return TRadian<fix32_t>(TFixMath<fix32_t, int32_t>::asin(value));
+    }
+
+    template <>
+    inline TRadian<fix32_t> TMath<fix32_t>::acos(fix32_t value)
+    {
+        return TRadian<fix32_t>(TFixMath<fix32_t, int32_t>::acos(value));
+    }
+
+    template <>
+    inline TRadian<fix32_t> TMath<fix32_t>::atan(fix32_t value)
+    {
+        return TRadian<fix32_t>(TFixMath<fix32_t, int32_t>::atan(value));
+    }
+
+    template <>
+    inline TRadian<fix32_t> TMath<fix32_t>::atan2(fix32_t y, fix32_t x)
+    {
+        return TRadian<fix32_t>(TFixMath<fix32_t, int32_t>::atan2(y, x));
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::sqrt(fix64_t value)
+    {
+        return TFixMath<fix64_t, int64_t>::sqrt(value);
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::invSqrt(fix64_t value)
+    {
+        return TFixMath<fix64_t, int64_t>::invSqrt(value);
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::abs(fix64_t value)
+    {
+        return TFixMath<fix64_t, int64_t>::abs(value);
+    }
+
+    template <>
+    inline TDegree<fix64_t> TMath<fix64_t>::abs(const TDegree<fix64_t> &value)
+    {
+        return TDegree<fix64_t>(TFixMath<fix64_t, int64_t>::abs(value.valueDegrees()));
+    }
+
+    template <>
+    inline TRadian<fix64_t> TMath<fix64_t>::abs(const TRadian<fix64_t> &value)
+    {
+        return TRadian<fix64_t>(TFixMath<fix64_t, int64_t>::abs(value.valueRadians()));
+    }
+
+    template <>
+    inline bool TMath<fix64_t>::realEqual(fix64_t a, fix64_t b, fix64_t tolerance)
+    {
+        return TFixMath<fix64_t, int64_t>::abs(b - a) <= tolerance;
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::sin(const TDegree<fix64_t> &degrees)
+    {
+        return TFixMath<fix64_t, int64_t>::sinDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::sin(const TRadian<fix64_t> &radians)
+    {
+        return TFixMath<fix64_t, int64_t>::sin(radians.valueRadians());
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::cos(const TDegree<fix64_t> &degrees)
+    {
+        return TFixMath<fix64_t, int64_t>::cosDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::cos(const TRadian<fix64_t> &radians)
+    {
+        return TFixMath<fix64_t, int64_t>::cos(radians.valueRadians());
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::tan(const TDegree<fix64_t> &degrees)
+    {
+        return TFixMath<fix64_t, int64_t>::tanDegrees(degrees.valueDegrees());
+    }
+
+    template <>
+    inline fix64_t TMath<fix64_t>::tan(const TRadian<fix64_t> &radians)
+    {
+        return TFixMath<fix64_t, int64_t>::tan(radians.valueRadians());
+    }
+
+    template <>
+    inline TRadian<fix64_t> TMath<fix64_t>::asin(fix64_t value)
+    {
+        return TRadian<fix64_t>(TFixMath<fix64_t, int64_t>::asin(value));
+    }
+
+    template <>
+    inline TRadian<fix64_t> TMath<fix64_t>::acos(fix64_t value)
+    {
+        return TRadian<fix64_t>(TFixMath<fix64_t, int64_t>::acos(value));
+    }
+
+    template <>
+    inline TRadian<fix64_t> TMath<fix64_t>::atan(fix64_t value)
+    {
+        return TRadian<fix64_t>(TFixMath<fix64_t, int64_t>::atan(value));
+    }
+
+    template <>
+    inline TRadian<fix64_t> TMath<fix64_t>::atan2(fix64_t y, fix64_t x)
+    {
+        return TRadian<fix64_t>(TFixMath<fix64_t, int64_t>::atan2(y, x));
+    }
+
 }
 
@@ -36,6 +36,9 @@
 #include "T3DMatrix3.h"
 #include "T3DQuaternion.h"
 #include "T3DMatrix4.h"
+#include "T3DVector3Stream.h"
+#include "T3DTransformBatch.h"
+#include "T3DBoundingBatch.h"
 #include "T3DRay.h"
 #include "T3DPlane.h"
 #include "T3DTriangle.h"
@@ -67,6 +70,13 @@
 #include "T3DIntrFrustumObb.h"
 #include "T3DIntrFrustumSphere.h"
 
+#include "T3DFrustumCuller.h"
+#include "T3DBvh.h"
+#include "T3DAabbTree.h"
+#include "T3DLooseOctree.h"
+#include "T3DHalfFloat.h"
+#include "T3DCompactBounds.h"
+
 
 namespace Tiny3D
 {
@@ -99,6 +109,7 @@ typedef TMatrix2<Real>      Matrix2;
 typedef TMatrix3<Real>      Matrix3;
 typedef TMatrix4<Real>      Matrix4;
 typedef TQuaternion<Real>   Quaternion;
+typedef TVector3Stream<Real> Vector3Stream;
 
 typedef TRay<Real>          Ray;
 typedef TTriangle<Real>     Triangle;
@@ -131,6 +142,15 @@ typedef TIntrFrustumSphere<Real>    IntrFrustumSphere;
 typedef TIntrFrustumAabb<Real>      IntrFrustumAabb;
 typedef TIntrFrustumObb<Real>       IntrFrustumObb;
 
+typedef TFrustumCuller<Real>        FrustumCuller;
+typedef TBvh<Real>                  Bvh;
+typedef TAabbTree<Real>            AabbTree;
+typedef TLooseOctree<Real>         LooseOctree;
+typedef TBoundingBatch<Real>       BoundingBatch;
+typedef TQuantizedAabb<Real>       QuantizedAabb;
+typedef TAabbQuantizer<Real>       AabbQuantizer;
+typedef TCompactObb<Real>          CompactObb;
+
 
 #define REAL_ZERO           TReal<Real>::ZERO
 #define REAL_HALF           TReal<Real>::HALF
@@ -0,0 +1,550 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_MATH_SIMD_H__
+#define __T3D_MATH_SIMD_H__
+
+
+#include "T3DMathPrerequisites.h"
+
+
+/**
+ * 根据编译器开启的指令集选择 SIMD 实现，float32_t 的向量、矩阵、四元数运算会
+ * 特化成 SIMD 版本，其他类型（double、fix32、fix64）仍然使用通用模板。
+ * 定义 T3D_MATH_NO_SIMD 可以关掉所有 SIMD 特化。
+ */
+#if !defined (T3D_MATH_NO_SIMD)
+    #if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define T3D_SIMD_SSE2
+        #include <emmintrin.h>
+        #if defined (__SSE4_1__)
+            #include <smmintrin.h>
+        #endif
+        #if defined (__AVX__)
+            #define T3D_SIMD_AVX
+            #include <immintrin.h>
+        #endif
+    #elif defined (__ARM_NEON) || defined (__ARM_NEON__) || defined (_M_ARM64)
+        #define T3D_SIMD_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined (T3D_SIMD_SSE2) || defined (T3D_SIMD_NEON)
+    #define T3D_SIMD
+#endif
+
+
+#if defined (T3D_SIMD)
+
+namespace Tiny3D
+{
+#if defined (T3D_SIMD_SSE2)
+    typedef __m128          SIMDFloat4;
+#else
+    typedef float32x4_t     SIMDFloat4;
+#endif
+
+    /// 从任意对齐的地址读取 4 个 float
+    inline SIMDFloat4 simdLoad(const float32_t *p)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_loadu_ps(p);
+#else
+        return vld1q_f32(p);
+#endif
+    }
+
+    /// 写 4 个 float 到任意对齐的地址
+    inline void simdStore(float32_t *p, SIMDFloat4 v)
+    {
+#if defined (T3D_SIMD_SSE2)
+        _mm_storeu_ps(p, v);
+#else
+        vst1q_f32(p, v);
+#endif
+    }
+
+    /// 按 (x, y, z, w) 的顺序构造
+    inline SIMDFloat4 simdSet(float32_t x, float32_t y, float32_t z, float32_t w)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_set_ps(w, z, y, x);
+#else
+        float32_t values[4] = { x, y, z, w };
+        return vld1q_f32(values);
+#endif
+    }
+
+    /// 4 个分量都设成 s
+    inline SIMDFloat4 simdSplat(float32_t s)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_set1_ps(s);
+#else
+        return vdupq_n_f32(s);
+#endif
+    }
+
+    inline SIMDFloat4 simdAdd(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_add_ps(a, b);
+#else
+        return vaddq_f32(a, b);
+#endif
+    }
+
+    inline SIMDFloat4 simdSub(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_sub_ps(a, b);
+#else
+        return vsubq_f32(a, b);
+#endif
+    }
+
+    inline SIMDFloat4 simdMul(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_mul_ps(a, b);
+#else
+        return vmulq_f32(a, b);
+#endif
+    }
+
+    /// 返回 a * b + c，有 FMA 指令时用一条指令完成
+    inline SIMDFloat4 simdMulAdd(SIMDFloat4 a, SIMDFloat4 b, SIMDFloat4 c)
+    {
+#if defined (T3D_SIMD_SSE2)
+    #if defined (__FMA__)
+        return _mm_fmadd_ps(a, b, c);
+    #else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    #endif
+#elif defined (__aarch64__) || defined (_M_ARM64)
+        return vfmaq_f32(c, a, b);
+#else
+        return vmlaq_f32(c, a, b);
+#endif
+    }
+
+    inline SIMDFloat4 simdMin(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_min_ps(a, b);
+#else
+        return vminq_f32(a, b);
+#endif
+    }
+
+    inline SIMDFloat4 simdMax(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_max_ps(a, b);
+#else
+        return vmaxq_f32(a, b);
+#endif
+    }
+
+    /// 逐分量比较 a > b，成立的分量所有位都是 1，否则是 0
+    inline SIMDFloat4 simdCmpGt(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_cmpgt_ps(a, b);
+#else
+        return vreinterpretq_f32_u32(vcgtq_f32(a, b));
+#endif
+    }
+
+    /// 取出 simdCmpGt 等比较结果每个分量的最高位，第 i 个分量对应第 i 位
+    inline uint32_t simdMoveMask(SIMDFloat4 mask)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return (uint32_t)_mm_movemask_ps(mask);
+#else
+        static const uint32_t bits[4] = { 1, 2, 4, 8 };
+        uint32x4_t m = vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(bits));
+        uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+        return vget_lane_u32(t, 0) | vget_lane_u32(t, 1);
+#endif
+    }
+
+    /// 按下标重排分量，返回 (v[X], v[Y], v[Z], v[W])
+    template <int X, int Y, int Z, int W>
+    inline SIMDFloat4 simdPermute(SIMDFloat4 v)
+    {
+#if defined (T3D_SIMD_SSE2)
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+#elif defined (__clang__)
+        return __builtin_shufflevector(v, v, X, Y, Z, W);
+#else
+        SIMDFloat4 r = vdupq_n_f32(vgetq_lane_f32(v, X));
+        r = vsetq_lane_f32(vgetq_lane_f32(v, Y), r, 1);
+        r = vsetq_lane_f32(vgetq_lane_f32(v, Z), r, 2);
+        r = vsetq_lane_f32(vgetq_lane_f32(v, W), r, 3);
+        return r;
+#endif
+    }
+
+    /// 把 4 个行向量原地转置成 4 个列向量
+    inline void simdTranspose(SIMDFloat4 &r0, SIMDFloat4 &r1, SIMDFloat4 &r2,
+        SIMDFloat4 &r3)
+    {
+#if defined (T3D_SIMD_SSE2)
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+#else
+        float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#endif
+    }
+
+    /// 4 个分量的点积
+    inline float32_t simdDot4(SIMDFloat4 a, SIMDFloat4 b)
+    {
+#if defined (T3D_SIMD_SSE2)
+        __m128 m = _mm_mul_ps(a, b);
+        __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(s);
+#elif defined (__aarch64__) || defined (_M_ARM64)
+        return vaddvq_f32(vmulq_f32(a, b));
+#else
+        float32x4_t m = vmulq_f32(a, b);
+        float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+        s = vpadd_f32(s, s);
+        return vget_lane_f32(s, 0);
+#endif
+    }
+
+    /// xyz 三个分量的叉积，结果的 w 分量为 0
+    inline SIMDFloat4 simdCross3(SIMDFloat4 a, SIMDFloat4 b)
+    {
+        SIMDFloat4 a1 = simdPermute<1, 2, 0, 3>(a);
+        SIMDFloat4 b1 = simdPermute<1, 2, 0, 3>(b);
+        SIMDFloat4 a2 = simdPermute<2, 0, 1, 3>(a);
+        SIMDFloat4 b2 = simdPermute<2, 0, 1, 3>(b);
+        return simdSub(simdMul(a1, b2), simdMul(a2, b1));
+    }
+
+    /**
+     * @brief 行主序 4x4 矩阵右乘列向量，即 M * v
+     * @param [in] m : 行主序排列的 16 个元素
+     * @param [in] v : 列向量
+     */
+    inline SIMDFloat4 simdTransform(const float32_t *m, SIMDFloat4 v)
+    {
+        SIMDFloat4 r0 = simdMul(simdLoad(m + 0), v);
+        SIMDFloat4 r1 = simdMul(simdLoad(m + 4), v);
+        SIMDFloat4 r2 = simdMul(simdLoad(m + 8), v);
+        SIMDFloat4 r3 = simdMul(simdLoad(m + 12), v);
+        simdTranspose(r0, r1, r2, r3);
+        return simdAdd(simdAdd(r0, r1), simdAdd(r2, r3));
+    }
+
+    /**
+     * @brief 两个行主序 4x4 矩阵相乘，out = a * b
+     * @remarks out 可以跟 a 或者 b 是同一个矩阵
+     */
+    inline void simdMultiplyMatrix(const float32_t *a, const float32_t *b,
+        float32_t *out)
+    {
+#if defined (T3D_SIMD_AVX)
+        // 一次算两行，每个 128 位的半边各自从左边矩阵的行里取系数
+        __m128 b0 = _mm_loadu_ps(b + 0);
+        __m128 b1 = _mm_loadu_ps(b + 4);
+        __m128 b2 = _mm_loadu_ps(b + 8);
+        __m128 b3 = _mm_loadu_ps(b + 12);
+        __m256 bb0 = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b0, 1);
+        __m256 bb1 = _mm256_insertf128_ps(_mm256_castps128_ps256(b1), b1, 1);
+        __m256 bb2 = _mm256_insertf128_ps(_mm256_castps128_ps256(b2), b2, 1);
+        __m256 bb3 = _mm256_insertf128_ps(_mm256_castps128_ps256(b3), b3, 1);
+
+        for (int32_t i = 0; i < 16; i += 8)
+        {
+            __m256 r0 = _mm256_loadu_ps(a + i);
+            __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(r0, r0, 0x00), bb0);
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(r0, r0, 0x55), bb1));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(r0, r0, 0xAA), bb2));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(r0, r0, 0xFF), bb3));
+            _mm256_storeu_ps(out + i, r);
+        }
+#else
+        // 结果的第 i 行是右边矩阵 4 行按左边矩阵第 i 行的系数线性组合
+        SIMDFloat4 b0 = simdLoad(b + 0);
+        SIMDFloat4 b1 = simdLoad(b + 4);
+        SIMDFloat4 b2 = simdLoad(b + 8);
+        SIMDFloat4 b3 = simdLoad(b + 12);
+
+        for (int32_t i = 0; i < 16; i += 4)
+        {
+            SIMDFloat4 row = simdLoad(a + i);
+            SIMDFloat4 r = simdMul(simdPermute<0, 0, 0, 0>(row), b0);
+            r = simdMulAdd(simdPermute<1, 1, 1, 1>(row), b1, r);
+            r = simdMulAdd(simdPermute<2, 2, 2, 2>(row), b2, r);
+            r = simdMulAdd(simdPermute<3, 3, 3, 3>(row), b3, r);
+            simdStore(out + i, r);
+        }
+#endif
+    }
+
+    /**
+     * @brief 两个行主序 4x4 的定点数矩阵相乘，out = a * b，a、b、out 都是尾数
+     * @tparam FRAC : 小数位数，fix32 是 12
+     * @remarks 每个元素的 4 个乘积在 64 位里累加，最后只做一次四舍五入移位，
+     *      跟 TMatrix4<fix32_t> 的标量实现逐位一致。out 可以跟 a 或者 b 是同一个矩阵
+     */
+    template <int32_t FRAC>
+    inline void simdMultiplyMatrixFix(const int32_t *a, const int32_t *b,
+        int32_t *out)
+    {
+#if defined (T3D_SIMD_AVX) && defined (__AVX2__)
+        // 一次算两行，每个 128 位的半边各自从左边矩阵的行里取系数
+        const __m256i half = _mm256_set1_epi64x(1LL << (FRAC - 1));
+        const __m256i lowMask = _mm256_set_epi32(0, -1, 0, -1, 0, -1, 0, -1);
+        __m256i bk[4], odd[4];
+
+        for (int32_t k = 0; k < 4; ++k)
+        {
+            bk[k] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i *)(b + k * 4)));
+            odd[k] = _mm256_srli_epi64(bk[k], 32);
+        }
+
+        __m256i ra = _mm256_loadu_si256((const __m256i *)(a + 0));
+        __m256i rb = _mm256_loadu_si256((const __m256i *)(a + 8));
+        __m256i rows[2] = { ra, rb };
+
+        for (int32_t i = 0; i < 2; ++i)
+        {
+            __m256i r = rows[i];
+            __m256i s0 = _mm256_shuffle_epi32(r, 0x00);
+            __m256i s1 = _mm256_shuffle_epi32(r, 0x55);
+            __m256i s2 = _mm256_shuffle_epi32(r, 0xAA);
+            __m256i s3 = _mm256_shuffle_epi32(r, 0xFF);
+            __m256i sumEven = _mm256_add_epi64(half, _mm256_mul_epi32(s0, bk[0]));
+            __m256i sumOdd = _mm256_add_epi64(half, _mm256_mul_epi32(s0, odd[0]));
+            sumEven = _mm256_add_epi64(sumEven, _mm256_mul_epi32(s1, bk[1]));
+            sumOdd = _mm256_add_epi64(sumOdd, _mm256_mul_epi32(s1, odd[1]));
+            sumEven = _mm256_add_epi64(sumEven, _mm256_mul_epi32(s2, bk[2]));
+            sumOdd = _mm256_add_epi64(sumOdd, _mm256_mul_epi32(s2, odd[2]));
+            sumEven = _mm256_add_epi64(sumEven, _mm256_mul_epi32(s3, bk[3]));
+            sumOdd = _mm256_add_epi64(sumOdd, _mm256_mul_epi32(s3, odd[3]));
+            sumEven = _mm256_srli_epi64(sumEven, FRAC);
+            sumOdd = _mm256_srli_epi64(sumOdd, FRAC);
+            rows[i] = _mm256_or_si256(_mm256_and_si256(sumEven, lowMask),
+                _mm256_slli_epi64(sumOdd, 32));
+        }
+
+        _mm256_storeu_si256((__m256i *)(out + 0), rows[0]);
+        _mm256_storeu_si256((__m256i *)(out + 8), rows[1]);
+#elif defined (T3D_SIMD_SSE2)
+        const __m128i half = _mm_set1_epi64x(1LL << (FRAC - 1));
+        const __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+        __m128i bk[4], odd[4];
+#if defined (__SSE4_1__)
+        for (int32_t k = 0; k < 4; ++k)
+        {
+            bk[k] = _mm_loadu_si128((const __m128i *)(b + k * 4));
+            // 奇数列挪到每个 64 位的低半边，给 32x32->64 的乘法用
+            odd[k] = _mm_srli_epi64(bk[k], 32);
+        }
+
+        __m128i rows[4];
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            __m128i sumEven = half;
+            __m128i sumOdd = half;
+
+            for (int32_t k = 0; k < 4; ++k)
+            {
+                __m128i s = _mm_set1_epi32(a[i * 4 + k]);
+                sumEven = _mm_add_epi64(sumEven, _mm_mul_epi32(s, bk[k]));
+                sumOdd = _mm_add_epi64(sumOdd, _mm_mul_epi32(s, odd[k]));
+            }
+#else
+        // SSE2 只有无符号的 _mm_mul_epu32，先把两边都加上 2^31 变成无符号数，
+        // (x + 2^31)(y + 2^31) = xy + 2^31 x + 2^31 y + 2^62，4 项相加以后
+        // 2^64 在 64 位里回绕掉了，剩下的修正量只跟左边的行和、右边的列和有关
+        const __m128i sign = _mm_set1_epi32((int32_t)0x80000000);
+        __m128i colEven = _mm_setzero_si128();
+        __m128i colOdd = _mm_setzero_si128();
+
+        for (int32_t k = 0; k < 4; ++k)
+        {
+            bk[k] = _mm_xor_si128(
+                _mm_loadu_si128((const __m128i *)(b + k * 4)), sign);
+            // 奇数列挪到每个 64 位的低半边，给 32x32->64 的乘法用
+            odd[k] = _mm_srli_epi64(bk[k], 32);
+            colEven = _mm_add_epi64(colEven, _mm_and_si128(bk[k], lowMask));
+            colOdd = _mm_add_epi64(colOdd, odd[k]);
+        }
+
+        const __m128i biasEven = _mm_sub_epi64(half, _mm_slli_epi64(colEven, 31));
+        const __m128i biasOdd = _mm_sub_epi64(half, _mm_slli_epi64(colOdd, 31));
+
+        __m128i rows[4];
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            uint64_t rowSum = 0;
+
+            for (int32_t k = 0; k < 4; ++k)
+            {
+                rowSum += (uint32_t)a[i * 4 + k] ^ 0x80000000u;
+            }
+
+            __m128i rowBias = _mm_set1_epi64x((int64_t)(rowSum << 31));
+            __m128i sumEven = _mm_sub_epi64(biasEven, rowBias);
+            __m128i sumOdd = _mm_sub_epi64(biasOdd, rowBias);
+
+            for (int32_t k = 0; k < 4; ++k)
+            {
+                __m128i s = _mm_set1_epi32(
+                    (int32_t)((uint32_t)a[i * 4 + k] ^ 0x80000000u));
+                sumEven = _mm_add_epi64(sumEven, _mm_mul_epu32(s, bk[k]));
+                sumOdd = _mm_add_epi64(sumOdd, _mm_mul_epu32(s, odd[k]));
+            }
+#endif
+            sumEven = _mm_srli_epi64(sumEven, FRAC);
+            sumOdd = _mm_srli_epi64(sumOdd, FRAC);
+            rows[i] = _mm_or_si128(_mm_and_si128(sumEven, lowMask),
+                _mm_slli_epi64(sumOdd, 32));
+        }
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            _mm_storeu_si128((__m128i *)(out + i * 4), rows[i]);
+        }
+#else
+        int32x4_t bk[4];
+
+        for (int32_t k = 0; k < 4; ++k)
+        {
+            bk[k] = vld1q_s32(b + k * 4);
+        }
+
+        int32x4_t rows[4];
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            int64x2_t lo = vdupq_n_s64(1LL << (FRAC - 1));
+            int64x2_t hi = lo;
+
+            for (int32_t k = 0; k < 4; ++k)
+            {
+                int32x2_t s = vdup_n_s32(a[i * 4 + k]);
+                lo = vmlal_s32(lo, vget_low_s32(bk[k]), s);
+                hi = vmlal_s32(hi, vget_high_s32(bk[k]), s);
+            }
+
+            rows[i] = vcombine_s32(vshrn_n_s64(lo, FRAC), vshrn_n_s64(hi, FRAC));
+        }
+
+        for (int32_t i = 0; i < 4; ++i)
+        {
+            vst1q_s32(out + i * 4, rows[i]);
+        }
+#endif
+    }
+
+    /// 4 个分量里的最小值
+    inline float32_t simdHorizontalMin(SIMDFloat4 v)
+    {
+        float32_t a[4];
+        simdStore(a, v);
+        return std::min(std::min(a[0], a[1]), std::min(a[2], a[3]));
+    }
+
+    /// 4 个分量里的最大值
+    inline float32_t simdHorizontalMax(SIMDFloat4 v)
+    {
+        float32_t a[4];
+        simdStore(a, v);
+        return std::max(std::max(a[0], a[1]), std::max(a[2], a[3]));
+    }
+
+    /// 4 个分量的和
+    inline float32_t simdHorizontalSum(SIMDFloat4 v)
+    {
+        float32_t a[4];
+        simdStore(a, v);
+        return (a[0] + a[1]) + (a[2] + a[3]);
+    }
+
+    /**
+     * @brief 从 4 个连续存放的 (x, y, z) 读出各分量，即 AoS 转 SoA
+     * @param [in] p : 12 个 float，依次是 4 个点的 x, y, z
+     */
+    inline void simdLoadXYZ4(const float32_t *p, SIMDFloat4 &x, SIMDFloat4 &y,
+        SIMDFloat4 &z)
+    {
+#if defined (T3D_SIMD_SSE2)
+        // v0 = x0 y0 z0 x1, v1 = y1 z1 x2 y2, v2 = z2 x3 y3 z3
+        __m128 v0 = _mm_loadu_ps(p + 0);
+        __m128 v1 = _mm_loadu_ps(p + 4);
+        __m128 v2 = _mm_loadu_ps(p + 8);
+        __m128 t0 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1));  // y0 z0 y1 z1
+        __m128 t1 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2));  // x2 y2 x3 y3
+        x = _mm_shuffle_ps(v0, t1, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm_shuffle_ps(t0, v2, _MM_SHUFFLE(3, 0, 3, 1));
+#else
+        float32x4x3_t v = vld3q_f32(p);
+        x = v.val[0];
+        y = v.val[1];
+        z = v.val[2];
+#endif
+    }
+
+    /**
+     * @brief 把 4 个点的各分量写回成连续存放的 (x, y, z)，即 SoA 转 AoS
+     */
+    inline void simdStoreXYZ4(float32_t *p, SIMDFloat4 x, SIMDFloat4 y,
+        SIMDFloat4 z)
+    {
+#if defined (T3D_SIMD_SSE2)
+        __m128 a = _mm_unpacklo_ps(x, y);                           // x0 y0 x1 y1
+        __m128 b = _mm_unpackhi_ps(x, y);                           // x2 y2 x3 y3
+        __m128 c = _mm_shuffle_ps(z, a, _MM_SHUFFLE(2, 2, 0, 0));   // z0 z0 x1 x1
+        __m128 d = _mm_shuffle_ps(a, z, _MM_SHUFFLE(1, 1, 3, 3));   // y1 y1 z1 z1
+        __m128 e = _mm_shuffle_ps(z, b, _MM_SHUFFLE(2, 2, 2, 2));   // z2 z2 x3 x3
+        __m128 f = _mm_shuffle_ps(b, z, _MM_SHUFFLE(3, 3, 3, 3));   // y3 y3 z3 z3
+        _mm_storeu_ps(p + 0, _mm_shuffle_ps(a, c, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(d, b, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(e, f, _MM_SHUFFLE(2, 0, 2, 0)));
+#else
+        float32x4x3_t v;
+        v.val[0] = x;
+        v.val[1] = y;
+        v.val[2] = z;
+        vst3q_f32(p, v);
+#endif
+    }
+}
+
+#endif  /*T3D_SIMD*/
+
+
+#endif  /*__T3D_MATH_SIMD_H__*/
@@ -233,6 +233,10 @@ namespace Tiny3D
         ///   rU 表示分解出来的切变矩阵中上三角矩阵的元素构成的向量
         void QDUDecomposition(TMatrix3 &rQ, TVector3<T> &rD, TVector3<T> &rU) const;
 
+        /// 对称矩阵的特征分解，M = rRot * rDiag * (rRot ^ T)，
+        /// rRot 的列是单位特征向量，rDiag 对角线上是对应的特征值
+        void eigendecomposition(TMatrix3 &rRot, TMatrix3 &rDiag) const;
+
     public:
         static const TMatrix3 ZERO;
         static const TMatrix3 IDENTITY;
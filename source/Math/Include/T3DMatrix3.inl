@@ -1420,4 +1420,71 @@ namespace Tiny3D
         kU[1] = kR[0][2] * fInvD0;
         kU[2] = kR[1][2] / kD[1];
     }
+
+    template <typename T>
+    void TMatrix3<T>::eigendecomposition(TMatrix3 &rRot, TMatrix3 &rDiag) const
+    {
+        // 循环 Jacobi 迭代，每次旋转把一个非对角元素变成 0，
+        // 3x3 的矩阵一般 4 到 5 轮就收敛到浮点精度
+        const int32_t MAX_SWEEPS = 16;
+        const int32_t P[3] = { 0, 0, 1 };
+        const int32_t Q[3] = { 1, 2, 2 };
+
+        TMatrix3 kA(*this);
+        rRot.makeIdentity();
+
+        for (int32_t iSweep = 0; iSweep < MAX_SWEEPS; ++iSweep)
+        {
+            T fOff = kA[0][1] * kA[0][1] + kA[0][2] * kA[0][2]
+                + kA[1][2] * kA[1][2];
+            T fDiag = kA[0][0] * kA[0][0] + kA[1][1] * kA[1][1]
+                + kA[2][2] * kA[2][2];
+
+            if (fOff <= fDiag * TReal<T>::EPSILON * TReal<T>::EPSILON)
+                break;
+
+            for (int32_t i = 0; i < 3; ++i)
+            {
+                int32_t p = P[i], q = Q[i];
+                T fApq = kA[p][q];
+
+                if (fApq == TReal<T>::ZERO)
+                    continue;
+
+                // t = tan(theta)，取绝对值较小的根，旋转角不超过 45 度
+                T fTheta = (kA[q][q] - kA[p][p]) / (fApq + fApq);
+                T fT = TReal<T>::ONE / (TMath<T>::abs(fTheta)
+                    + TMath<T>::sqrt(fTheta * fTheta + TReal<T>::ONE));
+                if (fTheta < TReal<T>::ZERO)
+                    fT = -fT;
+
+                T fC = TReal<T>::ONE / TMath<T>::sqrt(fT * fT + TReal<T>::ONE);
+                T fS = fT * fC;
+
+                // A = J^T * A * J，V = V * J
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    T fKp = kA[k][p], fKq = kA[k][q];
+                    kA[k][p] = fC * fKp - fS * fKq;
+                    kA[k][q] = fS * fKp + fC * fKq;
+                }
+
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    T fPk = kA[p][k], fQk = kA[q][k];
+                    kA[p][k] = fC * fPk - fS * fQk;
+                    kA[q][k] = fS * fPk + fC * fQk;
+                }
+
+                for (int32_t k = 0; k < 3; ++k)
+                {
+                    T fKp = rRot[k][p], fKq = rRot[k][q];
+                    rRot[k][p] = fC * fKp - fS * fKq;
+                    rRot[k][q] = fS * fKp + fC * fKq;
+                }
+            }
+        }
+
+        rDiag.makeDiagonal(kA[0][0], kA[1][1], kA[2][2]);
+    }
 }
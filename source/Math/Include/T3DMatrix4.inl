@@ -833,4 +833,211 @@ namespace Tiny3D
         m4x4[3][2] = TReal<T>::ZERO;
         m4x4[3][3] = TReal<T>::ONE;
     }
+
+    //--------------------------------------------------------------------------
+    // fix32_t 的特化，每个元素在 64 位里累加 4 个乘积后只舍入一次，
+    // 比逐项相乘再相加少 3 次舍入，并且 SIMD 跟标量版本结果逐位一致
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline TMatrix4<fix32_t> TMatrix4<fix32_t>::operator *(
+        const TMatrix4 &other) const
+    {
+        TMatrix4 result(true);
+        const int32_t *a = (const int32_t *)mTuples;
+        const int32_t *b = (const int32_t *)other.mTuples;
+        int32_t *out = (int32_t *)result.mTuples;
+#if defined (T3D_SIMD)
+        simdMultiplyMatrixFix<fix32_t::DECIMAL_BITS>(a, b, out);
+#else
+        const int64_t half = 1LL << (fix32_t::DECIMAL_BITS - 1);
+
+        for (int32_t i = 0; i < 16; i += 4)
+        {
+            for (int32_t c = 0; c < 4; ++c)
+            {
+                int64_t sum = half
+                    + (int64_t)a[i + 0] * b[c + 0] + (int64_t)a[i + 1] * b[c + 4]
+                    + (int64_t)a[i + 2] * b[c + 8] + (int64_t)a[i + 3] * b[c + 12];
+                out[i + c] = (int32_t)(sum >> fix32_t::DECIMAL_BITS);
+            }
+        }
+#endif
+        return result;
+    }
+
+#if defined (T3D_SIMD)
+    //--------------------------------------------------------------------------
+    // float32_t 的 SIMD 特化，矩阵按行存放，每一行正好是一个 SIMDFloat4
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline TMatrix4<float32_t> TMatrix4<float32_t>::operator *(
+        const TMatrix4 &other) const
+    {
+        TMatrix4 result(true);
+        simdMultiplyMatrix(mTuples, other.mTuples, result.mTuples);
+        return result;
+    }
+
+    template <>
+    inline TVector4<float32_t> TMatrix4<float32_t>::operator *(
+        const TVector4<float32_t> &rkV) const
+    {
+        TVector4<float32_t> result;
+        simdStore(result, simdTransform(mTuples, simdLoad(rkV)));
+        return result;
+    }
+
+    template <>
+    inline TVector3<float32_t> TMatrix4<float32_t>::operator *(
+        const TVector3<float32_t> &rkV) const
+    {
+        float32_t values[4];
+        simdStore(values, simdTransform(mTuples,
+            simdSet(rkV.x(), rkV.y(), rkV.z(), 1.0f)));
+
+        if (values[3] != 0.0f)
+        {
+            return TVector3<float32_t>(values[0] / values[3],
+                values[1] / values[3], values[2] / values[3]);
+        }
+
+        return TVector3<float32_t>(values[0], values[1], values[2]);
+    }
+
+    template <>
+    inline TMatrix4<float32_t> TMatrix4<float32_t>::concatenateAffine(
+        const TMatrix4 &other) const
+    {
+        T3D_ASSERT(isAffine() && other.isAffine());
+
+        SIMDFloat4 b0 = simdLoad(other.mTuples + 0);
+        SIMDFloat4 b1 = simdLoad(other.mTuples + 4);
+        SIMDFloat4 b2 = simdLoad(other.mTuples + 8);
+        SIMDFloat4 b3 = simdSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+        TMatrix4 result(false);
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            SIMDFloat4 a = simdLoad(mTuples + i * 4);
+            SIMDFloat4 r = simdMul(simdPermute<0, 0, 0, 0>(a), b0);
+            r = simdMulAdd(simdPermute<1, 1, 1, 1>(a), b1, r);
+            r = simdMulAdd(simdPermute<2, 2, 2, 2>(a), b2, r);
+            r = simdMulAdd(simdPermute<3, 3, 3, 3>(a), b3, r);
+            simdStore(result.mTuples + i * 4, r);
+        }
+
+        return result;
+    }
+
+    template <>
+    inline TVector4<float32_t> TMatrix4<float32_t>::transformAffine(
+        const TVector4<float32_t> &v) const
+    {
+        T3D_ASSERT(isAffine());
+
+        TVector4<float32_t> result;
+        simdStore(result, simdTransform(mTuples, simdLoad(v)));
+        result.w() = v.w();
+        return result;
+    }
+
+    template <>
+    inline TMatrix4<float32_t> TMatrix4<float32_t>::inverse() const
+    {
+        // 跟通用版本同一个算法：先用下面两行求 2x2 子式，再跟剩下的行组合成
+        // 伴随矩阵的一列，4 个分量正好对应结果的 4 行，最后转置回行主序
+        SIMDFloat4 r0 = simdLoad(mTuples + 0);
+        SIMDFloat4 r1 = simdLoad(mTuples + 4);
+        SIMDFloat4 r2 = simdLoad(mTuples + 8);
+        SIMDFloat4 r3 = simdLoad(mTuples + 12);
+
+        SIMDFloat4 r0a = simdPermute<1, 0, 0, 0>(r0);
+        SIMDFloat4 r0b = simdPermute<2, 2, 1, 1>(r0);
+        SIMDFloat4 r0c = simdPermute<3, 3, 3, 2>(r0);
+        SIMDFloat4 r1a = simdPermute<1, 0, 0, 0>(r1);
+        SIMDFloat4 r1b = simdPermute<2, 2, 1, 1>(r1);
+        SIMDFloat4 r1c = simdPermute<3, 3, 3, 2>(r1);
+        SIMDFloat4 r2a = simdPermute<1, 0, 0, 0>(r2);
+        SIMDFloat4 r2b = simdPermute<2, 2, 1, 1>(r2);
+        SIMDFloat4 r2c = simdPermute<3, 3, 3, 2>(r2);
+        SIMDFloat4 r3a = simdPermute<1, 0, 0, 0>(r3);
+        SIMDFloat4 r3b = simdPermute<2, 2, 1, 1>(r3);
+        SIMDFloat4 r3c = simdPermute<3, 3, 3, 2>(r3);
+
+        // 第 2、3 行的子式 (v5, v5, v4, v3)、(v4, v2, v2, v1)、(v3, v1, v0, v0)
+        SIMDFloat4 a23 = simdSub(simdMul(r2b, r3c), simdMul(r2c, r3b));
+        SIMDFloat4 b23 = simdSub(simdMul(r2a, r3c), simdMul(r2c, r3a));
+        SIMDFloat4 c23 = simdSub(simdMul(r2a, r3b), simdMul(r2b, r3a));
+        // 第 1、3 行的子式
+        SIMDFloat4 a13 = simdSub(simdMul(r1b, r3c), simdMul(r1c, r3b));
+        SIMDFloat4 b13 = simdSub(simdMul(r1a, r3c), simdMul(r1c, r3a));
+        SIMDFloat4 c13 = simdSub(simdMul(r1a, r3b), simdMul(r1b, r3a));
+        // 第 1、2 行的子式
+        SIMDFloat4 a12 = simdSub(simdMul(r1b, r2c), simdMul(r1c, r2b));
+        SIMDFloat4 b12 = simdSub(simdMul(r1a, r2c), simdMul(r1c, r2a));
+        SIMDFloat4 c12 = simdSub(simdMul(r1a, r2b), simdMul(r1b, r2a));
+
+        SIMDFloat4 pos = simdSet(1.0f, -1.0f, 1.0f, -1.0f);
+        SIMDFloat4 neg = simdSet(-1.0f, 1.0f, -1.0f, 1.0f);
+
+        SIMDFloat4 c0 = simdMulAdd(c23, r1c, simdSub(simdMul(a23, r1a), simdMul(b23, r1b)));
+        SIMDFloat4 c1 = simdMulAdd(c23, r0c, simdSub(simdMul(a23, r0a), simdMul(b23, r0b)));
+        SIMDFloat4 c2 = simdMulAdd(c13, r0c, simdSub(simdMul(a13, r0a), simdMul(b13, r0b)));
+        SIMDFloat4 c3 = simdMulAdd(c12, r0c, simdSub(simdMul(a12, r0a), simdMul(b12, r0b)));
+
+        c0 = simdMul(c0, pos);
+        c1 = simdMul(c1, neg);
+        c2 = simdMul(c2, pos);
+        c3 = simdMul(c3, neg);
+
+        SIMDFloat4 invDet = simdSplat(1.0f / simdDot4(c0, r0));
+
+        simdTranspose(c0, c1, c2, c3);
+
+        TMatrix4 result(true);
+        simdStore(result.mTuples + 0, simdMul(c0, invDet));
+        simdStore(result.mTuples + 4, simdMul(c1, invDet));
+        simdStore(result.mTuples + 8, simdMul(c2, invDet));
+        simdStore(result.mTuples + 12, simdMul(c3, invDet));
+        return result;
+    }
+
+    template <>
+    inline TMatrix4<float32_t> TMatrix4<float32_t>::inverseAffine() const
+    {
+        T3D_ASSERT(isAffine());
+
+        // 3x3 部分的逆矩阵各列是行向量两两的叉积除以行列式
+        SIMDFloat4 r0 = simdLoad(mTuples + 0);
+        SIMDFloat4 r1 = simdLoad(mTuples + 4);
+        SIMDFloat4 r2 = simdLoad(mTuples + 8);
+
+        SIMDFloat4 c0 = simdCross3(r1, r2);
+        SIMDFloat4 c1 = simdCross3(r2, r0);
+        SIMDFloat4 c2 = simdCross3(r0, r1);
+
+        SIMDFloat4 invDet = simdSplat(1.0f / simdDot4(r0, c0));
+        c0 = simdMul(c0, invDet);
+        c1 = simdMul(c1, invDet);
+        c2 = simdMul(c2, invDet);
+
+        // 平移部分是 -(R^-1 * t)，w 分量补 1 转置后正好是最后一行
+        SIMDFloat4 t = simdMul(c0, simdSplat(m4x4[0][3]));
+        t = simdMulAdd(c1, simdSplat(m4x4[1][3]), t);
+        t = simdMulAdd(c2, simdSplat(m4x4[2][3]), t);
+        SIMDFloat4 c3 = simdSub(simdSet(0.0f, 0.0f, 0.0f, 1.0f), t);
+
+        simdTranspose(c0, c1, c2, c3);
+
+        TMatrix4 result(true);
+        simdStore(result.mTuples + 0, c0);
+        simdStore(result.mTuples + 4, c1);
+        simdStore(result.mTuples + 8, c2);
+        simdStore(result.mTuples + 12, c3);
+        return result;
+    }
+#endif  /*T3D_SIMD*/
 }
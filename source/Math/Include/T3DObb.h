@@ -23,6 +23,8 @@
 
 #include "T3DMathPrerequisites.h"
 #include "T3DVector3.h"
+#include "T3DMatrix3.h"
+#include "T3DBoundingBatch.h"
 
 
 namespace Tiny3D
@@ -71,6 +73,7 @@ namespace Tiny3D
     protected:
         void buildByAABB(const TVector3<T> points[], size_t count);
 
+        /// 协方差矩阵的特征向量作为三个轴，特征值最大的是第 0 个轴
         void buildByCovariance(const TVector3<T> points[], size_t count);
 
     private:
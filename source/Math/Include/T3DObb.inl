@@ -24,7 +24,7 @@ namespace Tiny3D
         : mCenter(TVector3<T>::ZERO)
     {
         mAxis[0] = mAxis[1] = mAxis[2] = TVector3<T>::ZERO;
-        mExtent[0] = mExtent[1] = mExtent[2] = 0.0;
+        mExtent[0] = mExtent[1] = mExtent[2] = TReal<T>::ZERO;
     }
 
     template <typename T>
@@ -147,48 +147,64 @@ namespace Tiny3D
     template <typename T>
     void TObb<T>::buildByAABB(const TVector3<T> points[], size_t count)
     {
-        T maxX = TReal<T>::MINUS_INF;
-        T maxY = TReal<T>::MINUS_INF;
-        T maxZ = TReal<T>::MINUS_INF;
-        T minX = TReal<T>::INF;
-        T minY = TReal<T>::INF;
-        T minZ = TReal<T>::INF;
-
-        size_t i = 0;
-        for (i = 0; i < count; ++i)
-        {
-            if (points[i].x() > maxX)
-                maxX = points[i].x();
-            if (points[i].x() < minX)
-                minX = points[i].x();
-            if (points[i].y() > maxY)
-                maxY = points[i].y();
-            if (points[i].y() < minY)
-                minY = points[i].y();
-            if (points[i].z() > maxZ)
-                maxZ = points[i].z();
-            if (points[i].z() < minZ)
-                minZ = points[i].z();
-        }
+        TVector3<T> vMin, vMax;
+        TBoundingBatch<T>::computeBounds(points, count, vMin, vMax);
 
-        mCenter[0] = (minX + maxX) * TReal<T>::HALF;
-        mCenter[1] = (minY + maxY) * TReal<T>::HALF;
-        mCenter[2] = (minZ + maxZ) * TReal<T>::HALF;
+        mCenter = (vMin + vMax) * TReal<T>::HALF;
 
         mAxis[0] = TVector3<T>::UNIT_X;
         mAxis[1] = TVector3<T>::UNIT_Y;
         mAxis[2] = TVector3<T>::UNIT_Z;
 
-        mExtent[0] = (maxX - minX) * TReal<T>::HALF;
-        mExtent[1] = (maxY - minY) * TReal<T>::HALF;
-        mExtent[2] = (maxZ - minZ) * TReal<T>::HALF;
+        mExtent[0] = (vMax.x() - vMin.x()) * TReal<T>::HALF;
+        mExtent[1] = (vMax.y() - vMin.y()) * TReal<T>::HALF;
+        mExtent[2] = (vMax.z() - vMin.z()) * TReal<T>::HALF;
     }
 
     template <typename T>
     void TObb<T>::buildByCovariance(const TVector3<T> points[], size_t count)
     {
-        // 暂未实现
-        T3D_ASSERT(0);
+        if (count == 0)
+        {
+            buildByAABB(points, count);
+            return;
+        }
+
+        TVector3<T> mean;
+        TMatrix3<T> covariance;
+        TBoundingBatch<T>::computeCovariance(points, count, mean, covariance);
+
+        TMatrix3<T> rot, diag;
+        covariance.eigendecomposition(rot, diag);
+
+        // 按特征值从大到小排列，第 2 个轴用叉积保证是右手坐标系
+        int32_t order[3] = { 0, 1, 2 };
+
+        for (int32_t i = 0; i < 2; ++i)
+        {
+            for (int32_t j = i + 1; j < 3; ++j)
+            {
+                if (diag[order[j]][order[j]] > diag[order[i]][order[i]])
+                    std::swap(order[i], order[j]);
+            }
+        }
+
+        mAxis[0] = rot.getColumn(order[0]);
+        mAxis[1] = rot.getColumn(order[1]);
+        mAxis[0].normalize();
+        mAxis[1].normalize();
+        mAxis[2] = mAxis[0].cross(mAxis[1]);
+
+        TVector3<T> vMin, vMax;
+        TBoundingBatch<T>::computeProjectedBounds(points, count, mAxis,
+            vMin, vMax);
+
+        mCenter = TVector3<T>::ZERO;
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            mCenter += mAxis[i] * ((vMin[i] + vMax[i]) * TReal<T>::HALF);
+            mExtent[i] = (vMax[i] - vMin[i]) * TReal<T>::HALF;
+        }
     }
 }
-
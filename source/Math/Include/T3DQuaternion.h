@@ -23,6 +23,7 @@
 
 #include "T3DMathPrerequisites.h"
 #include "T3DMath.h"
+#include "T3DMathSIMD.h"
 #include "T3DMatrix3.h"
 
 
@@ -725,4 +725,58 @@ namespace Tiny3D
 
         return *this;
     }
+
+#if defined (T3D_SIMD)
+    //--------------------------------------------------------------------------
+    // float32_t 的 SIMD 特化，分量顺序是 (w, x, y, z)
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline TQuaternion<float32_t> TQuaternion<float32_t>::operator *(
+        const TQuaternion &other) const
+    {
+        SIMDFloat4 b = simdLoad(&other._w);
+
+        // 把每个分量对应的乘积项按 (w, x, y, z) 排好，再带上符号累加
+        SIMDFloat4 r = simdMul(simdSplat(_w), b);
+        r = simdMulAdd(simdSplat(_x),
+            simdMul(simdPermute<1, 0, 3, 2>(b), simdSet(-1.0f, 1.0f, -1.0f, 1.0f)),
+            r);
+        r = simdMulAdd(simdSplat(_y),
+            simdMul(simdPermute<2, 3, 0, 1>(b), simdSet(-1.0f, 1.0f, 1.0f, -1.0f)),
+            r);
+        r = simdMulAdd(simdSplat(_z),
+            simdMul(simdPermute<3, 2, 1, 0>(b), simdSet(-1.0f, -1.0f, 1.0f, 1.0f)),
+            r);
+
+        TQuaternion result;
+        simdStore(&result._w, r);
+        return result;
+    }
+
+    template <>
+    inline TQuaternion<float32_t> &TQuaternion<float32_t>::operator *=(
+        const TQuaternion &other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    template <>
+    inline TVector3<float32_t> TQuaternion<float32_t>::operator* (
+        const TVector3<float32_t> &v) const
+    {
+        // 跟通用版本一样是 nVidia SDK 的算法，v + 2w(q x v) + 2(q x (q x v))
+        SIMDFloat4 q = simdSet(_x, _y, _z, 0.0f);
+        SIMDFloat4 p = simdSet(v.x(), v.y(), v.z(), 0.0f);
+        SIMDFloat4 uv = simdCross3(q, p);
+        SIMDFloat4 uuv = simdCross3(q, uv);
+        SIMDFloat4 r = simdMulAdd(uv, simdSplat(2.0f * _w), p);
+        r = simdMulAdd(uuv, simdSplat(2.0f), r);
+
+        float32_t values[4];
+        simdStore(values, r);
+        return TVector3<float32_t>(values[0], values[1], values[2]);
+    }
+#endif  /*T3D_SIMD*/
 }
@@ -25,6 +25,7 @@
 #include "T3DVector3.h"
 #include "T3DMatrix3.h"
 #include "T3DReal.h"
+#include "T3DBoundingBatch.h"
 
 
 namespace Tiny3D
@@ -92,10 +93,39 @@ namespace Tiny3D
         bool contains(const TVector3<T> &point) const;
 
     protected:
-        /// Welzl最小包围球算法生成包围球
+        /// Welzl 算法第一轮使用的点数，点更多时先均匀取样
+        static const size_t WELZL_SAMPLE_SIZE = 4096;
+
+        /// 取样以后补点的最多轮数
+        static const int32_t WELZL_MAX_PASSES = 32;
+
+        /**
+         * @brief Welzl 最小包围球算法生成包围球
+         * @remarks 先对取样的点求最小包围球，再并行扫描全部点，把每块里
+         *      在球外最远的点加进工作集重新求，直到没有点在球外。
+         *      工作集上的 Welzl 算法不用递归，见 minSphere。
+         */
         void buildByWelzl(const TVector3<T> points[], size_t count);
 
-        TSphere recurseMinSphere(TVector3<T> *points[], size_t count, size_t b = 0);
+        /**
+         * @brief 求 count 个点的最小包围球，会改变点的顺序
+         * @remarks 迭代版本的 Welzl 算法：边界上最多 4 个点，递归展开成 4 层
+         *      循环。点事先随机打乱，期望时间是线性的；每个引起外层更新的点
+         *      换到最前面（move-to-front），之后的循环先测它。
+         */
+        static TSphere minSphere(TVector3<T> *points, size_t count);
+
+        /// 3 个点都在球面上的最小球，3 点共线时退化成最远两点为直径的球
+        static TSphere sphereOnBoundary(const TVector3<T> &p0,
+            const TVector3<T> &p1, const TVector3<T> &p2);
+
+        /// 4 个点都在球面上的球，4 点共面时退化成包含 4 个点的 3 点球
+        static TSphere sphereOnBoundary(const TVector3<T> &p0,
+            const TVector3<T> &p1, const TVector3<T> &p2,
+            const TVector3<T> &p3);
+
+        /// 点在球外，带一点相对容差，避免浮点误差导致反复更新
+        bool isOutside(const TVector3<T> &point) const;
 
         /// Ritter逼近修正算法生成包围球
         void buildByRitter(const TVector3<T> points[], size_t count);
@@ -39,7 +39,7 @@ namespace Tiny3D
     {
         TVector3<T> a = p1 - p0;
         TVector3<T> o = TReal<T>::HALF * a;
-        mRadius = o.normalize();
+        mRadius = o.length();
         mCenter = p0 + o;
     }
 
@@ -59,7 +59,7 @@ namespace Tiny3D
         TVector3<T> o = (b.dot(b) * (n.cross(a))
             + (a.dot(a) * (b.cross(n)))) / denominator;
 
-        mRadius = o.normalize();
+        mRadius = o.length();
         mCenter = p0 + o;
 
         return true;
@@ -88,7 +88,7 @@ namespace Tiny3D
         TVector3<T> o = (c.dot(c) * n + (b.dot(b) * c.cross(a))
             + a.dot(a) * b.cross(c)) / denominator;
 
-        mRadius = o.normalize();
+        mRadius = o.length();
         mCenter = p0 + o;
 
         return true;
@@ -178,86 +178,208 @@ namespace Tiny3D
         return ((point - mCenter).length() <= mRadius);
     }
 
+    template <typename T>
+    const size_t TSphere<T>::WELZL_SAMPLE_SIZE;
+
+    template <typename T>
+    const int32_t TSphere<T>::WELZL_MAX_PASSES;
+
     template <typename T>
     void TSphere<T>::buildByWelzl(const TVector3<T> points[], size_t count)
     {
-        TVector3<T> **ptr = new TVector3<T>*[count];
+        if (count == 0)
+        {
+            mCenter = TVector3<T>::ZERO;
+            mRadius = TReal<T>::ZERO;
+            return;
+        }
 
-        size_t i = 0;
-        for (i = 0; i < count; ++i)
+        // 工作集是连续存放的点的副本，不是指针数组
+        TArray<TVector3<T>> support;
+
+        if (count <= WELZL_SAMPLE_SIZE)
         {
-            ptr[i] = (TVector3<T>*)(&points[i]);
+            support.assign(points, points + count);
         }
+        else
+        {
+            support.reserve(WELZL_SAMPLE_SIZE * 2);
 
-        *this = recurseMinSphere(ptr, count);
+            for (size_t i = 0; i < WELZL_SAMPLE_SIZE; ++i)
+            {
+                support.push_back(points[i * count / WELZL_SAMPLE_SIZE]);
+            }
+        }
 
-        delete []ptr;
+        // 固定种子的随机打乱，同样的输入总是得到同样的结果
+        uint32_t seed = 0x9E3779B9;
 
-        for (i = 0; i < count; ++i)
+        for (size_t i = support.size() - 1; i > 0; --i)
         {
-            TVector3<T> dist = points[i] - mCenter;
-            T radius = dist.length();
-            T3D_ASSERT(radius <= mRadius);
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            std::swap(support[i], support[seed % (i + 1)]);
         }
-    }
 
-    template <typename T>
-    TSphere<T> TSphere<T>::recurseMinSphere(
-        TVector3<T> *points[], 
-        size_t count,
-        size_t b)
-    {
-        TSphere<T> sphere;
+        size_t chunks = TBoundingBatch<T>::getChunkCount(count);
+        TArray<size_t> indices(chunks);
+        TArray<T> distances2(chunks);
+        TSphere sphere;
 
-        switch (b)
+        for (int32_t pass = 0; ; ++pass)
         {
-        case 0:
-            sphere = TSphere<T>();
-            break;
-        case 1:
-            sphere = TSphere<T>(*points[-1]);
-            break;
-        case 2:
-            sphere = TSphere<T>(*points[-1], *points[-2]);
-            break;
-        case 3:
-//             sphere = Sphere(*points[-1], *points[-2], *points[-3]);
-            if (!sphere.build(*points[-1], *points[-2], *points[-3]))
+            sphere = minSphere(&support[0], support.size());
+
+            TBoundingBatch<T>::computeFarthestPoints(points, count,
+                sphere.mCenter, &indices[0], &distances2[0]);
+
+            T radius2 = sphere.mRadius * sphere.mRadius;
+            T max2 = radius2;
+            size_t added = 0;
+
+            for (size_t c = 0; c < chunks; ++c)
             {
-                recurseMinSphere(points + 1, 3, b);
+                max2 = TMath<T>::max(max2, distances2[c]);
+
+                if (sphere.isOutside(points[indices[c]]))
+                {
+                    // 放到最前面，下一轮先处理
+                    support.insert(support.begin(), points[indices[c]]);
+                    ++added;
+                }
             }
-            break;
-        case 4:
-//             sphere = Sphere(*points[-1], *points[-2], *points[-3], *points[-4]);
-            if (!sphere.build(*points[-1], *points[-2], *points[-3], *points[-4]))
+
+            if (added == 0 || pass + 1 >= WELZL_MAX_PASSES)
             {
-                recurseMinSphere(points + 1, 4, b);
+                // 容差以内的点也要包进去
+                sphere.mRadius = TMath<T>::sqrt(max2);
+                break;
             }
-            return sphere;
-            break;
         }
 
-        size_t i = 0;
-        for (i = 0; i < count; ++i)
+        *this = sphere;
+    }
+
+    template <typename T>
+    TSphere<T> TSphere<T>::minSphere(TVector3<T> *points, size_t count)
+    {
+        TSphere sphere(points[0]);
+
+        for (size_t i = 1; i < count; ++i)
         {
-            T d = sphere.mCenter.distance2(*points[i]);
-            if (d > TReal<T>::ZERO)
+            if (!sphere.isOutside(points[i]))
+                continue;
+
+            // p[i] 在边界上，重新包含 p[0] ~ p[i-1]
+            sphere = TSphere(points[i]);
+
+            for (size_t j = 0; j < i; ++j)
             {
-                size_t j = 0;
-                for (j = i; j > 0; --j)
+                if (!sphere.isOutside(points[j]))
+                    continue;
+
+                sphere = TSphere(points[i], points[j]);
+
+                for (size_t k = 0; k < j; ++k)
                 {
-                    TVector3<T> *t = points[j];
-                    points[j] = points[j - 1];
-                    points[j - 1] = t;
+                    if (!sphere.isOutside(points[k]))
+                        continue;
+
+                    sphere = sphereOnBoundary(points[i], points[j], points[k]);
+
+                    for (size_t l = 0; l < k; ++l)
+                    {
+                        if (sphere.isOutside(points[l]))
+                        {
+                            sphere = sphereOnBoundary(points[i], points[j],
+                                points[k], points[l]);
+                        }
+                    }
                 }
+            }
+
+            // p[0] ~ p[i] 都在球里，交换顺序不影响这个结论
+            std::swap(points[0], points[i]);
+        }
 
-                sphere = recurseMinSphere(points + 1, i, b + 1);
+        return sphere;
+    }
+
+    template <typename T>
+    TSphere<T> TSphere<T>::sphereOnBoundary(const TVector3<T> &p0,
+        const TVector3<T> &p1, const TVector3<T> &p2)
+    {
+        TSphere sphere;
+
+        if (!sphere.build(p0, p1, p2))
+        {
+            T d01 = p0.distance2(p1);
+            T d02 = p0.distance2(p2);
+            T d12 = p1.distance2(p2);
+
+            if (d01 >= d02 && d01 >= d12)
+                sphere = TSphere(p0, p1);
+            else if (d02 >= d12)
+                sphere = TSphere(p0, p2);
+            else
+                sphere = TSphere(p1, p2);
+        }
+
+        return sphere;
+    }
+
+    template <typename T>
+    TSphere<T> TSphere<T>::sphereOnBoundary(const TVector3<T> &p0,
+        const TVector3<T> &p1, const TVector3<T> &p2, const TVector3<T> &p3)
+    {
+        TSphere sphere;
+
+        if (sphere.build(p0, p1, p2, p3))
+            return sphere;
+
+        // 共面时取包含全部 4 个点的最小的 3 点球
+        const TVector3<T> *p[4] = { &p0, &p1, &p2, &p3 };
+        bool found = false;
+
+        for (int32_t skip = 0; skip < 4; ++skip)
+        {
+            const TVector3<T> *q[3];
+            int32_t n = 0;
+
+            for (int32_t i = 0; i < 4; ++i)
+            {
+                if (i != skip)
+                    q[n++] = p[i];
+            }
+
+            TSphere s = sphereOnBoundary(*q[0], *q[1], *q[2]);
+
+            if (!s.isOutside(*p[skip])
+                && (!found || s.mRadius < sphere.mRadius))
+            {
+                sphere = s;
+                found = true;
             }
         }
 
+        if (!found)
+        {
+            sphere = sphereOnBoundary(p0, p1, p2);
+            sphere.mRadius = TMath<T>::max(sphere.mRadius,
+                (p3 - sphere.mCenter).length());
+        }
+
         return sphere;
     }
 
+    template <typename T>
+    inline bool TSphere<T>::isOutside(const TVector3<T> &point) const
+    {
+        T radius2 = mRadius * mRadius;
+        return (point.distance2(mCenter) > radius2 + radius2 * TReal<T>::EPSILON);
+    }
+
     template <typename T>
     void TSphere<T>::buildByRitter(const TVector3<T> points[], size_t count)
     {
@@ -349,7 +471,7 @@ namespace Tiny3D
             for (i = 0; i < count; ++i)
                 center += points[i];
 
-            center /= T(count);
+            center /= T((int32_t)count);
 
             for (i = 0; i < count; ++i)
             {
@@ -0,0 +1,73 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_TRANSFORM_BATCH_H__
+#define __T3D_TRANSFORM_BATCH_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DVector3.h"
+#include "T3DMatrix4.h"
+#include "T3DVector3Stream.h"
+#include "T3DMathSIMD.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 用仿射矩阵批量变换点
+     * @param [in] m : 仿射变换矩阵
+     * @param [in] in : 输入点数组
+     * @param [out] out : 输出点数组，可以和 in 是同一个数组
+     * @param [in] count : 点的个数
+     * @remarks 结果和逐个调用 TMatrix4::transformAffine 一样。
+     *      float32_t 在开启 SIMD 时一次处理 4 个点。
+     */
+    template <typename T>
+    void transformPoints(const TMatrix4<T> &m, const TVector3<T> *in,
+        TVector3<T> *out, size_t count);
+
+    /**
+     * @brief 用仿射矩阵批量变换 SoA 存放的点
+     * @param [in] m : 仿射变换矩阵
+     * @param [in] in : 输入点
+     * @param [out] out : 输出点，个数会被调整成和 in 一样，可以和 in 是同一个对象
+     * @remarks float32_t 在开启 AVX 时一次处理 8 个点，SSE2/NEON 一次 4 个点。
+     */
+    template <typename T>
+    void transformPoints(const TMatrix4<T> &m, const TVector3Stream<T> &in,
+        TVector3Stream<T> &out);
+
+    /**
+     * @brief 批量矩阵相乘，out[i] = a[i] * b[i]
+     * @param [in] a : 左矩阵数组
+     * @param [in] b : 右矩阵数组
+     * @param [out] out : 结果数组，可以和 a 或 b 是同一个数组
+     * @param [in] count : 矩阵个数
+     */
+    template <typename T>
+    void multiplyMatrices(const TMatrix4<T> *a, const TMatrix4<T> *b,
+        TMatrix4<T> *out, size_t count);
+}
+
+
+#include "T3DTransformBatch.inl"
+
+
+#endif  /*__T3D_TRANSFORM_BATCH_H__*/
@@ -0,0 +1,193 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    inline void transformPoints(const TMatrix4<T> &m, const TVector3<T> *in,
+        TVector3<T> *out, size_t count)
+    {
+        T3D_ASSERT(m.isAffine());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = m.transformAffine(in[i]);
+        }
+    }
+
+    template <typename T>
+    inline void transformPoints(const TMatrix4<T> &m,
+        const TVector3Stream<T> &in, TVector3Stream<T> &out)
+    {
+        T3D_ASSERT(m.isAffine());
+
+        const size_t count = in.size();
+        out.resize(count);
+
+        const T *ix = in.x();
+        const T *iy = in.y();
+        const T *iz = in.z();
+        T *ox = out.x();
+        T *oy = out.y();
+        T *oz = out.z();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            T x = ix[i], y = iy[i], z = iz[i];
+            ox[i] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+            oy[i] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+            oz[i] = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+        }
+    }
+
+    template <typename T>
+    inline void multiplyMatrices(const TMatrix4<T> *a, const TMatrix4<T> *b,
+        TMatrix4<T> *out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+#if defined (T3D_SIMD)
+    template <>
+    inline void transformPoints(const TMatrix4<float32_t> &m,
+        const TVector3<float32_t> *in, TVector3<float32_t> *out, size_t count)
+    {
+        T3D_ASSERT(m.isAffine());
+
+        const SIMDFloat4 m00 = simdSplat(m[0][0]), m01 = simdSplat(m[0][1]);
+        const SIMDFloat4 m02 = simdSplat(m[0][2]), m03 = simdSplat(m[0][3]);
+        const SIMDFloat4 m10 = simdSplat(m[1][0]), m11 = simdSplat(m[1][1]);
+        const SIMDFloat4 m12 = simdSplat(m[1][2]), m13 = simdSplat(m[1][3]);
+        const SIMDFloat4 m20 = simdSplat(m[2][0]), m21 = simdSplat(m[2][1]);
+        const SIMDFloat4 m22 = simdSplat(m[2][2]), m23 = simdSplat(m[2][3]);
+
+        // TVector3<float32_t> 只有 3 个连续的 float，4 个点正好 12 个 float
+        const float32_t *src = (const float32_t *)in;
+        float32_t *dst = (float32_t *)out;
+        size_t i = 0;
+
+        for (; i + 4 <= count; i += 4, src += 12, dst += 12)
+        {
+            SIMDFloat4 x, y, z;
+            simdLoadXYZ4(src, x, y, z);
+
+            SIMDFloat4 rx = simdMulAdd(m02, z, simdMulAdd(m01, y,
+                simdMulAdd(m00, x, m03)));
+            SIMDFloat4 ry = simdMulAdd(m12, z, simdMulAdd(m11, y,
+                simdMulAdd(m10, x, m13)));
+            SIMDFloat4 rz = simdMulAdd(m22, z, simdMulAdd(m21, y,
+                simdMulAdd(m20, x, m23)));
+
+            simdStoreXYZ4(dst, rx, ry, rz);
+        }
+
+        for (; i < count; ++i)
+        {
+            out[i] = m.transformAffine(in[i]);
+        }
+    }
+
+    template <>
+    inline void transformPoints(const TMatrix4<float32_t> &m,
+        const TVector3Stream<float32_t> &in, TVector3Stream<float32_t> &out)
+    {
+        T3D_ASSERT(m.isAffine());
+
+        out.resize(in.size());
+
+        // 容量按 TVector3Stream::LANES 补齐过，循环直接跑到容量，最后再清零尾巴
+        const size_t count = in.size();
+        const size_t capacity = in.capacity();
+        const float32_t *ix = in.x();
+        const float32_t *iy = in.y();
+        const float32_t *iz = in.z();
+        float32_t *ox = out.x();
+        float32_t *oy = out.y();
+        float32_t *oz = out.z();
+
+#if defined (T3D_SIMD_AVX)
+        const __m256 m00 = _mm256_set1_ps(m[0][0]), m01 = _mm256_set1_ps(m[0][1]);
+        const __m256 m02 = _mm256_set1_ps(m[0][2]), m03 = _mm256_set1_ps(m[0][3]);
+        const __m256 m10 = _mm256_set1_ps(m[1][0]), m11 = _mm256_set1_ps(m[1][1]);
+        const __m256 m12 = _mm256_set1_ps(m[1][2]), m13 = _mm256_set1_ps(m[1][3]);
+        const __m256 m20 = _mm256_set1_ps(m[2][0]), m21 = _mm256_set1_ps(m[2][1]);
+        const __m256 m22 = _mm256_set1_ps(m[2][2]), m23 = _mm256_set1_ps(m[2][3]);
+
+        for (size_t i = 0; i < capacity; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(ix + i);
+            __m256 y = _mm256_loadu_ps(iy + i);
+            __m256 z = _mm256_loadu_ps(iz + i);
+
+            __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x),
+                _mm256_mul_ps(m01, y)), _mm256_add_ps(_mm256_mul_ps(m02, z), m03));
+            __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, x),
+                _mm256_mul_ps(m11, y)), _mm256_add_ps(_mm256_mul_ps(m12, z), m13));
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, x),
+                _mm256_mul_ps(m21, y)), _mm256_add_ps(_mm256_mul_ps(m22, z), m23));
+
+            _mm256_storeu_ps(ox + i, rx);
+            _mm256_storeu_ps(oy + i, ry);
+            _mm256_storeu_ps(oz + i, rz);
+        }
+#else
+        const SIMDFloat4 m00 = simdSplat(m[0][0]), m01 = simdSplat(m[0][1]);
+        const SIMDFloat4 m02 = simdSplat(m[0][2]), m03 = simdSplat(m[0][3]);
+        const SIMDFloat4 m10 = simdSplat(m[1][0]), m11 = simdSplat(m[1][1]);
+        const SIMDFloat4 m12 = simdSplat(m[1][2]), m13 = simdSplat(m[1][3]);
+        const SIMDFloat4 m20 = simdSplat(m[2][0]), m21 = simdSplat(m[2][1]);
+        const SIMDFloat4 m22 = simdSplat(m[2][2]), m23 = simdSplat(m[2][3]);
+
+        for (size_t i = 0; i < capacity; i += 4)
+        {
+            SIMDFloat4 x = simdLoad(ix + i);
+            SIMDFloat4 y = simdLoad(iy + i);
+            SIMDFloat4 z = simdLoad(iz + i);
+
+            simdStore(ox + i, simdMulAdd(m02, z, simdMulAdd(m01, y,
+                simdMulAdd(m00, x, m03))));
+            simdStore(oy + i, simdMulAdd(m12, z, simdMulAdd(m11, y,
+                simdMulAdd(m10, x, m13))));
+            simdStore(oz + i, simdMulAdd(m22, z, simdMulAdd(m21, y,
+                simdMulAdd(m20, x, m23))));
+        }
+#endif
+
+        // 补齐部分被写成了平移量，要恢复成 0
+        for (size_t i = count; i < capacity; ++i)
+        {
+            ox[i] = oy[i] = oz[i] = TReal<float32_t>::ZERO;
+        }
+    }
+
+    template <>
+    inline void multiplyMatrices(const TMatrix4<float32_t> *a,
+        const TMatrix4<float32_t> *b, TMatrix4<float32_t> *out, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            simdMultiplyMatrix(a[i], b[i], out[i]);
+        }
+    }
+#endif  /*T3D_SIMD*/
+}
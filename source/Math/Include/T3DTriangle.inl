@@ -23,9 +23,9 @@ namespace Tiny3D
     template <typename T>
     inline TTriangle<T>::TTriangle()
     {
-        mVertices[0] = TReal<T>::ZERO;
-        mVertices[1] = TReal<T>::ZERO;
-        mVertices[2] = TReal<T>::ZERO;
+        mVertices[0] = TVector3<T>::ZERO;
+        mVertices[1] = TVector3<T>::ZERO;
+        mVertices[2] = TVector3<T>::ZERO;
     }
 
     template <typename T>
@@ -0,0 +1,88 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_VECTOR3_STREAM_H__
+#define __T3D_VECTOR3_STREAM_H__
+
+
+#include "T3DMathPrerequisites.h"
+#include "T3DVector3.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief 按分量分开存放的 3D 向量数组（SoA）
+     * @remarks x、y、z 各自一段连续内存，批量运算时一次就能取到同一分量的
+     *      4 个或 8 个值。每段的容量按 LANES 补齐，补出来的元素都是 0，
+     *      这样 SIMD 循环不需要单独处理尾巴。
+     */
+    template <typename T>
+    class TVector3Stream
+    {
+    public:
+        /// 容量补齐的粒度
+        static const size_t LANES = 8;
+
+        /// 构造指定元素个数的数组，元素都初始化为 0
+        TVector3Stream(size_t count = 0);
+        /// 从 AoS 的点数组构造
+        TVector3Stream(const TVector3<T> points[], size_t count);
+
+        /// 调整元素个数，新增的元素为 0
+        void resize(size_t count);
+
+        /// 元素个数
+        size_t size() const;
+        /// 补齐以后的容量，总是 LANES 的倍数
+        size_t capacity() const;
+
+        /// 获取第 i 个向量
+        TVector3<T> get(size_t i) const;
+        /// 设置第 i 个向量
+        void set(size_t i, const TVector3<T> &v);
+
+        /// 获取 x 分量数组的首地址
+        const T *x() const;
+        T *x();
+        /// 获取 y 分量数组的首地址
+        const T *y() const;
+        T *y();
+        /// 获取 z 分量数组的首地址
+        const T *z() const;
+        T *z();
+
+        /// 用 AoS 的点数组重新填充
+        void assign(const TVector3<T> points[], size_t count);
+        /// 写回 AoS 的点数组，points 至少要有 size() 个元素
+        void copyTo(TVector3<T> points[]) const;
+
+    private:
+        size_t      mSize;  /// 元素个数
+        TArray<T>   mX;     /// x 分量
+        TArray<T>   mY;     /// y 分量
+        TArray<T>   mZ;     /// z 分量
+    };
+}
+
+
+#include "T3DVector3Stream.inl"
+
+
+#endif  /*__T3D_VECTOR3_STREAM_H__*/
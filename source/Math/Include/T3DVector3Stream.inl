@@ -0,0 +1,144 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+namespace Tiny3D
+{
+    template <typename T>
+    const size_t TVector3Stream<T>::LANES;
+
+    template <typename T>
+    inline TVector3Stream<T>::TVector3Stream(size_t count /* = 0 */)
+        : mSize(0)
+    {
+        resize(count);
+    }
+
+    template <typename T>
+    inline TVector3Stream<T>::TVector3Stream(const TVector3<T> points[],
+        size_t count)
+        : mSize(0)
+    {
+        assign(points, count);
+    }
+
+    template <typename T>
+    inline void TVector3Stream<T>::resize(size_t count)
+    {
+        size_t cap = (count + LANES - 1) / LANES * LANES;
+        mX.resize(cap, TReal<T>::ZERO);
+        mY.resize(cap, TReal<T>::ZERO);
+        mZ.resize(cap, TReal<T>::ZERO);
+
+        // 缩小的时候把补齐部分重新清零
+        for (size_t i = count; i < mSize && i < cap; ++i)
+        {
+            mX[i] = mY[i] = mZ[i] = TReal<T>::ZERO;
+        }
+
+        mSize = count;
+    }
+
+    template <typename T>
+    inline size_t TVector3Stream<T>::size() const
+    {
+        return mSize;
+    }
+
+    template <typename T>
+    inline size_t TVector3Stream<T>::capacity() const
+    {
+        return mX.size();
+    }
+
+    template <typename T>
+    inline TVector3<T> TVector3Stream<T>::get(size_t i) const
+    {
+        T3D_ASSERT(i < mSize);
+        return TVector3<T>(mX[i], mY[i], mZ[i]);
+    }
+
+    template <typename T>
+    inline void TVector3Stream<T>::set(size_t i, const TVector3<T> &v)
+    {
+        T3D_ASSERT(i < mSize);
+        mX[i] = v.x();
+        mY[i] = v.y();
+        mZ[i] = v.z();
+    }
+
+    template <typename T>
+    inline const T *TVector3Stream<T>::x() const
+    {
+        return mX.data();
+    }
+
+    template <typename T>
+    inline T *TVector3Stream<T>::x()
+    {
+        return mX.data();
+    }
+
+    template <typename T>
+    inline const T *TVector3Stream<T>::y() const
+    {
+        return mY.data();
+    }
+
+    template <typename T>
+    inline T *TVector3Stream<T>::y()
+    {
+        return mY.data();
+    }
+
+    template <typename T>
+    inline const T *TVector3Stream<T>::z() const
+    {
+        return mZ.data();
+    }
+
+    template <typename T>
+    inline T *TVector3Stream<T>::z()
+    {
+        return mZ.data();
+    }
+
+    template <typename T>
+    inline void TVector3Stream<T>::assign(const TVector3<T> points[],
+        size_t count)
+    {
+        resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            mX[i] = points[i].x();
+            mY[i] = points[i].y();
+            mZ[i] = points[i].z();
+        }
+    }
+
+    template <typename T>
+    inline void TVector3Stream<T>::copyTo(TVector3<T> points[]) const
+    {
+        for (size_t i = 0; i < mSize; ++i)
+        {
+            points[i] = TVector3<T>(mX[i], mY[i], mZ[i]);
+        }
+    }
+}
@@ -300,4 +300,74 @@ namespace Tiny3D
 
     template <typename T>
     const TVector4<T> TVector4<T>::ZERO(0.0, 0.0, 0.0, 0.0);
+
+#if defined (T3D_SIMD)
+    //--------------------------------------------------------------------------
+    // float32_t 的 SIMD 特化
+    //--------------------------------------------------------------------------
+
+    template <>
+    inline TVector4<float32_t> TVector4<float32_t>::operator +(
+        const TVector4 &other) const
+    {
+        TVector4 result;
+        simdStore(&result._x, simdAdd(simdLoad(&_x), simdLoad(&other._x)));
+        return result;
+    }
+
+    template <>
+    inline TVector4<float32_t> TVector4<float32_t>::operator -(
+        const TVector4 &other) const
+    {
+        TVector4 result;
+        simdStore(&result._x, simdSub(simdLoad(&_x), simdLoad(&other._x)));
+        return result;
+    }
+
+    template <>
+    inline TVector4<float32_t> TVector4<float32_t>::operator *(
+        float32_t scalar) const
+    {
+        TVector4 result;
+        simdStore(&result._x, simdMul(simdLoad(&_x), simdSplat(scalar)));
+        return result;
+    }
+
+    template <>
+    inline TVector4<float32_t> &TVector4<float32_t>::operator +=(
+        const TVector4 &other)
+    {
+        simdStore(&_x, simdAdd(simdLoad(&_x), simdLoad(&other._x)));
+        return *this;
+    }
+
+    template <>
+    inline TVector4<float32_t> &TVector4<float32_t>::operator -=(
+        const TVector4 &other)
+    {
+        simdStore(&_x, simdSub(simdLoad(&_x), simdLoad(&other._x)));
+        return *this;
+    }
+
+    template <>
+    inline TVector4<float32_t> &TVector4<float32_t>::operator *=(
+        float32_t fScalar)
+    {
+        simdStore(&_x, simdMul(simdLoad(&_x), simdSplat(fScalar)));
+        return *this;
+    }
+
+    template <>
+    inline float32_t TVector4<float32_t>::squaredLength() const
+    {
+        SIMDFloat4 v = simdLoad(&_x);
+        return simdDot4(v, v);
+    }
+
+    template <>
+    inline float32_t TVector4<float32_t>::dot(const TVector4 &other) const
+    {
+        return simdDot4(simdLoad(&_x), simdLoad(&other._x));
+    }
+#endif  /*T3D_SIMD*/
 }
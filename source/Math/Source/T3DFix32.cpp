@@ -23,8 +23,8 @@
 
 namespace Tiny3D
 {
-    const int32_t fix32::INTEGER_BITS = 20;
-    const int32_t fix32::DECIMAL_BITS = 12;
+    const int32_t fix32::INTEGER_BITS;
+    const int32_t fix32::DECIMAL_BITS;
 
     const int32_t fix32::MAX_INT_VALUE = 524287; // 524287
     const int32_t fix32::MIN_INT_VALUE = -524288; // -524288
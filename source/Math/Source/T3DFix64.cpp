@@ -22,8 +22,8 @@
 
 namespace Tiny3D
 {
-    const int32_t fix64::INTEGER_BITS = 40;
-    const int32_t fix64::DECIMAL_BITS = 24;
+    const int32_t fix64::INTEGER_BITS;
+    const int32_t fix64::DECIMAL_BITS;
 
     const int64_t fix64::MAX_INT_VALUE = 549755813887LL; // 549755813887LL
     const int64_t fix64::MIN_INT_VALUE = -549755813888LL; // -549755813888LL
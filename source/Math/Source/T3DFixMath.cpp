@@ -0,0 +1,352 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "T3DFixMath.h"
+
+
+namespace Tiny3D
+{
+    namespace
+    {
+        /// sin(i * PI / 512)，i = [0, 256]，Q30
+        const int32_t SIN_TABLE[257] =
+        {
+        0, 6588356, 13176464, 19764076, 26350943, 32936819,
+        39521455, 46104602, 52686014, 59265442, 65842639, 72417357,
+        78989349, 85558366, 92124163, 98686491, 105245103, 111799753,
+        118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+        157550647, 164064728, 170572633, 177074115, 183568930, 190056834,
+        196537583, 203010932, 209476638, 215934457, 222384147, 228825464,
+        235258165, 241682010, 248096755, 254502159, 260897982, 267283981,
+        273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+        311690799, 317989595, 324276419, 330551034, 336813204, 343062693,
+        349299266, 355522689, 361732726, 367929144, 374111709, 380280190,
+        386434353, 392573967, 398698801, 404808624, 410903207, 416982319,
+        423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+        459083786, 465030947, 470960600, 476872522, 482766489, 488642281,
+        494499676, 500338453, 506158392, 511959275, 517740883, 523502998,
+        529245404, 534967884, 540670223, 546352205, 552013618, 557654248,
+        563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+        596538995, 602005783, 607449906, 612871159, 618269338, 623644239,
+        628995660, 634323400, 639627258, 644907034, 650162530, 655393548,
+        660599890, 665781362, 670937767, 676068911, 681174602, 686254647,
+        691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+        721080937, 725949013, 730789757, 735602987, 740388522, 745146182,
+        749875788, 754577161, 759250125, 763894504, 768510122, 773096806,
+        777654384, 782182683, 786681534, 791150767, 795590213, 799999706,
+        804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+        830013654, 834177638, 838310216, 842411232, 846480531, 850517961,
+        854523370, 858496606, 862437520, 866345964, 870221790, 874064853,
+        877875009, 881652112, 885396022, 889106597, 892783698, 896427186,
+        900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+        920979082, 924348837, 927683790, 930983817, 934248793, 937478595,
+        940673101, 943832191, 946955747, 950043650, 953095785, 956112036,
+        959092290, 962036435, 964944360, 967815955, 970651112, 973449725,
+        976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+        992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648,
+        1006460100, 1008736660, 1010975242, 1013175761, 1015338134, 1017462281,
+        1019548121, 1021595575, 1023604567, 1025575020, 1027506862, 1029400018,
+        1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+        1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980,
+        1050460278, 1051805027, 1053110176, 1054375676, 1055601479, 1056787540,
+        1057933813, 1059040255, 1060106826, 1061133483, 1062120190, 1063066909,
+        1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+        1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985,
+        1071721163, 1072104991, 1072448455, 1072751542, 1073014240, 1073236540,
+        1073418433, 1073559913, 1073660973, 1073721611, 1073741824
+        };
+
+        /// atan(2^-i)，i = [0, 29]，Q30
+        const int32_t ATAN_TABLE[30] =
+        {
+        843314857, 497837829, 263043837, 133525159, 67021687, 33543516,
+        16775851, 8388437, 4194283, 2097149, 1048576, 524288,
+        262144, 131072, 65536, 32768, 16384, 8192,
+        4096, 2048, 1024, 512, 256, 128,
+        64, 32, 16, 8, 4, 2
+        };
+
+        /// 正弦表相邻两项的弧度间隔 PI / 512，Q30
+        const int64_t SIN_TABLE_STEP = 6588397;
+
+        /// 2 / PI，Q30，把 [0, 2PI) 的 Q30 弧度变成一圈 2^32 的相位
+        const int64_t TWO_OVER_PI = 683565276;
+
+        /// 最高的 1 所在的位，value 不能为 0
+        int32_t highestBit(uint64_t value)
+        {
+            int32_t n = 0;
+
+            if (value >= (1ULL << 32))
+            {
+                value >>= 32;
+                n += 32;
+            }
+
+            if (value >= (1ULL << 16))
+            {
+                value >>= 16;
+                n += 16;
+            }
+
+            if (value >= (1ULL << 8))
+            {
+                value >>= 8;
+                n += 8;
+            }
+
+            if (value >= (1ULL << 4))
+            {
+                value >>= 4;
+                n += 4;
+            }
+
+            if (value >= (1ULL << 2))
+            {
+                value >>= 2;
+                n += 2;
+            }
+
+            if (value >= (1ULL << 1))
+            {
+                n += 1;
+            }
+
+            return n;
+        }
+
+        /// 整数平方根，同时返回余数
+        uint64_t isqrt(uint64_t value, uint64_t &remainder)
+        {
+            uint64_t result = 0;
+            uint64_t bit = 0;
+
+            // 从不超过 value 的最大的 4 的幂开始
+            if (value != 0)
+                bit = 1ULL << (highestBit(value) & ~1);
+
+            // 逐位试商，用掩码代替分支，避免每一位都可能预测失败
+            while (bit != 0)
+            {
+                uint64_t trial = result + bit;
+                uint64_t mask = (uint64_t)0 - (uint64_t)(value >= trial);
+                value -= trial & mask;
+                result = (result >> 1) + (bit & mask);
+                bit >>= 2;
+            }
+
+            remainder = value;
+            return result;
+        }
+
+        /// 把带 shift 位小数的弧度放大到 Q30 并规约到 [0, 2PI)，再转成相位
+        uint32_t radiansToPhase(int64_t radians, int32_t shift)
+        {
+            // (radians * 2^shift) mod 2PI = ((radians mod 2PI) * 2^shift) mod 2PI，
+            // 先取模再放大就不会溢出
+            int64_t r = radians % FixMath::Q_TWO_PI;
+            r = (r * (1LL << shift)) % FixMath::Q_TWO_PI;
+            if (r < 0)
+                r += FixMath::Q_TWO_PI;
+
+            return (uint32_t)((r * TWO_OVER_PI) >> FixMath::Q_BITS);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    const int32_t FixMath::Q_BITS;
+    const int64_t FixMath::Q_ONE;
+    const int64_t FixMath::Q_PI;
+    const int64_t FixMath::Q_HALF_PI;
+    const int64_t FixMath::Q_TWO_PI;
+
+    //--------------------------------------------------------------------------
+
+    void FixMath::sinCosPhase(uint32_t phase, int64_t &s, int64_t &c)
+    {
+        // 高 2 位是象限，接着 8 位是表的下标，剩下 22 位是表项之间的偏移
+        uint32_t quadrant = phase >> 30;
+        uint32_t index = (phase >> 22) & 0xFF;
+        int64_t d = ((int64_t)(phase & 0x3FFFFF) * SIN_TABLE_STEP) >> 22;
+
+        // d < PI / 512，泰勒展开到 d^3 就够了
+        int64_t d2 = (d * d) >> Q_BITS;
+        int64_t cosD = Q_ONE - (d2 >> 1);
+        int64_t sinD = d - ((d2 * d) >> Q_BITS) / 6;
+
+        int64_t sinA = SIN_TABLE[index];
+        int64_t cosA = SIN_TABLE[256 - index];
+
+        const int64_t round = 1LL << (Q_BITS - 1);
+        int64_t sv = (sinA * cosD + cosA * sinD + round) >> Q_BITS;
+        int64_t cv = (cosA * cosD - sinA * sinD + round) >> Q_BITS;
+
+        switch (quadrant)
+        {
+        case 0:
+            s = sv;
+            c = cv;
+            break;
+        case 1:
+            s = cv;
+            c = -sv;
+            break;
+        case 2:
+            s = -sv;
+            c = -cv;
+            break;
+        default:
+            s = -cv;
+            c = sv;
+            break;
+        }
+    }
+
+    void FixMath::sinCosRadians(int64_t radians, int32_t fracBits,
+        int64_t &s, int64_t &c)
+    {
+        T3D_ASSERT(fracBits >= 0 && fracBits <= Q_BITS);
+
+        sinCosPhase(radiansToPhase(radians, Q_BITS - fracBits), s, c);
+    }
+
+    void FixMath::sinCosDegrees(int64_t degrees, int32_t fracBits,
+        int64_t &s, int64_t &c)
+    {
+        T3D_ASSERT(fracBits >= 0 && fracBits <= Q_BITS);
+
+        int64_t turn = 360LL << fracBits;
+        int64_t r = degrees % turn;
+        if (r < 0)
+            r += turn;
+
+        // phase = r / turn * 2^32 = r * 2^29 / (45 << fracBits)
+        if (fracBits <= 24)
+        {
+            sinCosPhase((uint32_t)((r << 29) / (45LL << fracBits)), s, c);
+        }
+        else
+        {
+            int32_t shift = fracBits - 24;
+            sinCosPhase((uint32_t)(((r >> shift) << 29) / (45LL << 24)), s, c);
+        }
+    }
+
+    int64_t FixMath::atan2(int64_t y, int64_t x, int32_t fracBits /* = Q_BITS */)
+    {
+        if (x == 0 && y == 0)
+            return 0;
+
+        uint64_t ax = (x < 0) ? (uint64_t)0 - (uint64_t)x : (uint64_t)x;
+        uint64_t ay = (y < 0) ? (uint64_t)0 - (uint64_t)y : (uint64_t)y;
+
+        // 把较大的分量缩放到 [2^29, 2^30)，CORDIC 迭代时既不会溢出也不丢精度
+        int32_t shift = 29 - highestBit(ax > ay ? ax : ay);
+        if (shift > 0)
+        {
+            ax <<= shift;
+            ay <<= shift;
+        }
+        else
+        {
+            ax >>= -shift;
+            ay >>= -shift;
+        }
+
+        // 向量模式的 CORDIC，把 (ax, ay) 转到 x 轴上，累计的角度就是反正切
+        int64_t vx = (int64_t)ax;
+        int64_t vy = (int64_t)ay;
+        int64_t angle = 0;
+
+        // 每次迭代大约多一位精度，比需要的小数位数多迭代几次就够了
+        int32_t iterations = fracBits + 4 < 30 ? fracBits + 4 : 30;
+
+        for (int32_t i = 0; i < iterations; ++i)
+        {
+            // vy >= 0 时顺时针转，否则逆时针转，sign 为 0 或 -1，
+            // (v ^ sign) - sign 就是按符号取反，省掉难以预测的分支
+            int64_t sign = vy >> 63;
+            int64_t dx = ((vy >> i) ^ sign) - sign;
+            int64_t dy = ((vx >> i) ^ sign) - sign;
+            vx += dx;
+            vy -= dy;
+            angle += ((int64_t)ATAN_TABLE[i] ^ sign) - sign;
+        }
+
+        if (x < 0)
+            angle = Q_PI - angle;
+        if (y < 0)
+            angle = -angle;
+
+        return angle;
+    }
+
+    int64_t FixMath::asin(int64_t value, int32_t fracBits /* = Q_BITS */)
+    {
+        if (value >= Q_ONE)
+            return Q_HALF_PI;
+        if (value <= -Q_ONE)
+            return -Q_HALF_PI;
+
+        // cos = sqrt(1 - value^2)，Q60 开方正好是 Q30
+        uint64_t remainder;
+        int64_t c = (int64_t)isqrt((uint64_t)(Q_ONE * Q_ONE - value * value),
+            remainder);
+        return atan2(value, c, fracBits);
+    }
+
+    int64_t FixMath::acos(int64_t value, int32_t fracBits /* = Q_BITS */)
+    {
+        if (value >= Q_ONE)
+            return 0;
+        if (value <= -Q_ONE)
+            return Q_PI;
+
+        uint64_t remainder;
+        int64_t s = (int64_t)isqrt((uint64_t)(Q_ONE * Q_ONE - value * value),
+            remainder);
+        return atan2(s, value, fracBits);
+    }
+
+    uint64_t FixMath::sqrt(uint64_t value, int32_t fracBits)
+    {
+        T3D_ASSERT((fracBits & 1) == 0);
+
+        // 先求整数部分，再逐位补上 fracBits / 2 位小数，
+        // 相当于求 value * 2^fracBits 的整数平方根，但不需要 128 位整数
+        uint64_t remainder;
+        uint64_t result = isqrt(value, remainder);
+
+        for (int32_t i = 0; i < fracBits / 2; ++i)
+        {
+            remainder <<= 2;
+            uint64_t trial = (result << 2) | 1;
+            uint64_t bit = (uint64_t)(remainder >= trial);
+            remainder -= trial & ((uint64_t)0 - bit);
+            result = (result << 1) | bit;
+        }
+
+        // 余数超过结果说明平方根的小数部分大于 0.5
+        if (remainder > result)
+            ++result;
+
+        return result;
+    }
+}
@@ -64,44 +64,62 @@ namespace Tiny3D
          */
         virtual TResult pollEvents() override;
 
-        /** 线程函数，循环检测是否超时 */
+        /** 线程函数，睡眠到最近的定时器到期再触发 */
         void update();
 
+        /** 定时器堆里失效的节点太多时重建堆 */
+        void compactHeap();
+
         struct Timer
         {
-            int64_t         timestamp;  /**< 定时器启动时间戳 */
-            int64_t         interval;   /**< 定时器触发间隔 */
+            int64_t         timestamp;  /**< 定时器上次触发时间戳，纳秒 */
+            int64_t         deadline;   /**< 定时器下次到期时间戳，纳秒 */
+            int64_t         interval;   /**< 定时器触发间隔，纳秒 */
             ITimerListener  *listener;  /**< 定时器触发的监听对象 */
+            uint32_t        pending;    /**< 事件队列里还没派发的事件数量 */
             bool            repeat;     /**< 定时器是否循环 */
             bool            alive;      /**< 定时器是否有效 */
         };
 
+        struct TimerNode
+        {
+            int64_t         deadline;   /**< 到期时间戳，纳秒 */
+            ID              timerID;    /**< 定时器ID */
+
+            bool operator >(const TimerNode &other) const
+            {
+                return deadline > other.deadline;
+            }
+        };
+
         struct TimerEvent
         {
             ID              timerID;    /**< 定时器ID */
             int32_t         dt;         /**< 实际时间间隔 */
-            ITimerListener  *listener;  /**< 定时器触发的监听对象 */
         };
 
-        typedef TMap<uint32_t, Timer>       TimerList;
+        typedef TUnorderedMap<ID, Timer>    TimerList;
         typedef TimerList::iterator         TimerListItr;
         typedef TimerList::const_iterator   TimerListConstItr;
         typedef TimerList::value_type       TimerValue;
 
+        typedef TArray<TimerNode>           TimerHeap;
+
         typedef TList<TimerEvent>               TimerEventQueue;
         typedef TimerEventQueue::iterator       TimerEventQueueItr;
         typedef TimerEventQueue::const_iterator TimerEventQueueConstItr;
 
 
         TimerList       mTimerList;         /// 定时器对象列表
+        TimerHeap       mTimerHeap;         /// 按到期时间排序的小顶堆，停止的定时器延迟清除
         TimerEventQueue mTimerEventQueue;   /// 定时器事件队列
         ID              mTimerID;           /// 当前定时器ID，用于下一个生成的ID
 
         bool            mIsRunning;         /// 轮询线程是否在运行
 
         TThread         mPollThread;        /// 轮询线程
-        TMutex          mTimerListMutex;    /// 操作定时器对象列表的互斥量
-        TRecursiveMutex mEventListMutex;    /// 操作事件队列的互斥量
+        TMutex          mTimerListMutex;    /// 操作定时器对象、堆和事件队列的互斥量
+        TCondVariable   mTimerCond;         /// 有更早到期的定时器或者退出时唤醒轮询线程
     };
 }
 
@@ -0,0 +1,87 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_MAPPED_FILE_H__
+#define __T3D_MAPPED_FILE_H__
+
+
+#include "T3DType.h"
+#include "T3DMacro.h"
+#include "T3DPlatformPrerequisites.h"
+#include <atomic>
+
+
+namespace Tiny3D
+{
+    /**
+     * @class MappedFile
+     * @brief 只读内存映射文件.
+     * @note 映射的内存区域由引用计数管理，最后一个使用者 release() 后才解除映射，
+     *      可以交给 MemoryDataStream 直接读取，避免再拷贝一次文件内容.
+     */
+    class T3D_PLATFORM_API MappedFile
+    {
+        T3D_DISABLE_COPY(MappedFile);
+
+    public:
+        /**
+         * @brief 当前平台是否支持内存映射文件.
+         */
+        static bool isSupported();
+
+        /**
+         * @brief 以只读方式映射文件.
+         * @param [in] szFileName : 文件名
+         * @return 成功返回引用计数为 1 的映射对象，失败或者空文件返回 nullptr.
+         */
+        static MappedFile *create(const char *szFileName);
+
+        /**
+         * @brief 增加引用计数.
+         */
+        MappedFile *acquire();
+
+        /**
+         * @brief 减少引用计数，计数为 0 时解除映射并释放对象.
+         */
+        void release();
+
+        /**
+         * @brief 获取映射区域首地址.
+         */
+        uchar_t *getData() const    { return m_pData; }
+
+        /**
+         * @brief 获取映射区域大小.
+         */
+        size_t getSize() const      { return m_unSize; }
+
+    protected:
+        MappedFile(uchar_t *pData, size_t unSize);
+        ~MappedFile();
+
+    protected:
+        std::atomic<uint32_t>   m_unRefCount;   /**< 引用计数 */
+        uchar_t                 *m_pData;       /**< 映射区域首地址 */
+        size_t                  m_unSize;       /**< 映射区域大小 */
+    };
+}
+
+
+#endif  /*__T3D_MAPPED_FILE_H__*/
@@ -57,6 +57,13 @@ namespace Tiny3D
          */
         MemoryDataStream(size_t unSize);
 
+        /**
+         * @brief Constructor for T3DMemoryDataStream.
+         * @note 直接读取内存映射文件的内容，不拷贝数据，数据流为只读.
+         * @param [in] pMappedFile : 内存映射文件，内部会增加其引用计数
+         */
+        MemoryDataStream(MappedFile *pMappedFile);
+
         /**
          * @brief Constructor for T3DMemoryDataStream.
          * @note 拷贝构造.
@@ -127,15 +134,32 @@ namespace Tiny3D
 
         void getBuffer(uint8_t *&buffer, size_t &bufSize) const;
 
+        /**
+         * @brief 设置内存映射文件作为数据缓冲区.
+         * @note 数据流借用映射区域，不拷贝数据，并持有映射文件的一个引用，
+         *      直到数据流析构或者重新设置缓冲区时才释放.
+         * @param [in] pMappedFile : 内存映射文件
+         */
+        void setMappedFile(MappedFile *pMappedFile);
+
+        /**
+         * @brief 是否借用内存映射文件的数据.
+         */
+        bool isMapped() const   { return (m_pMappedFile != nullptr); }
+
     protected:
         void copy(const MemoryDataStream &other);
 
+        void releaseBuffer();
+
     protected:
         uchar_t     *m_pBuffer;     /**< 数据缓冲区 */
         long_t      m_lSize;        /**< 数据缓冲区大小 */
         long_t      m_lCurPos;      /**< 当前读写位置 */
 
         bool        m_bCreated;     /**< 是否内存创建标记 */
+
+        MappedFile  *m_pMappedFile; /**< 借用的内存映射文件 */
     };
 }
 
@@ -0,0 +1,218 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_MEMORY_POOL_H__
+#define __T3D_MEMORY_POOL_H__
+
+
+#include "T3DType.h"
+#include "T3DMacro.h"
+#include "T3DPlatformPrerequisites.h"
+#include <atomic>
+
+
+namespace Tiny3D
+{
+    /**
+     * @class MemoryPool
+     * @brief 固定大小内存块的池，空闲块串成链表，分配和释放都是 O(1)
+     * @remarks 内存按块批量向系统申请，池销毁前不会还给系统
+     */
+    class T3D_PLATFORM_API MemoryPool
+    {
+        T3D_DISABLE_COPY(MemoryPool);
+
+    public:
+        /**
+         * @brief 内存池统计信息
+         */
+        struct Stats
+        {
+            size_t      blockSize;      /**< 内存块大小 */
+            size_t      chunkCount;     /**< 向系统申请的大块数量 */
+            size_t      totalBlocks;    /**< 总共的内存块数量 */
+            size_t      usedBlocks;     /**< 正在使用的内存块数量 */
+            size_t      peakBlocks;     /**< 同时使用的内存块数量峰值 */
+            uint64_t    allocCount;     /**< 累计分配次数 */
+            uint64_t    freeCount;      /**< 累计释放次数 */
+        };
+
+        /**
+         * @brief 构造函数
+         * @param [in] blockSize : 内存块大小
+         * @param [in] blocksPerChunk : 每次向系统申请的内存块数量
+         */
+        MemoryPool(size_t blockSize, size_t blocksPerChunk);
+
+        /**
+         * @brief 析构函数，所有内存还给系统
+         */
+        ~MemoryPool();
+
+        /**
+         * @brief 分配一个内存块
+         */
+        void *allocate();
+
+        /**
+         * @brief 释放一个内存块
+         * @param [in] ptr : 通过 allocate() 分配的内存块
+         */
+        void deallocate(void *ptr);
+
+        /**
+         * @brief 一次分配多个内存块，用第一个指针大小的空间串成链表
+         * @param [in] count : 内存块数量
+         * @return 链表头
+         */
+        void *allocateBatch(size_t count);
+
+        /**
+         * @brief 一次释放多个内存块
+         * @param [in] head : 用第一个指针大小的空间串起来的链表头
+         * @param [in] tail : 链表尾
+         * @param [in] count : 内存块数量
+         */
+        void deallocateBatch(void *head, void *tail, size_t count);
+
+        /**
+         * @brief 获取内存块大小
+         */
+        size_t getBlockSize() const { return mBlockSize; }
+
+        /**
+         * @brief 获取统计信息
+         */
+        Stats getStats() const;
+
+    protected:
+        /// 向系统申请一个大块，切成内存块挂到空闲链表
+        void grow();
+
+        struct FreeBlock
+        {
+            FreeBlock   *next;
+        };
+
+        typedef TList<void*>                ChunkList;
+        typedef ChunkList::iterator         ChunkListItr;
+
+        mutable TMutex  mMutex;             /**< 分配和释放的互斥量 */
+        FreeBlock       *mFreeList;         /**< 空闲内存块链表 */
+        ChunkList       mChunks;            /**< 向系统申请的大块 */
+        size_t          mBlockSize;         /**< 内存块大小 */
+        size_t          mBlocksPerChunk;    /**< 每个大块的内存块数量 */
+        size_t          mUsedBlocks;        /**< 正在使用的内存块数量 */
+        size_t          mPeakBlocks;        /**< 同时使用的内存块数量峰值 */
+        uint64_t        mAllocCount;        /**< 累计分配次数 */
+        uint64_t        mFreeCount;         /**< 累计释放次数 */
+    };
+
+    /**
+     * @class PoolAllocator
+     * @brief 按大小分级的内存池分配器，Object、EventParam 等频繁创建的小对象
+     *      的 operator new 都从这里分配
+     * @remarks 不超过 MAX_POOL_SIZE 的分配按 POOL_GRANULARITY 对齐后落到对应
+     *      的内存池，大小相同的类共用一个空闲链表；更大的直接交给系统分配。
+     *      每个线程对每一级内存池都有一个小缓存，分配和释放先走缓存，不加锁，
+     *      缓存空了或者满了才成批地和内存池交换 THREAD_CACHE_BATCH 个内存块。
+     *      线程退出时缓存还给内存池。分配器第一次使用时创建，进程结束前都不会
+     *      销毁，保证全局对象析构时还能正确释放。
+     */
+    class T3D_PLATFORM_API PoolAllocator
+    {
+        T3D_DISABLE_COPY(PoolAllocator);
+
+    public:
+        enum
+        {
+            POOL_GRANULARITY = 16,      /**< 内存池分级粒度，也是分配的对齐 */
+            MAX_POOL_SIZE = 512,        /**< 使用内存池的最大分配大小 */
+            MAX_POOLS = MAX_POOL_SIZE / POOL_GRANULARITY,
+            THREAD_CACHE_BATCH = 32,    /**< 线程缓存和内存池每次交换的内存块数量 */
+        };
+
+        /**
+         * @brief 分配和释放内存的回调，用于外部统计
+         * @param [in] ptr : 内存地址
+         * @param [in] size : 申请的大小
+         * @param [in] allocated : true 是分配，false 是释放
+         */
+        typedef void (*MemoryHook)(void *ptr, size_t size, bool allocated);
+
+        /**
+         * @brief 获取全局分配器
+         */
+        static PoolAllocator &getInstance();
+
+        /**
+         * @brief 分配内存
+         * @param [in] size : 申请的大小
+         */
+        void *allocate(size_t size);
+
+        /**
+         * @brief 释放内存
+         * @param [in] ptr : 通过 allocate() 分配的内存
+         * @param [in] size : 分配时申请的大小
+         */
+        void deallocate(void *ptr, size_t size);
+
+        /**
+         * @brief 设置分配和释放内存的回调，传 nullptr 取消
+         * @note 需要在其他线程开始分配对象之前设置
+         */
+        void setHook(MemoryHook hook) { mHook = hook; }
+
+        /**
+         * @brief 获取所有已经创建的内存池统计信息
+         * @param [out] stats : 每个内存池一项
+         * @note 线程缓存里的内存块也算作正在使用
+         */
+        void getStats(TArray<MemoryPool::Stats> &stats) const;
+
+        /**
+         * @brief 获取超过 MAX_POOL_SIZE 直接向系统分配的次数
+         */
+        uint64_t getLargeAllocCount() const { return mLargeAllocCount; }
+
+        /**
+         * @brief 把当前线程缓存的内存块都还给内存池
+         * @note 线程退出时会自动调用，一般不需要手动调用
+         */
+        void flushThreadCache();
+
+    protected:
+        PoolAllocator();
+        ~PoolAllocator();
+
+        /// 获取对应大小的内存池，第一次使用时创建
+        MemoryPool *getPool(size_t index);
+
+        std::atomic<MemoryPool*>    mPools[MAX_POOLS];      /**< 各级内存池 */
+        TMutex                      mPoolsMutex;            /**< 创建内存池的互斥量 */
+        MemoryHook                  mHook;                  /**< 分配和释放的回调 */
+        std::atomic<uint64_t>       mLargeAllocCount;       /**< 直接向系统分配的次数 */
+    };
+
+    #define T3D_POOL_ALLOCATOR      PoolAllocator::getInstance()
+}
+
+
+#endif  /*__T3D_MEMORY_POOL_H__*/
@@ -41,6 +41,9 @@ namespace Tiny3D
     class DataStream;
     class FileDataStream;
     class MemoryDataStream;
+    class MappedFile;
+    class MemoryPool;
+    class PoolAllocator;
 }
  
 
@@ -29,6 +29,7 @@
 #include <stack>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <thread>
 #include <mutex>
@@ -100,6 +101,9 @@ using TSet = std::set<T>;
 template <typename K, typename V>
 using TMap = std::map<K, V>;
 
+template <typename K, typename V>
+using TUnorderedMap = std::unordered_map<K, V>;
+
 template <typename T1, typename T2>
 using TPair = std::pair<T1, T2>;
 
@@ -0,0 +1,64 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_CLOCK_H__
+#define __T3D_CLOCK_H__
+
+
+#include "T3DType.h"
+#include "T3DMacro.h"
+#include "T3DPlatformPrerequisites.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @class Clock
+     * @brief 单调递增的高精度时钟.
+     * @note 跟 DateTime 不同，这里的时间不受修改系统时间和 NTP 校时影响，
+     *      起点也没有意义，只能用来计算时间间隔，定时器调度和性能统计都用它.
+     */
+    class T3D_PLATFORM_API Clock
+    {
+    public:
+        /**
+         * @brief 获取单调时钟的纳秒数.
+         */
+        static int64_t currentNanoseconds();
+
+        /**
+         * @brief 获取单调时钟的微秒数.
+         */
+        static int64_t currentMicroseconds()
+        {
+            return currentNanoseconds() / 1000;
+        }
+
+        /**
+         * @brief 获取单调时钟的毫秒数.
+         */
+        static int64_t currentMilliseconds()
+        {
+            return currentNanoseconds() / 1000000;
+        }
+    };
+}
+
+
+#endif  /*__T3D_CLOCK_H__*/
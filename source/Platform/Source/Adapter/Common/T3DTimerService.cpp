@@ -20,9 +20,10 @@
 
 #include "Adapter/Common/T3DTimerService.h"
 #include "T3DTimerListener.h"
-#include "T3DDateTime.h"
+#include "T3DClock.h"
 #include <chrono>
 #include <functional>
+#include <algorithm>
 
 
 namespace Tiny3D
@@ -34,16 +35,23 @@ namespace Tiny3D
         , mIsRunning(false)
         , mPollThread()
         , mTimerListMutex()
-        , mEventListMutex()
+        , mTimerCond()
     {
 
     }
 
     TimerService::~TimerService()
     {
-        // 设置线程退出，等待线程结束，才析构
+        // 设置线程退出，唤醒线程并等待线程结束，才析构
+        TAutoLock<TMutex> lock(mTimerListMutex);
         mIsRunning = false;
-        mPollThread.join();
+        lock.unlock();
+        mTimerCond.notify_all();
+
+        if (mPollThread.joinable())
+        {
+            mPollThread.join();
+        }
     }
 
     ID TimerService::startTimer(uint32_t interval, bool repeat,
@@ -52,22 +60,48 @@ namespace Tiny3D
         if (nullptr == listener)
             return INVALID_TIMER_ID;
 
-        int64_t timestamp = DateTime::currentMSecsSinceEpoch();
-        Timer timer = { timestamp, interval, listener, repeat, true };
+        if (repeat && interval == 0)
+        {
+            // 循环定时器间隔为0会让轮询线程空转
+            interval = 1;
+        }
+
+        // 定时器内部都用单调时钟的纳秒数，不受修改系统时间影响
+        int64_t timestamp = Clock::currentNanoseconds();
+        int64_t duration = (int64_t)interval * 1000000LL;
+        Timer timer = { timestamp, timestamp + duration, duration, listener, 
+            0, repeat, true };
 
         TAutoLock<TMutex> lockL(mTimerListMutex);
 
         ID timerID = mTimerID + 1;
+        if (timerID == INVALID_TIMER_ID)
+        {
+            // 越界了，重置为1
+            timerID = 1;
+        }
+
         auto r = mTimerList.insert(TimerValue(timerID, timer));
-        if (r.second)
+        if (!r.second)
         {
-            if (timerID == (uint32_t)-1)
-            {
-                // 越界了，重置为1
-                timerID = 1;
-            }
+            return INVALID_TIMER_ID;
+        }
+
+        mTimerID = timerID;
+
+        TimerNode node = { timer.deadline, timerID };
+        bool isEarliest = (mTimerHeap.empty() 
+            || node.deadline < mTimerHeap.front().deadline);
+        mTimerHeap.push_back(node);
+        std::push_heap(mTimerHeap.begin(), mTimerHeap.end(), 
+            std::greater<TimerNode>());
+
+        lockL.unlock();
 
-            mTimerID = timerID;
+        if (isEarliest)
+        {
+            // 新的定时器比之前最早的还要早，唤醒线程重新计算睡眠时间
+            mTimerCond.notify_one();
         }
 
         return timerID;
@@ -85,22 +119,23 @@ namespace Tiny3D
                 break;
             }
 
+            // 堆里的节点和事件队列里的事件都不删除，到期或者派发时发现
+            // 定时器已经不在或者无效了就直接跳过
             TAutoLock<TMutex> lockL(mTimerListMutex);
-            mTimerList.erase(timerID);
-            lockL.unlock();
 
-            // 事件队列里面把这个ID的都干掉
-            TAutoLock<TRecursiveMutex> lockQ(mEventListMutex);
-
-            auto itrQ = mTimerEventQueue.begin();
+            auto itr = mTimerList.find(timerID);
+            if (itr == mTimerList.end())
+            {
+                break;
+            }
 
-            while (itrQ != mTimerEventQueue.end())
+            if (itr->second.pending == 0)
             {
-                auto itrCur = itrQ++;
-                if (timerID == itrCur->timerID)
-                {
-                    mTimerEventQueue.erase(itrCur);
-                }
+                mTimerList.erase(itr);
+            }
+            else
+            {
+                itr->second.alive = false;
             }
         } while (0);
 
@@ -115,71 +150,130 @@ namespace Tiny3D
         return ret;
     }
 
+    void TimerService::compactHeap()
+    {
+        if (mTimerHeap.size() <= 2 * mTimerList.size() + 64)
+            return;
+
+        mTimerHeap.clear();
+
+        for (const auto &value : mTimerList)
+        {
+            const Timer &timer = value.second;
+
+            if (timer.alive && (timer.repeat || timer.pending == 0))
+            {
+                TimerNode node = { timer.deadline, value.first };
+                mTimerHeap.push_back(node);
+            }
+        }
+
+        std::make_heap(mTimerHeap.begin(), mTimerHeap.end(), 
+            std::greater<TimerNode>());
+    }
+
     void TimerService::update()
     {
-        // 这里算法可以优化一下，使用二叉堆，可以快速的通过判断对顶元素是否时间
-        // 到达触发回调来减少遍历
+        TAutoLock<TMutex> lockL(mTimerListMutex);
 
         while (mIsRunning)
         {
-            if (!mTimerList.empty())
+            if (mTimerHeap.empty())
             {
-                int64_t timestamp = DateTime::currentMSecsSinceEpoch();
+                // 没有定时器，一直睡到有新的定时器启动
+                mTimerCond.wait(lockL);
+                continue;
+            }
 
-                TAutoLock<TMutex> lockL(mTimerListMutex);
+            int64_t timestamp = Clock::currentNanoseconds();
+            TimerNode node = mTimerHeap.front();
 
-                auto itr = mTimerList.begin();
+            if (node.deadline > timestamp)
+            {
+                // 睡到最近的定时器到期
+                mTimerCond.wait_for(lockL, 
+                    std::chrono::nanoseconds(node.deadline - timestamp));
+                continue;
+            }
 
-                while (itr != mTimerList.end())
-                {
-                    ID timerID = itr->first;
-                    auto itrCur = itr++;
+            std::pop_heap(mTimerHeap.begin(), mTimerHeap.end(), 
+                std::greater<TimerNode>());
+            mTimerHeap.pop_back();
 
-                    Timer &timer = itrCur->second;
-                    int32_t dt = int32_t(timestamp - timer.timestamp);
+            auto itr = mTimerList.find(node.timerID);
 
-                    if (dt >= timer.interval)
-                    {
-                        timer.timestamp = timestamp;
+            if (itr == mTimerList.end() || !itr->second.alive
+                || itr->second.deadline != node.deadline)
+            {
+                // 已经停止的定时器
+                compactHeap();
+                continue;
+            }
 
-                        // 放到事件队列里
-                        TimerEvent ev = { timerID, dt, timer.listener };
+            Timer &timer = itr->second;
+            int32_t dt = int32_t((timestamp - timer.timestamp) / 1000000LL);
+            timer.timestamp = timestamp;
+            timer.pending++;
 
-                        if (!timer.repeat)
-                        {
-                            // 不循环的定时器，直接删掉
-                            mTimerList.erase(itrCur);
-                        }
+            // 放到事件队列里
+            TimerEvent ev = { node.timerID, dt };
+            mTimerEventQueue.push_back(ev);
 
-                        TAutoLock<TRecursiveMutex> lockQ(mEventListMutex);
-                        mTimerEventQueue.push_back(ev);
-                    }
+            if (timer.repeat)
+            {
+                // 从本次到期时间开始算，避免误差累积，落后太多就从当前时间算
+                timer.deadline = node.deadline + timer.interval;
+                if (timer.deadline <= timestamp)
+                {
+                    timer.deadline = timestamp + timer.interval;
                 }
 
-                lockL.unlock();
+                node.deadline = timer.deadline;
+                mTimerHeap.push_back(node);
+                std::push_heap(mTimerHeap.begin(), mTimerHeap.end(), 
+                    std::greater<TimerNode>());
             }
-
-            // 挂起10ms
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
-
-        int a = 0;
     }
 
     TResult TimerService::pollEvents()
     {
-        // 查询事件并派发
-        TAutoLock<TRecursiveMutex> lockQ(mEventListMutex);
+        // 先把事件都取出来，派发的时候不加锁，回调里面可以启动和停止定时器
+        TimerEventQueue events;
 
-        auto itr = mTimerEventQueue.begin();
+        TAutoLock<TMutex> lockL(mTimerListMutex);
+        events.swap(mTimerEventQueue);
+        lockL.unlock();
 
-        while (itr != mTimerEventQueue.end())
+        for (const TimerEvent &ev : events)
         {
-            TimerEvent ev = *itr++;
-            ev.listener->onTimer(ev.timerID, ev.dt);
-        }
+            lockL.lock();
+
+            auto itr = mTimerList.find(ev.timerID);
+            if (itr == mTimerList.end())
+            {
+                lockL.unlock();
+                continue;
+            }
+
+            Timer &timer = itr->second;
+            ITimerListener *listener = timer.listener;
+            bool alive = timer.alive;
+            timer.pending--;
 
-        mTimerEventQueue.clear();
+            if (timer.pending == 0 && (!timer.repeat || !timer.alive))
+            {
+                // 单次定时器已经触发或者定时器已经停止了，可以删掉
+                mTimerList.erase(itr);
+            }
+
+            lockL.unlock();
+
+            if (alive)
+            {
+                listener->onTimer(ev.timerID, ev.dt);
+            }
+        }
 
         return T3D_ERR_OK;
     }
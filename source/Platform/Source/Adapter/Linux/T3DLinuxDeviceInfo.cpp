@@ -206,6 +206,12 @@ namespace Tiny3D
         Display *display;
         char *displayName = nullptr;
         display = XOpenDisplay(displayName);
+        if (display == nullptr)
+        {
+            // 没有图形界面，比如在服务器上跑测试
+            return;
+        }
+
         int w = DisplayWidth(display, 0);
         int h = DisplayHeight(display, 0);
 
@@ -0,0 +1,111 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "IO/T3DMappedFile.h"
+
+#if !defined (T3D_OS_WINDOWS)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace Tiny3D
+{
+    bool MappedFile::isSupported()
+    {
+#if defined (T3D_OS_WINDOWS)
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    MappedFile *MappedFile::create(const char *szFileName)
+    {
+        MappedFile *mapping = nullptr;
+
+#if !defined (T3D_OS_WINDOWS)
+        do 
+        {
+            int fd = ::open(szFileName, O_RDONLY);
+            if (fd < 0)
+            {
+                break;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+            {
+                ::close(fd);
+                break;
+            }
+
+            size_t size = (size_t)st.st_size;
+            void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            // 映射建立后文件描述符就不再需要了
+            ::close(fd);
+
+            if (data == MAP_FAILED)
+            {
+                break;
+            }
+
+            mapping = new MappedFile((uchar_t *)data, size);
+        } while (0);
+#endif
+
+        return mapping;
+    }
+
+    MappedFile::MappedFile(uchar_t *pData, size_t unSize)
+        : m_unRefCount(1)
+        , m_pData(pData)
+        , m_unSize(unSize)
+    {
+
+    }
+
+    MappedFile::~MappedFile()
+    {
+#if !defined (T3D_OS_WINDOWS)
+        if (m_pData != nullptr)
+        {
+            ::munmap(m_pData, m_unSize);
+            m_pData = nullptr;
+        }
+#endif
+    }
+
+    MappedFile *MappedFile::acquire()
+    {
+        m_unRefCount.fetch_add(1, std::memory_order_relaxed);
+        return this;
+    }
+
+    void MappedFile::release()
+    {
+        if (m_unRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete this;
+        }
+    }
+}
@@ -18,6 +18,7 @@
  ******************************************************************************/
 
 #include "IO/T3DMemoryDataStream.h"
+#include "IO/T3DMappedFile.h"
 #include <memory.h>
 
 
@@ -30,6 +31,7 @@ namespace Tiny3D
         , m_lSize(0)
         , m_lCurPos(0)
         , m_bCreated(false)
+        , m_pMappedFile(nullptr)
     {
 
     }
@@ -40,6 +42,7 @@ namespace Tiny3D
         , m_lSize(unSize)
         , m_lCurPos(0)
         , m_bCreated(false)
+        , m_pMappedFile(nullptr)
     {
         if (reallocate)
         {
@@ -54,21 +57,34 @@ namespace Tiny3D
         , m_lSize(unSize)
         , m_lCurPos(0)
         , m_bCreated(true)
+        , m_pMappedFile(nullptr)
     {
         m_pBuffer = new uchar_t[unSize];
     }
 
+    MemoryDataStream::MemoryDataStream(MappedFile *pMappedFile)
+        : m_pBuffer(nullptr)
+        , m_lSize(0)
+        , m_lCurPos(0)
+        , m_bCreated(false)
+        , m_pMappedFile(nullptr)
+    {
+        setMappedFile(pMappedFile);
+    }
+
     MemoryDataStream::MemoryDataStream(const MemoryDataStream &other)
+        : m_pBuffer(nullptr)
+        , m_lSize(0)
+        , m_lCurPos(0)
+        , m_bCreated(false)
+        , m_pMappedFile(nullptr)
     {
         copy(other);
     }
 
     MemoryDataStream::~MemoryDataStream()
     {
-        if (m_bCreated)
-        {
-            T3D_SAFE_DELETE_ARRAY(m_pBuffer);
-        }
+        releaseBuffer();
     }
 
     MemoryDataStream &MemoryDataStream::operator=(const MemoryDataStream &other)
@@ -88,6 +104,12 @@ namespace Tiny3D
 
     size_t MemoryDataStream::write(void *pBuffer, size_t nSize)
     {
+        if (m_pMappedFile != nullptr)
+        {
+            // 内存映射文件是只读的
+            return 0;
+        }
+
         long_t lSpace = m_lSize - m_lCurPos - 1;
         long_t lBytesOfWritten =
             (long_t)nSize > lSpace ? lSpace : (long_t)nSize;
@@ -144,9 +166,10 @@ namespace Tiny3D
     void MemoryDataStream::setBuffer(uint8_t *buffer, size_t bufSize,
         bool reallocate /* = true */)
     {
+        releaseBuffer();
+
         if (reallocate)
         {
-            T3D_SAFE_DELETE_ARRAY(m_pBuffer);
             m_lSize = bufSize;
             m_pBuffer = new uint8_t[m_lSize];
             memcpy(m_pBuffer, buffer, m_lSize);
@@ -166,16 +189,59 @@ namespace Tiny3D
         bufSize = m_lSize;
     }
 
+    void MemoryDataStream::setMappedFile(MappedFile *pMappedFile)
+    {
+        if (pMappedFile != nullptr)
+        {
+            // 先持有引用，防止传入的就是当前正在使用的映射文件
+            pMappedFile->acquire();
+        }
+
+        releaseBuffer();
+
+        m_pMappedFile = pMappedFile;
+
+        if (m_pMappedFile != nullptr)
+        {
+            m_pBuffer = m_pMappedFile->getData();
+            m_lSize = m_pMappedFile->getSize();
+        }
+        else
+        {
+            m_pBuffer = nullptr;
+            m_lSize = 0;
+        }
+
+        m_lCurPos = 0;
+        m_bCreated = false;
+    }
+
     void MemoryDataStream::copy(const MemoryDataStream &other)
     {
-        if (m_bCreated)
+        if (this == &other)
         {
-            T3D_SAFE_DELETE_ARRAY(m_pBuffer);
+            return;
+        }
+
+        if (other.m_pMappedFile != nullptr)
+        {
+            // 映射文件只共享引用，不拷贝数据
+            setMappedFile(other.m_pMappedFile);
+            m_lCurPos = other.m_lCurPos;
+            return;
+        }
+
+        releaseBuffer();
+
+        if (other.m_bCreated)
+        {
+            // 源数据流自己持有缓冲区，复制一份，两边各自释放
             m_pBuffer = new uchar_t[other.m_lSize];
             memcpy(m_pBuffer, other.m_pBuffer, other.m_lSize);
         }
         else
         {
+            // 源数据流借用外部缓冲区，一起借用
             m_pBuffer = other.m_pBuffer;
         }
 
@@ -183,4 +249,19 @@ namespace Tiny3D
         m_lCurPos = other.m_lCurPos;
         m_bCreated = other.m_bCreated;
     }
+
+    void MemoryDataStream::releaseBuffer()
+    {
+        if (m_pMappedFile != nullptr)
+        {
+            // 借用的映射区域不属于数据流，只释放引用
+            m_pMappedFile->release();
+            m_pMappedFile = nullptr;
+            m_pBuffer = nullptr;
+        }
+        else if (m_bCreated)
+        {
+            T3D_SAFE_DELETE_ARRAY(m_pBuffer);
+        }
+    }
 }
@@ -0,0 +1,402 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "Memory/T3DMemoryPool.h"
+
+
+namespace Tiny3D
+{
+    //--------------------------------------------------------------------------
+
+    MemoryPool::MemoryPool(size_t blockSize, size_t blocksPerChunk)
+        : mFreeList(nullptr)
+        , mBlockSize(blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize)
+        , mBlocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1)
+        , mUsedBlocks(0)
+        , mPeakBlocks(0)
+        , mAllocCount(0)
+        , mFreeCount(0)
+    {
+
+    }
+
+    MemoryPool::~MemoryPool()
+    {
+        for (auto itr = mChunks.begin(); itr != mChunks.end(); ++itr)
+        {
+            ::operator delete(*itr);
+        }
+
+        mChunks.clear();
+        mFreeList = nullptr;
+    }
+
+    void MemoryPool::grow()
+    {
+        uchar_t *chunk = (uchar_t *)::operator new(mBlockSize * mBlocksPerChunk);
+        mChunks.push_back(chunk);
+
+        // 倒着串起来，分配的时候就是按地址从低到高
+        for (size_t i = mBlocksPerChunk; i > 0; --i)
+        {
+            FreeBlock *block = (FreeBlock *)(chunk + (i - 1) * mBlockSize);
+            block->next = mFreeList;
+            mFreeList = block;
+        }
+    }
+
+    void *MemoryPool::allocate()
+    {
+        TAutoLock<TMutex> lock(mMutex);
+
+        if (mFreeList == nullptr)
+        {
+            grow();
+        }
+
+        FreeBlock *block = mFreeList;
+        mFreeList = block->next;
+
+        ++mAllocCount;
+        if (++mUsedBlocks > mPeakBlocks)
+        {
+            mPeakBlocks = mUsedBlocks;
+        }
+
+        return block;
+    }
+
+    void MemoryPool::deallocate(void *ptr)
+    {
+        if (ptr == nullptr)
+            return;
+
+        TAutoLock<TMutex> lock(mMutex);
+
+        FreeBlock *block = (FreeBlock *)ptr;
+        block->next = mFreeList;
+        mFreeList = block;
+
+        ++mFreeCount;
+        --mUsedBlocks;
+    }
+
+    void *MemoryPool::allocateBatch(size_t count)
+    {
+        FreeBlock *head = nullptr;
+        FreeBlock **link = &head;
+
+        TAutoLock<TMutex> lock(mMutex);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (mFreeList == nullptr)
+            {
+                grow();
+            }
+
+            FreeBlock *block = mFreeList;
+            mFreeList = block->next;
+            *link = block;
+            link = &block->next;
+        }
+
+        *link = nullptr;
+
+        mAllocCount += count;
+        mUsedBlocks += count;
+        if (mUsedBlocks > mPeakBlocks)
+        {
+            mPeakBlocks = mUsedBlocks;
+        }
+
+        return head;
+    }
+
+    void MemoryPool::deallocateBatch(void *head, void *tail, size_t count)
+    {
+        if (head == nullptr)
+            return;
+
+        TAutoLock<TMutex> lock(mMutex);
+
+        ((FreeBlock *)tail)->next = mFreeList;
+        mFreeList = (FreeBlock *)head;
+
+        mFreeCount += count;
+        mUsedBlocks -= count;
+    }
+
+    MemoryPool::Stats MemoryPool::getStats() const
+    {
+        TAutoLock<TMutex> lock(mMutex);
+
+        Stats stats;
+        stats.blockSize = mBlockSize;
+        stats.chunkCount = mChunks.size();
+        stats.totalBlocks = mChunks.size() * mBlocksPerChunk;
+        stats.usedBlocks = mUsedBlocks;
+        stats.peakBlocks = mPeakBlocks;
+        stats.allocCount = mAllocCount;
+        stats.freeCount = mFreeCount;
+        return stats;
+    }
+
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief 线程缓存，每一级内存池一个空闲链表
+     * @remarks 只有平凡类型的成员，线程退出清理之后再访问也是安全的
+     */
+    struct ThreadCache
+    {
+        struct FreeBlock
+        {
+            FreeBlock   *next;
+        };
+
+        FreeBlock   *heads[PoolAllocator::MAX_POOLS];   /**< 各级空闲链表 */
+        size_t      counts[PoolAllocator::MAX_POOLS];   /**< 各级空闲链表长度 */
+        bool        registered; /**< 是否已经注册线程退出的清理 */
+        bool        retired;    /**< 线程已经退出清理，之后直接走内存池 */
+    };
+
+    /**
+     * @brief 线程退出时把缓存还给内存池
+     */
+    struct ThreadCacheReaper
+    {
+        ~ThreadCacheReaper();
+    };
+
+    static thread_local ThreadCache sThreadCache;
+
+    ThreadCacheReaper::~ThreadCacheReaper()
+    {
+        T3D_POOL_ALLOCATOR.flushThreadCache();
+
+        // 后面析构的线程局部对象和全局对象还可能释放内存
+        sThreadCache.retired = true;
+    }
+
+    /// 访问一次线程局部的 ThreadCacheReaper，线程退出时才会析构它
+    static void registerThreadCache(ThreadCache &cache)
+    {
+        static thread_local ThreadCacheReaper reaper;
+        (void)&reaper;
+        cache.registered = true;
+    }
+
+    //--------------------------------------------------------------------------
+
+    PoolAllocator &PoolAllocator::getInstance()
+    {
+        // 故意不释放，进程退出时全局对象析构还会用到
+        static PoolAllocator *instance = new PoolAllocator();
+        return *instance;
+    }
+
+    PoolAllocator::PoolAllocator()
+        : mHook(nullptr)
+        , mLargeAllocCount(0)
+    {
+        for (size_t i = 0; i < MAX_POOLS; ++i)
+        {
+            mPools[i] = nullptr;
+        }
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        for (size_t i = 0; i < MAX_POOLS; ++i)
+        {
+            MemoryPool *pool = mPools[i];
+            T3D_SAFE_DELETE(pool);
+            mPools[i] = nullptr;
+        }
+    }
+
+    MemoryPool *PoolAllocator::getPool(size_t index)
+    {
+        MemoryPool *pool = mPools[index].load(std::memory_order_acquire);
+
+        if (pool == nullptr)
+        {
+            TAutoLock<TMutex> lock(mPoolsMutex);
+
+            pool = mPools[index].load(std::memory_order_relaxed);
+
+            if (pool == nullptr)
+            {
+                // 每次向系统申请大约 16KB
+                size_t blockSize = (index + 1) * POOL_GRANULARITY;
+                pool = new MemoryPool(blockSize, 16384 / blockSize);
+                mPools[index].store(pool, std::memory_order_release);
+            }
+        }
+
+        return pool;
+    }
+
+    void *PoolAllocator::allocate(size_t size)
+    {
+        void *ptr = nullptr;
+
+        if (size > 0 && size <= MAX_POOL_SIZE)
+        {
+            size_t index = (size - 1) / POOL_GRANULARITY;
+            ThreadCache &cache = sThreadCache;
+
+            if (cache.retired)
+            {
+                ptr = getPool(index)->allocate();
+            }
+            else
+            {
+                if (cache.counts[index] == 0)
+                {
+                    if (!cache.registered)
+                    {
+                        registerThreadCache(cache);
+                    }
+
+                    cache.heads[index] = (ThreadCache::FreeBlock *)
+                        getPool(index)->allocateBatch(THREAD_CACHE_BATCH);
+                    cache.counts[index] = THREAD_CACHE_BATCH;
+                }
+
+                ThreadCache::FreeBlock *block = cache.heads[index];
+                cache.heads[index] = block->next;
+                --cache.counts[index];
+                ptr = block;
+            }
+        }
+        else
+        {
+            mLargeAllocCount.fetch_add(1, std::memory_order_relaxed);
+            ptr = ::operator new(size);
+        }
+
+        if (mHook != nullptr)
+        {
+            mHook(ptr, size, true);
+        }
+
+        return ptr;
+    }
+
+    void PoolAllocator::deallocate(void *ptr, size_t size)
+    {
+        if (ptr == nullptr)
+            return;
+
+        if (mHook != nullptr)
+        {
+            mHook(ptr, size, false);
+        }
+
+        if (size > 0 && size <= MAX_POOL_SIZE)
+        {
+            size_t index = (size - 1) / POOL_GRANULARITY;
+            ThreadCache &cache = sThreadCache;
+
+            if (cache.retired)
+            {
+                getPool(index)->deallocate(ptr);
+            }
+            else
+            {
+                if (!cache.registered)
+                {
+                    registerThreadCache(cache);
+                }
+
+                ThreadCache::FreeBlock *block = (ThreadCache::FreeBlock *)ptr;
+                block->next = cache.heads[index];
+                cache.heads[index] = block;
+
+                if (++cache.counts[index] >= 2 * THREAD_CACHE_BATCH)
+                {
+                    // 缓存太多了，最近释放的留着，其余的还给内存池
+                    ThreadCache::FreeBlock *tail = block;
+                    for (size_t i = 1; i < THREAD_CACHE_BATCH; ++i)
+                    {
+                        tail = tail->next;
+                    }
+
+                    ThreadCache::FreeBlock *head = tail->next;
+                    tail->next = nullptr;
+                    cache.heads[index] = block;
+                    cache.counts[index] = THREAD_CACHE_BATCH;
+
+                    ThreadCache::FreeBlock *last = head;
+                    while (last->next != nullptr)
+                    {
+                        last = last->next;
+                    }
+
+                    getPool(index)->deallocateBatch(head, last,
+                        THREAD_CACHE_BATCH);
+                }
+            }
+        }
+        else
+        {
+            ::operator delete(ptr);
+        }
+    }
+
+    void PoolAllocator::flushThreadCache()
+    {
+        ThreadCache &cache = sThreadCache;
+
+        for (size_t i = 0; i < MAX_POOLS; ++i)
+        {
+            ThreadCache::FreeBlock *head = cache.heads[i];
+
+            if (head == nullptr)
+                continue;
+
+            ThreadCache::FreeBlock *tail = head;
+            while (tail->next != nullptr)
+            {
+                tail = tail->next;
+            }
+
+            getPool(i)->deallocateBatch(head, tail, cache.counts[i]);
+            cache.heads[i] = nullptr;
+            cache.counts[i] = 0;
+        }
+    }
+
+    void PoolAllocator::getStats(TArray<MemoryPool::Stats> &stats) const
+    {
+        stats.clear();
+
+        for (size_t i = 0; i < MAX_POOLS; ++i)
+        {
+            MemoryPool *pool = mPools[i].load(std::memory_order_acquire);
+
+            if (pool != nullptr)
+            {
+                stats.push_back(pool->getStats());
+            }
+        }
+    }
+}
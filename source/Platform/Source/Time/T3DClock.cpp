@@ -0,0 +1,70 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "Time/T3DClock.h"
+
+#if defined (T3D_OS_WINDOWS)
+#include <windows.h>
+#elif defined (T3D_OS_IOS) || defined (T3D_OS_OSX)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+
+namespace Tiny3D
+{
+#if defined (T3D_OS_WINDOWS)
+    static int64_t getPerformanceFrequency()
+    {
+        LARGE_INTEGER freq;
+        ::QueryPerformanceFrequency(&freq);
+        return (int64_t)freq.QuadPart;
+    }
+#elif defined (T3D_OS_IOS) || defined (T3D_OS_OSX)
+    static mach_timebase_info_data_t getTimebase()
+    {
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        return timebase;
+    }
+#endif
+
+    int64_t Clock::currentNanoseconds()
+    {
+#if defined (T3D_OS_WINDOWS)
+        static const int64_t freq = getPerformanceFrequency();
+        LARGE_INTEGER counter;
+        ::QueryPerformanceCounter(&counter);
+        // 分开算整数秒和余数，避免乘以 10^9 后溢出
+        int64_t sec = counter.QuadPart / freq;
+        int64_t rem = counter.QuadPart % freq;
+        return sec * 1000000000LL + rem * 1000000000LL / freq;
+#elif defined (T3D_OS_IOS) || defined (T3D_OS_OSX)
+        static const mach_timebase_info_data_t timebase = getTimebase();
+        uint64_t ticks = mach_absolute_time();
+        return (int64_t)(ticks / timebase.denom * timebase.numer
+            + ticks % timebase.denom * timebase.numer / timebase.denom);
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+    }
+}
@@ -81,6 +81,11 @@ namespace Tiny3D
          */
         virtual TResult read(const String &name, MemoryDataStream &stream) override;
 
+        /**
+         * @brief 重写 Archieve::open() 接口
+         */
+        virtual TResult open(const String &name, DataStream *&stream) override;
+
         /**
          * @brief 重写 Archieve::write() 接口
          */
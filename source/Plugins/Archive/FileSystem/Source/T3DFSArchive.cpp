@@ -95,6 +95,18 @@ namespace Tiny3D
 
         do 
         {
+            if (MappedFile::isSupported())
+            {
+                // 支持内存映射的平台，数据流直接借用映射区域，不再拷贝文件内容
+                MappedFile *mapping = MappedFile::create(path.c_str());
+                if (mapping != nullptr)
+                {
+                    stream.setMappedFile(mapping);
+                    mapping->release();
+                    break;
+                }
+            }
+
             ret = getFileStreamFromCache(name, fs);
             if (ret != T3D_ERR_OK)
             {
@@ -117,6 +129,7 @@ namespace Tiny3D
             uint8_t *data = new uint8_t[size];
             if (fs->read(data, size) != size)
             {
+                T3D_SAFE_DELETE_ARRAY(data);
                 ret = T3D_ERR_FILE_DATA_MISSING;
                 T3D_LOG_ERROR("Read file [%s] from file system failed !", 
                     name.c_str());
@@ -129,6 +142,32 @@ namespace Tiny3D
         return ret;
     }
 
+    TResult FileSystemArchive::open(const String &name, DataStream *&stream)
+    {
+        String path = Engine::getInstance().getAppPath() + getLocation() 
+            + Dir::NATIVE_SEPARATOR + name;
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            // 不使用文件流缓存，返回的数据流归调用者所有，读取时才从文件读数据
+            FileDataStream *fs = new FileDataStream();
+
+            if (!fs->open(path.c_str(), FileDataStream::E_MODE_READ_ONLY))
+            {
+                T3D_SAFE_DELETE(fs);
+                ret = T3D_ERR_FILE_NOT_EXIST;
+                T3D_LOG_ERROR("Open file [%s] from file system failed !", 
+                    name.c_str());
+                break;
+            }
+
+            stream = fs;
+        } while (0);
+
+        return ret;
+    }
+
     TResult FileSystemArchive::write(const String &name, 
         const MemoryDataStream &stream)
     {
@@ -220,7 +259,7 @@ namespace Tiny3D
                     stream = fs;
                 }
 
-                uint64_t timestamp = DateTime::currentMSecsSinceEpoch();
+                uint64_t timestamp = Clock::currentNanoseconds();
                 mFileIndexCache.insert(FileIndexCacheValue(timestamp, name));
                 mFileStreamCache.insert(FileStreamCacheValue(name, stream));
             }
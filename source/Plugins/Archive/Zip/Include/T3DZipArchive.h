@@ -81,6 +81,19 @@ namespace Tiny3D
          */
         virtual TResult read(const String &name, MemoryDataStream &stream) override;
 
+        /**
+         * @brief 重写 Archieve::readMany() 接口
+         * @remarks 按文件数据在 zip 里的偏移排序后分给多个线程解压，每个线程
+         *      使用自己的 zip 文件句柄，整体上仍然按顺序读盘
+         */
+        virtual TResult readMany(const TArray<String> &names, 
+            TArray<MemoryDataStream> &streams, size_t threads = 0) override;
+
+        /**
+         * @brief 重写 Archieve::open() 接口
+         */
+        virtual TResult open(const String &name, DataStream *&stream) override;
+
         /**
          * @brief 重写 Archieve::write() 接口
          */
@@ -91,8 +104,67 @@ namespace Tiny3D
          */
         ZipArchive(const String &name);
 
+        /**
+         * @brief 遍历 zip 中央目录，建立文件名到文件位置的索引
+         * @remarks 只在 load() 时遍历一次，之后 exists() 和 read() 直接查表，
+         *      避免每次调用 unzLocateFile 线性扫描中央目录
+         */
+        TResult buildEntryIndex();
+
+        /**
+         * @brief 规范化文件名，统一使用 '/' 作为分隔符并去掉开头的 './' 和 '/'
+         */
+        static String normalizeName(const String &name);
+
+        /**
+         * @brief 取一个空闲的 zip 文件句柄，没有空闲的就新打开一个
+         * @remarks 同一个句柄同时只能有一个线程使用，用完调用 releaseHandle()
+         */
+        THandle acquireHandle();
+
+        /**
+         * @brief 把句柄放回空闲列表，空闲句柄已经够多时直接关闭
+         */
+        void releaseHandle(THandle zip);
+
     protected:
-        THandle     mZipFile;   /**< zip 压缩文件句柄 */
+        enum
+        {
+            PARALLEL_MIN_FILES = 16,    /**< readMany() 每个线程至少分到的文件数 */
+        };
+
+        /**
+         * @brief zip 中单个文件的索引信息
+         */
+        struct ZipEntry
+        {
+            uint64_t    posInCentralDir;    /**< 在中央目录中的偏移 */
+            uint64_t    numOfFile;          /**< 在 zip 中的文件序号 */
+            uint64_t    dataOffset;         /**< 文件数据在 zip 文件里的偏移 */
+            uint64_t    compressedSize;     /**< 压缩后的大小 */
+            uint64_t    uncompressedSize;   /**< 压缩前的大小 */
+            uint32_t    compressMethod;     /**< 压缩方法 */
+        };
+
+        typedef TUnorderedMap<String, ZipEntry>     EntryIndex;
+        typedef EntryIndex::iterator                EntryIndexItr;
+        typedef EntryIndex::const_iterator          EntryIndexConstItr;
+        typedef EntryIndex::value_type              EntryIndexValue;
+
+        typedef TList<THandle>                      Handles;
+
+        /**
+         * @brief 用指定的句柄读取一个文件的全部数据
+         */
+        TResult readEntry(THandle zip, const String &name, 
+            const ZipEntry &entry, MemoryDataStream &stream);
+
+        THandle     mZipFile;       /**< 建立索引用的 zip 压缩文件句柄，也在空闲列表里 */
+        EntryIndex  mEntries;       /**< 中央目录索引，load() 以后只读 */
+        String      mPath;          /**< zip 文件完整路径 */
+        Handles     mFreeHandles;   /**< 空闲的 zip 文件句柄 */
+        TMutex      mHandleMutex;   /**< 空闲句柄列表的互斥量 */
+        size_t      mMaxFreeHandles;    /**< 最多保留的空闲句柄数量 */
     };
 }
 
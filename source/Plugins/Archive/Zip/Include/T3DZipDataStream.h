@@ -0,0 +1,138 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __T3D_ZIP_DATA_STREAM_H__
+#define __T3D_ZIP_DATA_STREAM_H__
+
+
+#include "T3DZipArchivePrerequisites.h"
+
+
+namespace Tiny3D
+{
+    /**
+     * @brief zip 压缩包里单个文件的只读数据流
+     * @remarks 每个数据流单独打开一次 zip 文件，读取时才用 unzReadCurrentFile
+     *      解压需要的部分，解压出来的数据放在一个固定大小的窗口里，
+     *      占用的内存和文件大小无关。
+     *      向前定位时解压并丢弃中间的数据，定位到窗口之前时要从头重新解压，
+     *      所以尽量顺序读取。
+     */
+    class ZipDataStream : public DataStream
+    {
+        T3D_DISABLE_COPY(ZipDataStream);
+
+    public:
+        enum
+        {
+            WINDOW_SIZE = 64 * 1024,    /**< 解压窗口大小 */
+        };
+
+        /**
+         * @brief 构造函数
+         */
+        ZipDataStream();
+
+        /**
+         * @brief 析构函数
+         */
+        virtual ~ZipDataStream();
+
+        /**
+         * @brief 打开 zip 压缩包里的文件
+         * @param [in] path : zip 文件完整路径
+         * @param [in] posInCentralDir : 文件在中央目录中的偏移
+         * @param [in] numOfFile : 文件在 zip 中的序号
+         * @param [in] size : 文件解压后的大小
+         * @return 打开成功返回 T3D_ERR_OK
+         */
+        TResult open(const String &path, uint64_t posInCentralDir,
+            uint64_t numOfFile, uint64_t size);
+
+        /**
+         * @brief 关闭数据流
+         */
+        void close();
+
+        /**
+         * @brief 重写 DataStream::read() 接口
+         */
+        virtual size_t read(void *pBuffer, size_t nSize) override;
+
+        /**
+         * @brief 重写 DataStream::write() 接口，只读数据流，总是返回 0
+         */
+        virtual size_t write(void *pBuffer, size_t nSize) override;
+
+        /**
+         * @brief 重写 DataStream::seek() 接口
+         */
+        virtual bool seek(long_t lPos, bool relative) override;
+
+        /**
+         * @brief 重写 DataStream::tell() 接口
+         */
+        virtual long_t tell() const override;
+
+        /**
+         * @brief 重写 DataStream::size() 接口
+         */
+        virtual long_t size() const override;
+
+        /**
+         * @brief 重写 DataStream::eof() 接口
+         */
+        virtual bool eof() const override;
+
+        /**
+         * @brief 重写 DataStream::read() 接口
+         * @remarks 会把整个文件解压到内存，大文件应该用 read(pBuffer, nSize)
+         */
+        virtual size_t read(uint8_t *&pData) override;
+
+    protected:
+        /**
+         * @brief 从头重新解压
+         */
+        bool rewind();
+
+        /**
+         * @brief 从当前解压位置解压下一块数据到窗口
+         */
+        bool fill();
+
+        /**
+         * @brief 从当前解压位置直接解压到外部缓冲区，不经过窗口
+         */
+        size_t inflate(void *pBuffer, size_t nSize);
+
+    protected:
+        THandle     mZipFile;       /**< zip 文件句柄，只属于本数据流 */
+        uint8_t     *mWindow;       /**< 解压窗口 */
+        uint8_t     *mData;         /**< read(pData) 返回的整个文件数据 */
+        long_t      mSize;          /**< 文件解压后的大小 */
+        long_t      mPos;           /**< 当前读位置 */
+        long_t      mWindowStart;   /**< 窗口第一个字节在文件中的位置 */
+        long_t      mWindowLen;     /**< 窗口里有效数据长度 */
+        long_t      mInflatePos;    /**< 下一次解压出来的数据在文件中的位置 */
+    };
+}
+
+
+#endif  /*__T3D_ZIP_DATA_STREAM_H__*/
@@ -19,7 +19,9 @@
 
 
 #include "T3DZipArchive.h"
+#include "T3DZipDataStream.h"
 #include "minizip/unzip.h"
+#include <atomic>
 
 
 namespace Tiny3D
@@ -42,6 +44,7 @@ namespace Tiny3D
     ZipArchive::ZipArchive(const String &name)
         : Archive(name)
         , mZipFile(nullptr)
+        , mMaxFreeHandles(1)
     {
 
     }
@@ -59,16 +62,31 @@ namespace Tiny3D
 
         do 
         {
-            String path = Engine::getInstance().getAppPath() + getLocation();
+            mPath = Engine::getInstance().getAppPath() + getLocation();
 
             // 打开 zip 文件
-            mZipFile = unzOpen64(path.c_str());
+            mZipFile = unzOpen64(mPath.c_str());
             if (mZipFile == nullptr)
             {
                 ret = T3D_ERR_FILE_NOT_EXIST;
-                T3D_LOG_ERROR("Open zip file [%s] failed !", path.c_str());
+                T3D_LOG_ERROR("Open zip file [%s] failed !", mPath.c_str());
                 break;
             }
+
+            // 建立中央目录索引
+            ret = buildEntryIndex();
+            if (ret != T3D_ERR_OK)
+            {
+                unzClose(mZipFile);
+                mZipFile = nullptr;
+                break;
+            }
+
+            // 建完索引的句柄作为第一个空闲句柄给 read() 使用，
+            // 每个硬件线程最多保留一个空闲句柄
+            mFreeHandles.push_back(mZipFile);
+            mMaxFreeHandles = std::max(
+                (size_t)TThread::hardware_concurrency(), (size_t)1);
         } while (0);
 
         return ret;
@@ -76,11 +94,20 @@ namespace Tiny3D
 
     TResult ZipArchive::unload()
     {
-        if (mZipFile != nullptr)
+        // mZipFile 也在空闲列表里，一起关闭
+        TAutoLock<TMutex> lock(mHandleMutex);
+
+        for (THandle zip : mFreeHandles)
         {
-            unzClose(mZipFile);
-            mZipFile = nullptr;
+            unzClose(zip);
         }
+
+        mFreeHandles.clear();
+        lock.unlock();
+
+        mZipFile = nullptr;
+
+        mEntries.clear();
         
         return T3D_ERR_OK;
     }
@@ -116,27 +143,58 @@ namespace Tiny3D
                 break;
             }
 
-            // 跳到指定文件，如果文件不存在，则失败了
-            int zret = 0;
-            zret = unzLocateFile(mZipFile, name.c_str(), 0);
-            if (zret != UNZ_OK)
+            ret = (mEntries.find(normalizeName(name)) != mEntries.end());
+        } while (0);
+
+        return ret;
+    }
+
+    TResult ZipArchive::read(const String &name, MemoryDataStream &stream)
+    {
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            if (mZipFile == nullptr)
             {
-                ret = false;
-                T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed ! \
-                    Error : %d", name.c_str(), mName.c_str(), zret);
+                ret = T3D_ERR_FILE_NOT_EXIST;
+                T3D_LOG_ERROR("Open zip file [%s] failed !", mName.c_str());
+                break;
+            }
+
+            // 从索引中查找文件
+            auto itr = mEntries.find(normalizeName(name));
+            if (itr == mEntries.end())
+            {
+                ret = T3D_ERR_ZIP_FILE_LOCATE_FILE;
+                T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed !",
+                    name.c_str(), mName.c_str());
+                break;
+            }
+
+            // 每个线程用自己的句柄，多个线程可以同时读
+            THandle zip = acquireHandle();
+            if (zip == nullptr)
+            {
+                ret = T3D_ERR_FILE_NOT_EXIST;
                 break;
             }
 
-            ret = true;
+            ret = readEntry(zip, name, itr->second, stream);
+            releaseHandle(zip);
         } while (0);
 
         return ret;
     }
 
-    TResult ZipArchive::read(const String &name, MemoryDataStream &stream)
+    TResult ZipArchive::readMany(const TArray<String> &names, 
+        TArray<MemoryDataStream> &streams, size_t threads /* = 0 */)
     {
         TResult ret = T3D_ERR_OK;
 
+        streams.clear();
+        streams.resize(names.size());
+
         do 
         {
             if (mZipFile == nullptr)
@@ -146,33 +204,239 @@ namespace Tiny3D
                 break;
             }
 
-            int zret = 0;
+            // 先查索引，找不到的直接记下错误
+            struct Job
+            {
+                const ZipEntry  *entry;
+                size_t          index;
+            };
 
-            // 跳到指定文件
-            zret = unzLocateFile(mZipFile, name.c_str(), 0);
-            if (zret != UNZ_OK)
+            TArray<Job> jobs;
+            TArray<TResult> results(names.size(), T3D_ERR_OK);
+            jobs.reserve(names.size());
+
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                auto itr = mEntries.find(normalizeName(names[i]));
+
+                if (itr == mEntries.end())
+                {
+                    results[i] = T3D_ERR_ZIP_FILE_LOCATE_FILE;
+                    T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed !",
+                        names[i].c_str(), mName.c_str());
+                }
+                else
+                {
+                    Job job = { &itr->second, i };
+                    jobs.push_back(job);
+                }
+            }
+
+            // 按文件数据在 zip 里的偏移读，各个线程依次领取下一个文件，
+            // 读盘的位置总体上一直往前走。中央目录的顺序不一定是数据的顺序
+            std::sort(jobs.begin(), jobs.end(), 
+                [](const Job &a, const Job &b)
+            {
+                return a.entry->dataOffset < b.entry->dataOffset;
+            });
+
+            if (threads == 0)
+            {
+                threads = TThread::hardware_concurrency();
+            }
+
+            // 文件太少时开线程不划算
+            threads = std::min(threads, jobs.size() / PARALLEL_MIN_FILES);
+            threads = std::max(threads, (size_t)1);
+
+            std::atomic<size_t> next(0);
+
+            auto work = [&]()
+            {
+                THandle zip = acquireHandle();
+                size_t i;
+
+                while ((i = next.fetch_add(1)) < jobs.size())
+                {
+                    const Job &job = jobs[i];
+
+                    if (zip != nullptr)
+                    {
+                        results[job.index] = readEntry(zip, names[job.index],
+                            *job.entry, streams[job.index]);
+                    }
+                    else
+                    {
+                        results[job.index] = T3D_ERR_FILE_NOT_EXIST;
+                    }
+                }
+
+                if (zip != nullptr)
+                {
+                    releaseHandle(zip);
+                }
+            };
+
+            TArray<TThread> workers;
+
+            for (size_t t = 1; t < threads; ++t)
+            {
+                workers.push_back(TThread(work));
+            }
+
+            work();
+
+            for (size_t t = 0; t < workers.size(); ++t)
+            {
+                workers[t].join();
+            }
+
+            for (TResult r : results)
+            {
+                if (r != T3D_ERR_OK)
+                {
+                    ret = r;
+                    break;
+                }
+            }
+        } while (0);
+
+        return ret;
+    }
+
+    TResult ZipArchive::open(const String &name, DataStream *&stream)
+    {
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            if (mZipFile == nullptr)
+            {
+                ret = T3D_ERR_FILE_NOT_EXIST;
+                T3D_LOG_ERROR("Open zip file [%s] failed !", mName.c_str());
+                break;
+            }
+
+            // 从索引中查找文件
+            auto itr = mEntries.find(normalizeName(name));
+            if (itr == mEntries.end())
             {
                 ret = T3D_ERR_ZIP_FILE_LOCATE_FILE;
-                T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed ! \
-                    Error : %d", name.c_str(), mName.c_str(), zret);
+                T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed !",
+                    name.c_str(), mName.c_str());
                 break;
             }
 
-            // 获取压缩前的文件信息
-            unz_file_info64 fileInfo;
-            char filename[256];
-            zret = unzGetCurrentFileInfo64(mZipFile, &fileInfo, filename,
-                sizeof(filename), NULL, 0, NULL, 0);
+            const ZipEntry &entry = itr->second;
+
+            ZipDataStream *zs = new ZipDataStream();
+            ret = zs->open(mPath, entry.posInCentralDir, entry.numOfFile,
+                entry.uncompressedSize);
+            if (ret != T3D_ERR_OK)
+            {
+                T3D_SAFE_DELETE(zs);
+                T3D_LOG_ERROR("Open file [%s] in zip file [%s] failed !",
+                    name.c_str(), mName.c_str());
+                break;
+            }
+
+            stream = zs;
+        } while (0);
+
+        return ret;
+    }
+
+    TResult ZipArchive::write(const String &name, const MemoryDataStream &stream)
+    {
+        T3D_LOG_ERROR("Could not support append any file into current zip file [%s] !",
+            mName.c_str());
+        return T3D_ERR_ZIP_FILE_NOT_SUPPORT;
+    }
+
+    //--------------------------------------------------------------------------
+
+    THandle ZipArchive::acquireHandle()
+    {
+        THandle zip = nullptr;
+
+        TAutoLock<TMutex> lock(mHandleMutex);
+
+        if (!mFreeHandles.empty())
+        {
+            zip = mFreeHandles.front();
+            mFreeHandles.pop_front();
+        }
+
+        lock.unlock();
+
+        if (zip == nullptr)
+        {
+            // 只读取末尾的中央目录信息，不会重新遍历中央目录
+            zip = unzOpen64(mPath.c_str());
+
+            if (zip == nullptr)
+            {
+                T3D_LOG_ERROR("Open zip file [%s] failed !", mPath.c_str());
+            }
+        }
+
+        return zip;
+    }
+
+    void ZipArchive::releaseHandle(THandle zip)
+    {
+        THandle extra = nullptr;
+
+        TAutoLock<TMutex> lock(mHandleMutex);
+
+        if (mFreeHandles.size() < mMaxFreeHandles)
+        {
+            mFreeHandles.push_back(zip);
+        }
+        else if (zip != mZipFile)
+        {
+            extra = zip;
+        }
+        else
+        {
+            // mZipFile 一直保留，关掉另外一个
+            extra = mFreeHandles.front();
+            mFreeHandles.pop_front();
+            mFreeHandles.push_back(zip);
+        }
+
+        lock.unlock();
+
+        if (extra != nullptr)
+        {
+            unzClose(extra);
+        }
+    }
+
+    TResult ZipArchive::readEntry(THandle zip, const String &name, 
+        const ZipEntry &entry, MemoryDataStream &stream)
+    {
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            // 直接跳到索引记录的位置，不需要扫描中央目录
+            unz64_file_pos pos;
+            pos.pos_in_zip_directory = entry.posInCentralDir;
+            pos.num_of_file = entry.numOfFile;
+
+            int zret = 0;
+            zret = unzGoToFilePos64(zip, &pos);
             if (zret != UNZ_OK)
             {
-                ret = T3D_ERR_ZIP_FILE_GET_FILE_INFO;
-                T3D_LOG_ERROR("Get file [%s] info in zip file [%s] failed ! \
+                ret = T3D_ERR_ZIP_FILE_LOCATE_FILE;
+                T3D_LOG_ERROR("Locate file [%s] in zip file [%s] failed ! \
                     Error : %d", name.c_str(), mName.c_str(), zret);
                 break;
             }
 
             // 打开当前文件
-            zret = unzOpenCurrentFile(mZipFile);
+            zret = unzOpenCurrentFile(zip);
             if (zret != UNZ_OK)
             {
                 ret = T3D_ERR_ZIP_FILE_OPEN_FILE;
@@ -182,31 +446,173 @@ namespace Tiny3D
             }
 
             // 读取文件内容
-            uint64_t contentSize = fileInfo.uncompressed_size;
+            uint64_t contentSize = entry.uncompressedSize;
             uchar_t *content = new uchar_t[contentSize];
 
-            zret = unzReadCurrentFile(mZipFile, content, contentSize);
-            if (zret < 0)
+            zret = unzReadCurrentFile(zip, content, contentSize);
+            unzCloseCurrentFile(zip);
+
+            if (zret < 0 || (uint64_t)zret != contentSize)
             {
-                unzCloseCurrentFile(mZipFile);
+                T3D_SAFE_DELETE_ARRAY(content);
                 ret = T3D_ERR_ZIP_FILE_READ_DATA;
                 T3D_LOG_ERROR("Get file [%s] data in zip file [%s] failed ! \
                     Error : %d", name.c_str(), mName.c_str(), zret);
                 break;
             }
 
-            stream.setBuffer(content, contentSize);
+            // 数据直接交给数据流管理，不再拷贝一次
+            stream.setBuffer(content, contentSize, false);
 
         } while (0);
 
         return ret;
     }
 
-    TResult ZipArchive::write(const String &name, const MemoryDataStream &stream)
+    //--------------------------------------------------------------------------
+
+    TResult ZipArchive::buildEntryIndex()
     {
-        T3D_LOG_ERROR("Could not support append any file into current zip file [%s] !",
-            mName.c_str());
-        return T3D_ERR_ZIP_FILE_NOT_SUPPORT;
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            mEntries.clear();
+
+            // 获取文件数量，预先分配好索引空间
+            unz_global_info64 globalInfo;
+            int zret = unzGetGlobalInfo64(mZipFile, &globalInfo);
+            if (zret != UNZ_OK)
+            {
+                ret = T3D_ERR_ZIP_FILE_INFO;
+                T3D_LOG_ERROR("Get global info of zip file [%s] failed ! \
+                    Error : %d", mName.c_str(), zret);
+                break;
+            }
+
+            mEntries.reserve((size_t)globalInfo.number_entry);
+
+            zret = unzGoToFirstFile(mZipFile);
+            if (zret != UNZ_OK && zret != UNZ_END_OF_LIST_OF_FILE)
+            {
+                ret = T3D_ERR_ZIP_FILE_GOTO_FILE;
+                T3D_LOG_ERROR("Go to first file in zip file [%s] failed ! \
+                    Error : %d", mName.c_str(), zret);
+                break;
+            }
+
+            // 遍历一次中央目录，记录每个文件的位置和大小
+            TArray<char> nameBuffer(256);
+            unz_file_info64 fileInfo;
+            unz64_file_pos pos;
+
+            while (zret == UNZ_OK)
+            {
+                // 先取文件名长度，缓冲区不够就加大，长文件名不会被截断
+                zret = unzGetCurrentFileInfo64(mZipFile, &fileInfo, NULL, 0,
+                    NULL, 0, NULL, 0);
+                if (zret == UNZ_OK)
+                {
+                    if (fileInfo.size_filename >= nameBuffer.size())
+                    {
+                        nameBuffer.resize((size_t)fileInfo.size_filename + 1);
+                    }
+
+                    zret = unzGetCurrentFileInfo64(mZipFile, &fileInfo,
+                        &nameBuffer[0], (uLong)nameBuffer.size(),
+                        NULL, 0, NULL, 0);
+                }
+
+                if (zret != UNZ_OK)
+                {
+                    ret = T3D_ERR_ZIP_FILE_GET_FILE_INFO;
+                    T3D_LOG_ERROR("Get file info in zip file [%s] failed ! \
+                        Error : %d", mName.c_str(), zret);
+                    break;
+                }
+
+                const char *filename = &nameBuffer[0];
+
+                zret = unzGetFilePos64(mZipFile, &pos);
+                if (zret != UNZ_OK)
+                {
+                    ret = T3D_ERR_ZIP_FILE_GET_FILE_INFO;
+                    T3D_LOG_ERROR("Get file position in zip file [%s] failed !\
+                        Error : %d", mName.c_str(), zret);
+                    break;
+                }
+
+                ZipEntry entry;
+                entry.posInCentralDir = pos.pos_in_zip_directory;
+                entry.numOfFile = pos.num_of_file;
+                entry.dataOffset = 0;
+
+                // 以原始模式打开当前文件，只读本地文件头，不初始化解压，
+                // 用来取得文件数据在 zip 文件里的偏移。本地文件头坏了的
+                // 文件仍然放进索引，读的时候再报错
+                if (unzOpenCurrentFile2(mZipFile, NULL, NULL, 1) == UNZ_OK)
+                {
+                    entry.dataOffset = unzGetCurrentFileZStreamPos64(mZipFile);
+                    unzCloseCurrentFile(mZipFile);
+                }
+                else
+                {
+                    T3D_LOG_WARNING("Read local header of file [%s] in zip \
+                        file [%s] failed !", filename, mName.c_str());
+                }
+
+
+                entry.compressedSize = fileInfo.compressed_size;
+                entry.uncompressedSize = fileInfo.uncompressed_size;
+                entry.compressMethod = (uint32_t)fileInfo.compression_method;
+                mEntries.insert(EntryIndexValue(normalizeName(filename), entry));
+
+                zret = unzGoToNextFile(mZipFile);
+            }
+
+            if (ret != T3D_ERR_OK)
+            {
+                mEntries.clear();
+                break;
+            }
+
+            if (zret != UNZ_END_OF_LIST_OF_FILE)
+            {
+                ret = T3D_ERR_ZIP_FILE_GOTO_FILE;
+                mEntries.clear();
+                T3D_LOG_ERROR("Iterate files in zip file [%s] failed ! \
+                    Error : %d", mName.c_str(), zret);
+                break;
+            }
+        } while (0);
+
+        return ret;
+    }
+
+    String ZipArchive::normalizeName(const String &name)
+    {
+        String result(name);
+        std::replace(result.begin(), result.end(), '\\', '/');
+
+        size_t start = 0;
+
+        while (start < result.length())
+        {
+            if (result[start] == '/')
+            {
+                start += 1;
+            }
+            else if (result.compare(start, 2, "./") == 0)
+            {
+                start += 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return result.substr(start);
     }
 }
 
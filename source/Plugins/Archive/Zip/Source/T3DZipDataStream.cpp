@@ -0,0 +1,295 @@
+﻿/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "T3DZipDataStream.h"
+#include "minizip/unzip.h"
+
+
+namespace Tiny3D
+{
+    //--------------------------------------------------------------------------
+
+    ZipDataStream::ZipDataStream()
+        : mZipFile(nullptr)
+        , mWindow(nullptr)
+        , mData(nullptr)
+        , mSize(0)
+        , mPos(0)
+        , mWindowStart(0)
+        , mWindowLen(0)
+        , mInflatePos(0)
+    {
+
+    }
+
+    ZipDataStream::~ZipDataStream()
+    {
+        close();
+    }
+
+    //--------------------------------------------------------------------------
+
+    TResult ZipDataStream::open(const String &path, uint64_t posInCentralDir,
+        uint64_t numOfFile, uint64_t size)
+    {
+        TResult ret = T3D_ERR_OK;
+
+        do 
+        {
+            close();
+
+            // 单独打开一次 zip 文件，不和档案对象共用当前文件状态
+            mZipFile = unzOpen64(path.c_str());
+            if (mZipFile == nullptr)
+            {
+                ret = T3D_ERR_FILE_NOT_EXIST;
+                T3D_LOG_ERROR("Open zip file [%s] failed !", path.c_str());
+                break;
+            }
+
+            unz64_file_pos pos;
+            pos.pos_in_zip_directory = posInCentralDir;
+            pos.num_of_file = numOfFile;
+
+            int zret = unzGoToFilePos64(mZipFile, &pos);
+            if (zret != UNZ_OK)
+            {
+                ret = T3D_ERR_ZIP_FILE_LOCATE_FILE;
+                T3D_LOG_ERROR("Locate file in zip file [%s] failed ! \
+                    Error : %d", path.c_str(), zret);
+                break;
+            }
+
+            zret = unzOpenCurrentFile(mZipFile);
+            if (zret != UNZ_OK)
+            {
+                ret = T3D_ERR_ZIP_FILE_OPEN_FILE;
+                T3D_LOG_ERROR("Open current file in zip file [%s] failed ! \
+                    Error : %d", path.c_str(), zret);
+                break;
+            }
+
+            mSize = (long_t)size;
+            mWindow = new uint8_t[WINDOW_SIZE];
+        } while (0);
+
+        if (ret != T3D_ERR_OK && mZipFile != nullptr)
+        {
+            unzClose(mZipFile);
+            mZipFile = nullptr;
+        }
+
+        return ret;
+    }
+
+    void ZipDataStream::close()
+    {
+        if (mZipFile != nullptr)
+        {
+            unzCloseCurrentFile(mZipFile);
+            unzClose(mZipFile);
+            mZipFile = nullptr;
+        }
+
+        T3D_SAFE_DELETE_ARRAY(mWindow);
+        T3D_SAFE_DELETE_ARRAY(mData);
+
+        mSize = 0;
+        mPos = 0;
+        mWindowStart = 0;
+        mWindowLen = 0;
+        mInflatePos = 0;
+    }
+
+    //--------------------------------------------------------------------------
+
+    size_t ZipDataStream::read(void *pBuffer, size_t nSize)
+    {
+        uint8_t *dst = (uint8_t *)pBuffer;
+        size_t bytesOfRead = 0;
+
+        while (mZipFile != nullptr && bytesOfRead < nSize && mPos < mSize)
+        {
+            size_t remain = nSize - bytesOfRead;
+
+            if (mPos >= mWindowStart && mPos < mWindowStart + mWindowLen)
+            {
+                // 窗口里已经有数据，直接拷贝
+                size_t n = (size_t)(mWindowStart + mWindowLen - mPos);
+                n = (n < remain ? n : remain);
+                memcpy(dst + bytesOfRead, mWindow + (mPos - mWindowStart), n);
+                bytesOfRead += n;
+                mPos += n;
+                continue;
+            }
+
+            if (mPos < mInflatePos)
+            {
+                // 要读的数据已经解压过并且不在窗口里，只能从头再解压
+                if (!rewind())
+                {
+                    break;
+                }
+            }
+
+            if (mPos == mInflatePos && remain >= WINDOW_SIZE)
+            {
+                // 大块读取直接解压到外部缓冲区，省掉一次拷贝
+                size_t n = inflate(dst + bytesOfRead, remain);
+                if (n == 0)
+                {
+                    break;
+                }
+
+                bytesOfRead += n;
+                mPos += n;
+                mWindowStart = mInflatePos;
+                mWindowLen = 0;
+            }
+            else
+            {
+                // 解压下一块到窗口，向前定位过的会一直解压并丢弃数据，
+                // 直到窗口包含读位置
+                if (!fill())
+                {
+                    break;
+                }
+            }
+        }
+
+        return bytesOfRead;
+    }
+
+    size_t ZipDataStream::write(void *pBuffer, size_t nSize)
+    {
+        T3D_LOG_ERROR("Could not write into file in zip file !");
+        return 0;
+    }
+
+    bool ZipDataStream::seek(long_t lPos, bool relative)
+    {
+        long_t pos = (relative ? mPos + lPos : lPos);
+
+        if (mZipFile == nullptr || pos < 0 || pos > mSize)
+        {
+            return false;
+        }
+
+        // 只记录位置，读取时才解压
+        mPos = pos;
+        return true;
+    }
+
+    long_t ZipDataStream::tell() const
+    {
+        return mPos;
+    }
+
+    long_t ZipDataStream::size() const
+    {
+        return mSize;
+    }
+
+    bool ZipDataStream::eof() const
+    {
+        return (mPos >= mSize);
+    }
+
+    size_t ZipDataStream::read(uint8_t *&pData)
+    {
+        size_t bytesOfRead = 0;
+
+        if (mZipFile != nullptr)
+        {
+            if (mData == nullptr)
+            {
+                mData = new uint8_t[mSize];
+            }
+
+            long_t pos = mPos;
+            mPos = 0;
+            bytesOfRead = read(mData, mSize);
+            mPos = pos;
+            pData = mData;
+        }
+
+        return bytesOfRead;
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool ZipDataStream::rewind()
+    {
+        unzCloseCurrentFile(mZipFile);
+
+        int zret = unzOpenCurrentFile(mZipFile);
+        if (zret != UNZ_OK)
+        {
+            T3D_LOG_ERROR("Reopen current file in zip file failed ! \
+                Error : %d", zret);
+            return false;
+        }
+
+        mWindowStart = 0;
+        mWindowLen = 0;
+        mInflatePos = 0;
+        return true;
+    }
+
+    bool ZipDataStream::fill()
+    {
+        mWindowStart = mInflatePos;
+        mWindowLen = (long_t)inflate(mWindow, WINDOW_SIZE);
+        return (mWindowLen > 0);
+    }
+
+    size_t ZipDataStream::inflate(void *pBuffer, size_t nSize)
+    {
+        uint8_t *dst = (uint8_t *)pBuffer;
+        size_t bytesOfRead = 0;
+
+        // 不要超出文件大小，unzReadCurrentFile 一次最多读 unsigned int 大小
+        size_t remain = (size_t)(mSize - mInflatePos);
+        nSize = (nSize < remain ? nSize : remain);
+
+        while (bytesOfRead < nSize)
+        {
+            size_t n = nSize - bytesOfRead;
+            n = (n < 0x40000000 ? n : 0x40000000);
+
+            int zret = unzReadCurrentFile(mZipFile, dst + bytesOfRead, 
+                (unsigned)n);
+            if (zret <= 0)
+            {
+                if (zret < 0)
+                {
+                    T3D_LOG_ERROR("Read data from zip file failed ! \
+                        Error : %d", zret);
+                }
+                break;
+            }
+
+            bytesOfRead += zret;
+        }
+
+        mInflatePos += bytesOfRead;
+        return bytesOfRead;
+    }
+}
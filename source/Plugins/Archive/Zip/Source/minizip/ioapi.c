@@ -10,8 +10,6 @@
 
 */
 
-#include <stdio.h>
-
 #if defined(_WIN32) && (!(defined(_CRT_SECURE_NO_WARNINGS)))
         #define _CRT_SECURE_NO_WARNINGS
 #endif
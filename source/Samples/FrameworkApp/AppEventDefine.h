@@ -30,6 +30,7 @@ enum AppEvent
     EV_RESERVED = 0,
     EV_ATTACKED,
     EV_DEFEND,
+    EV_BENCHMARK,
 };
 
 
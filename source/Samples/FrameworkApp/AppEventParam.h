@@ -78,4 +78,28 @@ protected:
 };
 
 
+class BenchmarkParam : public EventParam
+{
+public:
+    BenchmarkParam(uint32_t seq)
+        : Sequence(seq)
+    {
+    }
+
+    virtual ~BenchmarkParam()
+    {
+    }
+
+protected:
+    virtual EventParam *clone() override
+    {
+        BenchmarkParam *param = new BenchmarkParam(Sequence);
+        return param;
+    }
+
+public:
+    uint32_t    Sequence;
+};
+
+
 #endif  /*__APP_EVENT_PARAM_H__*/
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "EventBenchmark.h"
+
+
+T3D_BEGIN_EVENT_FILTER(EventBenchmark, EventHandler)
+    T3D_EVENT_FILTER(EV_BENCHMARK)
+T3D_END_EVENT_FILTER()
+
+T3D_BEGIN_EVENT_MAP(EventBenchmark, EventHandler)
+    T3D_ON_EVENT(EV_BENCHMARK, onBenchmark)
+T3D_END_EVENT_MAP()
+
+
+EventBenchmark::EventBenchmark()
+    : mReceived(0)
+{
+    T3D_SETUP_EVENT_FILTER();
+}
+
+EventBenchmark::~EventBenchmark()
+{
+
+}
+
+void EventBenchmark::run(uint32_t frames, uint32_t eventsPerFrame)
+{
+    mReceived = 0;
+
+    // 先预热一帧，让参数内存池和事件队列达到稳定的容量
+    for (uint32_t i = 0; i < eventsPerFrame; ++i)
+    {
+        BenchmarkParam param(i);
+        postEvent(EV_BENCHMARK, &param, getInstance());
+    }
+
+    T3D_EVENT_MGR.dispatchEvent();
+    mReceived = 0;
+
+    int64_t start = Clock::currentNanoseconds();
+
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        for (uint32_t i = 0; i < eventsPerFrame; ++i)
+        {
+            BenchmarkParam param(i);
+            postEvent(EV_BENCHMARK, &param, getInstance());
+        }
+
+        T3D_EVENT_MGR.dispatchEvent();
+    }
+
+    int64_t elapsed = Clock::currentNanoseconds() - start;
+    uint64_t posted = (uint64_t)frames * eventsPerFrame;
+    double seconds = (double)elapsed / 1000000000.0;
+    double rate = seconds > 0.0 ? (double)mReceived / seconds : 0.0;
+
+    T3D_LOG_INFO("Event benchmark : posted [%llu], received [%llu], "
+        "elapsed [%lld] ns, [%.0f] events/sec",
+        (unsigned long long)posted, (unsigned long long)mReceived,
+        (long long)elapsed, rate);
+}
+
+TResult EventBenchmark::onBenchmark(EventParam *param, TINSTANCE sender)
+{
+    mReceived++;
+    return T3D_ERR_OK;
+}
+
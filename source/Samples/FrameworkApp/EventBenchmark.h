@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * This file is part of Tiny3D (Tiny 3D Graphic Rendering Engine)
+ * Copyright (C) 2015-2019  Answer Wong
+ * For latest info, see https://github.com/asnwerear/Tiny3D
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#ifndef __EVENT_BENCHMARK_H__
+#define __EVENT_BENCHMARK_H__
+
+
+#include <Tiny3D.h>
+#include "AppEventDefine.h"
+#include "AppEventParam.h"
+
+
+using namespace Tiny3D;
+
+
+/**
+ * @brief 事件吞吐量测试，每帧投递一批事件再派发，最后输出每秒处理的事件数
+ */
+class EventBenchmark : public EventHandler
+{
+    T3D_DECLARE_EVENT_FILTER();
+    T3D_DECLARE_EVENT_MAP();
+
+public:
+    EventBenchmark();
+    virtual ~EventBenchmark();
+
+    /**
+     * @brief 运行测试
+     * @param [in] frames : 模拟的帧数
+     * @param [in] eventsPerFrame : 每帧投递的事件数
+     */
+    void run(uint32_t frames, uint32_t eventsPerFrame);
+
+protected:
+    TResult onBenchmark(EventParam *param, TINSTANCE sender);
+
+    uint64_t    mReceived;
+};
+
+
+#endif  /*__EVENT_BENCHMARK_H__*/
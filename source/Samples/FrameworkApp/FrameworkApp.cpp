@@ -20,14 +20,16 @@
 #include "FrameworkApp.h"
 #include "Player.h"
 #include "Enemy.h"
+#include "EventBenchmark.h"
 
 
 using namespace Tiny3D;
 
-FrameworkApp::FrameworkApp()
+FrameworkApp::FrameworkApp(bool runEventBenchmark /* = false */)
     : Application()
     , mPlayer(nullptr)
     , mEnemy(nullptr)
+    , mRunEventBenchmark(runEventBenchmark)
 {
 }
 
@@ -43,6 +45,13 @@ bool FrameworkApp::applicationDidFinishLaunching()
     mEnemy->idle();
     mPlayer->attack(mEnemy->getInstance());
 
+    if (mRunEventBenchmark)
+    {
+        // 测试事件投递和派发的吞吐量
+        EventBenchmark benchmark;
+        benchmark.run(1000, 1000);
+    }
+
     return true;
 }
 
@@ -64,6 +73,6 @@ void FrameworkApp::applicationWillTerminate()
 
 void FrameworkApp::applicationLowMemory()
 {
-
+    T3D_ENGINE.appLowMemory();
 }
 
@@ -30,7 +30,10 @@ class Entity;
 class FrameworkApp : public Tiny3D::Application
 {
 public:
-    FrameworkApp();
+    /**
+     * @param [in] runEventBenchmark : 启动后是否跑一遍事件吞吐量测试
+     */
+    FrameworkApp(bool runEventBenchmark = false);
     virtual ~FrameworkApp();
 
 protected:  /// from Tiny3D::Application
@@ -46,6 +49,8 @@ protected:  /// from Tiny3D::Application
 
     Entity  *mPlayer;
     Entity  *mEnemy;
+
+    bool    mRunEventBenchmark;
 };
 
 
@@ -19,10 +19,21 @@
 
 
 #include "FrameworkApp.h"
+#include <string.h>
 
 int main(int argc, char *argv[])
 {
-    FrameworkApp *theApp = new FrameworkApp();
+    // 带上 --event-benchmark 参数时启动后跑事件吞吐量测试
+    bool runEventBenchmark = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--event-benchmark") == 0)
+        {
+            runEventBenchmark = true;
+        }
+    }
+
+    FrameworkApp *theApp = new FrameworkApp(runEventBenchmark);
     Tiny3D::Engine *theEngine = new Tiny3D::Engine();
 
     theEngine->init(argv[0]);
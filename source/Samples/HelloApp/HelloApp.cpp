@@ -56,7 +56,7 @@ void HelloApp::applicationWillTerminate()
 
 void HelloApp::applicationLowMemory()
 {
-
+    T3D_ENGINE.appLowMemory();
 }
 
 void HelloApp::onTimer(uint32_t timerID, int32_t dt)
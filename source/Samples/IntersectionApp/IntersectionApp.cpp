@@ -161,6 +161,9 @@ bool IntersectionApp::applicationDidFinishLaunching()
     // ׶OBBཻ
     testFrustumObb();
 
+    // ׶üܲ
+    benchFrustumCulling();
+
     return true;
 }
 
@@ -542,6 +545,137 @@ void IntersectionApp::testFrustumObb()
     printf("Frustum and OBB #1 intersection result is %d\n", isIntersection);
 }
 
+void IntersectionApp::benchFrustumCulling()
+{
+    const size_t ObjectCount = 100000;
+    const size_t FrameCount = 20;
+
+    Frustum frustum;
+    buildFrustum(frustum);
+
+    // 尴˳УλҲڣﰴռ֯
+    TArray<Sphere> spheres(ObjectCount);
+    TArray<Aabb> boxes(ObjectCount);
+    Vector3Stream centers(ObjectCount);
+    Vector3Stream mins(ObjectCount);
+    Vector3Stream maxs(ObjectCount);
+    TArray<Real> radii(ObjectCount);
+
+    srand(0);
+
+    size_t i = 0;
+    for (i = 0; i < ObjectCount; ++i)
+    {
+        Real jitter = Real((float32_t)rand() / RAND_MAX);
+        Vector3 center(
+            Real(float32_t(i % 50)) * Real(1.6f) - Real(40) + jitter,
+            Real(float32_t((i / 50) % 40)) * Real(1.6f) - Real(32),
+            Real(float32_t(i / 2000)) * Real(1.6f) - Real(40) - jitter);
+        Real radius = REAL_HALF + jitter * REAL_HALF;
+
+        spheres[i] = Sphere(center, radius);
+        boxes[i] = Aabb(center.x() - radius, center.x() + radius,
+            center.y() - radius, center.y() + radius,
+            center.z() - radius, center.z() + radius);
+
+        centers.set(i, center);
+        radii[i] = radius;
+        mins.set(i, Vector3(boxes[i].getMinX(), boxes[i].getMinY(),
+            boxes[i].getMinZ()));
+        maxs.set(i, Vector3(boxes[i].getMaxX(), boxes[i].getMaxY(),
+            boxes[i].getMaxZ()));
+    }
+
+    FrustumCuller culler(frustum);
+    TArray<uint32_t> mask(FrustumCuller::getMaskSize(ObjectCount));
+    TArray<uint8_t> cache(FrustumCuller::getCacheSize(ObjectCount), 0);
+
+    size_t frame = 0;
+    size_t visible = 0;
+    size_t mismatch = 0;
+    int64_t start, elapsed;
+
+    // 
+    IntrFrustumSphere intrSphere;
+    intrSphere.setFrustum(&frustum);
+
+    start = Clock::currentNanoseconds();
+    for (frame = 0; frame < FrameCount; ++frame)
+    {
+        visible = 0;
+        for (i = 0; i < ObjectCount; ++i)
+        {
+            intrSphere.setSphere(&spheres[i]);
+            visible += intrSphere.test();
+        }
+    }
+    elapsed = Clock::currentNanoseconds() - start;
+    printf("Frustum culling %u spheres one by one : %.3f ms/frame, %u visible\n",
+        (uint32_t)ObjectCount, elapsed / 1000000.0 / FrameCount,
+        (uint32_t)visible);
+
+    // 
+    start = Clock::currentNanoseconds();
+    for (frame = 0; frame < FrameCount; ++frame)
+    {
+        visible = culler.cullSpheres(centers, radii.data(), mask.data(),
+            cache.data());
+    }
+    elapsed = Clock::currentNanoseconds() - start;
+
+    for (i = 0; i < ObjectCount; ++i)
+    {
+        intrSphere.setSphere(&spheres[i]);
+        if (intrSphere.test() != FrustumCuller::isVisible(mask.data(), i))
+            ++mismatch;
+    }
+
+    printf("Frustum culling %u spheres in batch : %.3f ms/frame, %u visible, %u mismatch\n",
+        (uint32_t)ObjectCount, elapsed / 1000000.0 / FrameCount,
+        (uint32_t)visible, (uint32_t)mismatch);
+
+    // AABB
+    IntrFrustumAabb intrBox;
+    intrBox.setFrustum(&frustum);
+
+    start = Clock::currentNanoseconds();
+    for (frame = 0; frame < FrameCount; ++frame)
+    {
+        visible = 0;
+        for (i = 0; i < ObjectCount; ++i)
+        {
+            intrBox.setBox(&boxes[i]);
+            visible += intrBox.test();
+        }
+    }
+    elapsed = Clock::currentNanoseconds() - start;
+    printf("Frustum culling %u AABBs one by one : %.3f ms/frame, %u visible\n",
+        (uint32_t)ObjectCount, elapsed / 1000000.0 / FrameCount,
+        (uint32_t)visible);
+
+    // AABB
+    std::fill(cache.begin(), cache.end(), 0);
+
+    start = Clock::currentNanoseconds();
+    for (frame = 0; frame < FrameCount; ++frame)
+    {
+        visible = culler.cullAabbs(mins, maxs, mask.data(), cache.data());
+    }
+    elapsed = Clock::currentNanoseconds() - start;
+
+    mismatch = 0;
+    for (i = 0; i < ObjectCount; ++i)
+    {
+        intrBox.setBox(&boxes[i]);
+        if (intrBox.test() != FrustumCuller::isVisible(mask.data(), i))
+            ++mismatch;
+    }
+
+    printf("Frustum culling %u AABBs in batch : %.3f ms/frame, %u visible, %u mismatch\n",
+        (uint32_t)ObjectCount, elapsed / 1000000.0 / FrameCount,
+        (uint32_t)visible, (uint32_t)mismatch);
+}
+
 void IntersectionApp::buildFrustum(Frustum &frustum)
 {
     // Frustumƽ
@@ -77,6 +77,9 @@ protected:  // from Tiny3D::Application
     // ׶OBBཻ
     void testFrustumObb();
 
+    // ׶ü׶üĺʱԱ
+    void benchFrustumCulling();
+
     void buildFrustum(Tiny3D::Frustum &frustum);
 };
 
@@ -60,7 +60,7 @@ void PlatformApp::applicationWillTerminate()
 
 void PlatformApp::applicationLowMemory()
 {
-
+    T3D_ENGINE.appLowMemory();
 }
 
 void PlatformApp::onTimer(uint32_t timerID, int32_t dt)